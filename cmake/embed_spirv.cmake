@@ -0,0 +1,52 @@
+# generates a c++ source that embeds compiled spir-v into the executable.
+# see `engine/shaders/embedded/embedded_spirv.hpp`
+#
+# usage:
+#   cmake -DOUTPUT=<generated.cpp> -DSPIRV_FILES=<a.spv|b.spv|...> -P embed_spirv.cmake
+#
+# NOTE : the file list is '|' separated, because ';' would be split by add_custom_command
+
+string(REPLACE "|" ";" SPIRV_FILES "${SPIRV_FILES}")
+
+set(ARRAYS "")
+set(TABLE "")
+set(INDEX 0)
+foreach(SPIRV ${SPIRV_FILES})
+  get_filename_component(FILE_NAME ${SPIRV} NAME)
+  file(READ ${SPIRV} HEX_CONTENT HEX)
+  string(LENGTH "${HEX_CONTENT}" HEX_LENGTH)
+  math(EXPR BYTE_COUNT "${HEX_LENGTH} / 2")
+  # spir-v is a stream of little endian 32 bit words
+  string(REGEX REPLACE
+    "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+    "0x\\4\\3\\2\\1u,"
+    WORDS "${HEX_CONTENT}")
+  string(APPEND ARRAYS "    const uint32_t spirv${INDEX}[] = {${WORDS}};\n")
+  string(APPEND TABLE "      {\"${FILE_NAME}\", spirv${INDEX}, ${BYTE_COUNT}},\n")
+  math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+file(WRITE ${OUTPUT}
+"// generated by cmake/embed_spirv.cmake -- do not edit
+#include \"engine/shaders/embedded/embedded_spirv.hpp\"
+
+namespace walrus::embedded {
+
+  namespace {
+${ARRAYS}
+    const SpirvBlob blobs[] = {
+${TABLE}      {nullptr, nullptr, 0}
+    };
+  }
+
+  const SpirvBlob *findSpirv(const std::string &fileName) {
+    for (const auto &blob: blobs) {
+      if (blob.fileName != nullptr && fileName == blob.fileName) {
+        return &blob;
+      }
+    }
+    return nullptr;
+  }
+
+} // walrus::embedded
+")
@@ -0,0 +1,124 @@
+// tiled matrix multiply, C = alpha * A * B + beta * C, with row major A (m x k), B (k x n) and C (m x n).
+// each workgroup computes a TILE_M x TILE_N block of C, stepping through k a TILE_K slice at a time:
+// the slices of A & B are staged in shared memory, and each invocation accumulates a THREAD_M x THREAD_N
+// block of C in registers. rows & columns of an invocation's block are strided by the workgroup size,
+// so shared memory reads are conflict free and stores to C are coalesced.
+// tiles past the edges of the matrices are zero padded, so any m, n & k work.
+//
+// include after defining USE_FP16: A & B are stored as 16 bit floats, and converted on load.
+// accumulation is always in 32 bit floats.
+
+// tuned per device -- see blas::Gemm
+layout (local_size_x_id = 0, local_size_y_id = 1) in;
+layout (constant_id = 0) const uint WORKGROUP_X = 16;
+layout (constant_id = 1) const uint WORKGROUP_Y = 16;
+layout (constant_id = 2) const uint THREAD_M = 4;
+layout (constant_id = 3) const uint THREAD_N = 4;
+layout (constant_id = 4) const uint TILE_K = 16;
+
+const uint TILE_M = WORKGROUP_Y * THREAD_M;
+const uint TILE_N = WORKGROUP_X * THREAD_N;
+const uint INVOCATIONS = WORKGROUP_X * WORKGROUP_Y;
+
+#if USE_FP16
+#define ELEMENT float16_t
+#else
+#define ELEMENT float
+#endif
+
+layout (std430, set = 0, binding = 0) readonly buffer MatrixA {
+    ELEMENT values[];
+} a;
+
+layout (std430, set = 0, binding = 1) readonly buffer MatrixB {
+    ELEMENT values[];
+} b;
+
+layout (std430, set = 0, binding = 2) buffer MatrixC {
+    float values[];
+} c;
+
+layout (push_constant) uniform Constants {
+    uint m;
+    uint n;
+    uint k;
+    float alpha;
+    float beta;
+} constants;
+
+// k major, so the inner loop reads THREAD_M rows of A & THREAD_N columns of B from the same slice row
+shared float tileA[TILE_K * TILE_M];
+shared float tileB[TILE_K * TILE_N];
+
+void main()
+{
+    const uint tx = gl_LocalInvocationID.x;
+    const uint ty = gl_LocalInvocationID.y;
+    const uint local = gl_LocalInvocationIndex;
+    const uint rowBase = gl_WorkGroupID.y * TILE_M;
+    const uint colBase = gl_WorkGroupID.x * TILE_N;
+
+    float accumulators[THREAD_M * THREAD_N];
+    for (uint i = 0; i < THREAD_M * THREAD_N; i++) {
+        accumulators[i] = 0.0;
+    }
+    float rowValues[THREAD_M];
+    float colValues[THREAD_N];
+
+    for (uint k0 = 0; k0 < constants.k; k0 += TILE_K) {
+        // cooperative loads: consecutive invocations read consecutive k of A, and consecutive columns of B
+        for (uint i = local; i < TILE_M * TILE_K; i += INVOCATIONS) {
+            const uint row = i / TILE_K;
+            const uint kk = i % TILE_K;
+            const uint globalRow = rowBase + row;
+            const uint globalK = k0 + kk;
+            tileA[kk * TILE_M + row] = globalRow < constants.m && globalK < constants.k
+                                       ? float(a.values[globalRow * constants.k + globalK])
+                                       : 0.0;
+        }
+        for (uint i = local; i < TILE_K * TILE_N; i += INVOCATIONS) {
+            const uint kk = i / TILE_N;
+            const uint col = i % TILE_N;
+            const uint globalK = k0 + kk;
+            const uint globalCol = colBase + col;
+            tileB[kk * TILE_N + col] = globalK < constants.k && globalCol < constants.n
+                                       ? float(b.values[globalK * constants.n + globalCol])
+                                       : 0.0;
+        }
+        barrier();
+
+        for (uint kk = 0; kk < TILE_K; kk++) {
+            for (uint i = 0; i < THREAD_M; i++) {
+                rowValues[i] = tileA[kk * TILE_M + ty + i * WORKGROUP_Y];
+            }
+            for (uint j = 0; j < THREAD_N; j++) {
+                colValues[j] = tileB[kk * TILE_N + tx + j * WORKGROUP_X];
+            }
+            for (uint i = 0; i < THREAD_M; i++) {
+                for (uint j = 0; j < THREAD_N; j++) {
+                    accumulators[i * THREAD_N + j] = fma(rowValues[i], colValues[j], accumulators[i * THREAD_N + j]);
+                }
+            }
+        }
+        barrier();
+    }
+
+    for (uint i = 0; i < THREAD_M; i++) {
+        const uint row = rowBase + ty + i * WORKGROUP_Y;
+        if (row >= constants.m) {
+            break;
+        }
+        for (uint j = 0; j < THREAD_N; j++) {
+            const uint col = colBase + tx + j * WORKGROUP_X;
+            if (col >= constants.n) {
+                break;
+            }
+            const uint index = row * constants.n + col;
+            float result = constants.alpha * accumulators[i * THREAD_N + j];
+            if (constants.beta != 0.0) {
+                result += constants.beta * c.values[index];
+            }
+            c.values[index] = result;
+        }
+    }
+}
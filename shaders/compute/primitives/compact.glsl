@@ -0,0 +1,138 @@
+// single pass stream compaction / partition with decoupled look-back.
+// selected values keep their order at the front of the output. when partitioning, rejected values are written
+// from the back of the output, so they end up in reverse order.
+// the number of selected values is written to `selected`.
+
+#include "values.glsl"
+
+// tuned per device -- see primitives::Compact
+layout (local_size_x_id = 0) in;
+layout (constant_id = 0) const uint WORKGROUP_SIZE = 256;
+layout (constant_id = 1) const uint ITEMS_PER_THREAD = 4;
+layout (constant_id = 2) const uint MIN_SUBGROUP_SIZE = 32;
+layout (constant_id = 3) const uint VALUE_TYPE = TYPE_FLOAT;
+
+layout (std430, set = 0, binding = 0) readonly buffer Input {
+    uint values[];
+} src;
+
+layout (std430, set = 0, binding = 1) writeonly buffer Output {
+    uint values[];
+} dst;
+
+// counts are always uints, whatever the value type
+#define SCAN_TYPE TYPE_UINT
+#define STATE_BINDING 2
+#include "tile_scan.glsl"
+
+layout (std430, set = 0, binding = 3) writeonly buffer Selected {
+    uint count;
+} selected;
+
+// matches primitives::Predicate
+#define PREDICATE_EQUAL 0
+#define PREDICATE_NOT_EQUAL 1
+#define PREDICATE_LESS 2
+#define PREDICATE_LESS_EQUAL 3
+#define PREDICATE_GREATER 4
+#define PREDICATE_GREATER_EQUAL 5
+
+layout (push_constant) uniform Constants {
+    uint count;
+    uint predicate;
+    uint operand; // bits of a VALUE_TYPE value
+    uint partition;
+} constants;
+
+const uint TILE_SIZE = WORKGROUP_SIZE * ITEMS_PER_THREAD;
+shared uint tile[TILE_SIZE];
+
+bool isSelected(uint value)
+{
+    bool less;
+    bool equal;
+    bool greater;
+    if (VALUE_TYPE == TYPE_FLOAT) {
+        const float a = uintBitsToFloat(value);
+        const float b = uintBitsToFloat(constants.operand);
+        less = a < b;
+        equal = a == b;
+        greater = a > b;
+    } else if (VALUE_TYPE == TYPE_INT) {
+        less = int(value) < int(constants.operand);
+        equal = value == constants.operand;
+        greater = int(value) > int(constants.operand);
+    } else {
+        less = value < constants.operand;
+        equal = value == constants.operand;
+        greater = value > constants.operand;
+    }
+    switch (constants.predicate) {
+        case PREDICATE_EQUAL: return equal;
+        case PREDICATE_NOT_EQUAL: return !equal;
+        case PREDICATE_LESS: return less;
+        case PREDICATE_LESS_EQUAL: return less || equal;
+        case PREDICATE_GREATER: return greater;
+        case PREDICATE_GREATER_EQUAL: return greater || equal;
+    }
+    return false;
+}
+
+void main()
+{
+    const uint local = gl_LocalInvocationID.x;
+
+    // the group count is capped at maxComputeWorkGroupCount[0]: groups keep acquiring tiles until none are left.
+    // tiles are still acquired in order, so the look-back only waits on tiles of running groups
+    for (;;) {
+        const uint tileId = acquireTile();
+        const uint tileStart = tileId * TILE_SIZE;
+        if (tileStart >= constants.count) {
+            break; // uniform: every invocation read the same shared tile index
+        }
+
+        // coalesced loads into shared memory
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint index = i * WORKGROUP_SIZE + local;
+            const uint global = tileStart + index;
+            if (global < constants.count) {
+                tile[index] = src.values[global];
+            }
+        }
+        barrier();
+
+        // each invocation owns ITEMS_PER_THREAD consecutive values
+        const uint first = local * ITEMS_PER_THREAD;
+        uint count = 0;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            if (tileStart + first + i < constants.count && isSelected(tile[first + i])) {
+                count++;
+            }
+        }
+        const uint invocationPrefix = workgroupExclusiveScan(count);
+        const uint tileExclusive = lookback(tileId, workgroupTotal);
+
+        // `written` = selected values before the current one
+        uint written = tileExclusive + invocationPrefix;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint global = tileStart + first + i;
+            if (global >= constants.count) {
+                break;
+            }
+            const uint value = tile[first + i];
+            if (isSelected(value)) {
+                dst.values[written] = value;
+                written++;
+            } else if (constants.partition != 0) {
+                const uint rejected = global - written;
+                dst.values[constants.count - 1 - rejected] = value;
+            }
+            if (global == constants.count - 1) {
+                selected.count = written;
+            }
+        }
+
+        // the next tile reuses the shared memory
+        barrier();
+    }
+}
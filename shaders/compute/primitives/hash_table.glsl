@@ -0,0 +1,208 @@
+// lock-free open addressing hash table: build, probe & aggregate kernels, picked by the OPERATION constant.
+// slots hold a key (32 or 64 bit, with KEY64) and a 32 bit value, in two arrays of `capacity` (a power of 2).
+// keys are placed by linear probing from their hash. empty slots hold EMPTY_KEY (all ones), and inserts claim
+// them with an atomic compare-exchange: a claimed slot never changes key, so plain reads of it are safe too.
+// the all ones key itself can't be hashed into the table, and lives in an extra slot at [capacity].
+// a key that finds no slot within MAX_PROBES (a full or badly clustered table) overflows: it is counted
+// in `state`, and the host rebuilds into a larger table -- see primitives::HashTable.
+//
+// include after defining KEY64 (with its extensions: 64 bit types & atomics).
+
+#define USE_SUBGROUPS 0
+#include "values.glsl"
+
+// matches primitives::HashTable
+#define OPERATION_BUILD 0
+#define OPERATION_PROBE 1
+#define OPERATION_AGGREGATE 2
+
+// matches primitives::Aggregate
+#define AGGREGATE_SUM 0
+#define AGGREGATE_MIN 1
+#define AGGREGATE_MAX 2
+#define AGGREGATE_COUNT 3
+
+layout (local_size_x_id = 0) in;
+layout (constant_id = 0) const uint WORKGROUP_SIZE = 256;
+layout (constant_id = 1) const uint OPERATION = OPERATION_BUILD;
+layout (constant_id = 2) const uint AGGREGATE = AGGREGATE_SUM;
+layout (constant_id = 3) const uint VALUE_TYPE = TYPE_UINT;
+layout (constant_id = 4) const uint MAX_PROBES = 128;
+
+#if KEY64
+#define KEY uint64_t
+const KEY EMPTY_KEY = 0xFFFFFFFFFFFFFFFFul;
+#else
+#define KEY uint
+const KEY EMPTY_KEY = 0xFFFFFFFFu;
+#endif
+
+const uint NOT_FOUND = 0xFFFFFFFFu;
+
+layout (std430, set = 0, binding = 0) coherent buffer TableKeys {
+    KEY keys[];
+} table;
+
+layout (std430, set = 0, binding = 1) coherent buffer TableValues {
+    uint values[];
+} tableValues;
+
+layout (std430, set = 0, binding = 2) buffer State {
+    uint overflow; // keys that found no slot
+    uint emptyKeyUsed; // the extra slot holds the all ones key
+} state;
+
+layout (std430, set = 0, binding = 3) readonly buffer Keys {
+    KEY values[];
+} keys;
+
+// build & aggregate: the value of each key (unused by COUNT). probe: the value found for each key, or NOT_FOUND
+layout (std430, set = 0, binding = 4) buffer Values {
+    uint values[];
+} values;
+
+layout (push_constant) uniform Constants {
+    uint count;
+    uint capacity;
+} constants;
+
+
+// murmur3 finalizers: every key bit affects every hash bit, so sequential keys don't cluster
+uint hashKey(KEY key)
+{
+#if KEY64
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdul;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ul;
+    key ^= key >> 33;
+    return uint(key);
+#else
+    key ^= key >> 16;
+    key *= 0x85ebca6bu;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35u;
+    key ^= key >> 16;
+    return key;
+#endif
+}
+
+// the slot of `key`, claiming an empty one if it isn't in the table yet. NOT_FOUND if it overflowed
+uint insertKey(KEY key)
+{
+    if (key == EMPTY_KEY) {
+        state.emptyKeyUsed = 1;
+        return constants.capacity;
+    }
+    const uint mask = constants.capacity - 1;
+    uint slot = hashKey(key) & mask;
+    for (uint probe = 0; probe < min(MAX_PROBES, constants.capacity); probe++) {
+        const KEY current = table.keys[slot];
+        if (current == key) {
+            return slot;
+        }
+        if (current == EMPTY_KEY) {
+            const KEY previous = atomicCompSwap(table.keys[slot], EMPTY_KEY, key);
+            // claimed by this invocation, or by another one inserting the same key
+            if (previous == EMPTY_KEY || previous == key) {
+                return slot;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+    atomicAdd(state.overflow, 1);
+    return NOT_FOUND;
+}
+
+uint findKey(KEY key)
+{
+    if (key == EMPTY_KEY) {
+        return state.emptyKeyUsed != 0 ? constants.capacity : NOT_FOUND;
+    }
+    const uint mask = constants.capacity - 1;
+    uint slot = hashKey(key) & mask;
+    for (uint probe = 0; probe < min(MAX_PROBES, constants.capacity); probe++) {
+        const KEY current = table.keys[slot];
+        if (current == key) {
+            return slot;
+        }
+        if (current == EMPTY_KEY) {
+            return NOT_FOUND;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NOT_FOUND;
+}
+
+
+uint aggregateValues(uint a, uint b)
+{
+    if (AGGREGATE == AGGREGATE_SUM) {
+        return addValues(VALUE_TYPE, a, b);
+    }
+    bool less;
+    if (VALUE_TYPE == TYPE_FLOAT) {
+        less = uintBitsToFloat(a) < uintBitsToFloat(b);
+    } else if (VALUE_TYPE == TYPE_INT) {
+        less = int(a) < int(b);
+    } else {
+        less = a < b;
+    }
+    return (AGGREGATE == AGGREGATE_MIN) == less ? a : b;
+}
+
+void aggregate(uint slot, uint value)
+{
+    if (AGGREGATE == AGGREGATE_COUNT) {
+        atomicAdd(tableValues.values[slot], 1);
+        return;
+    }
+    if (AGGREGATE == AGGREGATE_SUM && VALUE_TYPE != TYPE_FLOAT) {
+        atomicAdd(tableValues.values[slot], value);
+        return;
+    }
+    if (VALUE_TYPE == TYPE_UINT) {
+        if (AGGREGATE == AGGREGATE_MIN) {
+            atomicMin(tableValues.values[slot], value);
+        } else {
+            atomicMax(tableValues.values[slot], value);
+        }
+        return;
+    }
+    // float sums, and int & float min / max: compare-exchange until no other invocation got in between
+    uint expected = tableValues.values[slot];
+    while (true) {
+        const uint desired = aggregateValues(expected, value);
+        if (desired == expected) {
+            return;
+        }
+        const uint previous = atomicCompSwap(tableValues.values[slot], expected, desired);
+        if (previous == expected) {
+            return;
+        }
+        expected = previous;
+    }
+}
+
+
+void main()
+{
+    for (uint i = gl_GlobalInvocationID.x; i < constants.count; i += gl_NumWorkGroups.x * WORKGROUP_SIZE) {
+        const KEY key = keys.values[i];
+        if (OPERATION == OPERATION_PROBE) {
+            const uint slot = findKey(key);
+            values.values[i] = slot == NOT_FOUND ? NOT_FOUND : tableValues.values[slot];
+            continue;
+        }
+        const uint slot = insertKey(key);
+        if (slot == NOT_FOUND) {
+            continue;
+        }
+        if (OPERATION == OPERATION_BUILD) {
+            // duplicate keys: any of their values wins
+            tableValues.values[slot] = values.values[i];
+        } else {
+            aggregate(slot, AGGREGATE == AGGREGATE_COUNT ? 0 : values.values[i]);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+// helpers shared by the radix sort kernels. include after declaring KEY_WORDS and VALUE_TYPE (see values.glsl).
+// keys are KEY_WORDS 32 bit words, least significant first, held in a uvec2 (32 bit keys leave y unused).
+// they are sorted as "ordered" bits, whose unsigned order is the order of the VALUE_TYPE keys:
+// kernels map keys to ordered bits when loading them, and back when storing them.
+
+#define RADIX_BITS 8
+#define RADIX 256
+#define RADIX_MASK 255
+
+const uint SIGN_BIT = 0x80000000u;
+const uint PASS_COUNT = KEY_WORDS * 32 / RADIX_BITS;
+
+
+uint mostSignificantWord(uvec2 key)
+{
+    return KEY_WORDS == 2 ? key.y : key.x;
+}
+
+uvec2 signFlip()
+{
+    return KEY_WORDS == 2 ? uvec2(0, SIGN_BIT) : uvec2(SIGN_BIT, 0);
+}
+
+
+uvec2 toOrderedKey(uvec2 key)
+{
+    if (VALUE_TYPE == TYPE_INT) {
+        return key ^ signFlip();
+    }
+    if (VALUE_TYPE == TYPE_FLOAT) {
+        // negative floats order backwards, so flip all their bits. positive ones only need to follow them
+        return (mostSignificantWord(key) & SIGN_BIT) != 0 ? ~key : key ^ signFlip();
+    }
+    return key;
+}
+
+uvec2 fromOrderedKey(uvec2 key)
+{
+    if (VALUE_TYPE == TYPE_INT) {
+        return key ^ signFlip();
+    }
+    if (VALUE_TYPE == TYPE_FLOAT) {
+        return (mostSignificantWord(key) & SIGN_BIT) != 0 ? key ^ signFlip() : ~key;
+    }
+    return key;
+}
+
+
+// the RADIX_BITS bits of an ordered key starting at `shift`
+uint radixDigit(uvec2 key, uint shift)
+{
+    const uint word = shift < 32 ? key.x : key.y;
+    return (word >> (shift & 31)) & RADIX_MASK;
+}
@@ -0,0 +1,220 @@
+// one pass of an onesweep LSD radix sort: scatters keys (and payloads) to their order by RADIX_BITS bits,
+// in a single dispatch. see Adinets & Merrill, "Onesweep: A Faster Least Significant Digit Radix Sort for GPUs" (2022).
+// each workgroup sorts a tile by the digit in shared memory, then finds where each of its digits goes with a
+// decoupled look-back per digit, on top of the digit offsets computed up front by radix_histogram & radix_scan.
+
+#include "values.glsl"
+
+// tuned per device -- see primitives::RadixSort
+layout (local_size_x_id = 0) in;
+layout (constant_id = 0) const uint WORKGROUP_SIZE = 256;
+layout (constant_id = 1) const uint ITEMS_PER_THREAD = 4;
+layout (constant_id = 2) const uint MIN_SUBGROUP_SIZE = 32;
+layout (constant_id = 3) const uint VALUE_TYPE = TYPE_UINT;
+layout (constant_id = 4) const uint KEY_WORDS = 1;
+layout (constant_id = 5) const uint HAS_PAYLOAD = 1;
+
+#include "radix.glsl"
+
+layout (std430, set = 0, binding = 0) readonly buffer KeysIn {
+    uint values[];
+} keysIn;
+
+layout (std430, set = 0, binding = 1) writeonly buffer KeysOut {
+    uint values[];
+} keysOut;
+
+// bound to the keys when there are no payloads
+layout (std430, set = 0, binding = 2) readonly buffer PayloadsIn {
+    uint values[];
+} payloadsIn;
+
+layout (std430, set = 0, binding = 3) writeonly buffer PayloadsOut {
+    uint values[];
+} payloadsOut;
+
+// scanned by radix_scan
+layout (std430, set = 0, binding = 4) readonly buffer Offsets {
+    uint values[];
+} offsets;
+
+// the look-back state replaces tile_scan's (flag, aggregate, prefix) triplets with one word per digit & tile,
+// [1 + tile * RADIX + digit] = flag << DIGIT_FLAG_SHIFT | count, so a flag & its count are published atomically
+#define SCAN_TYPE TYPE_UINT
+#define STATE_BINDING 5
+#include "tile_scan.glsl"
+
+#define DIGIT_FLAG_SHIFT 30
+#define DIGIT_COUNT_MASK 0x3FFFFFFFu
+
+layout (push_constant) uniform Constants {
+    uint count;
+    uint pass;
+} constants;
+
+const uint TILE_SIZE = WORKGROUP_SIZE * ITEMS_PER_THREAD;
+shared uint tileKeys[TILE_SIZE * KEY_WORDS];
+shared uint tilePayloads[TILE_SIZE];
+shared uint digitCounts[RADIX];
+shared uint digitStarts[RADIX];
+shared uint digitOffsets[RADIX];
+
+
+uint digitOf(uvec2 key)
+{
+    return radixDigit(key, constants.pass * RADIX_BITS);
+}
+
+uvec2 loadTileKey(uint index)
+{
+    return uvec2(tileKeys[index * KEY_WORDS], KEY_WORDS == 2 ? tileKeys[index * KEY_WORDS + 1] : 0);
+}
+
+void storeTile(uint index, uvec2 key, uint payload)
+{
+    tileKeys[index * KEY_WORDS] = key.x;
+    if (KEY_WORDS == 2) {
+        tileKeys[index * KEY_WORDS + 1] = key.y;
+    }
+    if (HAS_PAYLOAD != 0) {
+        tilePayloads[index] = payload;
+    }
+}
+
+
+uint digitSlot(uint tile, uint digit)
+{
+    return 1 + tile * RADIX + digit;
+}
+
+void publishDigit(uint tile, uint digit, uint count)
+{
+    // the first tile's counts are already inclusive prefixes
+    const uint flag = tile == 0 ? FLAG_PREFIX : FLAG_AGGREGATE;
+    atomicExchange(state.values[digitSlot(tile, digit)], (flag << DIGIT_FLAG_SHIFT) | count);
+}
+
+// keys of `digit` in the tiles before `tile`. publishes the tile's inclusive prefix for the tiles after it
+uint lookbackDigit(uint tile, uint digit, uint count)
+{
+    if (tile == 0) {
+        return 0;
+    }
+    uint exclusive = 0;
+    int previous = int(tile) - 1;
+    while (previous >= 0) {
+        const uint entry = atomicAdd(state.values[digitSlot(uint(previous), digit)], 0);
+        const uint flag = entry >> DIGIT_FLAG_SHIFT;
+        if (flag == FLAG_NOT_READY) {
+            continue; // the previous tile already started, so it will publish soon
+        }
+        exclusive += entry & DIGIT_COUNT_MASK;
+        if (flag == FLAG_PREFIX) {
+            break;
+        }
+        previous--;
+    }
+    atomicExchange(state.values[digitSlot(tile, digit)], (FLAG_PREFIX << DIGIT_FLAG_SHIFT) | (exclusive + count));
+    return exclusive;
+}
+
+
+void main()
+{
+    const uint tileId = acquireTile();
+    const uint local = gl_LocalInvocationID.x;
+    const uint tileStart = tileId * TILE_SIZE;
+    const uint tileCount = min(TILE_SIZE, constants.count - tileStart);
+
+    for (uint digit = local; digit < RADIX; digit += WORKGROUP_SIZE) {
+        digitCounts[digit] = 0;
+    }
+
+    // coalesced loads into shared memory. keys past the end have every digit set, so they sort last in the tile
+    for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+        const uint index = i * WORKGROUP_SIZE + local;
+        uvec2 key = uvec2(0xFFFFFFFFu);
+        uint payload = 0;
+        if (index < tileCount) {
+            const uint global = tileStart + index;
+            const uint word = global * KEY_WORDS;
+            key = toOrderedKey(uvec2(keysIn.values[word], KEY_WORDS == 2 ? keysIn.values[word + 1] : 0));
+            payload = HAS_PAYLOAD != 0 ? payloadsIn.values[global] : 0;
+        }
+        storeTile(index, key, payload);
+    }
+    barrier();
+
+    // each invocation owns ITEMS_PER_THREAD consecutive keys
+    const uint first = local * ITEMS_PER_THREAD;
+    uvec2 keys[ITEMS_PER_THREAD];
+    uint payloads[ITEMS_PER_THREAD];
+    for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+        keys[i] = loadTileKey(first + i);
+        payloads[i] = HAS_PAYLOAD != 0 ? tilePayloads[first + i] : 0;
+        if (first + i < tileCount) {
+            atomicAdd(digitCounts[digitOf(keys[i])], 1);
+        }
+    }
+    barrier();
+
+    // publish the counts before sorting the tile, so the tiles after this one can look back past it sooner
+    for (uint digit = local; digit < RADIX; digit += WORKGROUP_SIZE) {
+        publishDigit(tileId, digit, digitCounts[digit]);
+    }
+
+    // stable sort of the tile by digit, one split per digit bit
+    for (uint bit = 0; bit < RADIX_BITS; bit++) {
+        uint zeros = 0;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            zeros += 1 - ((digitOf(keys[i]) >> bit) & 1);
+        }
+        uint zerosBefore = workgroupExclusiveScan(zeros);
+        const uint totalZeros = workgroupTotal;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            uint position;
+            if (((digitOf(keys[i]) >> bit) & 1) == 0) {
+                position = zerosBefore;
+                zerosBefore++;
+            } else {
+                // ones before this key = keys before it - zeros before it
+                position = totalZeros + first + i - zerosBefore;
+            }
+            storeTile(position, keys[i], payloads[i]);
+        }
+        barrier();
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            keys[i] = loadTileKey(first + i);
+            payloads[i] = HAS_PAYLOAD != 0 ? tilePayloads[first + i] : 0;
+        }
+    }
+
+    // where each digit starts in the sorted tile
+    for (uint i = local; i < tileCount; i += WORKGROUP_SIZE) {
+        const uint digit = digitOf(loadTileKey(i));
+        if (i == 0 || digitOf(loadTileKey(i - 1)) != digit) {
+            digitStarts[digit] = i;
+        }
+    }
+
+    for (uint digit = local; digit < RADIX; digit += WORKGROUP_SIZE) {
+        const uint exclusive = lookbackDigit(tileId, digit, digitCounts[digit]);
+        digitOffsets[digit] = offsets.values[constants.pass * RADIX + digit] + exclusive;
+    }
+    barrier();
+
+    // keys of a digit are consecutive in the tile, so the stores are mostly coalesced
+    for (uint i = local; i < tileCount; i += WORKGROUP_SIZE) {
+        const uvec2 key = loadTileKey(i);
+        const uint digit = digitOf(key);
+        const uint global = digitOffsets[digit] + i - digitStarts[digit];
+        const uvec2 stored = fromOrderedKey(key);
+        keysOut.values[global * KEY_WORDS] = stored.x;
+        if (KEY_WORDS == 2) {
+            keysOut.values[global * KEY_WORDS + 1] = stored.y;
+        }
+        if (HAS_PAYLOAD != 0) {
+            payloadsOut.values[global] = tilePayloads[i];
+        }
+    }
+}
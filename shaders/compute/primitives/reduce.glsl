@@ -0,0 +1,87 @@
+// sums `count` values into one partial sum per workgroup.
+// run again over the partial sums until a single value is left.
+// the subgroup variant sums in registers with subgroupAdd, so shared memory only holds one partial per subgroup,
+// and the workgroup needs a single barrier instead of one per tree level.
+
+#include "values.glsl"
+
+// tuned per device -- see primitives::Reduce
+layout (local_size_x_id = 0) in;
+layout (constant_id = 0) const uint WORKGROUP_SIZE = 256; // power of two
+layout (constant_id = 1) const uint ITEMS_PER_THREAD = 4;
+// the smallest subgroup size the device may use. sizes shared memory for the most subgroups per workgroup
+layout (constant_id = 2) const uint MIN_SUBGROUP_SIZE = 32;
+layout (constant_id = 3) const uint VALUE_TYPE = TYPE_FLOAT;
+
+layout (std430, set = 0, binding = 0) readonly buffer Input {
+    uint values[];
+} src;
+
+layout (std430, set = 0, binding = 1) writeonly buffer Output {
+    uint values[];
+} dst;
+
+layout (push_constant) uniform Constants {
+    uint count;
+} constants;
+
+#if USE_SUBGROUPS
+shared uint partials[(WORKGROUP_SIZE + MIN_SUBGROUP_SIZE - 1) / MIN_SUBGROUP_SIZE];
+#else
+shared uint partials[WORKGROUP_SIZE];
+#endif
+
+void main()
+{
+    const uint local = gl_LocalInvocationID.x;
+
+    // grid-stride over the tiles: the group count is capped at maxComputeWorkGroupCount[0], so a group may sum several
+    const uint tileSize = WORKGROUP_SIZE * ITEMS_PER_THREAD;
+    uint sum = 0;
+    for (uint tile = gl_WorkGroupID.x; tile * tileSize < constants.count; tile += gl_NumWorkGroups.x) {
+        // coalesced loads: consecutive invocations read consecutive values
+        const uint base = tile * tileSize + local;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint index = base + i * WORKGROUP_SIZE;
+            if (index < constants.count) {
+                sum = addValues(VALUE_TYPE, sum, src.values[index]);
+            }
+        }
+    }
+
+#if USE_SUBGROUPS
+    // one partial per subgroup
+    sum = subgroupAddValues(VALUE_TYPE, sum);
+    if (subgroupElect()) {
+        partials[gl_SubgroupID] = sum;
+    }
+    barrier();
+
+    // the first subgroup sums the partials. loops in case there are more subgroups than invocations per subgroup
+    if (gl_SubgroupID == 0) {
+        uint total = 0;
+        for (uint i = gl_SubgroupInvocationID; i < gl_NumSubgroups; i += gl_SubgroupSize) {
+            total = addValues(VALUE_TYPE, total, partials[i]);
+        }
+        total = subgroupAddValues(VALUE_TYPE, total);
+        if (subgroupElect()) {
+            dst.values[gl_WorkGroupID.x] = total;
+        }
+    }
+#else
+    partials[local] = sum;
+    barrier();
+
+    // tree reduction in shared memory
+    for (uint stride = WORKGROUP_SIZE / 2; stride > 0; stride >>= 1) {
+        if (local < stride) {
+            partials[local] = addValues(VALUE_TYPE, partials[local], partials[local + stride]);
+        }
+        barrier();
+    }
+
+    if (local == 0) {
+        dst.values[gl_WorkGroupID.x] = partials[0];
+    }
+#endif
+}
@@ -0,0 +1,83 @@
+// single pass inclusive / exclusive prefix sum with decoupled look-back.
+// each workgroup scans tiles of WORKGROUP_SIZE * ITEMS_PER_THREAD values, so the input is read & written once.
+
+#include "values.glsl"
+
+// tuned per device -- see primitives::Scan
+layout (local_size_x_id = 0) in;
+layout (constant_id = 0) const uint WORKGROUP_SIZE = 256;
+layout (constant_id = 1) const uint ITEMS_PER_THREAD = 4;
+layout (constant_id = 2) const uint MIN_SUBGROUP_SIZE = 32;
+layout (constant_id = 3) const uint VALUE_TYPE = TYPE_FLOAT;
+
+layout (std430, set = 0, binding = 0) readonly buffer Input {
+    uint values[];
+} src;
+
+layout (std430, set = 0, binding = 1) writeonly buffer Output {
+    uint values[];
+} dst;
+
+#define SCAN_TYPE VALUE_TYPE
+#define STATE_BINDING 2
+#include "tile_scan.glsl"
+
+layout (push_constant) uniform Constants {
+    uint count;
+    uint inclusive;
+} constants;
+
+const uint TILE_SIZE = WORKGROUP_SIZE * ITEMS_PER_THREAD;
+shared uint tile[TILE_SIZE];
+
+void main()
+{
+    const uint local = gl_LocalInvocationID.x;
+
+    // the group count is capped at maxComputeWorkGroupCount[0]: groups keep acquiring tiles until none are left.
+    // tiles are still acquired in order, so the look-back only waits on tiles of running groups
+    for (;;) {
+        const uint tileId = acquireTile();
+        const uint tileStart = tileId * TILE_SIZE;
+        if (tileStart >= constants.count) {
+            break; // uniform: every invocation read the same shared tile index
+        }
+
+        // coalesced loads into shared memory
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint index = i * WORKGROUP_SIZE + local;
+            const uint global = tileStart + index;
+            tile[index] = global < constants.count ? src.values[global] : 0;
+        }
+        barrier();
+
+        // each invocation owns ITEMS_PER_THREAD consecutive values
+        const uint first = local * ITEMS_PER_THREAD;
+        uint total = 0;
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            total = addValues(VALUE_TYPE, total, tile[first + i]);
+        }
+        const uint invocationPrefix = workgroupExclusiveScan(total);
+        const uint tileExclusive = lookback(tileId, workgroupTotal);
+
+        uint running = addValues(VALUE_TYPE, tileExclusive, invocationPrefix);
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint inclusive = addValues(VALUE_TYPE, running, tile[first + i]);
+            tile[first + i] = constants.inclusive != 0 ? inclusive : running;
+            running = inclusive;
+        }
+        barrier();
+
+        // coalesced stores
+        for (uint i = 0; i < ITEMS_PER_THREAD; i++) {
+            const uint index = i * WORKGROUP_SIZE + local;
+            const uint global = tileStart + index;
+            if (global < constants.count) {
+                dst.values[global] = tile[index];
+            }
+        }
+
+        // the next tile reuses the shared memory
+        barrier();
+    }
+}
@@ -0,0 +1,124 @@
+// building blocks of single pass scans: a workgroup wide exclusive scan, and decoupled look-back between tiles.
+// see Merrill & Garland, "Single-pass Parallel Prefix Scan with Decoupled Look-back" (2016).
+//
+// include after declaring WORKGROUP_SIZE, MIN_SUBGROUP_SIZE, USE_SUBGROUPS, SCAN_TYPE and STATE_BINDING.
+// the state buffer must be zeroed before the dispatch. layout: [0] = tile counter, then per tile:
+// a status flag, the tile's aggregate and its inclusive prefix -- interleaved so a tile's state shares a cache line.
+
+#define FLAG_NOT_READY 0
+#define FLAG_AGGREGATE 1
+#define FLAG_PREFIX 2
+
+layout (std430, set = 0, binding = STATE_BINDING) coherent buffer State {
+    uint values[];
+} state;
+
+#if USE_SUBGROUPS
+shared uint scanPartials[(WORKGROUP_SIZE + MIN_SUBGROUP_SIZE - 1) / MIN_SUBGROUP_SIZE];
+#else
+shared uint scanPartials[WORKGROUP_SIZE];
+#endif
+shared uint workgroupTotal;
+shared uint tileIndex;
+shared uint tilePrefix;
+
+
+// tiles are numbered in the order workgroups start, not by gl_WorkGroupID.
+// a tile only waits on tiles that started before it, so the look-back can't deadlock.
+uint acquireTile()
+{
+    if (gl_LocalInvocationIndex == 0) {
+        tileIndex = atomicAdd(state.values[0], 1);
+    }
+    barrier();
+    return tileIndex;
+}
+
+
+// exclusive prefix of `value` across the workgroup. `workgroupTotal` holds the sum of every value afterwards.
+uint workgroupExclusiveScan(uint value)
+{
+#if USE_SUBGROUPS
+    const uint exclusive = subgroupExclusiveAddValues(SCAN_TYPE, value);
+    const uint total = subgroupAddValues(SCAN_TYPE, value);
+    if (subgroupElect()) {
+        scanPartials[gl_SubgroupID] = total;
+    }
+    barrier();
+
+    // the first subgroup scans the subgroup totals, a subgroup sized chunk at a time
+    if (gl_SubgroupID == 0) {
+        uint carry = 0;
+        for (uint base = 0; base < gl_NumSubgroups; base += gl_SubgroupSize) {
+            const uint i = base + gl_SubgroupInvocationID;
+            const uint partial = i < gl_NumSubgroups ? scanPartials[i] : 0;
+            const uint prefix = addValues(SCAN_TYPE, carry, subgroupExclusiveAddValues(SCAN_TYPE, partial));
+            if (i < gl_NumSubgroups) {
+                scanPartials[i] = prefix;
+            }
+            carry = addValues(SCAN_TYPE, carry, subgroupAddValues(SCAN_TYPE, partial));
+        }
+        if (subgroupElect()) {
+            workgroupTotal = carry;
+        }
+    }
+    barrier();
+    return addValues(SCAN_TYPE, scanPartials[gl_SubgroupID], exclusive);
+#else
+    // hillis-steele scan in shared memory
+    const uint local = gl_LocalInvocationID.x;
+    scanPartials[local] = value;
+    barrier();
+    for (uint offset = 1; offset < WORKGROUP_SIZE; offset <<= 1) {
+        const uint previous = local >= offset ? scanPartials[local - offset] : 0;
+        barrier();
+        scanPartials[local] = addValues(SCAN_TYPE, scanPartials[local], previous);
+        barrier();
+    }
+    const uint exclusive = local > 0 ? scanPartials[local - 1] : 0;
+    if (local == WORKGROUP_SIZE - 1) {
+        workgroupTotal = scanPartials[local];
+    }
+    barrier();
+    return exclusive;
+#endif
+}
+
+
+// publishes the tile's aggregate, then walks back over previous tiles, adding their aggregates until one
+// has published its inclusive prefix. returns the exclusive prefix of the tile.
+// only the first invocation looks back. the others wait at the barrier.
+uint lookback(uint tile, uint aggregate)
+{
+    if (gl_LocalInvocationIndex == 0) {
+        const uint slot = 1 + tile * 3;
+        uint exclusive = 0;
+        if (tile > 0) {
+            state.values[slot + 1] = aggregate;
+            memoryBarrierBuffer();
+            atomicExchange(state.values[slot], FLAG_AGGREGATE);
+
+            int previous = int(tile) - 1;
+            while (previous >= 0) {
+                const uint previousSlot = 1 + uint(previous) * 3;
+                const uint flag = atomicAdd(state.values[previousSlot], 0);
+                if (flag == FLAG_NOT_READY) {
+                    continue; // the previous tile already started, so it will publish soon
+                }
+                memoryBarrierBuffer();
+                if (flag == FLAG_PREFIX) {
+                    exclusive = addValues(SCAN_TYPE, state.values[previousSlot + 2], exclusive);
+                    break;
+                }
+                exclusive = addValues(SCAN_TYPE, state.values[previousSlot + 1], exclusive);
+                previous--;
+            }
+        }
+        state.values[slot + 2] = addValues(SCAN_TYPE, exclusive, aggregate);
+        memoryBarrierBuffer();
+        atomicExchange(state.values[slot], FLAG_PREFIX);
+        tilePrefix = exclusive;
+    }
+    barrier();
+    return tilePrefix;
+}
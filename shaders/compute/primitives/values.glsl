@@ -0,0 +1,34 @@
+// 32 bit values are stored as uint bits, and interpreted according to a type constant.
+// ints & uints add the same bits (two's complement), so only floats need their own path.
+// branches on the type are resolved when the pipeline is specialized.
+// include after defining USE_SUBGROUPS.
+
+#define TYPE_UINT 0
+#define TYPE_INT 1
+#define TYPE_FLOAT 2
+
+uint addValues(uint type, uint a, uint b)
+{
+    if (type == TYPE_FLOAT) {
+        return floatBitsToUint(uintBitsToFloat(a) + uintBitsToFloat(b));
+    }
+    return a + b;
+}
+
+#if USE_SUBGROUPS
+uint subgroupAddValues(uint type, uint value)
+{
+    if (type == TYPE_FLOAT) {
+        return floatBitsToUint(subgroupAdd(uintBitsToFloat(value)));
+    }
+    return subgroupAdd(value);
+}
+
+uint subgroupExclusiveAddValues(uint type, uint value)
+{
+    if (type == TYPE_FLOAT) {
+        return floatBitsToUint(subgroupExclusiveAdd(uintBitsToFloat(value)));
+    }
+    return subgroupExclusiveAdd(value);
+}
+#endif
@@ -0,0 +1,103 @@
+// helpers shared by the fft kernels. complex values are vec2(real, imaginary).
+// transforms are Stockham autosort passes: each pass reads `radix` values `size / radix` apart, multiplies them
+// by twiddles, runs a radix 2, 4 or 8 butterfly and writes them `stride` apart, so the output comes out in order
+// without a bit reversal. `stride` (the sub-transform size) starts at 1 and grows by the radix every pass.
+// the first pass takes the remainder radix (2 or 4) when log2(size) isn't a multiple of 3, the others are radix 8.
+//
+// signals of a batch are found through a layout, so the same kernels transform the rows & columns of 2D signals:
+// signal s starts at (s / blockSignals) * blockStride + (s % blockSignals) * signalStride,
+// and its values are elementStride apart. all in complex values.
+
+const float PI = 3.14159265358979323846;
+
+struct Layout {
+    uint elementStride;
+    uint signalStride;
+    uint blockSignals;
+    uint blockStride;
+};
+
+
+uint signalStart(Layout shape, uint signal)
+{
+    return signal / shape.blockSignals * shape.blockStride + signal % shape.blockSignals * shape.signalStride;
+}
+
+vec2 complexMultiply(vec2 a, vec2 b)
+{
+    return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// a * (direction * i)
+vec2 multiplyI(vec2 a, float direction)
+{
+    return direction * vec2(-a.y, a.x);
+}
+
+// exp(direction * 2 pi i * numerator / denominator), for numerator < denominator
+vec2 twiddle(uint numerator, uint denominator, float direction)
+{
+    const float angle = direction * 2.0 * PI * float(numerator) / float(denominator);
+    return vec2(cos(angle), sin(angle));
+}
+
+uint firstRadix(uint size)
+{
+    const uint remainder = findMSB(size) % 3;
+    return remainder == 0 ? 8 : 1u << remainder;
+}
+
+
+/// BUTTERFLIES
+// in place, outputs in order
+
+void fft2(inout vec2 a, inout vec2 b)
+{
+    const vec2 difference = a - b;
+    a += b;
+    b = difference;
+}
+
+void fft4(inout vec2 v0, inout vec2 v1, inout vec2 v2, inout vec2 v3, float direction)
+{
+    fft2(v0, v2);
+    fft2(v1, v3);
+    v3 = multiplyI(v3, direction);
+    fft2(v0, v1);
+    fft2(v2, v3);
+    // v1 holds X2 and v2 holds X1
+    const vec2 x1 = v2;
+    v2 = v1;
+    v1 = x1;
+}
+
+void fft8(inout vec2 v[8], float direction)
+{
+    for (uint i = 0; i < 4; i++) {
+        fft2(v[i], v[i + 4]);
+    }
+    const float root = sqrt(0.5); // W8 = (1 - i) / sqrt(2) forward
+    v[5] = complexMultiply(v[5], vec2(root, direction * root));
+    v[6] = multiplyI(v[6], direction);
+    v[7] = complexMultiply(v[7], vec2(-root, direction * root));
+    // the even outputs, then the odd ones
+    fft4(v[0], v[1], v[2], v[3], direction);
+    fft4(v[4], v[5], v[6], v[7], direction);
+    const vec2 even[4] = vec2[4](v[0], v[1], v[2], v[3]);
+    for (uint i = 0; i < 4; i++) {
+        v[2 * i] = even[i];
+        v[2 * i + 1] = v[4 + i];
+    }
+}
+
+// one butterfly of the first `radix` values
+void butterfly(inout vec2 v[8], uint radix, float direction)
+{
+    if (radix == 8) {
+        fft8(v, direction);
+    } else if (radix == 4) {
+        fft4(v[0], v[1], v[2], v[3], direction);
+    } else {
+        fft2(v[0], v[1]);
+    }
+}
@@ -0,0 +1,54 @@
+#include "benchmark.hpp"
+
+#include "pretty_io.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace walrus::benchmark {
+
+  void printHeader() {
+    std::cout << std::left << std::setw(32) << "benchmark"
+              << std::setw(6) << "type"
+              << std::right << std::setw(12) << "count"
+              << std::setw(12) << "ms"
+              << std::setw(12) << "GB/s"
+              << std::setw(12) << "GFLOP/s"
+              << "  check" << std::endl;
+  }
+
+
+  void print(const Result &result) {
+    const double gigabytesPerSecond = result.ms > 0.0 ? result.bytes / (result.ms * 1e6) : 0.0;
+    std::cout << std::left << std::setw(32) << result.name
+              << std::setw(6) << result.type
+              << std::right << std::setw(12) << result.count
+              << std::setw(12) << std::fixed << std::setprecision(3) << result.ms
+              << std::setw(12) << std::setprecision(2) << gigabytesPerSecond;
+    if (result.flops > 0.0 && result.ms > 0.0) {
+      std::cout << std::setw(12) << result.flops / (result.ms * 1e6);
+    } else {
+      std::cout << std::setw(12) << "-";
+    }
+    std::cout << std::defaultfloat << "  ";
+    io::printExists(result.valid, result.valid ? "ok" : "MISMATCH");
+  }
+
+
+  double fastest(uint32_t repeats, const std::function<double()> &run) {
+    double best = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < std::max<uint32_t>(repeats, 1); i++) {
+      best = std::min(best, run());
+    }
+    return best;
+  }
+
+
+  bool nearlyEqual(double value, double expected, double tolerance) {
+    return std::abs(value - expected) <= tolerance * std::max(std::abs(expected), 1.0);
+  }
+
+} // walrus::benchmark
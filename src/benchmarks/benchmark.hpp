@@ -0,0 +1,81 @@
+#ifndef WALRUS_COMPUTE_ENGINE_BENCHMARK_HPP
+#define WALRUS_COMPUTE_ENGINE_BENCHMARK_HPP
+
+#include "engine/compute/context/compute_context.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace walrus::benchmark {
+
+  struct Options {
+    /// elements per benchmark
+    uint32_t count = 1u << 24;
+    /// timed runs per benchmark. the fastest is reported
+    uint32_t repeats = 10;
+    /// only run suites whose name contains this. empty = all
+    std::string filter{};
+  };
+
+  struct Result {
+    std::string name{};
+    std::string type{};
+    uint64_t count = 0;
+    double ms = 0.0;
+    /// bytes read + written by the algorithm, used for the effective bandwidth
+    double bytes = 0.0;
+    bool valid = false;
+    /// floating point operations, for compute bound benchmarks. 0 = not reported
+    double flops = 0.0;
+  };
+
+  void printHeader();
+
+  void print(const Result &result);
+
+  /// @brief fastest of `repeats` runs. `run` returns its time in ms
+  double fastest(uint32_t repeats, const std::function<double()> &run);
+
+  /// @brief true if `value` is within `tolerance` of `expected`, relative to the larger of |expected| and 1
+  bool nearlyEqual(double value, double expected, double tolerance);
+
+  /// @brief deterministic values: floats in [0, 1), ints in [-1000, 1000), uints in [0, 2000)
+  template<class T>
+  std::vector<T> randomValues(size_t count, uint32_t seed = 1) {
+    std::vector<T> values(count);
+    std::mt19937 generator(seed);
+    if constexpr (std::is_floating_point_v<T>) {
+      std::uniform_real_distribution<T> distribution(0, 1);
+      for (auto &value: values) {
+        value = distribution(generator);
+      }
+    } else {
+      const int64_t low = std::is_signed_v<T> ? -1000 : 0;
+      std::uniform_int_distribution<int64_t> distribution(low, low + 1999);
+      for (auto &value: values) {
+        value = (T) distribution(generator);
+      }
+    }
+    return values;
+  }
+
+  /// SUITES
+  void runPrimitives(ComputeContext &context, const Options &options);
+
+  void runSort(ComputeContext &context, const Options &options);
+
+  void runHash(ComputeContext &context, const Options &options);
+
+  void runBlas(ComputeContext &context, const Options &options);
+
+  void runFft(ComputeContext &context, const Options &options);
+
+  void runExpression(ComputeContext &context, const Options &options);
+
+} // walrus::benchmark
+
+#endif //WALRUS_COMPUTE_ENGINE_BENCHMARK_HPP
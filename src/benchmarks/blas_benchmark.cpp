@@ -0,0 +1,227 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/blas/gemm/gemm.hpp"
+#include "engine/compute/blas/reference/reference.hpp"
+#include "engine/compute/blas/spmv/spmv.hpp"
+#include "engine/utils/half/half.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// accumulation order differs from the reference
+    constexpr double GEMM_TOLERANCE = 1e-3;
+    /// rows of C checked against the reference, spread over the matrix (including the last, an edge tile)
+    constexpr uint32_t CHECKED_ROWS = 8;
+    /// ELL layouts storing more than this many entries per non zero aren't benchmarked
+    constexpr double MAX_ELL_PADDING = 8.0;
+
+    struct Shape {
+      uint32_t m;
+      uint32_t n;
+      uint32_t k;
+    };
+
+    std::vector<float> randomMatrix(size_t count, uint32_t seed) {
+      std::vector<float> values(count);
+      std::mt19937 generator(seed);
+      std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+      for (auto &value: values) {
+        value = distribution(generator);
+      }
+      return values;
+    }
+
+    /// @brief the values the kernel actually multiplies: rounded to 16 bits for FP16
+    std::vector<float> stored(const std::vector<float> &values, const std::vector<uint16_t> &halves, bool fp16) {
+      if (!fp16) {
+        return values;
+      }
+      std::vector<float> result(halves.size());
+      for (size_t i = 0; i < halves.size(); i++) {
+        result[i] = half::toFloat(halves[i]);
+      }
+      return result;
+    }
+
+    void run(ComputeContext &context, blas::Gemm &gemm, blas::Precision precision, Shape shape, const Options &options) {
+      const bool fp16 = precision == blas::Precision::FP16;
+      const size_t elementSize = fp16 ? sizeof(uint16_t) : sizeof(float);
+      const std::vector<float> a = randomMatrix((size_t) shape.m * shape.k, 1);
+      const std::vector<float> b = randomMatrix((size_t) shape.k * shape.n, 2);
+      const std::vector<uint16_t> aHalves = fp16 ? half::fromFloats(a) : std::vector<uint16_t>{};
+      const std::vector<uint16_t> bHalves = fp16 ? half::fromFloats(b) : std::vector<uint16_t>{};
+
+      AllocatedBuffer aBuffer = context.createBuffer(a.size() * elementSize);
+      AllocatedBuffer bBuffer = context.createBuffer(b.size() * elementSize);
+      AllocatedBuffer cBuffer = context.createBuffer((VkDeviceSize) shape.m * shape.n * sizeof(float));
+      context.upload(aBuffer, fp16 ? (const void *) aHalves.data() : (const void *) a.data(), aBuffer.size);
+      context.upload(bBuffer, fp16 ? (const void *) bHalves.data() : (const void *) b.data(), bBuffer.size);
+
+      const double ms = fastest(options.repeats, [&]() {
+        return gemm.multiply(aBuffer, bBuffer, cBuffer, shape.m, shape.n, shape.k, precision).ms;
+      });
+
+      std::vector<float> c((size_t) shape.m * shape.n);
+      context.download(cBuffer, c.data(), cBuffer.size);
+      const std::vector<float> aStored = stored(a, aHalves, fp16);
+      const std::vector<float> bStored = stored(b, bHalves, fp16);
+      bool valid = true;
+      for (uint32_t i = 0; i < CHECKED_ROWS && valid; i++) {
+        const uint32_t row = (uint32_t) ((uint64_t) (shape.m - 1) * i / (CHECKED_ROWS - 1));
+        const std::vector<double> expected = blas::reference::gemmRow(aStored, bStored, shape.n, shape.k, row);
+        for (uint32_t col = 0; col < shape.n; col++) {
+          if (!nearlyEqual(c[(size_t) row * shape.n + col], expected[col], GEMM_TOLERANCE)) {
+            valid = false;
+            break;
+          }
+        }
+      }
+
+      Result result{};
+      result.name = "gemm " + std::to_string(shape.m) + "x" + std::to_string(shape.n) + "x" + std::to_string(shape.k);
+      result.type = blas::toString(precision);
+      result.count = (uint64_t) shape.m * shape.n;
+      result.ms = ms;
+      result.bytes = (double) (a.size() + b.size()) * elementSize + (double) c.size() * sizeof(float);
+      result.valid = valid;
+      result.flops = 2.0 * shape.m * shape.n * shape.k;
+      print(result);
+
+      context.destroyBuffer(cBuffer);
+      context.destroyBuffer(bBuffer);
+      context.destroyBuffer(aBuffer);
+    }
+
+    /**
+     * @brief a square matrix whose row lengths follow a power law (like the degrees of a social graph):
+     * most rows have a few non zeros, a few have thousands. `exponent` > 1, smaller = heavier tail
+     */
+    blas::CsrMatrix powerLawMatrix(uint32_t rows, double exponent, uint32_t minLength) {
+      blas::CsrMatrix matrix{};
+      matrix.rows = rows;
+      matrix.cols = rows;
+      std::mt19937 generator(rows);
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      std::uniform_int_distribution<uint32_t> column(0, rows - 1);
+      std::uniform_real_distribution<float> value(-1.f, 1.f);
+      for (uint32_t row = 0; row < rows; row++) {
+        // inverse transform sampling of a pareto distribution
+        const double length = minLength * std::pow(1.0 - uniform(generator), -1.0 / (exponent - 1.0));
+        const auto count = (uint32_t) std::min<double>(length, rows);
+        const size_t first = matrix.columns.size();
+        for (uint32_t i = 0; i < count; i++) {
+          matrix.columns.push_back(column(generator));
+          matrix.values.push_back(value(generator));
+        }
+        std::sort(matrix.columns.begin() + (long) first, matrix.columns.end());
+        matrix.rowOffsets.push_back((uint32_t) matrix.columns.size());
+      }
+      return matrix;
+    }
+
+    /// @brief every row has `length` non zeros, in a band around the diagonal (like a stencil)
+    blas::CsrMatrix bandedMatrix(uint32_t rows, uint32_t length) {
+      blas::CsrMatrix matrix{};
+      matrix.rows = rows;
+      matrix.cols = rows;
+      std::mt19937 generator(rows);
+      std::uniform_real_distribution<float> value(-1.f, 1.f);
+      for (uint32_t row = 0; row < rows; row++) {
+        const uint32_t first = std::min(row > length / 2 ? row - length / 2 : 0, rows - std::min(length, rows));
+        for (uint32_t i = 0; i < std::min(length, rows); i++) {
+          matrix.columns.push_back(first + i);
+          matrix.values.push_back(value(generator));
+        }
+        matrix.rowOffsets.push_back((uint32_t) matrix.columns.size());
+      }
+      return matrix;
+    }
+
+    void runSpmv(
+      ComputeContext &context,
+      blas::Spmv &spmv,
+      const std::string &name,
+      const blas::CsrMatrix &matrix,
+      const Options &options
+    ) {
+      const blas::RowStatistics statistics = blas::rowStatistics(matrix);
+      const blas::SparseFormat best = blas::bestFormat(statistics);
+      std::cout << name << ": " << statistics.rows << " rows, " << statistics.nonZeros << " non zeros, row length "
+                << statistics.minLength << "-" << statistics.maxLength << " (mean " << statistics.meanLength
+                << ", stddev " << statistics.stddevLength << "), best fit: " << blas::toString(best) << std::endl;
+
+      const std::vector<float> x = randomMatrix(matrix.cols, 3);
+      const std::vector<double> expected = blas::reference::spmv(matrix, x);
+      AllocatedBuffer xBuffer = context.createBuffer(std::max<VkDeviceSize>(x.size(), 1) * sizeof(float));
+      AllocatedBuffer yBuffer = context.createBuffer(std::max<VkDeviceSize>(matrix.rows, 1) * sizeof(float));
+      context.upload(xBuffer, x.data(), x.size() * sizeof(float));
+
+      for (auto format: {blas::SparseFormat::CSR_VECTOR, blas::SparseFormat::CSR_MERGE_PATH,
+                         blas::SparseFormat::ELL, blas::SparseFormat::SLICED_ELL}) {
+        const double padding = format == blas::SparseFormat::ELL ? statistics.ellPadding
+                                                                 : format == blas::SparseFormat::SLICED_ELL
+                                                                   ? statistics.slicedEllPadding : 1.0;
+        if (padding > MAX_ELL_PADDING) {
+          continue;
+        }
+        blas::Spmv::Matrix device = spmv.upload(matrix, format);
+        const double ms = fastest(options.repeats, [&]() { return spmv.multiply(device, xBuffer, yBuffer); });
+
+        std::vector<float> y(matrix.rows);
+        context.download(yBuffer, y.data(), y.size() * sizeof(float));
+        bool valid = true;
+        for (uint32_t row = 0; row < matrix.rows && valid; row++) {
+          valid = nearlyEqual(y[row], expected[row], GEMM_TOLERANCE);
+        }
+
+        Result result{};
+        result.name = "spmv " + name + " " + blas::toString(format) + (format == best ? " *" : "");
+        result.type = "f32";
+        result.count = statistics.nonZeros;
+        result.ms = ms;
+        // the matrix, the gathered x values & y
+        result.bytes = (double) (device.offsets.size + device.columns.size + device.values.size)
+                       + (double) statistics.nonZeros * sizeof(float) + (double) matrix.rows * sizeof(float);
+        result.valid = valid;
+        result.flops = 2.0 * statistics.nonZeros;
+        print(result);
+        spmv.destroy(device);
+      }
+
+      context.destroyBuffer(yBuffer);
+      context.destroyBuffer(xBuffer);
+    }
+
+  }
+
+
+  void runBlas(ComputeContext &context, const Options &options) {
+    blas::Gemm gemm{};
+    gemm.init(context);
+
+    // square sizes, and one that isn't a multiple of any tile size
+    const Shape shapes[] = {{1024, 1024, 1024}, {2048, 2048, 2048}, {1000, 1003, 997}};
+    for (auto precision: {blas::Precision::FP32, blas::Precision::FP16}) {
+      if (!gemm.supports(precision)) {
+        continue;
+      }
+      for (const Shape &shape: shapes) {
+        run(context, gemm, precision, shape, options);
+      }
+    }
+
+    // about `count` non zeros, like the other suites
+    blas::Spmv spmv{};
+    spmv.init(context);
+    const uint32_t rows = std::max<uint32_t>(options.count / 16, 1);
+    runSpmv(context, spmv, "power-law", powerLawMatrix(rows, 2.1, 4), options);
+    runSpmv(context, spmv, "banded", bandedMatrix(rows, 16), options);
+  }
+
+} // walrus::benchmark
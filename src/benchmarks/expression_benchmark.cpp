@@ -0,0 +1,209 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/expression/evaluator/evaluator.hpp"
+#include "engine/compute/primitives/compact/compact.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// transcendental functions differ slightly between the device & the host
+    constexpr double TOLERANCE = 1e-4;
+
+    constexpr float OFFSET = 0.25f;
+    constexpr float LOW = 0.f;
+    constexpr float HIGH = 0.8f;
+    constexpr float SCALE = 2.f;
+
+    /// @brief the chain on the host: tanh(clamp(a * x + OFFSET, LOW, HIGH)) * SCALE
+    float chain(float a, float x) {
+      return std::tanh(std::min(std::max(a * x + OFFSET, LOW), HIGH)) * SCALE;
+    }
+
+    /// values kept by the filter
+    constexpr float THRESHOLD = 0.5f;
+
+    /// @brief the transform applied to the filtered values
+    expression::Expression transform(const expression::Expression &x) {
+      return expression::sqrt(x) * SCALE + OFFSET;
+    }
+
+    bool validate(ComputeContext &context, const AllocatedBuffer &buffer, const std::vector<float> &expected) {
+      std::vector<float> values(expected.size());
+      context.download(buffer, values.data(), values.size() * sizeof(float));
+      for (size_t i = 0; i < values.size(); i++) {
+        if (!nearlyEqual(values[i], expected[i], TOLERANCE)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * @brief a filter feeding a transform. sizing the transform on the host takes a submit & a readback of the count
+     * in between, an indirect dispatch sizes it on the device, in the same submission as the filter
+     */
+    void runFilterTransform(ComputeContext &context, expression::Evaluator &evaluator, const Options &options) {
+      using primitives::Compact;
+      using primitives::Predicate;
+      Compact compact{};
+      compact.init(context);
+
+      const uint32_t count = options.count;
+      const std::vector<float> values = randomValues<float>(count, 3);
+      std::vector<float> expected{};
+      for (const float value: values) {
+        if (value < THRESHOLD) {
+          expected.push_back(std::sqrt(value) * SCALE + OFFSET);
+        }
+      }
+
+      const VkDeviceSize size = (VkDeviceSize) count * sizeof(float);
+      AllocatedBuffer input = context.createBuffer(size);
+      AllocatedBuffer filtered = context.createBuffer(size);
+      AllocatedBuffer output = context.createBuffer(size);
+      AllocatedBuffer selected = context.createBuffer(sizeof(uint32_t));
+      AllocatedBuffer state = context.createBuffer(compact.stateSize(count));
+      AllocatedBuffer args = context.createBuffer(sizeof(ComputeContext::DispatchArgs));
+      context.upload(input, values.data(), size);
+      const expression::Expression transformed = transform(expression::Expression::input(filtered));
+      const auto recordFilter = [&]() {
+        compact.record(
+          input,
+          filtered,
+          selected,
+          count,
+          primitives::ValueType::FLOAT32,
+          Predicate::LESS,
+          primitives::toBits(THRESHOLD),
+          Compact::DISCARD,
+          state
+        );
+      };
+      // the host waits between the two, so both are timed on the host
+      const auto timed = [](const std::function<void()> &run) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        run();
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+      };
+      const double bytes = (double) size * 2 + (double) expected.size() * sizeof(float) * 2;
+
+      /// HOST: submit the filter, read back the count, then size the transform
+      const auto runHost = [&]() {
+        context.begin();
+        recordFilter();
+        context.submit();
+        uint32_t selectedCount = 0;
+        context.download(selected, &selectedCount, sizeof(selectedCount));
+        context.begin();
+        evaluator.record(transformed, output, selectedCount);
+        context.submit();
+      };
+      runHost(); // compiles the kernel outside of the timed runs
+      const double hostMs = fastest(options.repeats, [&]() { return timed(runHost); });
+      const bool hostValid = validate(context, output, expected);
+      print({"filter + transform (readback)", "f32", count, hostMs, bytes, hostValid});
+
+      /// INDIRECT: one submission, the filter writes the count the transform is dispatched with
+      const auto runIndirect = [&]() {
+        context.begin();
+        recordFilter();
+        context.recordDispatchArgs(selected, 0, args, 0, expression::Evaluator::GROUP_SIZE);
+        evaluator.recordIndirect(transformed, output, args);
+        context.submit();
+      };
+      // cleared, so the readback results can't pass for the indirect ones
+      context.begin();
+      context.fill(output, 0);
+      context.submit();
+      runIndirect();
+      const double indirectMs = fastest(options.repeats, [&]() { return timed(runIndirect); });
+      const bool indirectValid = validate(context, output, expected);
+      print({"filter + transform (indirect)", "f32", count, indirectMs, bytes, indirectValid});
+
+      context.destroyBuffer(args);
+      context.destroyBuffer(state);
+      context.destroyBuffer(selected);
+      context.destroyBuffer(output);
+      context.destroyBuffer(filtered);
+      context.destroyBuffer(input);
+    }
+
+  }
+
+
+  void runExpression(ComputeContext &context, const Options &options) {
+    using expression::Expression;
+    expression::Evaluator evaluator{};
+    evaluator.init(context);
+
+    const uint32_t count = options.count;
+    const std::vector<float> aValues = randomValues<float>(count, 1);
+    const std::vector<float> xValues = randomValues<float>(count, 2);
+    std::vector<float> expected(count);
+    for (uint32_t i = 0; i < count; i++) {
+      expected[i] = chain(aValues[i], xValues[i]);
+    }
+
+    const VkDeviceSize size = (VkDeviceSize) count * sizeof(float);
+    AllocatedBuffer aBuffer = context.createBuffer(size);
+    AllocatedBuffer xBuffer = context.createBuffer(size);
+    AllocatedBuffer first = context.createBuffer(size);
+    AllocatedBuffer second = context.createBuffer(size);
+    context.upload(aBuffer, aValues.data(), size);
+    context.upload(xBuffer, xValues.data(), size);
+    const Expression a = Expression::input(aBuffer);
+    const Expression x = Expression::input(xBuffer);
+
+    /// UNFUSED: a dispatch per operation, each one a round trip through memory
+    const std::vector<std::function<Expression(const Expression &)>> steps{
+      [&](const Expression &) { return a * x; },
+      [](const Expression &t) { return t + OFFSET; },
+      [](const Expression &t) { return expression::max(t, LOW); },
+      [](const Expression &t) { return expression::min(t, HIGH); },
+      [](const Expression &t) { return expression::tanh(t); },
+      [](const Expression &t) { return t * SCALE; },
+    };
+    const auto runSteps = [&]() {
+      context.begin();
+      AllocatedBuffer *src = &first;
+      AllocatedBuffer *dst = &second;
+      for (const auto &step: steps) {
+        evaluator.record(step(Expression::input(*src)), *dst, count);
+        context.barrier();
+        std::swap(src, dst);
+      }
+      return context.submit();
+    };
+    runSteps(); // compiles the kernels outside of the timed runs
+    const double unfusedMs = fastest(options.repeats, runSteps);
+    // steps alternate between writing `second` & `first`
+    const bool unfusedValid = validate(context, steps.size() % 2 == 0 ? first : second, expected);
+    const double unfusedBytes = (double) size * (3 + 2 * (steps.size() - 1));
+    print({"expression unfused (" + std::to_string(steps.size()) + " ops)", "f32", count, unfusedMs, unfusedBytes,
+           unfusedValid});
+
+    /// FUSED: one dispatch, reading a & x and writing the result once
+    const Expression fused = expression::tanh(expression::clamp(a * x + OFFSET, LOW, HIGH)) * SCALE;
+    const double fusedMs = fastest(options.repeats, [&]() {
+      return evaluator.evaluate(fused, first, count);
+    });
+    const bool fusedValid = validate(context, first, expected);
+    print({"expression fused (" + std::to_string(steps.size()) + " ops)", "f32", count, fusedMs, (double) size * 3,
+           fusedValid});
+
+    context.destroyBuffer(second);
+    context.destroyBuffer(first);
+    context.destroyBuffer(xBuffer);
+    context.destroyBuffer(aBuffer);
+
+    runFilterTransform(context, evaluator, options);
+  }
+
+} // walrus::benchmark
@@ -0,0 +1,132 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/signal/fft/fft.hpp"
+#include "engine/compute/signal/reference/reference.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// rounding grows with the transform size: errors are relative to sqrt(points), the rms of a bin of random values
+    constexpr double FFT_TOLERANCE = 1e-3;
+    /// bins checked against the reference, in the first & last signal of the batch
+    constexpr uint32_t CHECKED_BINS = 4;
+
+    struct Case {
+      signal::FftPlan plan;
+      signal::Direction direction;
+    };
+
+    std::vector<float> randomSignal(size_t count, uint32_t seed) {
+      std::vector<float> values(count);
+      std::mt19937 generator(seed);
+      std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+      for (auto &value: values) {
+        value = distribution(generator);
+      }
+      return values;
+    }
+
+    std::string caseName(const Case &test) {
+      const signal::FftPlan &plan = test.plan;
+      std::string name = plan.real ? "rfft " : test.direction == signal::Direction::INVERSE ? "ifft " : "fft ";
+      name += std::to_string(plan.width);
+      if (plan.height > 1) {
+        name += "x" + std::to_string(plan.height);
+      }
+      return name + " batch " + std::to_string(plan.batch);
+    }
+
+    /// @brief the reference value of a bin of one signal of the batch
+    std::complex<double> expectedBin(const Case &test, const std::vector<float> &input, uint32_t index, uint32_t bin) {
+      const signal::FftPlan &plan = test.plan;
+      const size_t signalSize = (size_t) plan.width * plan.height;
+      if (plan.real) {
+        return signal::reference::realDftBin(input.data() + index * signalSize, plan.width, bin);
+      }
+      const float *values = input.data() + 2 * index * signalSize;
+      if (plan.height > 1) {
+        return signal::reference::dft2DBin(values, plan.width, plan.height, bin / plan.width, bin % plan.width, test.direction);
+      }
+      return signal::reference::dftBin(values, plan.width, bin, test.direction);
+    }
+
+    void run(ComputeContext &context, signal::Fft &fft, const Case &test, const Options &options) {
+      const signal::FftPlan &plan = test.plan;
+      const std::vector<float> input = randomSignal(plan.inputSize() / sizeof(float), plan.width);
+      AllocatedBuffer inputBuffer = context.createBuffer(plan.inputSize());
+      AllocatedBuffer outputBuffer = context.createBuffer(plan.outputSize());
+      context.upload(inputBuffer, input.data(), plan.inputSize());
+
+      const double ms = fastest(options.repeats, [&]() {
+        return fft.transform(inputBuffer, outputBuffer, plan, test.direction);
+      });
+
+      std::vector<float> output(plan.outputSize() / sizeof(float));
+      context.download(outputBuffer, output.data(), plan.outputSize());
+      const uint32_t points = plan.width * plan.height;
+      const uint32_t bins = plan.real ? plan.width / 2 + 1 : points;
+      const double scale = test.direction == signal::Direction::INVERSE ? 1.0 / points : 1.0;
+      const double tolerance = FFT_TOLERANCE * std::sqrt((double) points) * scale;
+      bool valid = true;
+      for (uint32_t index: {0u, plan.batch - 1}) {
+        for (uint32_t i = 0; i < CHECKED_BINS && valid; i++) {
+          // the first & last bins, and some in between
+          const uint32_t bin = (uint32_t) ((uint64_t) (bins - 1) * i / (CHECKED_BINS - 1));
+          const std::complex<double> expected = expectedBin(test, input, index, bin);
+          const float *value = output.data() + 2 * ((size_t) index * bins + bin);
+          valid = std::abs(std::complex<double>(value[0], value[1]) - expected) <= tolerance;
+        }
+      }
+
+      Result result{};
+      result.name = caseName(test);
+      result.type = plan.real ? "r2c" : "c2c";
+      result.count = plan.points();
+      result.ms = ms;
+      // one read of the input & one write of the output, whatever the number of passes
+      result.bytes = (double) (plan.inputSize() + plan.outputSize());
+      result.valid = valid;
+      result.flops = signal::Fft::flops(plan);
+      print(result);
+
+      context.destroyBuffer(outputBuffer);
+      context.destroyBuffer(inputBuffer);
+    }
+
+  }
+
+
+  void runFft(ComputeContext &context, const Options &options) {
+    signal::Fft fft{};
+    fft.init(context);
+
+    // complex points per benchmark: `count` floats of real input
+    const uint32_t points = std::max<uint32_t>(options.count / 2, 1u << 16);
+    const auto batch = [&](uint32_t width, uint32_t height) { return std::max<uint32_t>(points / (width * height), 1); };
+    const auto forward = signal::Direction::FORWARD;
+    const auto inverse = signal::Direction::INVERSE;
+    const uint32_t shared = fft.getMaxSharedSize();
+    // small & workgroup sized transforms run in shared memory, larger ones pass through global memory
+    std::vector<Case> cases = {
+      {{64, 1, batch(64, 1)}, forward},
+      {{shared, 1, batch(shared, 1)}, forward},
+      {{shared, 1, batch(shared, 1)}, inverse},
+      {{shared * 16, 1, batch(shared * 16, 1)}, forward},
+      {{1u << 20, 1, batch(1u << 20, 1)}, forward},
+      {{256, 256, batch(256, 256)}, forward},
+      {{1024, 1024, batch(1024, 1024)}, forward},
+      {{1024, 1024, batch(1024, 1024)}, inverse},
+      {{1024, 1, batch(1024, 1) * 2, true}, forward},
+      {{1u << 20, 1, batch(1u << 20, 1) * 2, true}, forward},
+    };
+    for (const Case &test: cases) {
+      run(context, fft, test, options);
+    }
+  }
+
+} // walrus::benchmark
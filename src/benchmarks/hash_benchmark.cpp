@@ -0,0 +1,160 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/primitives/hash_table/hash_table.hpp"
+#include "engine/compute/primitives/reference/reference.hpp"
+
+#include <string>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// group-by keys are drawn from this many times fewer distinct values than there are rows
+    constexpr uint32_t ROWS_PER_GROUP = 16;
+    /// float sums are accumulated in a different order than the reference
+    constexpr double SUM_TOLERANCE = 1e-3;
+
+    template<class K>
+    const char *keyName() {
+      return sizeof(K) == sizeof(uint64_t) ? "u64" : "u32";
+    }
+
+    /// @brief distinct keys, spread over the whole range: odd multiples are a bijection, so i -> key never collides
+    template<class K>
+    K distinctKey(uint64_t i) {
+      return (K) ((i + 1) * 0x9E3779B97F4A7C15ull);
+    }
+
+    template<class T>
+    AllocatedBuffer uploadVector(ComputeContext &context, const std::vector<T> &values) {
+      AllocatedBuffer buffer = context.createBuffer(std::max<size_t>(values.size(), 1) * sizeof(T));
+      context.upload(buffer, values.data(), values.size() * sizeof(T));
+      return buffer;
+    }
+
+    template<class K>
+    std::string withKeys(const std::string &name) {
+      return name + " (" + keyName<K>() + " keys)";
+    }
+
+    /// @brief a join: build a table of `count` unique keys, probe it with `count` keys of which half are in it
+    template<class K>
+    void runJoin(ComputeContext &context, primitives::HashTable &hashTable, const Options &options) {
+      using primitives::HashTable;
+      const uint32_t count = options.count;
+      std::vector<K> buildKeys(count);
+      std::vector<uint32_t> buildValues(count);
+      std::vector<K> probeKeys(count);
+      for (uint32_t i = 0; i < count; i++) {
+        buildKeys[i] = distinctKey<K>(i);
+        buildValues[i] = i;
+        // even rows hit, odd rows miss
+        probeKeys[i] = distinctKey<K>(i % 2 == 0 ? i : (uint64_t) count + i);
+      }
+
+      AllocatedBuffer buildKeyBuffer = uploadVector(context, buildKeys);
+      AllocatedBuffer buildValueBuffer = uploadVector(context, buildValues);
+      AllocatedBuffer probeKeyBuffer = uploadVector(context, probeKeys);
+      AllocatedBuffer resultBuffer = context.createBuffer((VkDeviceSize) count * sizeof(uint32_t));
+
+      HashTable::Table table = hashTable.createTable(count, primitives::KeyWidth(sizeof(K) / sizeof(uint32_t)));
+      const double buildMs = fastest(options.repeats, [&]() {
+        return hashTable.build(table, buildKeyBuffer, buildValueBuffer, count);
+      });
+      const double probeMs = fastest(options.repeats, [&]() {
+        return hashTable.probe(table, probeKeyBuffer, resultBuffer, count);
+      });
+
+      std::vector<uint32_t> results(count);
+      context.download(resultBuffer, results.data(), results.size() * sizeof(uint32_t));
+      bool valid = hashTable.entries(table).size() == count;
+      for (uint32_t i = 0; i < count && valid; i++) {
+        valid = results[i] == (i % 2 == 0 ? i : HashTable::NOT_FOUND);
+      }
+      const double rowBytes = (double) count * (sizeof(K) + sizeof(uint32_t));
+      print({withKeys<K>("hash build"), "u32", count, buildMs, rowBytes, valid});
+      print({withKeys<K>("hash probe"), "u32", count, probeMs, rowBytes, valid});
+
+      hashTable.destroyTable(table);
+      context.destroyBuffer(resultBuffer);
+      context.destroyBuffer(probeKeyBuffer);
+      context.destroyBuffer(buildValueBuffer);
+      context.destroyBuffer(buildKeyBuffer);
+    }
+
+    /// @brief a group-by of random rows over count / ROWS_PER_GROUP distinct keys
+    template<class K, class T>
+    void runGroupBy(
+      ComputeContext &context,
+      primitives::HashTable &hashTable,
+      primitives::Aggregate aggregate,
+      const Options &options
+    ) {
+      using primitives::HashTable;
+      const uint32_t count = options.count;
+      const uint32_t groups = std::max<uint32_t>(count / ROWS_PER_GROUP, 1);
+      std::vector<K> keys(count);
+      std::mt19937 generator(count);
+      std::uniform_int_distribution<uint32_t> group(0, groups - 1);
+      for (auto &key: keys) {
+        key = distinctKey<K>(group(generator));
+      }
+      const std::vector<T> values = randomValues<T>(count);
+      const auto expected = primitives::reference::groupBy(keys, values, aggregate);
+
+      AllocatedBuffer keyBuffer = uploadVector(context, keys);
+      AllocatedBuffer valueBuffer = uploadVector(context, values);
+      HashTable::Table table = hashTable.createTable(groups, primitives::KeyWidth(sizeof(K) / sizeof(uint32_t)));
+      const bool counting = aggregate == primitives::Aggregate::COUNT;
+      const double ms = fastest(options.repeats, [&]() {
+        return hashTable.aggregate(
+          table,
+          keyBuffer,
+          counting ? nullptr : &valueBuffer,
+          count,
+          aggregate,
+          primitives::valueTypeOf<T>()
+        );
+      });
+
+      const std::vector<HashTable::Entry> entries = hashTable.entries(table);
+      bool valid = entries.size() == expected.size();
+      for (size_t i = 0; i < entries.size() && valid; i++) {
+        const auto group = expected.find((K) entries[i].key);
+        if (group == expected.end()) {
+          valid = false;
+        } else if (std::is_floating_point_v<T> && !counting) {
+          valid = nearlyEqual(primitives::fromBits<float>(entries[i].value), group->second, SUM_TOLERANCE);
+        } else {
+          valid = entries[i].value == (uint32_t) group->second;
+        }
+      }
+      const std::string name = withKeys<K>(std::string("hash group-by ") + primitives::toString(aggregate));
+      const double rowBytes = (double) count * (sizeof(K) + (counting ? 0 : sizeof(T)));
+      print({name, primitives::toString(primitives::valueTypeOf<T>()), count, ms, rowBytes, valid});
+
+      hashTable.destroyTable(table);
+      context.destroyBuffer(valueBuffer);
+      context.destroyBuffer(keyBuffer);
+    }
+
+  }
+
+
+  void runHash(ComputeContext &context, const Options &options) {
+    using primitives::Aggregate;
+    primitives::HashTable hashTable{};
+    hashTable.init(context);
+
+    runJoin<uint32_t>(context, hashTable, options);
+    runGroupBy<uint32_t, uint32_t>(context, hashTable, Aggregate::COUNT, options);
+    runGroupBy<uint32_t, float>(context, hashTable, Aggregate::SUM, options);
+    runGroupBy<uint32_t, int32_t>(context, hashTable, Aggregate::MIN, options);
+    runGroupBy<uint32_t, float>(context, hashTable, Aggregate::MAX, options);
+    if (hashTable.supports(primitives::KeyWidth::BITS_64)) {
+      runJoin<uint64_t>(context, hashTable, options);
+      runGroupBy<uint64_t, uint32_t>(context, hashTable, Aggregate::SUM, options);
+    }
+  }
+
+} // walrus::benchmark
@@ -0,0 +1,51 @@
+#include "benchmark.hpp"
+
+#include "engine/vk_engine.h"
+#include "pretty_io.hpp"
+
+#include <iostream>
+#include <string>
+
+/**
+ * runs the gpu primitives against their cpu references, reporting throughput & correctness.
+ * usage: walrus_benchmark [count] [filter]
+ */
+int main(int argc, char *argv[]) {
+  walrus::benchmark::Options options{};
+  if (argc > 1) {
+    options.count = (uint32_t) std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    options.filter = argv[2];
+  }
+
+  walrus::VulkanEngine engine{walrus::DeviceTask::COMPUTE};
+  auto &compute = engine.getCompute();
+
+  const auto selected = [&](const std::string &suite) {
+    return options.filter.empty() || suite.find(options.filter) != std::string::npos;
+  };
+
+  std::cout << io::to_color_string(io::Color::CYAN, "\nBENCHMARKS") << " (" << options.count << " values, best of "
+            << options.repeats << ")\n\n";
+  walrus::benchmark::printHeader();
+  if (selected("primitives")) {
+    walrus::benchmark::runPrimitives(compute, options);
+  }
+  if (selected("sort")) {
+    walrus::benchmark::runSort(compute, options);
+  }
+  if (selected("hash")) {
+    walrus::benchmark::runHash(compute, options);
+  }
+  if (selected("blas")) {
+    walrus::benchmark::runBlas(compute, options);
+  }
+  if (selected("fft")) {
+    walrus::benchmark::runFft(compute, options);
+  }
+  if (selected("expression")) {
+    walrus::benchmark::runExpression(compute, options);
+  }
+  return 0;
+}
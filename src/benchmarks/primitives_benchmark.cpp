@@ -0,0 +1,135 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/primitives/compact/compact.hpp"
+#include "engine/compute/primitives/reduce/reduce.hpp"
+#include "engine/compute/primitives/reference/reference.hpp"
+#include "engine/compute/primitives/scan/scan.hpp"
+
+#include <algorithm>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// floats are summed in a different order than the reference
+    constexpr double FLOAT_TOLERANCE = 1e-3;
+
+    template<class T>
+    bool matches(const std::vector<T> &values, const std::vector<T> &expected) {
+      if (values.size() != expected.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < values.size(); i++) {
+        if constexpr (std::is_floating_point_v<T>) {
+          if (!nearlyEqual(values[i], expected[i], FLOAT_TOLERANCE)) {
+            return false;
+          }
+        } else if (values[i] != expected[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    struct Primitives {
+      primitives::Reduce reduce{};
+      primitives::Scan scan{};
+      primitives::Compact compact{};
+    };
+
+    template<class T>
+    void run(ComputeContext &context, Primitives &kernels, const Options &options) {
+      using namespace primitives;
+      constexpr ValueType type = valueTypeOf<T>();
+      const uint32_t count = options.count;
+      const VkDeviceSize size = (VkDeviceSize) count * sizeof(T);
+      const auto bytes = (double) size;
+      const std::vector<T> values = randomValues<T>(count);
+
+      AllocatedBuffer input = context.createBuffer(size);
+      AllocatedBuffer output = context.createBuffer(size);
+      context.upload(input, values.data(), input.size);
+      std::vector<T> result(count);
+
+      /// REDUCE
+      {
+        AllocatedBuffer scratch = context.createBuffer(kernels.reduce.scratchCount(count) * sizeof(T));
+        uint32_t index = 0;
+        const double ms = fastest(options.repeats, [&]() {
+          context.begin();
+          index = kernels.reduce.record(input, count, type, scratch);
+          return context.submit();
+        });
+        T sum{};
+        context.download(scratch, &sum, sizeof(sum), (VkDeviceSize) index * sizeof(T));
+        const T expected = reference::reduce(values);
+        const bool valid = std::is_floating_point_v<T> ? nearlyEqual(sum, expected, FLOAT_TOLERANCE) : sum == expected;
+        print({"reduce", toString(type), count, ms, bytes, valid});
+        context.destroyBuffer(scratch);
+      }
+
+      /// SCAN
+      for (bool inclusive: {false, true}) {
+        AllocatedBuffer state = context.createBuffer(kernels.scan.stateSize(count));
+        const double ms = fastest(options.repeats, [&]() {
+          context.begin();
+          kernels.scan.record(input, output, count, type, inclusive, state);
+          return context.submit();
+        });
+        context.download(output, result.data(), size);
+        const bool valid = matches(result, reference::scan(values, inclusive));
+        print({inclusive ? "scan (inclusive)" : "scan (exclusive)", toString(type), count, ms, 2 * bytes, valid});
+        context.destroyBuffer(state);
+      }
+
+      /// COMPACT & PARTITION
+      // roughly half of the values are selected
+      const T operand = std::is_floating_point_v<T> ? (T) 0.5 : (std::is_signed_v<T> ? (T) 0 : (T) 1000);
+      for (auto mode: {Compact::DISCARD, Compact::PARTITION}) {
+        const bool partition = mode == Compact::PARTITION;
+        AllocatedBuffer state = context.createBuffer(kernels.compact.stateSize(count));
+        AllocatedBuffer selected = context.createBuffer(sizeof(uint32_t));
+        const double ms = fastest(options.repeats, [&]() {
+          context.begin();
+          kernels.compact.record(
+            input, output, selected, count, type, Predicate::LESS, toBits(operand), mode, state
+          );
+          return context.submit();
+        });
+        uint32_t selectedCount = 0;
+        context.download(selected, &selectedCount, sizeof(selectedCount));
+        const std::vector<T> expected = reference::compact(values, Predicate::LESS, operand, partition);
+        const auto written = partition ? count : selectedCount;
+        result.resize(written);
+        if (written > 0) {
+          context.download(output, result.data(), (VkDeviceSize) written * sizeof(T));
+        }
+        const auto expectedCount = (uint32_t) std::count_if(values.begin(), values.end(), [&](T value) {
+          return reference::isSelected(value, Predicate::LESS, operand);
+        });
+        const bool valid = selectedCount == expectedCount && matches(result, expected);
+        print({partition ? "partition" : "compact", toString(type), count, ms, bytes + (double) written * sizeof(T), valid});
+        result.resize(count);
+        context.destroyBuffer(selected);
+        context.destroyBuffer(state);
+      }
+
+      context.destroyBuffer(output);
+      context.destroyBuffer(input);
+    }
+
+  }
+
+
+  void runPrimitives(ComputeContext &context, const Options &options) {
+    Primitives kernels{};
+    kernels.reduce.init(context);
+    kernels.scan.init(context);
+    kernels.compact.init(context);
+
+    run<uint32_t>(context, kernels, options);
+    run<int32_t>(context, kernels, options);
+    run<float>(context, kernels, options);
+  }
+
+} // walrus::benchmark
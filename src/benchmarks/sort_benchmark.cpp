@@ -0,0 +1,223 @@
+#include "benchmark.hpp"
+
+#include "engine/compute/primitives/radix_sort/radix_sort.hpp"
+#include "engine/compute/primitives/reference/reference.hpp"
+#include "engine/utils/thread_pool/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace walrus::benchmark {
+
+  namespace {
+
+    /// cpu sorts are slow enough that a few runs are representative
+    constexpr uint32_t CPU_REPEATS = 3;
+
+    /// the smallest onesweep tile: 64 invocations x 2 keys
+    constexpr uint64_t SMALLEST_TILE = 64 * 2;
+
+    /// sorts past the group count limit are only run on devices where that's a reasonable size
+    constexpr uint64_t MAX_GROUP_LIMIT_COUNT = 1u << 26;
+
+    template<class K>
+    using Pair = std::pair<K, uint32_t>;
+
+    template<class K>
+    const char *keyName() {
+      if constexpr (std::is_same_v<K, uint32_t>) {
+        return "u32";
+      } else if constexpr (std::is_same_v<K, uint64_t>) {
+        return "u64";
+      } else if constexpr (std::is_same_v<K, float>) {
+        return "f32";
+      } else {
+        return "?";
+      }
+    }
+
+    /// @brief full range ints, floats in [-1, 1)
+    template<class K>
+    std::vector<K> randomKeys(size_t count) {
+      std::vector<K> keys(count);
+      std::mt19937_64 generator(count);
+      if constexpr (std::is_floating_point_v<K>) {
+        std::uniform_real_distribution<K> distribution(-1, 1);
+        for (auto &key: keys) {
+          key = distribution(generator);
+        }
+      } else {
+        std::uniform_int_distribution<K> distribution(std::numeric_limits<K>::min(), std::numeric_limits<K>::max());
+        for (auto &key: keys) {
+          key = distribution(generator);
+        }
+      }
+      return keys;
+    }
+
+    template<class K>
+    std::vector<Pair<K>> makePairs(const std::vector<K> &keys) {
+      std::vector<Pair<K>> pairs(keys.size());
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        pairs[i] = {keys[i], i};
+      }
+      return pairs;
+    }
+
+    template<class K>
+    bool keysMatch(const std::vector<Pair<K>> &pairs, const std::vector<K> &expected) {
+      for (size_t i = 0; i < pairs.size(); i++) {
+        if (pairs[i].first != expected[i]) {
+          return false;
+        }
+      }
+      return pairs.size() == expected.size();
+    }
+
+    /// @brief std::sort of one chunk per worker, then rounds of merges of neighbouring chunks
+    template<class K>
+    void parallelSort(std::vector<Pair<K>> &pairs, ThreadPool &pool) {
+      const auto byKey = [](const Pair<K> &a, const Pair<K> &b) { return a.first < b.first; };
+      const size_t chunks = std::max<size_t>(pool.size(), 1);
+      std::vector<size_t> bounds(chunks + 1);
+      for (size_t i = 0; i <= chunks; i++) {
+        bounds[i] = pairs.size() * i / chunks;
+      }
+
+      std::vector<std::future<void>> jobs{};
+      for (size_t i = 0; i < chunks; i++) {
+        jobs.push_back(pool.submit([&, i]() {
+          std::sort(pairs.begin() + bounds[i], pairs.begin() + bounds[i + 1], byKey);
+        }));
+      }
+      for (auto &job: jobs) {
+        job.get();
+      }
+
+      for (size_t width = 1; width < chunks; width *= 2) {
+        jobs.clear();
+        for (size_t i = 0; i + width < chunks; i += 2 * width) {
+          const size_t end = bounds[std::min(i + 2 * width, chunks)];
+          jobs.push_back(pool.submit([&, i, width, end]() {
+            std::inplace_merge(pairs.begin() + bounds[i], pairs.begin() + bounds[i + width], pairs.begin() + end, byKey);
+          }));
+        }
+        for (auto &job: jobs) {
+          job.get();
+        }
+      }
+    }
+
+    double timeHost(const std::function<void()> &run) {
+      const auto start = std::chrono::high_resolution_clock::now();
+      run();
+      return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    template<class K>
+    void run(ComputeContext &context, primitives::RadixSort &sort, ThreadPool &pool, const Options &options) {
+      using namespace primitives;
+      const uint32_t count = options.count;
+      const std::vector<K> keys = randomKeys<K>(count);
+      std::vector<uint32_t> indices(count);
+      std::iota(indices.begin(), indices.end(), 0);
+
+      std::vector<K> expectedKeys = keys;
+      std::vector<uint32_t> expectedPayloads = indices;
+      reference::sort(expectedKeys, &expectedPayloads);
+
+      /// GPU
+      const VkDeviceSize keySize = (VkDeviceSize) count * sizeof(K);
+      const VkDeviceSize payloadSize = (VkDeviceSize) count * sizeof(uint32_t);
+      AllocatedBuffer unsortedKeys = context.createBuffer(keySize);
+      AllocatedBuffer unsortedPayloads = context.createBuffer(payloadSize);
+      AllocatedBuffer sortedKeys = context.createBuffer(keySize);
+      AllocatedBuffer sortedPayloads = context.createBuffer(payloadSize);
+      context.upload(unsortedKeys, keys.data(), keySize);
+      context.upload(unsortedPayloads, indices.data(), payloadSize);
+
+      for (bool payloads: {false, true}) {
+        RadixSort::Scratch scratch = sort.createScratch(count, radixKeyWidth<K>(), payloads);
+        const double ms = fastest(options.repeats, [&]() {
+          // restore the unsorted input, outside of the timed submit
+          context.begin();
+          context.copy(unsortedKeys, sortedKeys, keySize);
+          context.copy(unsortedPayloads, sortedPayloads, payloadSize);
+          context.submit();
+
+          context.begin();
+          sort.record(
+            sortedKeys,
+            payloads ? &sortedPayloads : nullptr,
+            count,
+            radixKeyType<K>(),
+            radixKeyWidth<K>(),
+            scratch
+          );
+          return context.submit();
+        });
+        sort.destroyScratch(scratch);
+
+        std::vector<K> resultKeys(count);
+        std::vector<uint32_t> resultPayloads(count);
+        context.download(sortedKeys, resultKeys.data(), keySize);
+        bool valid = resultKeys == expectedKeys;
+        if (payloads) {
+          context.download(sortedPayloads, resultPayloads.data(), payloadSize);
+          valid = valid && resultPayloads == expectedPayloads;
+        }
+        const double bytes = (double) keySize + (payloads ? (double) payloadSize : 0.0);
+        print({payloads ? "radix sort (pairs)" : "radix sort (keys)", keyName<K>(), count, ms, bytes, valid});
+      }
+
+      context.destroyBuffer(sortedPayloads);
+      context.destroyBuffer(sortedKeys);
+      context.destroyBuffer(unsortedPayloads);
+      context.destroyBuffer(unsortedKeys);
+
+      /// CPU
+      const double pairBytes = (double) count * (sizeof(K) + sizeof(uint32_t));
+      const std::vector<Pair<K>> unsorted = makePairs(keys);
+      std::vector<Pair<K>> pairs{};
+      const double stdMs = fastest(std::min(options.repeats, CPU_REPEATS), [&]() {
+        pairs = unsorted;
+        return timeHost([&]() {
+          std::sort(pairs.begin(), pairs.end(), [](const Pair<K> &a, const Pair<K> &b) { return a.first < b.first; });
+        });
+      });
+      print({"std::sort (pairs)", keyName<K>(), count, stdMs, pairBytes, keysMatch(pairs, expectedKeys)});
+
+      const double parallelMs = fastest(std::min(options.repeats, CPU_REPEATS), [&]() {
+        pairs = unsorted;
+        return timeHost([&]() { parallelSort(pairs, pool); });
+      });
+      print({"parallel sort (pairs)", keyName<K>(), count, parallelMs, pairBytes, keysMatch(pairs, expectedKeys)});
+    }
+
+  }
+
+
+  void runSort(ComputeContext &context, const Options &options) {
+    primitives::RadixSort sort{};
+    sort.init(context);
+    ThreadPool pool{};
+
+    run<uint32_t>(context, sort, pool, options);
+    run<uint64_t>(context, sort, pool, options);
+    run<float>(context, sort, pool, options);
+
+    // more tiles of the smallest size than maxComputeWorkGroupCount[0]: the sort has to grow its tiles
+    const uint64_t groupLimitCount = (uint64_t) context.getLimits().maxComputeWorkGroupCount[0] * SMALLEST_TILE + 1;
+    if (groupLimitCount > options.count && groupLimitCount <= MAX_GROUP_LIMIT_COUNT) {
+      Options large = options;
+      large.count = (uint32_t) groupLimitCount;
+      run<uint32_t>(context, sort, pool, large);
+      run<uint64_t>(context, sort, pool, large);
+    }
+  }
+
+} // walrus::benchmark
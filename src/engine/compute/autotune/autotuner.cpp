@@ -0,0 +1,129 @@
+#include "autotuner.hpp"
+
+#include "pretty_io.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace walrus {
+
+  Autotuner::Autotuner(std::string filePath) : _filePath(std::move(filePath)) {
+    load();
+  }
+
+
+  std::string Autotuner::deviceKey(const VkPhysicalDeviceProperties &properties) {
+    std::ostringstream key{};
+    key << std::hex << properties.vendorID << ':' << properties.deviceID << ':' << properties.driverVersion;
+    return key.str();
+  }
+
+
+  bool Autotuner::find(const std::string &deviceKey, const std::string &kernelKey, KernelVariant *outVariant) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _results.find(deviceKey + ' ' + kernelKey);
+    if (it == _results.end()) {
+      return false;
+    }
+    *outVariant = it->second.variant;
+    return true;
+  }
+
+
+  KernelVariant Autotuner::tune(
+    const std::string &deviceKey,
+    const std::string &kernelKey,
+    const std::vector<KernelVariant> &candidates,
+    const std::function<double(const KernelVariant &)> &benchmark,
+    uint32_t repeats
+  ) {
+    KernelVariant best{};
+    double bestMs = std::numeric_limits<double>::max();
+    for (auto &candidate: candidates) {
+      double candidateMs = std::numeric_limits<double>::max();
+      for (uint32_t i = 0; i < repeats && candidateMs >= 0.0; i++) {
+        const double ms = benchmark(candidate);
+        candidateMs = ms < 0.0 ? ms : std::min(candidateMs, ms);
+      }
+      if (candidateMs >= 0.0 && candidateMs < bestMs) {
+        bestMs = candidateMs;
+        best = candidate;
+      }
+    }
+    if (best.empty()) {
+      std::cout << io::to_color_string(io::RED, "autotune failed: " + kernelKey) << std::endl;
+      return best;
+    }
+
+    std::cout << "autotuned " << kernelKey << " (" << candidates.size() << " variants): " << bestMs << " ms [";
+    for (size_t i = 0; i < best.size(); i++) {
+      std::cout << (i == 0 ? "" : " ") << best[i];
+    }
+    std::cout << "]" << std::endl;
+
+    store(deviceKey, kernelKey, best, bestMs);
+    save();
+    return best;
+  }
+
+
+  void Autotuner::store(const std::string &deviceKey, const std::string &kernelKey, const KernelVariant &variant, double ms) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _results[deviceKey + ' ' + kernelKey] = Result{ms, variant};
+  }
+
+
+  bool Autotuner::save() {
+    if (_filePath.empty()) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    // write a temporary file and rename it, so a crash mid-write can't leave a truncated file behind
+    const std::string tempPath = _filePath + ".tmp";
+    {
+      std::ofstream file(tempPath, std::ios::trunc);
+      if (!file.is_open()) {
+        return false;
+      }
+      for (auto &[key, result]: _results) {
+        file << key << ' ' << result.ms;
+        for (uint32_t value: result.variant) {
+          file << ' ' << value;
+        }
+        file << '\n';
+      }
+      if (!file.good()) {
+        return false;
+      }
+    }
+    return std::rename(tempPath.c_str(), _filePath.c_str()) == 0;
+  }
+
+
+  void Autotuner::load() {
+    std::ifstream file(_filePath);
+    if (!file.is_open()) {
+      return; // nothing tuned yet
+    }
+    std::string line{};
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string deviceKey{};
+      std::string kernelKey{};
+      Result result{};
+      if (!(fields >> deviceKey >> kernelKey >> result.ms)) {
+        continue; // skip malformed lines instead of discarding the whole file
+      }
+      uint32_t value = 0;
+      while (fields >> value) {
+        result.variant.push_back(value);
+      }
+      _results[deviceKey + ' ' + kernelKey] = std::move(result);
+    }
+  }
+
+} // walrus
@@ -0,0 +1,73 @@
+#ifndef WALRUS_COMPUTE_ENGINE_AUTOTUNER_HPP
+#define WALRUS_COMPUTE_ENGINE_AUTOTUNER_HPP
+
+#include "engine/compute/kernel/kernel.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace walrus {
+
+  /**
+   * @brief picks the fastest variant of a kernel by benchmarking the candidates, and remembers the winner.
+   * results are keyed by device (vendor, device id & driver version) and kernel, and persisted to a text file
+   * so that later runs on the same device & driver build the fastest variant without re-tuning.
+   * @note file format, one result per line: `<vendor>:<device>:<driver> <kernel key> <ms> <values...>`
+   */
+  class Autotuner {
+  public:
+    Autotuner() = default;
+
+    /// @brief loads previous results from `filePath`. an empty path keeps results in memory only
+    explicit Autotuner(std::string filePath);
+
+    Autotuner(const Autotuner &) = delete;
+    Autotuner &operator=(const Autotuner &) = delete;
+
+    /// @brief identifies a device & driver. a driver update invalidates its results
+    static std::string deviceKey(const VkPhysicalDeviceProperties &properties);
+
+    /// @brief returns true and sets `outVariant` if the kernel was already tuned for the device
+    /// @note keys must not contain whitespace
+    bool find(const std::string &deviceKey, const std::string &kernelKey, KernelVariant *outVariant);
+
+    /**
+     * @brief benchmark every candidate, store the fastest and write the results file.
+     * @param benchmark runs one candidate and returns its time in ms. negative = candidate failed
+     * @param repeats each candidate is run `repeats` times, and its fastest run is kept
+     * @return the fastest candidate, or an empty variant if every candidate failed
+     */
+    KernelVariant tune(
+      const std::string &deviceKey,
+      const std::string &kernelKey,
+      const std::vector<KernelVariant> &candidates,
+      const std::function<double(const KernelVariant &)> &benchmark,
+      uint32_t repeats = 3
+    );
+
+    void store(const std::string &deviceKey, const std::string &kernelKey, const KernelVariant &variant, double ms);
+
+    /// @brief write every result to the results file. returns false if it couldn't be written
+    bool save();
+
+    [[nodiscard]] const std::string &getFilePath() const { return _filePath; }
+
+  private:
+    struct Result {
+      double ms = 0.0;
+      KernelVariant variant{};
+    };
+
+    void load();
+
+    std::string _filePath{};
+    /// (device key + ' ' + kernel key) -> result. ordered, so the file is stable between saves
+    std::map<std::string, Result> _results{};
+    std::mutex _mutex{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_AUTOTUNER_HPP
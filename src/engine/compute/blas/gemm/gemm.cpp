@@ -0,0 +1,163 @@
+#include "gemm.hpp"
+
+#include "engine/utils/half/half.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace walrus::blas {
+
+  namespace {
+    struct PushConstants {
+      uint32_t m;
+      uint32_t n;
+      uint32_t k;
+      float alpha;
+      float beta;
+    };
+
+    /// matches gemm.glsl
+    enum SpecConstantId : uint32_t {
+      WORKGROUP_X = 0,
+      WORKGROUP_Y = 1,
+      THREAD_M = 2,
+      THREAD_N = 3,
+      TILE_K = 4,
+    };
+
+    /// square multiply the kernels are tuned on. ~2 GFLOP
+    constexpr uint32_t TUNING_SIZE = 1024;
+
+    KernelInfo kernelInfo(Precision precision) {
+      KernelInfo info{};
+      info.fileName = precision == Precision::FP16 ? "gemm_fp16.comp.spv" : "gemm.comp.spv";
+      info.bindingCount = 3;
+      info.pushConstantSize = sizeof(PushConstants);
+      info.specConstants = {
+        {WORKGROUP_X, "WORKGROUP_X", 16, {8, 16}},
+        {WORKGROUP_Y, "WORKGROUP_Y", 16, {8, 16}},
+        {THREAD_M, "THREAD_M", 4, {4, 8}},
+        {THREAD_N, "THREAD_N", 4, {4, 8}},
+        {TILE_K, "TILE_K", 16, {8, 16}},
+      };
+      info.workgroupSize = {"WORKGROUP_X", "WORKGROUP_Y", nullptr};
+      info.isSupported = [](const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) {
+        const uint64_t tileM = (uint64_t) variant[WORKGROUP_Y] * variant[THREAD_M];
+        const uint64_t tileN = (uint64_t) variant[WORKGROUP_X] * variant[THREAD_N];
+        // slices of A & B, staged as 32 bit floats
+        return (tileM + tileN) * variant[TILE_K] * sizeof(float) <= limits.maxComputeSharedMemorySize;
+      };
+      return info;
+    }
+  }
+
+
+  const char *toString(Precision precision) {
+    switch (precision) {
+      case Precision::FP32:
+        return "f32";
+      case Precision::FP16:
+        return "f16";
+    }
+    return "unknown";
+  }
+
+
+  void Gemm::init(ComputeContext &context) {
+    _context = &context;
+
+    std::vector<float> values(TUNING_SIZE * TUNING_SIZE);
+    std::mt19937 generator(TUNING_SIZE);
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    for (auto &value: values) {
+      value = distribution(generator);
+    }
+    const std::vector<uint16_t> halves = half::fromFloats(values);
+
+    AllocatedBuffer c = context.createBuffer(values.size() * sizeof(float));
+    for (Precision precision: {Precision::FP32, Precision::FP16}) {
+      if (!supports(precision)) {
+        continue;
+      }
+      // A & B can share the tuning input, the access patterns are what matter
+      const bool fp16 = precision == Precision::FP16;
+      const VkDeviceSize size = values.size() * (fp16 ? sizeof(uint16_t) : sizeof(float));
+      AllocatedBuffer input = context.createBuffer(size);
+      context.upload(input, fp16 ? (const void *) halves.data() : (const void *) values.data(), size);
+
+      const std::string key = std::string("gemm_") + toString(precision);
+      const Kernel tuned = context.getTunedKernel(kernelInfo(precision), key, [&](const Kernel &kernel) {
+        _kernels[(uint32_t) precision] = kernel;
+        record(input, input, c, TUNING_SIZE, TUNING_SIZE, TUNING_SIZE, precision);
+      });
+      _kernels[(uint32_t) precision] = tuned;
+      context.destroyBuffer(input);
+    }
+    context.destroyBuffer(c);
+  }
+
+
+  bool Gemm::supports(Precision precision) const {
+    if (precision == Precision::FP16) {
+      return _context->getDeviceInfo().capabilities.storageBuffer16BitAccess;
+    }
+    return true;
+  }
+
+
+  void Gemm::record(
+    const AllocatedBuffer &a,
+    const AllocatedBuffer &b,
+    const AllocatedBuffer &c,
+    uint32_t m,
+    uint32_t n,
+    uint32_t k,
+    Precision precision,
+    float alpha,
+    float beta
+  ) {
+    if (!supports(precision)) {
+      throw std::runtime_error(std::string("gemm precision not supported by the device: ") + toString(precision));
+    }
+    if (m == 0 || n == 0) {
+      return;
+    }
+    const Kernel &kernel = getKernel(precision);
+    const uint32_t tileM = kernel.variant[WORKGROUP_Y] * kernel.variant[THREAD_M];
+    const uint32_t tileN = kernel.variant[WORKGROUP_X] * kernel.variant[THREAD_N];
+    const PushConstants constants{m, n, k, alpha, beta};
+    _context->dispatch(
+      kernel,
+      {ComputeContext::bind(a), ComputeContext::bind(b), ComputeContext::bind(c)},
+      &constants,
+      (n + tileN - 1) / tileN,
+      (m + tileM - 1) / tileM
+    );
+    _context->barrier();
+  }
+
+
+  Gemm::Performance Gemm::multiply(
+    const AllocatedBuffer &a,
+    const AllocatedBuffer &b,
+    const AllocatedBuffer &c,
+    uint32_t m,
+    uint32_t n,
+    uint32_t k,
+    Precision precision,
+    float alpha,
+    float beta
+  ) {
+    _context->begin();
+    record(a, b, c, m, n, k, precision, alpha, beta);
+    const double ms = _context->submit();
+    return {ms, gflops(m, n, k, ms)};
+  }
+
+
+  double Gemm::gflops(uint32_t m, uint32_t n, uint32_t k, double ms) {
+    return ms > 0.0 ? 2.0 * m * n * k / (ms * 1e6) : 0.0;
+  }
+
+} // walrus::blas
@@ -0,0 +1,78 @@
+#ifndef WALRUS_COMPUTE_ENGINE_GEMM_HPP
+#define WALRUS_COMPUTE_ENGINE_GEMM_HPP
+
+#include "engine/compute/context/compute_context.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace walrus::blas {
+
+  /// @brief storage precision of the input matrices. products are always accumulated in 32 bit floats
+  enum class Precision : uint32_t {
+    FP32 = 0,
+    FP16 = 1,
+  };
+
+  const char *toString(Precision precision);
+
+  /**
+   * @brief tiled matrix multiply C = alpha * A * B + beta * C, with row major A (m x k), B (k x n) & C (m x n).
+   * blocks of C are computed per workgroup from slices of A & B staged in shared memory,
+   * with a register tile per invocation. the tile sizes are tuned per device & precision on first use.
+   * any m, n & k work: edge tiles are zero padded.
+   * @note FP16 stores A & B as IEEE binary16 (see half::fromFloat). C is always 32 bit floats.
+   *       it needs 16 bit storage buffer access, see supports()
+   */
+  class Gemm {
+  public:
+    struct Performance {
+      double ms = 0.0;
+      double gflops = 0.0;
+    };
+
+    /// @brief builds (and on the first run per device, tunes) the kernels
+    void init(ComputeContext &context);
+
+    /// @brief true if the device can run the precision
+    [[nodiscard]] bool supports(Precision precision) const;
+
+    /// @brief records the multiply between ComputeContext::begin() and submit()
+    void record(
+      const AllocatedBuffer &a,
+      const AllocatedBuffer &b,
+      const AllocatedBuffer &c,
+      uint32_t m,
+      uint32_t n,
+      uint32_t k,
+      Precision precision,
+      float alpha = 1.f,
+      float beta = 0.f
+    );
+
+    /// @brief C = alpha * A * B + beta * C. blocks until complete
+    Performance multiply(
+      const AllocatedBuffer &a,
+      const AllocatedBuffer &b,
+      const AllocatedBuffer &c,
+      uint32_t m,
+      uint32_t n,
+      uint32_t k,
+      Precision precision,
+      float alpha = 1.f,
+      float beta = 0.f
+    );
+
+    /// @brief 2 * m * n * k floating point operations in `ms`
+    static double gflops(uint32_t m, uint32_t n, uint32_t k, double ms);
+
+    [[nodiscard]] const Kernel &getKernel(Precision precision) const { return _kernels[(uint32_t) precision]; }
+
+  private:
+    ComputeContext *_context = nullptr;
+    std::array<Kernel, 2> _kernels{};
+  };
+
+} // walrus::blas
+
+#endif //WALRUS_COMPUTE_ENGINE_GEMM_HPP
@@ -0,0 +1,46 @@
+#ifndef WALRUS_COMPUTE_ENGINE_BLAS_REFERENCE_HPP
+#define WALRUS_COMPUTE_ENGINE_BLAS_REFERENCE_HPP
+
+#include "engine/compute/blas/sparse/sparse.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * CPU reference implementations of the blas kernels, used to check them.
+ * products are accumulated in double, so compare kernels against them with a tolerance.
+ */
+namespace walrus::blas::reference {
+
+  /// @brief one row of A * B, with row major A (m x k) and B (k x n)
+  inline std::vector<double> gemmRow(
+    const std::vector<float> &a,
+    const std::vector<float> &b,
+    uint32_t n,
+    uint32_t k,
+    uint32_t row
+  ) {
+    std::vector<double> result(n, 0.0);
+    for (uint32_t i = 0; i < k; i++) {
+      const double value = a[(size_t) row * k + i];
+      for (uint32_t col = 0; col < n; col++) {
+        result[col] += value * b[(size_t) i * n + col];
+      }
+    }
+    return result;
+  }
+
+  /// @brief A * x
+  inline std::vector<double> spmv(const CsrMatrix &matrix, const std::vector<float> &x) {
+    std::vector<double> result(matrix.rows, 0.0);
+    for (uint32_t row = 0; row < matrix.rows; row++) {
+      for (uint32_t i = matrix.rowOffsets[row]; i < matrix.rowOffsets[row + 1]; i++) {
+        result[row] += (double) matrix.values[i] * x[matrix.columns[i]];
+      }
+    }
+    return result;
+  }
+
+} // walrus::blas::reference
+
+#endif //WALRUS_COMPUTE_ENGINE_BLAS_REFERENCE_HPP
@@ -0,0 +1,116 @@
+#include "sparse.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace walrus::blas {
+
+  namespace {
+    /// stored entries of slices of `sliceSize` rows, each padded to its longest row
+    uint64_t paddedEntries(const CsrMatrix &matrix, uint32_t sliceSize) {
+      uint64_t entries = 0;
+      for (uint32_t first = 0; first < matrix.rows; first += sliceSize) {
+        uint32_t width = 0;
+        for (uint32_t row = first; row < std::min(first + sliceSize, matrix.rows); row++) {
+          width = std::max(width, matrix.rowLength(row));
+        }
+        entries += (uint64_t) width * sliceSize;
+      }
+      return entries;
+    }
+  }
+
+
+  const char *toString(SparseFormat format) {
+    switch (format) {
+      case SparseFormat::CSR_VECTOR:
+        return "csr vector";
+      case SparseFormat::CSR_MERGE_PATH:
+        return "csr merge-path";
+      case SparseFormat::ELL:
+        return "ell";
+      case SparseFormat::SLICED_ELL:
+        return "sliced ell";
+    }
+    return "unknown";
+  }
+
+
+  RowStatistics rowStatistics(const CsrMatrix &matrix) {
+    RowStatistics statistics{};
+    statistics.rows = matrix.rows;
+    statistics.nonZeros = matrix.nonZeros();
+    if (matrix.rows == 0) {
+      return statistics;
+    }
+    statistics.minLength = matrix.rowLength(0);
+    double sumOfSquares = 0.0;
+    for (uint32_t row = 0; row < matrix.rows; row++) {
+      const uint32_t length = matrix.rowLength(row);
+      statistics.minLength = std::min(statistics.minLength, length);
+      statistics.maxLength = std::max(statistics.maxLength, length);
+      sumOfSquares += (double) length * length;
+    }
+    statistics.meanLength = (double) statistics.nonZeros / matrix.rows;
+    statistics.stddevLength = std::sqrt(
+      std::max(sumOfSquares / matrix.rows - statistics.meanLength * statistics.meanLength, 0.0)
+    );
+
+    const double nonZeros = std::max<double>(statistics.nonZeros, 1.0);
+    statistics.ellPadding = (double) statistics.maxLength * matrix.rows / nonZeros;
+    statistics.slicedEllPadding = (double) paddedEntries(matrix, SLICE_SIZE) / nonZeros;
+    return statistics;
+  }
+
+
+  SparseFormat bestFormat(const RowStatistics &statistics) {
+    // padding costs bandwidth, but ELL reads are coalesced and need no row offsets
+    if (statistics.ellPadding <= 1.25) {
+      return SparseFormat::ELL;
+    }
+    if (statistics.slicedEllPadding <= 1.5) {
+      return SparseFormat::SLICED_ELL;
+    }
+    // a row per few invocations leaves the invocations of short rows idle while long rows finish
+    if (statistics.maxLength > 8 * std::max(statistics.meanLength, 1.0)) {
+      return SparseFormat::CSR_MERGE_PATH;
+    }
+    return SparseFormat::CSR_VECTOR;
+  }
+
+
+  EllMatrix toEll(const CsrMatrix &matrix, uint32_t sliceSize) {
+    EllMatrix ell{};
+    ell.rows = matrix.rows;
+    ell.cols = matrix.cols;
+    ell.sliceSize = std::max<uint32_t>(std::min(sliceSize, matrix.rows), 1);
+
+    const uint64_t entries = paddedEntries(matrix, ell.sliceSize);
+    if (entries >= ELL_PADDING) {
+      throw std::runtime_error("sparse matrix is too large for an ELL layout");
+    }
+    ell.columns.assign(entries, ELL_PADDING);
+    ell.values.assign(entries, 0.f);
+
+    ell.sliceOffsets.push_back(0);
+    for (uint32_t first = 0; first < matrix.rows; first += ell.sliceSize) {
+      const uint32_t last = std::min(first + ell.sliceSize, matrix.rows);
+      uint32_t width = 0;
+      for (uint32_t row = first; row < last; row++) {
+        width = std::max(width, matrix.rowLength(row));
+      }
+      const uint32_t start = ell.sliceOffsets.back();
+      for (uint32_t row = first; row < last; row++) {
+        for (uint32_t i = 0; i < matrix.rowLength(row); i++) {
+          const uint32_t entry = start + i * ell.sliceSize + (row - first);
+          ell.columns[entry] = matrix.columns[matrix.rowOffsets[row] + i];
+          ell.values[entry] = matrix.values[matrix.rowOffsets[row] + i];
+        }
+      }
+      ell.sliceOffsets.push_back(start + width * ell.sliceSize);
+    }
+    return ell;
+  }
+
+} // walrus::blas
@@ -0,0 +1,77 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SPARSE_HPP
+#define WALRUS_COMPUTE_ENGINE_SPARSE_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace walrus::blas {
+
+  /// @brief a host sparse matrix in compressed sparse row form
+  struct CsrMatrix {
+    uint32_t rows = 0;
+    uint32_t cols = 0;
+    /// rows + 1 offsets into `columns` & `values`
+    std::vector<uint32_t> rowOffsets{0};
+    std::vector<uint32_t> columns{};
+    std::vector<float> values{};
+
+    [[nodiscard]] uint32_t nonZeros() const { return (uint32_t) values.size(); }
+
+    [[nodiscard]] uint32_t rowLength(uint32_t row) const { return rowOffsets[row + 1] - rowOffsets[row]; }
+  };
+
+  /// @brief device layouts of a sparse matrix
+  enum class SparseFormat : uint32_t {
+    CSR_VECTOR = 0,     /// a few invocations per row
+    CSR_MERGE_PATH = 1, /// equal work per invocation, whatever the row lengths
+    ELL = 2,            /// every row padded to the longest, column major
+    SLICED_ELL = 3,     /// ELL per slice of SLICE_SIZE rows
+  };
+
+  const char *toString(SparseFormat format);
+
+  /// rows per slice of SLICED_ELL. one subgroup on most devices
+  constexpr uint32_t SLICE_SIZE = 32;
+
+  /// column of padding entries in ELL layouts
+  constexpr uint32_t ELL_PADDING = 0xFFFFFFFF;
+
+  /// @brief row length statistics, used to pick a layout
+  struct RowStatistics {
+    uint32_t rows = 0;
+    uint32_t nonZeros = 0;
+    uint32_t minLength = 0;
+    uint32_t maxLength = 0;
+    double meanLength = 0.0;
+    double stddevLength = 0.0;
+    /// stored entries / non zeros of each ELL layout. 1 = no padding
+    double ellPadding = 1.0;
+    double slicedEllPadding = 1.0;
+  };
+
+  RowStatistics rowStatistics(const CsrMatrix &matrix);
+
+  /**
+   * @brief the layout expected to multiply fastest:
+   * ELL when rows have about the same length, sliced ELL when neighbouring rows do,
+   * merge-path when a few rows are much longer than the rest (i.e. power law graphs), and CSR vector otherwise
+   */
+  SparseFormat bestFormat(const RowStatistics &statistics);
+
+  /// @brief sliced ELL: slices of `sliceSize` rows, each padded to its longest row and stored column major
+  struct EllMatrix {
+    uint32_t rows = 0;
+    uint32_t cols = 0;
+    uint32_t sliceSize = 0;
+    /// slices + 1 entry offsets
+    std::vector<uint32_t> sliceOffsets{};
+    std::vector<uint32_t> columns{};
+    std::vector<float> values{};
+  };
+
+  /// @brief `sliceSize` >= rows gives plain ELL. throws if the padded matrix has more than 2^32 - 1 entries
+  EllMatrix toEll(const CsrMatrix &matrix, uint32_t sliceSize);
+
+} // walrus::blas
+
+#endif //WALRUS_COMPUTE_ENGINE_SPARSE_HPP
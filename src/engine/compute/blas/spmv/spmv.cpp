@@ -0,0 +1,176 @@
+#include "spmv.hpp"
+
+#include <algorithm>
+
+namespace walrus::blas {
+
+  namespace {
+    struct VectorConstants {
+      uint32_t rows;
+    };
+
+    struct MergeConstants {
+      uint32_t rows;
+      uint32_t nonZeros;
+      uint32_t invocations;
+    };
+
+    struct FixupConstants {
+      uint32_t rows;
+      uint32_t invocations;
+    };
+
+    struct EllConstants {
+      uint32_t rows;
+      uint32_t sliceSize;
+    };
+
+    constexpr uint32_t WORKGROUP_SIZE = 256;
+    /// path steps per merge-path invocation
+    constexpr uint32_t MERGE_ITEMS_PER_THREAD = 8;
+    constexpr uint32_t MAX_VECTOR_SIZE = 32;
+
+    KernelInfo kernelInfo(const char *fileName, uint32_t bindingCount, uint32_t pushConstantSize) {
+      KernelInfo info{};
+      info.fileName = fileName;
+      info.bindingCount = bindingCount;
+      info.pushConstantSize = pushConstantSize;
+      info.specConstants = {{0, "WORKGROUP_SIZE", WORKGROUP_SIZE, {}}};
+      info.workgroupSize = {"WORKGROUP_SIZE", nullptr, nullptr};
+      return info;
+    }
+
+    /// @brief a power of 2 around the mean row length, so most invocations of a row have a non zero to read
+    uint32_t vectorSize(double meanLength) {
+      uint32_t size = 2;
+      while (size < MAX_VECTOR_SIZE && size < meanLength) {
+        size *= 2;
+      }
+      return size;
+    }
+  }
+
+
+  void Spmv::init(ComputeContext &context) {
+    _context = &context;
+    _vectorInfo = kernelInfo("spmv_csr_vector.comp.spv", 5, sizeof(VectorConstants));
+    _vectorInfo.specConstants.push_back({1, "VECTOR_SIZE", 8, {}});
+
+    KernelInfo mergeInfo = kernelInfo("spmv_csr_merge.comp.spv", 6, sizeof(MergeConstants));
+    mergeInfo.specConstants.push_back({1, "ITEMS_PER_THREAD", MERGE_ITEMS_PER_THREAD, {}});
+    _merge = context.getKernel(mergeInfo);
+    _mergeFixup = context.getKernel(kernelInfo("spmv_csr_merge_fixup.comp.spv", 2, sizeof(FixupConstants)));
+    _ell = context.getKernel(kernelInfo("spmv_ell.comp.spv", 5, sizeof(EllConstants)));
+  }
+
+
+  Spmv::Matrix Spmv::upload(const CsrMatrix &matrix, SparseFormat format) {
+    Matrix device{};
+    device.format = format;
+    device.rows = matrix.rows;
+    device.cols = matrix.cols;
+    device.nonZeros = matrix.nonZeros();
+
+    if (format == SparseFormat::ELL || format == SparseFormat::SLICED_ELL) {
+      const EllMatrix ell = toEll(matrix, format == SparseFormat::ELL ? matrix.rows : SLICE_SIZE);
+      device.sliceSize = ell.sliceSize;
+      device.offsets = uploadVector(ell.sliceOffsets.data(), ell.sliceOffsets.size() * sizeof(uint32_t));
+      device.columns = uploadVector(ell.columns.data(), ell.columns.size() * sizeof(uint32_t));
+      device.values = uploadVector(ell.values.data(), ell.values.size() * sizeof(float));
+      return device;
+    }
+
+    device.offsets = uploadVector(matrix.rowOffsets.data(), matrix.rowOffsets.size() * sizeof(uint32_t));
+    device.columns = uploadVector(matrix.columns.data(), matrix.columns.size() * sizeof(uint32_t));
+    device.values = uploadVector(matrix.values.data(), matrix.values.size() * sizeof(float));
+    if (format == SparseFormat::CSR_VECTOR) {
+      device.vectorSize = vectorSize(rowStatistics(matrix).meanLength);
+    } else {
+      const uint64_t pathLength = (uint64_t) matrix.rows + matrix.nonZeros();
+      device.mergeInvocations = (uint32_t) ((pathLength + MERGE_ITEMS_PER_THREAD - 1) / MERGE_ITEMS_PER_THREAD);
+      device.carries = _context->createBuffer(std::max<VkDeviceSize>(device.mergeInvocations, 1) * 2 * sizeof(uint32_t));
+    }
+    return device;
+  }
+
+
+  void Spmv::destroy(Matrix &matrix) {
+    _context->destroyBuffer(matrix.carries);
+    _context->destroyBuffer(matrix.values);
+    _context->destroyBuffer(matrix.columns);
+    _context->destroyBuffer(matrix.offsets);
+    matrix = Matrix{};
+  }
+
+
+  void Spmv::record(const Matrix &matrix, const AllocatedBuffer &x, const AllocatedBuffer &y) {
+    if (matrix.rows == 0) {
+      return;
+    }
+    const std::vector<VkDescriptorBufferInfo> buffers = {
+      ComputeContext::bind(matrix.offsets),
+      ComputeContext::bind(matrix.columns),
+      ComputeContext::bind(matrix.values),
+      ComputeContext::bind(x),
+      ComputeContext::bind(y),
+    };
+
+    switch (matrix.format) {
+      case SparseFormat::CSR_VECTOR: {
+        KernelVariant variant = _vectorInfo.defaultVariant();
+        variant[1] = matrix.vectorSize;
+        const Kernel kernel = _context->getKernel(_vectorInfo, variant);
+        const VectorConstants constants{matrix.rows};
+        _context->dispatch(kernel, buffers, &constants, groupCount(kernel, (uint64_t) matrix.rows * matrix.vectorSize));
+        break;
+      }
+      case SparseFormat::CSR_MERGE_PATH: {
+        std::vector<VkDescriptorBufferInfo> mergeBuffers = buffers;
+        mergeBuffers.push_back(ComputeContext::bind(matrix.carries));
+        const MergeConstants constants{matrix.rows, matrix.nonZeros, matrix.mergeInvocations};
+        _context->dispatch(_merge, mergeBuffers, &constants, groupCount(_merge, matrix.mergeInvocations));
+        _context->barrier();
+
+        const FixupConstants fixupConstants{matrix.rows, matrix.mergeInvocations};
+        _context->dispatch(
+          _mergeFixup,
+          {ComputeContext::bind(matrix.carries), ComputeContext::bind(y)},
+          &fixupConstants,
+          groupCount(_mergeFixup, matrix.mergeInvocations)
+        );
+        break;
+      }
+      case SparseFormat::ELL:
+      case SparseFormat::SLICED_ELL: {
+        const EllConstants constants{matrix.rows, matrix.sliceSize};
+        _context->dispatch(_ell, buffers, &constants, groupCount(_ell, matrix.rows));
+        break;
+      }
+    }
+    _context->barrier();
+  }
+
+
+  double Spmv::multiply(const Matrix &matrix, const AllocatedBuffer &x, const AllocatedBuffer &y) {
+    _context->begin();
+    record(matrix, x, y);
+    return _context->submit();
+  }
+
+
+  uint32_t Spmv::groupCount(const Kernel &kernel, uint64_t invocations) const {
+    const uint32_t groups = kernel.groupCount(std::max<uint64_t>(invocations, 1));
+    return std::min(groups, _context->getLimits().maxComputeWorkGroupCount[0]);
+  }
+
+
+  AllocatedBuffer Spmv::uploadVector(const void *data, VkDeviceSize size) {
+    // empty matrices still bind valid buffers
+    AllocatedBuffer buffer = _context->createBuffer(std::max<VkDeviceSize>(size, sizeof(uint32_t)));
+    if (size > 0) {
+      _context->upload(buffer, data, size);
+    }
+    return buffer;
+  }
+
+} // walrus::blas
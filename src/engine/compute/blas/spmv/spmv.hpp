@@ -0,0 +1,70 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SPMV_HPP
+#define WALRUS_COMPUTE_ENGINE_SPMV_HPP
+
+#include "engine/compute/blas/sparse/sparse.hpp"
+#include "engine/compute/context/compute_context.hpp"
+
+#include <cstdint>
+
+namespace walrus::blas {
+
+  /**
+   * @brief sparse matrix * dense vector, y = A * x, with 32 bit float values and 32 bit column indices.
+   * matrices are converted from CSR to a device layout on upload -- by default the best fit for their
+   * row lengths (see bestFormat) -- and copied through staging buffers.
+   * @note the kernel sizes aren't autotuned: the best sizes depend on the matrix more than the device
+   */
+  class Spmv {
+  public:
+    /// @brief a sparse matrix in device memory
+    struct Matrix {
+      SparseFormat format = SparseFormat::CSR_VECTOR;
+      uint32_t rows = 0;
+      uint32_t cols = 0;
+      uint32_t nonZeros = 0;
+      /// invocations per row of CSR_VECTOR
+      uint32_t vectorSize = 0;
+      /// rows per slice of ELL & SLICED_ELL
+      uint32_t sliceSize = 0;
+      /// invocations of CSR_MERGE_PATH
+      uint32_t mergeInvocations = 0;
+      /// CSR: row offsets. ELL: slice offsets
+      AllocatedBuffer offsets{};
+      AllocatedBuffer columns{};
+      AllocatedBuffer values{};
+      /// CSR_MERGE_PATH: a (row, partial sum) per invocation
+      AllocatedBuffer carries{};
+    };
+
+    void init(ComputeContext &context);
+
+    /// @brief converts `matrix` to `format`, and uploads it
+    Matrix upload(const CsrMatrix &matrix, SparseFormat format);
+
+    /// @brief uploads `matrix` in its best fit layout
+    Matrix upload(const CsrMatrix &matrix) { return upload(matrix, bestFormat(rowStatistics(matrix))); }
+
+    void destroy(Matrix &matrix);
+
+    /// @brief records y = A * x between ComputeContext::begin() and submit(). x has `cols` floats, y `rows`
+    void record(const Matrix &matrix, const AllocatedBuffer &x, const AllocatedBuffer &y);
+
+    /// @brief y = A * x. blocks until complete, returns the time in ms
+    double multiply(const Matrix &matrix, const AllocatedBuffer &x, const AllocatedBuffer &y);
+
+  private:
+    /// @brief workgroups for `invocations`, capped at the dispatch limit. the kernels stride over the rest
+    [[nodiscard]] uint32_t groupCount(const Kernel &kernel, uint64_t invocations) const;
+
+    AllocatedBuffer uploadVector(const void *data, VkDeviceSize size);
+
+    ComputeContext *_context = nullptr;
+    KernelInfo _vectorInfo{};
+    Kernel _merge{};
+    Kernel _mergeFixup{};
+    Kernel _ell{};
+  };
+
+} // walrus::blas
+
+#endif //WALRUS_COMPUTE_ENGINE_SPMV_HPP
@@ -0,0 +1,672 @@
+#include "compute_context.hpp"
+
+#include "engine/compute/commands/command.hpp"
+#include "engine/utils/hash/hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace walrus {
+
+  namespace {
+    /// mixed into compute pipeline keys, so they can't collide with graphics pipelines in the shared cache
+    constexpr uint64_t COMPUTE_TAG = 0xc2b2ae3d27d4eb4full;
+
+    /// matches dispatch_args.comp. offsets are in 32 bit words
+    struct DispatchArgsConstants {
+      uint32_t countIndex;
+      uint32_t argsIndex;
+      uint32_t itemsPerGroup;
+      uint32_t maxGroups;
+    };
+
+    void check(VkResult result, const char *what) {
+      if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("compute context: failed to ") + what);
+      }
+    }
+  }
+
+
+
+
+  void ComputeContext::init(const CreateInfo &createInfo) {
+    if (isInitialized()) {
+      throw std::runtime_error("compute context is already initialized");
+    }
+    _device = createInfo.device;
+    _queue = createInfo.queue;
+    _scheduler = createInfo.scheduler;
+    _priority = createInfo.priority;
+    _allocator = createInfo.allocator;
+    _pools = createInfo.pools;
+    _deviceInfo = createInfo.deviceInfo;
+    _pipelineCache = createInfo.pipelineCache;
+    _shaderModules = createInfo.shaderModules;
+    _shaderDirectory = createInfo.shaderDirectory;
+    _kernelCacheDirectory = createInfo.kernelCacheDirectory;
+    _autotuner = std::make_unique<Autotuner>(createInfo.autotuneFilePath);
+    _deviceKey = Autotuner::deviceKey(_deviceInfo->properties);
+    _pipelineCache->createDriverCache(_device);
+    _submitBatcher.init(_device, *_deviceInfo);
+    _queueFamilies = {createInfo.queueFamilyIndex};
+    for (uint32_t family: createInfo.concurrentQueueFamilies) {
+      if (std::find(_queueFamilies.begin(), _queueFamilies.end(), family) == _queueFamilies.end()) {
+        _queueFamilies.push_back(family);
+      }
+    }
+
+    /// COMMANDS
+    {
+      auto poolInfo = CommandPool::createInfo(createInfo.queueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+      check(vkCreateCommandPool(_device, &poolInfo, nullptr, &_commandPool), "create command pool");
+      auto allocInfo = CommandBuffer::allocateInfo(_commandPool);
+      check(vkAllocateCommandBuffers(_device, &allocInfo, &_commandBuffer), "allocate command buffer");
+
+      VkFenceCreateInfo fenceInfo{};
+      fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      check(vkCreateFence(_device, &fenceInfo, nullptr, &_fence), "create fence");
+    }
+
+    /// TIMELINE
+    _submitted = 0;
+    _completed = 0;
+    _pending = false;
+    if (_deviceInfo->capabilities.timelineSemaphore) {
+      VkSemaphoreTypeCreateInfo typeInfo{};
+      typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+      typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+      typeInfo.initialValue = 0;
+      VkSemaphoreCreateInfo info{};
+      info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      info.pNext = &typeInfo;
+      check(vkCreateSemaphore(_device, &info, nullptr, &_timeline), "create timeline semaphore");
+      _getCounterValue = (PFN_vkGetSemaphoreCounterValue) vkGetDeviceProcAddr(
+        _device,
+        _deviceInfo->properties.apiVersion >= VK_API_VERSION_1_2
+        ? "vkGetSemaphoreCounterValue"
+        : "vkGetSemaphoreCounterValueKHR"
+      );
+    }
+
+    /// DESCRIPTORS
+    {
+      VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_STORAGE_BUFFERS};
+      VkDescriptorPoolCreateInfo info{};
+      info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+      info.maxSets = MAX_DESCRIPTOR_SETS;
+      info.poolSizeCount = 1;
+      info.pPoolSizes = &poolSize;
+      check(vkCreateDescriptorPool(_device, &info, nullptr, &_descriptorPool), "create descriptor pool");
+    }
+
+    /// TIMESTAMPS
+    {
+      uint32_t familyCount = 0;
+      vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &familyCount, nullptr);
+      std::vector<VkQueueFamilyProperties> families(familyCount);
+      vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &familyCount, families.data());
+      const uint32_t validBits = families.at(createInfo.queueFamilyIndex).timestampValidBits;
+      if (validBits > 0) {
+        VkQueryPoolCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = 2;
+        check(vkCreateQueryPool(_device, &info, nullptr, &_queryPool), "create query pool");
+        _timestampPeriod = _deviceInfo->properties.limits.timestampPeriod;
+        _timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+      }
+    }
+  }
+
+
+  void ComputeContext::destroy() {
+    if (!isInitialized()) {
+      return;
+    }
+    if (_pending) {
+      wait();
+    }
+    if (_timeline != VK_NULL_HANDLE) {
+      vkDestroySemaphore(_device, _timeline, nullptr);
+    }
+    if (_queryPool != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(_device, _queryPool, nullptr);
+    }
+    vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+    for (auto &[bindingCount, setLayout]: _setLayouts) {
+      vkDestroyDescriptorSetLayout(_device, setLayout, nullptr);
+    }
+    _setLayouts.clear();
+    _dispatchArgsKernel = Kernel{};
+    vkDestroyFence(_device, _fence, nullptr);
+    vkDestroyCommandPool(_device, _commandPool, nullptr);
+    _autotuner.reset();
+    _timeline = VK_NULL_HANDLE;
+    _getCounterValue = nullptr;
+    _queryPool = VK_NULL_HANDLE;
+    _descriptorPool = VK_NULL_HANDLE;
+    _fence = VK_NULL_HANDLE;
+    _commandPool = VK_NULL_HANDLE;
+    _commandBuffer = VK_NULL_HANDLE;
+    _device = VK_NULL_HANDLE;
+  }
+
+
+
+
+
+  /// --------------------------------------------------
+  /// KERNELS
+  /// --------------------------------------------------
+
+  Kernel ComputeContext::getKernel(const KernelInfo &info, const KernelVariant &variant) {
+    ShaderModuleCache::Module shaderModule{};
+    if (!_shaderModules->load(_device, _shaderDirectory + info.fileName, &shaderModule)) {
+      throw std::runtime_error("failed to load compute shader: " + _shaderDirectory + info.fileName);
+    }
+    // the pipeline doesn't need the module once it is created
+    try {
+      Kernel kernel = createKernel(info, variant, shaderModule);
+      _shaderModules->release(_device, shaderModule.codeHash);
+      return kernel;
+    } catch (...) {
+      _shaderModules->release(_device, shaderModule.codeHash);
+      throw;
+    }
+  }
+
+
+  Kernel ComputeContext::getKernel(const KernelInfo &info, const KernelVariant &variant, const std::vector<uint32_t> &spirv) {
+    ShaderModuleCache::Module shaderModule{};
+    if (!_shaderModules->get(_device, spirv.data(), spirv.size() * sizeof(uint32_t), &shaderModule)) {
+      throw std::runtime_error("failed to create compute shader module: " + info.fileName);
+    }
+    // the pipeline doesn't need the module once it is created
+    try {
+      Kernel kernel = createKernel(info, variant, shaderModule);
+      _shaderModules->release(_device, shaderModule.codeHash);
+      return kernel;
+    } catch (...) {
+      _shaderModules->release(_device, shaderModule.codeHash);
+      throw;
+    }
+  }
+
+
+  Kernel ComputeContext::createKernel(
+    const KernelInfo &info,
+    const KernelVariant &variant,
+    const ShaderModuleCache::Module &shaderModule
+  ) {
+    if (!info.fits(variant, getLimits())) {
+      throw std::runtime_error("kernel variant doesn't fit the device: " + info.fileName);
+    }
+    Kernel kernel{};
+    kernel.info = info;
+    kernel.variant = variant;
+    kernel.localSize = info.localSize(variant);
+    kernel.setLayout = getSetLayout(info.bindingCount);
+
+    /// LAYOUT
+    VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, info.pushConstantSize};
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &kernel.setLayout;
+    layoutInfo.pushConstantRangeCount = info.pushConstantSize > 0 ? 1 : 0;
+    layoutInfo.pPushConstantRanges = &pushConstantRange;
+    kernel.layout = _pipelineCache->getLayout(_device, layoutInfo);
+
+    /// SPECIALIZATION
+    std::vector<VkSpecializationMapEntry> entries(info.specConstants.size());
+    for (uint32_t i = 0; i < entries.size(); i++) {
+      entries[i].constantID = info.specConstants[i].id;
+      entries[i].offset = i * sizeof(uint32_t);
+      entries[i].size = sizeof(uint32_t);
+    }
+    VkSpecializationInfo specialization{};
+    specialization.mapEntryCount = (uint32_t) entries.size();
+    specialization.pMapEntries = entries.data();
+    specialization.dataSize = variant.size() * sizeof(uint32_t);
+    specialization.pData = variant.data();
+
+    /// CACHED PIPELINE
+    hash::Hasher hasher = hash::Hasher::recorder();
+    hasher.add(COMPUTE_TAG);
+    hasher.add(shaderModule.codeHash);
+    hasher.addString(info.entryPoint);
+    // layouts are deduplicated by the PipelineCache and live as long as it does, so their handles identify their state
+    hasher.add(kernel.layout);
+    for (auto &entry: entries) {
+      hasher.add(entry.constantID);
+    }
+    hasher.addBytes(variant.data(), specialization.dataSize);
+    hash::Key key = hasher.key();
+    if (_pipelineCache->findPipeline(key, &kernel.pipeline)) {
+      return kernel;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule.module;
+    pipelineInfo.stage.pName = info.entryPoint;
+    pipelineInfo.stage.pSpecializationInfo = entries.empty() ? nullptr : &specialization;
+    pipelineInfo.layout = kernel.layout;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    check(vkCreateComputePipelines(
+      _device,
+      _pipelineCache->getDriverCache(),
+      1,
+      &pipelineInfo,
+      nullptr,
+      &pipeline
+    ), "create compute pipeline");
+    kernel.pipeline = _pipelineCache->insertPipeline(_device, std::move(key), pipeline);
+    return kernel;
+  }
+
+
+  Kernel ComputeContext::getTunedKernel(
+    const KernelInfo &info,
+    const std::string &kernelKey,
+    const std::function<void(const Kernel &)> &workload
+  ) {
+    /// PREVIOUS RESULT
+    KernelVariant variant{};
+    if (_autotuner->find(_deviceKey, kernelKey, &variant) && info.fits(variant, getLimits())) {
+      return getKernel(info, variant);
+    }
+
+    /// TUNE
+    const auto candidates = info.candidateVariants(getLimits());
+    if (candidates.size() <= 1) {
+      return getKernel(info, candidates.empty() ? info.defaultVariant() : candidates.front());
+    }
+    variant = _autotuner->tune(_deviceKey, kernelKey, candidates, [&](const KernelVariant &candidate) {
+      const Kernel kernel = getKernel(info, candidate);
+      begin();
+      workload(kernel);
+      return submit();
+    });
+    return getKernel(info, variant.empty() ? info.defaultVariant() : variant);
+  }
+
+
+  VkDescriptorSetLayout ComputeContext::getSetLayout(uint32_t bindingCount) {
+    auto it = _setLayouts.find(bindingCount);
+    if (it != _setLayouts.end()) {
+      return it->second;
+    }
+    std::vector<VkDescriptorSetLayoutBinding> bindings(bindingCount);
+    for (uint32_t i = 0; i < bindingCount; i++) {
+      bindings[i].binding = i;
+      bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      bindings[i].descriptorCount = 1;
+      bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    info.bindingCount = bindingCount;
+    info.pBindings = bindings.data();
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    check(vkCreateDescriptorSetLayout(_device, &info, nullptr, &setLayout), "create descriptor set layout");
+    _setLayouts[bindingCount] = setLayout;
+    return setLayout;
+  }
+
+
+
+
+
+  /// --------------------------------------------------
+  /// BUFFERS
+  /// --------------------------------------------------
+
+  AllocatedBuffer ComputeContext::createBuffer(VkDeviceSize size, VmaMemoryUsage memoryUsage, VkBufferUsageFlags usage) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    if (_queueFamilies.size() > 1) {
+      bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+      bufferInfo.queueFamilyIndexCount = (uint32_t) _queueFamilies.size();
+      bufferInfo.pQueueFamilyIndices = _queueFamilies.data();
+    }
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = memoryUsage;
+    allocInfo.pool = _pools != nullptr ? _pools->poolFor(memoryUsage, size) : nullptr;
+
+    AllocatedBuffer buffer{};
+    VkResult result = vmaCreateBuffer(_allocator, &bufferInfo, &allocInfo, &buffer.buffer, &buffer.allocation, nullptr);
+    if (result != VK_SUCCESS && allocInfo.pool != nullptr) {
+      // the pool's memory type doesn't suit this usage, or its heap is full
+      allocInfo.pool = nullptr;
+      result = vmaCreateBuffer(_allocator, &bufferInfo, &allocInfo, &buffer.buffer, &buffer.allocation, nullptr);
+    }
+    check(result, "create buffer");
+    buffer.size = size;
+    return buffer;
+  }
+
+
+  void ComputeContext::destroyBuffer(AllocatedBuffer &buffer) {
+    if (buffer.buffer != VK_NULL_HANDLE) {
+      vmaDestroyBuffer(_allocator, buffer.buffer, buffer.allocation);
+    }
+    buffer = AllocatedBuffer{};
+  }
+
+
+  void ComputeContext::upload(const AllocatedBuffer &dst, const void *data, VkDeviceSize size, VkDeviceSize offset) {
+    if (_recording) {
+      throw std::runtime_error("compute context: can't upload while recording");
+    }
+    AllocatedBuffer staging = createBuffer(size, VMA_MEMORY_USAGE_CPU_ONLY, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    void *mapped = nullptr;
+    vmaMapMemory(_allocator, staging.allocation, &mapped);
+    memcpy(mapped, data, size);
+    vmaFlushAllocation(_allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+    vmaUnmapMemory(_allocator, staging.allocation);
+
+    begin();
+    copy(staging, dst, size, 0, offset);
+    submit();
+    destroyBuffer(staging);
+  }
+
+
+  void ComputeContext::download(const AllocatedBuffer &src, void *data, VkDeviceSize size, VkDeviceSize offset) {
+    if (_recording) {
+      throw std::runtime_error("compute context: can't download while recording");
+    }
+    AllocatedBuffer staging = createBuffer(size, VMA_MEMORY_USAGE_GPU_TO_CPU, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    begin();
+    copy(src, staging, size, offset, 0);
+    submit();
+
+    void *mapped = nullptr;
+    vmaMapMemory(_allocator, staging.allocation, &mapped);
+    vmaInvalidateAllocation(_allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+    memcpy(data, mapped, size);
+    vmaUnmapMemory(_allocator, staging.allocation);
+    destroyBuffer(staging);
+  }
+
+
+  VkDescriptorBufferInfo ComputeContext::bind(const AllocatedBuffer &buffer, VkDeviceSize offset, VkDeviceSize range) {
+    return VkDescriptorBufferInfo{buffer.buffer, offset, range};
+  }
+
+
+
+
+
+  /// --------------------------------------------------
+  /// RECORDING
+  /// --------------------------------------------------
+
+  void ComputeContext::begin() {
+    if (_recording) {
+      throw std::runtime_error("compute context: begin() called twice without submit()");
+    }
+    if (_pending) {
+      wait();
+    }
+    VkCommandBufferBeginInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    check(vkBeginCommandBuffer(_commandBuffer, &info), "begin command buffer");
+    if (_queryPool != VK_NULL_HANDLE) {
+      vkCmdResetQueryPool(_commandBuffer, _queryPool, 0, 2);
+      vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queryPool, 0);
+    }
+    _recording = true;
+    _beginTime = std::chrono::steady_clock::now();
+  }
+
+
+  void ComputeContext::dispatch(
+    const Kernel &kernel,
+    const std::vector<VkDescriptorBufferInfo> &buffers,
+    const void *pushConstants,
+    uint32_t groupCountX,
+    uint32_t groupCountY,
+    uint32_t groupCountZ
+  ) {
+    bindKernel(kernel, buffers, pushConstants);
+    vkCmdDispatch(_commandBuffer, groupCountX, groupCountY, groupCountZ);
+  }
+
+
+  void ComputeContext::dispatchIndirect(
+    const Kernel &kernel,
+    const std::vector<VkDescriptorBufferInfo> &buffers,
+    const void *pushConstants,
+    const AllocatedBuffer &args,
+    VkDeviceSize offset
+  ) {
+    if (offset % sizeof(uint32_t) != 0 || offset + sizeof(VkDispatchIndirectCommand) > args.size) {
+      throw std::runtime_error("indirect dispatch arguments out of bounds: " + kernel.info.fileName);
+    }
+    bindKernel(kernel, buffers, pushConstants);
+    vkCmdDispatchIndirect(_commandBuffer, args.buffer, offset);
+  }
+
+
+  void ComputeContext::recordDispatchArgs(
+    const AllocatedBuffer &counts,
+    VkDeviceSize countOffset,
+    const AllocatedBuffer &args,
+    VkDeviceSize argsOffset,
+    uint32_t itemsPerGroup
+  ) {
+    if (countOffset % sizeof(uint32_t) != 0 || argsOffset % sizeof(uint32_t) != 0) {
+      throw std::runtime_error("dispatch args offsets must be multiples of 4");
+    }
+    if (countOffset + sizeof(uint32_t) > counts.size || argsOffset + sizeof(DispatchArgs) > args.size) {
+      throw std::runtime_error("dispatch args out of bounds");
+    }
+    if (itemsPerGroup == 0) {
+      throw std::runtime_error("dispatch args need at least one item per group");
+    }
+    if (_dispatchArgsKernel.pipeline == VK_NULL_HANDLE) {
+      KernelInfo info{};
+      info.fileName = "dispatch_args.comp.spv";
+      info.bindingCount = 2;
+      info.pushConstantSize = sizeof(DispatchArgsConstants);
+      _dispatchArgsKernel = getKernel(info);
+    }
+
+    // whole buffers are bound, so the offsets don't need the storage buffer alignment
+    const DispatchArgsConstants constants{
+      (uint32_t) (countOffset / sizeof(uint32_t)),
+      (uint32_t) (argsOffset / sizeof(uint32_t)),
+      itemsPerGroup,
+      getLimits().maxComputeWorkGroupCount[0],
+    };
+    dispatch(_dispatchArgsKernel, {bind(counts), bind(args)}, &constants, 1);
+    barrier();
+  }
+
+
+  void ComputeContext::bindKernel(
+    const Kernel &kernel,
+    const std::vector<VkDescriptorBufferInfo> &buffers,
+    const void *pushConstants
+  ) {
+    if (buffers.size() != kernel.info.bindingCount) {
+      throw std::runtime_error("wrong number of buffers for kernel: " + kernel.info.fileName);
+    }
+
+    /// DESCRIPTORS
+    if (!buffers.empty()) {
+      VkDescriptorSetAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+      allocInfo.descriptorPool = _descriptorPool;
+      allocInfo.descriptorSetCount = 1;
+      allocInfo.pSetLayouts = &kernel.setLayout;
+      VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+      check(vkAllocateDescriptorSets(_device, &allocInfo, &descriptorSet), "allocate descriptor set (submit more often)");
+
+      std::vector<VkWriteDescriptorSet> writes(buffers.size());
+      for (uint32_t i = 0; i < writes.size(); i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &buffers[i];
+      }
+      vkUpdateDescriptorSets(_device, (uint32_t) writes.size(), writes.data(), 0, nullptr);
+      vkCmdBindDescriptorSets(
+        _commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        kernel.layout,
+        0,
+        1,
+        &descriptorSet,
+        0,
+        nullptr
+      );
+    }
+
+    /// DISPATCH
+    vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.pipeline);
+    if (kernel.info.pushConstantSize > 0) {
+      vkCmdPushConstants(
+        _commandBuffer,
+        kernel.layout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        kernel.info.pushConstantSize,
+        pushConstants
+      );
+    }
+  }
+
+
+  void ComputeContext::barrier() {
+    VkMemoryBarrier2 memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    memoryBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    // indirect dispatch arguments are read in the draw indirect stage
+    memoryBarrier.dstStageMask = memoryBarrier.srcStageMask | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT
+                                  | VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT
+                                  | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+    VkDependencyInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    info.memoryBarrierCount = 1;
+    info.pMemoryBarriers = &memoryBarrier;
+    _submitBatcher.getSynchronization2().pipelineBarrier(_commandBuffer, info);
+  }
+
+
+  void ComputeContext::fill(const AllocatedBuffer &buffer, uint32_t value, VkDeviceSize offset, VkDeviceSize size) {
+    vkCmdFillBuffer(_commandBuffer, buffer.buffer, offset, size, value);
+  }
+
+
+  void ComputeContext::copy(
+    const AllocatedBuffer &src,
+    const AllocatedBuffer &dst,
+    VkDeviceSize size,
+    VkDeviceSize srcOffset,
+    VkDeviceSize dstOffset
+  ) {
+    VkBufferCopy region{srcOffset, dstOffset, size};
+    vkCmdCopyBuffer(_commandBuffer, src.buffer, dst.buffer, 1, &region);
+  }
+
+
+  double ComputeContext::submit() {
+    submitAsync();
+    return wait();
+  }
+
+
+  uint64_t ComputeContext::submitAsync() {
+    if (!_recording) {
+      throw std::runtime_error("compute context: submit() called without begin()");
+    }
+    if (_queryPool != VK_NULL_HANDLE) {
+      vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queryPool, 1);
+    }
+    check(vkEndCommandBuffer(_commandBuffer), "end command buffer");
+    _recording = false;
+
+    _submitBatcher.add(_commandBuffer);
+    if (_timeline != VK_NULL_HANDLE) {
+      _submitBatcher.signal(_timeline, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _submitted + 1);
+    }
+    if (_scheduler != nullptr) {
+      check(_scheduler->submit(_scheduler->select(_priority), _submitBatcher, _fence), "submit");
+    } else {
+      check(_submitBatcher.flush(_queue, _fence), "submit");
+    }
+    _pending = true;
+    return ++_submitted;
+  }
+
+
+  bool ComputeContext::isComplete(uint64_t submission) {
+    if (submission <= _completed) {
+      return true;
+    }
+    if (_getCounterValue != nullptr) {
+      uint64_t value = 0;
+      check(_getCounterValue(_device, _timeline, &value), "get timeline value");
+      _completed = value;
+    } else if (_pending && vkGetFenceStatus(_device, _fence) == VK_SUCCESS) {
+      _completed = _submitted;
+    }
+    return submission <= _completed;
+  }
+
+
+  double ComputeContext::wait() {
+    if (!_pending) {
+      throw std::runtime_error("compute context: wait() called without submitAsync()");
+    }
+    check(vkWaitForFences(_device, 1, &_fence, VK_TRUE, UINT64_MAX), "wait for fence");
+    const auto endTime = std::chrono::steady_clock::now();
+    _pending = false;
+    _completed = _submitted;
+
+    /// RESET
+    vkResetFences(_device, 1, &_fence);
+    vkResetDescriptorPool(_device, _descriptorPool, 0);
+    vkResetCommandPool(_device, _commandPool, 0);
+
+    /// TIMING
+    if (_queryPool != VK_NULL_HANDLE) {
+      uint64_t timestamps[2]{};
+      if (vkGetQueryPoolResults(
+            _device,
+            _queryPool,
+            0,
+            2,
+            sizeof(timestamps),
+            timestamps,
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+          ) == VK_SUCCESS) {
+        const uint64_t ticks = (timestamps[1] - timestamps[0]) & _timestampMask;
+        return (double) ticks * _timestampPeriod / 1e6;
+      }
+    }
+    return std::chrono::duration<double, std::milli>(endTime - _beginTime).count();
+  }
+
+
+  void ComputeContext::waitFor(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stages) {
+    _submitBatcher.wait(semaphore, stages, value);
+  }
+
+} // walrus
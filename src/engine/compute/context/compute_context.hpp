@@ -0,0 +1,361 @@
+#ifndef WALRUS_COMPUTE_ENGINE_COMPUTE_CONTEXT_HPP
+#define WALRUS_COMPUTE_ENGINE_COMPUTE_CONTEXT_HPP
+
+#include "engine/compute/device/device.hpp"
+#include "engine/compute/kernel/kernel.hpp"
+#include "engine/compute/gpu_buffer/gpu_buffer.hpp"
+#include "engine/compute/memory/pools/memory_pools.hpp"
+#include "engine/compute/autotune/autotuner.hpp"
+#include "engine/compute/synchronize/submit/submit_batcher.hpp"
+#include "engine/compute/synchronize/queue/queue_scheduler.hpp"
+#include "engine/rendering/pipelines/cache/pipeline_cache.hpp"
+#include "engine/shaders/cache/shader_module_cache.hpp"
+
+#include <vk_types.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief builds compute kernels and records, submits & times their dispatches on one queue.
+   * usage: begin(), dispatch() / barrier() / copy()..., submit() -- which blocks until the work is done.
+   * or submitAsync(), which returns right away: poll isComplete() and collect the timing with wait().
+   * one submission is in flight at a time, begin() waits for the previous one.
+   * @note kernels & buffers are created & dispatched from one thread (the queue and driver cache are externally synchronized)
+   * @note pipelines & layouts live in the shared PipelineCache. shader modules are released once a kernel is created
+   */
+  class ComputeContext {
+  public:
+    struct CreateInfo {
+      VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+      VkDevice device = VK_NULL_HANDLE;
+      VkQueue queue = VK_NULL_HANDLE;
+      uint32_t queueFamilyIndex = 0;
+      VmaAllocator allocator = nullptr;
+      const DeviceInfo *deviceInfo = nullptr;
+      PipelineCache *pipelineCache = nullptr;
+      ShaderModuleCache *shaderModules = nullptr;
+      /// prefixed to KernelInfo::fileName, i.e. "../../shaders/"
+      std::string shaderDirectory{};
+      /// autotune results file. empty = tune on every run
+      std::string autotuneFilePath{};
+      /// spir-v of kernels generated at runtime (expressions). empty = compiled on every run
+      std::string kernelCacheDirectory{};
+      /// families whose queues use the buffers too, i.e. graphics for async compute. shared without ownership transfers
+      std::vector<uint32_t> concurrentQueueFamilies{};
+      /// if set, each submission goes to the queue it selects for `priority` instead of `queue`. same family
+      QueueScheduler *scheduler = nullptr;
+      QueueScheduler::Priority priority = QueueScheduler::Priority::LOW;
+      /// if set, buffers are sub-allocated from the pool of their memory usage
+      const MemoryPools *pools = nullptr;
+    };
+
+    ComputeContext() = default;
+
+    ~ComputeContext() = default;
+
+    ComputeContext(const ComputeContext &) = delete;
+    ComputeContext &operator=(const ComputeContext &) = delete;
+
+    void init(const CreateInfo &createInfo);
+
+    /// @brief destroys everything the context created. kernels are destroyed with the pipeline cache
+    void destroy();
+
+    [[nodiscard]] bool isInitialized() const { return _device != VK_NULL_HANDLE; }
+
+
+
+
+  /// --------------------------------------------------
+  /// KERNELS
+  /// --------------------------------------------------
+  public:
+    /// @brief build (or get the cached) pipeline for a variant of the kernel. throws if it doesn't fit the device
+    Kernel getKernel(const KernelInfo &info, const KernelVariant &variant);
+
+    Kernel getKernel(const KernelInfo &info) { return getKernel(info, info.defaultVariant()); }
+
+    /**
+     * @brief like getKernel, for spir-v built at runtime (i.e. generated code) instead of loaded from `info.fileName`.
+     * `info.fileName` only names the kernel in errors
+     */
+    Kernel getKernel(const KernelInfo &info, const KernelVariant &variant, const std::vector<uint32_t> &spirv);
+
+    /**
+     * @brief the fastest variant of a kernel on this device.
+     * on first use per device & driver, every candidate variant is benchmarked with `workload` and the winner is saved.
+     * @param kernelKey names the kernel & workload in the results file, i.e. "reduce_f32". no whitespace.
+     * @param workload records one representative run of the kernel. called between begin() and submit()
+     */
+    Kernel getTunedKernel(
+      const KernelInfo &info,
+      const std::string &kernelKey,
+      const std::function<void(const Kernel &)> &workload
+    );
+
+  private:
+    /// @brief the pipeline of a variant of `shaderModule`, from the pipeline cache or newly created
+    Kernel createKernel(const KernelInfo &info, const KernelVariant &variant, const ShaderModuleCache::Module &shaderModule);
+
+    /// @brief a set layout of `bindingCount` compute storage buffers, shared by every kernel with that many bindings
+    VkDescriptorSetLayout getSetLayout(uint32_t bindingCount);
+
+
+
+
+  /// --------------------------------------------------
+  /// BUFFERS
+  /// --------------------------------------------------
+  public:
+    /// any buffer can hold the arguments of an indirect dispatch, so kernels can size their follow-ups
+    static constexpr VkBufferUsageFlags DEFAULT_BUFFER_USAGE = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                               | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                                               | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                                                               | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+    AllocatedBuffer createBuffer(
+      VkDeviceSize size,
+      VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+      VkBufferUsageFlags usage = DEFAULT_BUFFER_USAGE
+    );
+
+    void destroyBuffer(AllocatedBuffer &buffer);
+
+    /// @brief an owning buffer of `count` elements, shared with the concurrent queue families like createBuffer
+    template<class T>
+    GpuBuffer<T> createGpuBuffer(
+      size_t count,
+      VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+      VkBufferUsageFlags usage = DEFAULT_BUFFER_USAGE
+    ) {
+      const VmaPool pool = _pools != nullptr ? _pools->poolFor(memoryUsage, (VkDeviceSize) (count * sizeof(T))) : nullptr;
+      return GpuBuffer<T>(_allocator, count, usage, memoryUsage, _queueFamilies, pool);
+    }
+
+    /// @brief copy host data into a device buffer through a staging buffer. blocks, can't be called while recording
+    void upload(const AllocatedBuffer &dst, const void *data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+    /// @brief copy device buffer data to the host through a staging buffer. blocks, can't be called while recording
+    void download(const AllocatedBuffer &src, void *data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+    /// @brief copy elements into a buffer at element `first`. mapped buffers are written directly, without staging
+    template<class T>
+    void upload(GpuBuffer<T> &dst, const std::vector<T> &values, size_t first = 0) {
+      if (dst.isMapped()) {
+        dst.write(values, first);
+        return;
+      }
+      if (first + values.size() > dst.count()) {
+        throw std::runtime_error("compute context: upload out of bounds");
+      }
+      upload(dst.allocated(), values.data(), values.size() * sizeof(T), first * sizeof(T));
+    }
+
+    /// @brief every element of a buffer. mapped buffers are read directly, without staging
+    template<class T>
+    std::vector<T> download(const GpuBuffer<T> &src) {
+      if (src.isMapped()) {
+        return src.read();
+      }
+      std::vector<T> values(src.count());
+      download(src.allocated(), values.data(), src.sizeBytes());
+      return values;
+    }
+
+    /// @brief a descriptor for (part of) a buffer, as passed to dispatch()
+    static VkDescriptorBufferInfo bind(
+      const AllocatedBuffer &buffer,
+      VkDeviceSize offset = 0,
+      VkDeviceSize range = VK_WHOLE_SIZE
+    );
+
+
+
+
+  /// --------------------------------------------------
+  /// RECORDING
+  /// --------------------------------------------------
+  public:
+    /**
+     * @brief the arguments of dispatchIndirect(), followed by the item count they were sized for.
+     * kernels dispatched with them can bind the same buffer to read the count. matches dispatch_args.comp
+     */
+    struct DispatchArgs {
+      VkDispatchIndirectCommand command;
+      uint32_t count;
+    };
+
+    void begin();
+
+    /**
+     * @param buffers one per kernel binding, in binding order
+     * @param pushConstants `KernelInfo::pushConstantSize` bytes, or nullptr if the kernel has none
+     */
+    void dispatch(
+      const Kernel &kernel,
+      const std::vector<VkDescriptorBufferInfo> &buffers,
+      const void *pushConstants,
+      uint32_t groupCountX,
+      uint32_t groupCountY = 1,
+      uint32_t groupCountZ = 1
+    );
+
+    /**
+     * @brief like dispatch, with the group counts read from `args` on the device when the dispatch runs.
+     * lets a kernel size its follow-up (see recordDispatchArgs) without a round trip through the host.
+     * @param offset of a VkDispatchIndirectCommand (or DispatchArgs) in `args`, a multiple of 4
+     */
+    void dispatchIndirect(
+      const Kernel &kernel,
+      const std::vector<VkDescriptorBufferInfo> &buffers,
+      const void *pushConstants,
+      const AllocatedBuffer &args,
+      VkDeviceSize offset = 0
+    );
+
+    /**
+     * @brief records a dispatch writing DispatchArgs for a count left in a buffer by a previous dispatch,
+     * i.e. the number of values a compaction selected. the groups are capped at maxComputeWorkGroupCount[0],
+     * so the dispatched kernel is expected to grid-stride. followed by a barrier, so `args` can be dispatched next
+     * @param countOffset of the uint32 count in `counts`, a multiple of 4
+     * @param argsOffset of the DispatchArgs in `args`, a multiple of 4
+     * @param itemsPerGroup items handled by one workgroup of the kernel the args are for
+     */
+    void recordDispatchArgs(
+      const AllocatedBuffer &counts,
+      VkDeviceSize countOffset,
+      const AllocatedBuffer &args,
+      VkDeviceSize argsOffset,
+      uint32_t itemsPerGroup
+    );
+
+    /// @brief make every previous shader & transfer write visible to the following commands, indirect dispatches included
+    void barrier();
+
+    void fill(const AllocatedBuffer &buffer, uint32_t value, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    void copy(
+      const AllocatedBuffer &src,
+      const AllocatedBuffer &dst,
+      VkDeviceSize size,
+      VkDeviceSize srcOffset = 0,
+      VkDeviceSize dstOffset = 0
+    );
+
+    /**
+     * @brief submit the recorded commands and wait for them to complete
+     * @return the time the device spent on the commands in ms (measured on the host if timestamps aren't supported)
+     */
+    double submit();
+
+    /**
+     * @brief submit the recorded commands without waiting, i.e. to overlap them with rendering on another queue
+     * @return the submission's value: the timeline semaphore reaches it once the commands are done
+     */
+    uint64_t submitAsync();
+
+    /// @brief whether a submission is done. doesn't block
+    [[nodiscard]] bool isComplete(uint64_t submission);
+
+    /**
+     * @brief wait for the last submitAsync() to complete, and recycle its command buffer & descriptors
+     * @return the time the device spent on the commands in ms, see submit()
+     */
+    double wait();
+
+    /**
+     * @brief the next submission waits for `semaphore` at `stages`, i.e. for the frame that produced its input
+     * @param value of a timeline semaphore, 0 for a binary one
+     */
+    void waitFor(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+    [[nodiscard]] bool isRecording() const { return _recording; }
+
+  private:
+    /// @brief binds the pipeline, a descriptor set for `buffers` & the push constants of the next dispatch
+    void bindKernel(const Kernel &kernel, const std::vector<VkDescriptorBufferInfo> &buffers, const void *pushConstants);
+
+
+
+
+  /// --------------------------------------------------
+  /// ACCESSORS
+  /// --------------------------------------------------
+  public:
+    [[nodiscard]] VkDevice getDevice() const { return _device; }
+
+    [[nodiscard]] const DeviceInfo &getDeviceInfo() const { return *_deviceInfo; }
+
+    [[nodiscard]] const VkPhysicalDeviceLimits &getLimits() const { return _deviceInfo->properties.limits; }
+
+    [[nodiscard]] Autotuner &getAutotuner() { return *_autotuner; }
+
+    [[nodiscard]] const std::string &getKernelCacheDirectory() const { return _kernelCacheDirectory; }
+
+    /// @brief signaled with the value of each submission, for other queues to wait on. null without timeline semaphores
+    [[nodiscard]] VkSemaphore getTimeline() const { return _timeline; }
+
+
+
+
+  /// --------------------------------------------------
+  /// VARIABLES
+  /// --------------------------------------------------
+  private:
+    /// descriptor sets are allocated per dispatch and freed all at once by submit()
+    static constexpr uint32_t MAX_DESCRIPTOR_SETS = 4096;
+    static constexpr uint32_t MAX_STORAGE_BUFFERS = MAX_DESCRIPTOR_SETS * 8;
+
+    VkDevice _device = VK_NULL_HANDLE;
+    VkQueue _queue = VK_NULL_HANDLE;
+    QueueScheduler *_scheduler = nullptr;
+    QueueScheduler::Priority _priority = QueueScheduler::Priority::LOW;
+    VmaAllocator _allocator = nullptr;
+    const MemoryPools *_pools = nullptr;
+    const DeviceInfo *_deviceInfo = nullptr;
+    PipelineCache *_pipelineCache = nullptr;
+    ShaderModuleCache *_shaderModules = nullptr;
+    std::string _shaderDirectory{};
+    std::string _kernelCacheDirectory{};
+    std::unique_ptr<Autotuner> _autotuner{};
+    std::string _deviceKey{};
+
+    VkCommandPool _commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer _commandBuffer = VK_NULL_HANDLE;
+    VkFence _fence = VK_NULL_HANDLE;
+    /// submissions & barriers, with synchronization2 when the device has it
+    SubmitBatcher _submitBatcher{};
+    VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+    std::unordered_map<uint32_t, VkDescriptorSetLayout> _setLayouts{};
+    bool _recording = false;
+    /// buffers are shared between these families when there's more than one
+    std::vector<uint32_t> _queueFamilies{};
+
+    /// SUBMISSIONS
+    VkSemaphore _timeline = VK_NULL_HANDLE; // null if the device has no timeline semaphores
+    PFN_vkGetSemaphoreCounterValue _getCounterValue = nullptr;
+    uint64_t _submitted = 0;
+    uint64_t _completed = 0;
+    /// submitted, not yet waited for
+    bool _pending = false;
+    /// writes DispatchArgs. built on first use
+    Kernel _dispatchArgsKernel{};
+
+    /// TIMING
+    VkQueryPool _queryPool = VK_NULL_HANDLE; // null if the queue can't write timestamps
+    double _timestampPeriod = 1.0; // ns per tick
+    uint64_t _timestampMask = ~0ull;
+    std::chrono::steady_clock::time_point _beginTime{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_COMPUTE_CONTEXT_HPP
@@ -64,6 +64,18 @@ namespace walrus {
     io::printExists(features.alphaToOne, "alphaToOne");
     io::printExists(features.depthBiasClamp, "depthBiasClamp");
     io::printExists(features.depthBounds, "depthBounds");
+    io::printExists(capabilities.graphicsPipelineLibrary, "graphicsPipelineLibrary");
+    io::printExists(capabilities.shaderFloat16, "shaderFloat16");
+    io::printExists(capabilities.storageBuffer16BitAccess, "storageBuffer16BitAccess");
+    io::printExists(capabilities.shaderBufferInt64Atomics, "shaderBufferInt64Atomics");
+    io::printExists(capabilities.synchronization2, "synchronization2");
+    io::printExists(capabilities.timelineSemaphore, "timelineSemaphore");
+    io::printExists(capabilities.bufferDeviceAddress, "bufferDeviceAddress");
+    io::printExists(capabilities.memoryBudget, "memoryBudget");
+    io::printExists(
+      supportsSubgroupOperations(VK_SUBGROUP_FEATURE_ARITHMETIC_BIT),
+      "subgroupArithmetic (size " + std::to_string(subgroups.minSize) + "-" + std::to_string(subgroups.maxSize) + ")"
+    );
     std::cout << io::to_color_string(io::Color::LIGHT_GRAY, "etc...") << std::endl;
     std::cout << std::endl;
   }
@@ -154,6 +166,8 @@ namespace walrus {
   ){
     task = deviceTask;
     getPhysicalDeviceProperties(vkPhysicalDevice);
+    getAvailableExtensions(vkPhysicalDevice);
+    getOptionalCapabilities(vkPhysicalDevice);
     getQueueFamilyProperties(vkPhysicalDevice);
     updateQueueSurfaceSupport(vkPhysicalDevice, (task & GRAPHICS) ? vkSurface : VK_NULL_HANDLE);
     updateDeviceSupportSummary(vkPhysicalDevice, (task & GRAPHICS) ? vkSurface : VK_NULL_HANDLE);
@@ -168,12 +182,16 @@ namespace walrus {
     queueData = deviceInfo.queueData;
     properties = deviceInfo.properties;
     features = deviceInfo.features;
+    capabilities = deviceInfo.capabilities;
+    subgroups = deviceInfo.subgroups;
     task = deviceInfo.task;
     score = deviceInfo.score;
     supportSummary = deviceInfo.supportSummary;
     _bestQueueIndex = deviceInfo._bestQueueIndex;
+    _asyncComputeQueueIndex = deviceInfo._asyncComputeQueueIndex;
     _queueFamilies.clear();
     _queueFamilies = deviceInfo._queueFamilies;
+    _availableExtensions = deviceInfo._availableExtensions;
   }
 
 
@@ -254,6 +272,218 @@ namespace walrus {
 
 
 
+  /// @brief cache the names of all extensions the physical device supports
+  void DeviceInfo::getAvailableExtensions(
+          VkPhysicalDevice &vkPhysicalDevice
+  ){
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(vkPhysicalDevice, nullptr, &extensionCount, extensions.data());
+    _availableExtensions.clear();
+    for (const auto &extension: extensions) {
+      _availableExtensions.emplace_back(extension.extensionName);
+    }
+  }
+
+
+
+  bool DeviceInfo::hasExtension(const char *extensionName) const {
+    for (const auto &extension: _availableExtensions) {
+      if (extension == extensionName) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+
+  /// @brief query extension features through the vkGetPhysicalDeviceFeatures2 pNext chain
+  void DeviceInfo::getOptionalCapabilities(
+          VkPhysicalDevice &vkPhysicalDevice
+  ){
+    capabilities = Capabilities{};
+    subgroups = Subgroups{};
+    if (properties.apiVersion < VK_API_VERSION_1_1) {
+      return; // vkGetPhysicalDeviceFeatures2 is core since 1.1
+    }
+
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = nullptr;
+
+    /// GRAPHICS PIPELINE LIBRARY
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gplFeatures{};
+    gplFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT gplProperties{};
+    gplProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+    const bool gplExtensions = hasExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)
+                               && hasExtension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    if (gplExtensions) {
+      gplFeatures.pNext = features2.pNext;
+      features2.pNext = &gplFeatures;
+    }
+
+    /// 16 BIT TYPES
+    // core since 1.1
+    VkPhysicalDevice16BitStorageFeatures storage16Features{};
+    storage16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+    storage16Features.pNext = features2.pNext;
+    features2.pNext = &storage16Features;
+
+    // core since 1.2
+    VkPhysicalDeviceShaderFloat16Int8Features float16Features{};
+    float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+    const bool float16 = properties.apiVersion >= VK_API_VERSION_1_2
+                         || hasExtension(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME);
+    if (float16) {
+      float16Features.pNext = features2.pNext;
+      features2.pNext = &float16Features;
+    }
+
+    /// 64 BIT ATOMICS
+    // core since 1.2
+    VkPhysicalDeviceShaderAtomicInt64Features atomicInt64Features{};
+    atomicInt64Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_INT64_FEATURES;
+    const bool atomicInt64 = properties.apiVersion >= VK_API_VERSION_1_2
+                             || hasExtension(VK_KHR_SHADER_ATOMIC_INT64_EXTENSION_NAME);
+    if (atomicInt64) {
+      atomicInt64Features.pNext = features2.pNext;
+      features2.pNext = &atomicInt64Features;
+    }
+
+    /// SYNCHRONIZATION 2
+    // core since 1.3
+    VkPhysicalDeviceSynchronization2Features synchronization2Features{};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    const bool synchronization2 = properties.apiVersion >= VK_API_VERSION_1_3
+                                  || hasExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    if (synchronization2) {
+      synchronization2Features.pNext = features2.pNext;
+      features2.pNext = &synchronization2Features;
+    }
+
+    /// TIMELINE SEMAPHORES
+    // core since 1.2
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    const bool timeline = properties.apiVersion >= VK_API_VERSION_1_2
+                          || hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    if (timeline) {
+      timelineFeatures.pNext = features2.pNext;
+      features2.pNext = &timelineFeatures;
+    }
+
+    /// BUFFER DEVICE ADDRESS
+    // core since 1.2
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferAddressFeatures{};
+    bufferAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+    const bool bufferAddress = properties.apiVersion >= VK_API_VERSION_1_2
+                               || hasExtension(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+    if (bufferAddress) {
+      bufferAddressFeatures.pNext = features2.pNext;
+      features2.pNext = &bufferAddressFeatures;
+    }
+
+    vkGetPhysicalDeviceFeatures2(vkPhysicalDevice, &features2);
+    capabilities.storageBuffer16BitAccess = storage16Features.storageBuffer16BitAccess;
+    capabilities.shaderFloat16 = float16 && float16Features.shaderFloat16;
+    capabilities.shaderBufferInt64Atomics = atomicInt64 && features2.features.shaderInt64
+                                            && atomicInt64Features.shaderBufferInt64Atomics;
+    capabilities.synchronization2 = synchronization2 && synchronization2Features.synchronization2;
+    capabilities.timelineSemaphore = timeline && timelineFeatures.timelineSemaphore;
+    capabilities.bufferDeviceAddress = bufferAddress && bufferAddressFeatures.bufferDeviceAddress;
+    // no features, only vkGetPhysicalDeviceMemoryProperties2 data, queried by VMA
+    capabilities.memoryBudget = hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    /// PROPERTIES
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = nullptr;
+
+    // core since 1.1
+    VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+    subgroupProperties.pNext = properties2.pNext;
+    properties2.pNext = &subgroupProperties;
+
+    // core since 1.3
+    VkPhysicalDeviceSubgroupSizeControlPropertiesEXT sizeControlProperties{};
+    sizeControlProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES_EXT;
+    const bool sizeControl = properties.apiVersion >= VK_API_VERSION_1_3
+                             || hasExtension(VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME);
+    if (sizeControl) {
+      sizeControlProperties.pNext = properties2.pNext;
+      properties2.pNext = &sizeControlProperties;
+    }
+
+    if (gplExtensions) {
+      gplProperties.pNext = properties2.pNext;
+      properties2.pNext = &gplProperties;
+    }
+
+    vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties2);
+
+    if (gplExtensions) {
+      capabilities.graphicsPipelineLibrary = gplFeatures.graphicsPipelineLibrary;
+      capabilities.graphicsPipelineLibraryFastLinking = gplProperties.graphicsPipelineLibraryFastLinking;
+    }
+
+    subgroups.size = subgroupProperties.subgroupSize;
+    subgroups.supportedStages = subgroupProperties.supportedStages;
+    subgroups.supportedOperations = subgroupProperties.supportedOperations;
+    subgroups.minSize = subgroupProperties.subgroupSize;
+    subgroups.maxSize = subgroupProperties.subgroupSize;
+    if (sizeControl) {
+      subgroups.sizeControl = true;
+      subgroups.minSize = sizeControlProperties.minSubgroupSize;
+      subgroups.maxSize = sizeControlProperties.maxSubgroupSize;
+      subgroups.maxComputeWorkgroupSubgroups = sizeControlProperties.maxComputeWorkgroupSubgroups;
+      subgroups.requiredSizeStages = sizeControlProperties.requiredSubgroupSizeStages;
+    }
+  }
+
+
+
+  bool DeviceInfo::supportsSubgroupOperations(
+          VkSubgroupFeatureFlags operations,
+          VkShaderStageFlags stages
+  ) const {
+    return (subgroups.supportedOperations & operations) == operations
+           && (subgroups.supportedStages & stages) == stages;
+  }
+
+
+  std::vector<const char *> DeviceInfo::getOptionalExtensions() const {
+    std::vector<const char *> extensions{};
+    if (capabilities.graphicsPipelineLibrary && (task & GRAPHICS)) {
+      extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+      extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+    if (capabilities.shaderFloat16 && (task & COMPUTE) && properties.apiVersion < VK_API_VERSION_1_2) {
+      extensions.push_back(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME);
+    }
+    if (capabilities.shaderBufferInt64Atomics && (task & COMPUTE) && properties.apiVersion < VK_API_VERSION_1_2) {
+      extensions.push_back(VK_KHR_SHADER_ATOMIC_INT64_EXTENSION_NAME);
+    }
+    if (capabilities.synchronization2 && properties.apiVersion < VK_API_VERSION_1_3) {
+      extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
+    if (capabilities.timelineSemaphore && properties.apiVersion < VK_API_VERSION_1_2) {
+      extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
+    if (capabilities.bufferDeviceAddress && properties.apiVersion < VK_API_VERSION_1_2) {
+      extensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+    }
+    if (capabilities.memoryBudget) {
+      extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    return extensions;
+  }
+
+
+
   /// @brief list queue families and get QueueFamilyData from each
   void DeviceInfo::getQueueFamilyProperties(
           VkPhysicalDevice &vkPhysicalDevice
@@ -383,16 +613,31 @@ namespace walrus {
         }
         i++;
       }
+
+      /// ASYNC COMPUTE
+      // a compute family without graphics usually maps to separate hardware queues, so its work overlaps the frames
+      _asyncComputeQueueIndex = -1;
+      if (task == ALL && _bestQueueIndex >= 0) {
+        for (int family = 0; family < (int) queueData.size(); family++) {
+          const auto &queue = queueData[family];
+          if (family != _bestQueueIndex && queue.support.compute && !queue.support.graphics && queue.queueCount > 0) {
+            _asyncComputeQueueIndex = family;
+            break;
+          }
+        }
+      }
     }
 
 
 
-  /// @brief create a logical device and queues for the (single) queue family with the highest suitability score
+  /// @brief create a logical device and queues for the queue family with the highest suitability score,
+  /// and the async compute family if there is one
   void DeviceInfo::createLogicalDevice(
           DeviceInfo &deviceInfo,
           VkPhysicalDevice &vkPhysicalDevice,
           VkDevice *device,
-          std::vector<VkQueue> &queues
+          std::vector<VkQueue> &queues,
+          std::vector<VkQueue> *asyncComputeQueues
   ){
     if (deviceInfo._bestQueueIndex == -1) {
       throw std::runtime_error(
@@ -411,28 +656,115 @@ namespace walrus {
     auto bestQueueFamily = deviceInfo.queueData[deviceInfo._bestQueueIndex];
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
-    std::vector<float> queuePriorities(bestQueueFamily.queueCount, 1.0f);
+    std::vector<float> queuePriorities(bestQueueFamily.queueCount);
+    for (uint32_t i = 0; i < bestQueueFamily.queueCount; i++) {
+      queuePriorities[i] = queuePriority(i);
+    }
     VkDeviceQueueCreateInfo queueCreateInfo = {};
     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
     queueCreateInfo.queueFamilyIndex = bestQueueFamily.queueFamilyIndex;
     queueCreateInfo.queueCount = bestQueueFamily.queueCount;
     queueCreateInfo.pQueuePriorities = queuePriorities.data();
     queueCreateInfos.push_back(queueCreateInfo);
+
+    // a single queue, async compute overlaps one background submission with the frames
+    const float asyncComputePriority = LOW_QUEUE_PRIORITY;
+    const bool asyncCompute = asyncComputeQueues != nullptr && deviceInfo._asyncComputeQueueIndex >= 0;
+    if (asyncCompute) {
+      VkDeviceQueueCreateInfo computeQueueCreateInfo = {};
+      computeQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+      computeQueueCreateInfo.queueFamilyIndex =
+        deviceInfo.queueData[deviceInfo._asyncComputeQueueIndex].queueFamilyIndex;
+      computeQueueCreateInfo.queueCount = 1;
+      computeQueueCreateInfo.pQueuePriorities = &asyncComputePriority;
+      queueCreateInfos.push_back(computeQueueCreateInfo);
+    }
     std::cout << io::to_color_string(
             io::Color::LIGHT_PURPLE,
             "queueCreateInfos.size() = " + std::to_string(queueCreateInfos.size())
     ) << std::endl;
 
+    /// FEATURES
+    // core features go in features2.features, extension features are chained through pNext
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = nullptr;
     // if samplerAnisotropy is supported, enable it
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = deviceInfo.features.samplerAnisotropy;
-    const auto extensions = DeviceInfo::getExtensions(deviceInfo.task);
+    features2.features.samplerAnisotropy = deviceInfo.features.samplerAnisotropy;
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gplFeatures{};
+    gplFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    if (deviceInfo.capabilities.graphicsPipelineLibrary && (deviceInfo.task & GRAPHICS)) {
+      gplFeatures.graphicsPipelineLibrary = VK_TRUE;
+      gplFeatures.pNext = features2.pNext;
+      features2.pNext = &gplFeatures;
+    }
+
+    // 16 bit types, for the fp16 variants of compute kernels
+    VkPhysicalDevice16BitStorageFeatures storage16Features{};
+    storage16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+    if (deviceInfo.capabilities.storageBuffer16BitAccess && (deviceInfo.task & COMPUTE)) {
+      storage16Features.storageBuffer16BitAccess = VK_TRUE;
+      storage16Features.pNext = features2.pNext;
+      features2.pNext = &storage16Features;
+    }
+    VkPhysicalDeviceShaderFloat16Int8Features float16Features{};
+    float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+    if (deviceInfo.capabilities.shaderFloat16 && (deviceInfo.task & COMPUTE)) {
+      float16Features.shaderFloat16 = VK_TRUE;
+      float16Features.pNext = features2.pNext;
+      features2.pNext = &float16Features;
+    }
+
+    // 64 bit keys of the hash table
+    VkPhysicalDeviceShaderAtomicInt64Features atomicInt64Features{};
+    atomicInt64Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_INT64_FEATURES;
+    if (deviceInfo.capabilities.shaderBufferInt64Atomics && (deviceInfo.task & COMPUTE)) {
+      features2.features.shaderInt64 = VK_TRUE;
+      atomicInt64Features.shaderBufferInt64Atomics = VK_TRUE;
+      atomicInt64Features.pNext = features2.pNext;
+      features2.pNext = &atomicInt64Features;
+    }
+
+    // barriers & submissions, for every task
+    VkPhysicalDeviceSynchronization2Features synchronization2Features{};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    if (deviceInfo.capabilities.synchronization2) {
+      synchronization2Features.synchronization2 = VK_TRUE;
+      synchronization2Features.pNext = features2.pNext;
+      features2.pNext = &synchronization2Features;
+    }
+
+    // cross queue dependencies of async compute, for every task
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    if (deviceInfo.capabilities.timelineSemaphore) {
+      timelineFeatures.timelineSemaphore = VK_TRUE;
+      timelineFeatures.pNext = features2.pNext;
+      features2.pNext = &timelineFeatures;
+    }
+
+    // buffers allocated with device addresses (VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT), for every task
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferAddressFeatures{};
+    bufferAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+    if (deviceInfo.capabilities.bufferDeviceAddress) {
+      bufferAddressFeatures.bufferDeviceAddress = VK_TRUE;
+      bufferAddressFeatures.pNext = features2.pNext;
+      features2.pNext = &bufferAddressFeatures;
+    }
+
+    /// EXTENSIONS
+    auto extensions = DeviceInfo::getExtensions(deviceInfo.task);
+    for (auto extension: deviceInfo.getOptionalExtensions()) {
+      extensions.push_back(extension);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &features2;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = nullptr; // enabled through features2
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -458,6 +790,15 @@ namespace walrus {
         );
       }
     }
+    if (asyncCompute) {
+      asyncComputeQueues->push_back(VK_NULL_HANDLE);
+      vkGetDeviceQueue(
+              *device,
+              deviceInfo.queueData[deviceInfo._asyncComputeQueueIndex].queueFamilyIndex,
+              0,
+              &asyncComputeQueues->back()
+      );
+    }
   }
 
 
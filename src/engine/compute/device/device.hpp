@@ -2,6 +2,7 @@
 #define WALRUS_COMPUTE_DEVICE_HPP
 
 #include <vector>
+#include <string>
 #include "vk_types.h"
 
 namespace walrus {
@@ -11,6 +12,7 @@ namespace walrus {
    * task
    * constructors
    * queue family support
+   * optional capabilities
    * static functions
    * instance functions
    * variables
@@ -114,6 +116,73 @@ namespace walrus {
 
 
 
+  /// --------------------------------------------------
+  /// OPTIONAL CAPABILITIES
+  /// --------------------------------------------------
+  public:
+    /**
+     * @brief optional extensions & features that the engine uses when available.
+     * detected per physical device, and enabled by createLogicalDevice when supported.
+     */
+    struct Capabilities {
+        /// VK_EXT_graphics_pipeline_library (+ VK_KHR_pipeline_library)
+        bool graphicsPipelineLibrary = false;
+        /// linking libraries without link time optimization is fast enough to do at draw time
+        bool graphicsPipelineLibraryFastLinking = false;
+        /// 16 bit float arithmetic in shaders. VK_KHR_shader_float16_int8 (core in 1.2)
+        bool shaderFloat16 = false;
+        /// 16 bit types in storage buffers. VK_KHR_16bit_storage (core in 1.1)
+        bool storageBuffer16BitAccess = false;
+        /// 64 bit integers, and atomics on them in storage buffers. shaderInt64 + VK_KHR_shader_atomic_int64 (core in 1.2)
+        bool shaderBufferInt64Atomics = false;
+        /// vkCmdPipelineBarrier2 & vkQueueSubmit2. VK_KHR_synchronization2 (core in 1.3)
+        bool synchronization2 = false;
+        /// semaphores with a 64 bit counter, waited on & signaled by value. VK_KHR_timeline_semaphore (core in 1.2)
+        bool timelineSemaphore = false;
+        /// 64 bit gpu addresses of buffers, and allocations that can hold them. VK_KHR_buffer_device_address (core in 1.2)
+        bool bufferDeviceAddress = false;
+        /// the heap budgets & usage of this process, as the driver sees them. VK_EXT_memory_budget
+        bool memoryBudget = false;
+    };
+
+    /**
+     * @brief subgroup (warp / wavefront) properties, used to pick subgroup variants of kernels.
+     * left at the defaults (no subgroup operations) on vulkan 1.0 devices.
+     */
+    struct Subgroups {
+        /// the default subgroup size
+        uint32_t size = 1;
+        VkShaderStageFlags supportedStages = 0;
+        VkSubgroupFeatureFlags supportedOperations = 0;
+        /// VK_EXT_subgroup_size_control (core in 1.3). otherwise min & max are the default size
+        bool sizeControl = false;
+        uint32_t minSize = 1;
+        uint32_t maxSize = 1;
+        uint32_t maxComputeWorkgroupSubgroups = 0;
+        VkShaderStageFlags requiredSizeStages = 0;
+    };
+
+    /// @brief true if the physical device reported the extension
+    [[nodiscard]] bool hasExtension(const char *extensionName) const;
+
+    /// @brief true if every operation in `operations` is supported in every stage of `stages`
+    [[nodiscard]] bool supportsSubgroupOperations(
+            VkSubgroupFeatureFlags operations,
+            VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT
+    ) const;
+
+    /// @brief optional extensions to enable on the logical device, based on `capabilities`
+    [[nodiscard]] std::vector<const char *> getOptionalExtensions() const;
+
+  private:
+    void getAvailableExtensions(VkPhysicalDevice &vkPhysicalDevice);
+
+    void getOptionalCapabilities(VkPhysicalDevice &vkPhysicalDevice);
+
+
+
+
+
   /// --------------------------------------------------
   /// STATIC FUNCTIONS
   /// --------------------------------------------------
@@ -140,11 +209,23 @@ namespace walrus {
 
     int getBestQueueIndex() { return _bestQueueIndex; }
 
+    /// queue 0 of the best family gets the high priority (rendering & latency sensitive jobs), the others low (batch work)
+    static constexpr float HIGH_QUEUE_PRIORITY = 1.0f;
+    static constexpr float LOW_QUEUE_PRIORITY = 0.5f;
+
+    static float queuePriority(uint32_t queueIndex) {
+      return queueIndex == 0 ? HIGH_QUEUE_PRIORITY : LOW_QUEUE_PRIORITY;
+    }
+
+    /// @brief a compute family without graphics, besides the best one. -1 if there is none, or the task isn't ALL
+    [[nodiscard]] int getAsyncComputeQueueIndex() const { return _asyncComputeQueueIndex; }
+
     static void createLogicalDevice(
             DeviceInfo &deviceInfo,
             VkPhysicalDevice &vkPhysicalDevice,
             VkDevice *device,
-            std::vector<VkQueue> &queues
+            std::vector<VkQueue> &queues,
+            std::vector<VkQueue> *asyncComputeQueues = nullptr
     );
 
   private:
@@ -169,13 +250,17 @@ namespace walrus {
   /// --------------------------------------------------
   private:
     int _bestQueueIndex = -1;
+    int _asyncComputeQueueIndex = -1;
     std::vector<VkQueueFamilyProperties> _queueFamilies{};
+    std::vector<std::string> _availableExtensions{};
 
   public:
     /// @brief a vector of support features for each queue in the device
     std::vector<QueueFamilyData> queueData{};
     VkPhysicalDeviceProperties properties{};
     VkPhysicalDeviceFeatures features{};
+    Capabilities capabilities{};
+    Subgroups subgroups{};
 
     /**
      * @brief sets the default required tasks for the device. \n\n
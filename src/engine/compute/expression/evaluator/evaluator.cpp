@@ -0,0 +1,387 @@
+#include "evaluator.hpp"
+
+#include "engine/shaders/compiler/shader_compiler.hpp"
+#include "engine/utils/hash/hash.hpp"
+#include "engine/utils/mapped_file/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace walrus::expression {
+
+  namespace {
+    /// matches the block written by generateGlsl
+    struct PushConstants {
+      /// indirect kernels: the index of the count in the dispatch args, in words
+      uint32_t count;
+      float constants[Evaluator::MAX_CONSTANTS];
+    };
+
+    enum SpecConstantId : uint32_t {
+      WORKGROUP_SIZE = 0,
+    };
+
+    std::string hexString(uint64_t value) {
+      std::ostringstream out{};
+      out << std::hex << value;
+      return out.str();
+    }
+
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+    /// magic, version, generator, bound & schema words
+    constexpr size_t SPIRV_HEADER_WORDS = 5;
+
+    std::string readText(const std::filesystem::path &path) {
+      std::ifstream file(path, std::ios::binary);
+      return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    /// @brief written to a temporary file & renamed, so readers never see a partial file
+    void writeText(const std::filesystem::path &path, const std::string &text) {
+      const std::string temporary = ShaderCompiler::temporaryPath(path.string());
+      {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file << text;
+        if (!file) {
+          throw std::runtime_error("failed to write " + temporary);
+        }
+      }
+      std::error_code error{};
+      std::filesystem::rename(temporary, path, error);
+      if (error) {
+        std::filesystem::remove(temporary, error);
+        throw std::runtime_error("failed to write " + path.string());
+      }
+    }
+
+    /// @brief the words of a spir-v file. empty if missing, or not spir-v
+    std::vector<uint32_t> readSpirv(const std::filesystem::path &path) {
+      const MappedFile file(path.string());
+      if (!file.isOpen() || file.size() < SPIRV_HEADER_WORDS * sizeof(uint32_t) || file.size() % sizeof(uint32_t) != 0) {
+        return {};
+      }
+      std::vector<uint32_t> spirv(file.size() / sizeof(uint32_t));
+      memcpy(spirv.data(), file.data(), file.size());
+      if (spirv.front() != SPIRV_MAGIC) {
+        return {};
+      }
+      return spirv;
+    }
+
+    std::string checksum(const std::vector<uint32_t> &spirv) {
+      return hexString(hash::fnv1a(spirv.data(), spirv.size() * sizeof(uint32_t)));
+    }
+
+    /// @brief the glsl of one instruction's value, from the values before it
+    std::string valueOf(Op op, const std::string &a, const std::string &b) {
+      switch (op) {
+        case Op::NEGATE:
+          return "-" + a;
+        case Op::ABS:
+          return "abs(" + a + ")";
+        case Op::SQRT:
+          return "sqrt(" + a + ")";
+        case Op::EXP:
+          return "exp(" + a + ")";
+        case Op::LOG:
+          return "log(" + a + ")";
+        case Op::TANH:
+          return "tanh(" + a + ")";
+        case Op::SIGMOID:
+          return "1.0 / (1.0 + exp(-" + a + "))";
+        case Op::RELU:
+          return "max(" + a + ", 0.0)";
+        case Op::ADD:
+          return a + " + " + b;
+        case Op::SUBTRACT:
+          return a + " - " + b;
+        case Op::MULTIPLY:
+          return a + " * " + b;
+        case Op::DIVIDE:
+          return a + " / " + b;
+        case Op::MIN:
+          return "min(" + a + ", " + b + ")";
+        case Op::MAX:
+          return "max(" + a + ", " + b + ")";
+        case Op::POW:
+          return "pow(" + a + ", " + b + ")";
+        default:
+          throw std::runtime_error(std::string("not an expression operation: ") + toString(op));
+      }
+    }
+  }
+
+
+  void Evaluator::init(ComputeContext &context) {
+    _context = &context;
+  }
+
+
+  void Evaluator::record(const Expression &expression, const AllocatedBuffer &output, uint32_t count) {
+    record(lower(expression), output, count);
+  }
+
+
+  void Evaluator::record(const Program &program, const AllocatedBuffer &output, uint32_t count) {
+    const VkDeviceSize size = (VkDeviceSize) count * sizeof(float);
+    if (output.size < size) {
+      throw std::runtime_error("expression output buffer is too small");
+    }
+    for (const auto &input: program.inputs) {
+      if (input.size < size) {
+        throw std::runtime_error("expression input buffer is too small");
+      }
+    }
+    if (count == 0) {
+      return;
+    }
+
+    const Kernel &kernel = getKernel(program);
+    std::vector<VkDescriptorBufferInfo> buffers{};
+    for (const auto &input: program.inputs) {
+      buffers.push_back(ComputeContext::bind(input, 0, size));
+    }
+    buffers.push_back(ComputeContext::bind(output, 0, size));
+
+    PushConstants constants{};
+    constants.count = count;
+    std::copy(program.constants.begin(), program.constants.end(), constants.constants);
+    const uint32_t groups = std::min(kernel.groupCount(count), _context->getLimits().maxComputeWorkGroupCount[0]);
+    _context->dispatch(kernel, buffers, &constants, groups);
+  }
+
+
+  void Evaluator::recordIndirect(
+    const Expression &expression,
+    const AllocatedBuffer &output,
+    const AllocatedBuffer &args,
+    VkDeviceSize argsOffset
+  ) {
+    if (argsOffset % sizeof(uint32_t) != 0 || argsOffset + sizeof(ComputeContext::DispatchArgs) > args.size) {
+      throw std::runtime_error("expression dispatch args out of bounds");
+    }
+    const Program program = lower(expression, true);
+    const Kernel &kernel = getKernel(program);
+    std::vector<VkDescriptorBufferInfo> buffers{};
+    for (const auto &input: program.inputs) {
+      buffers.push_back(ComputeContext::bind(input));
+    }
+    buffers.push_back(ComputeContext::bind(output));
+    buffers.push_back(ComputeContext::bind(args));
+
+    PushConstants constants{};
+    constants.count = (uint32_t) ((argsOffset + offsetof(ComputeContext::DispatchArgs, count)) / sizeof(uint32_t));
+    std::copy(program.constants.begin(), program.constants.end(), constants.constants);
+    _context->dispatchIndirect(kernel, buffers, &constants, args, argsOffset);
+  }
+
+
+  double Evaluator::evaluate(const Expression &expression, const AllocatedBuffer &output, uint32_t count) {
+    // compile before recording, so the time is the dispatch alone
+    const Program program = lower(expression);
+    getKernel(program);
+    _context->begin();
+    record(program, output, count);
+    return _context->submit();
+  }
+
+
+  std::string Evaluator::generateGlsl(const Expression &expression) {
+    return generateGlsl(lower(expression));
+  }
+
+
+  Evaluator::Program Evaluator::lower(const Expression &expression, bool indirect) {
+    Program program{};
+    program.indirect = indirect;
+    std::unordered_map<const Node *, uint32_t> values{};
+    // an input read through several nodes is loaded once
+    std::unordered_map<VkBuffer, uint32_t> loads{};
+
+    const auto visit = [&](const auto &self, const Node &node) -> uint32_t {
+      if (const auto found = values.find(&node); found != values.end()) {
+        return found->second;
+      }
+      Instruction instruction{};
+      instruction.op = node.op;
+      if (node.op == Op::INPUT) {
+        if (const auto load = loads.find(node.buffer.buffer); load != loads.end()) {
+          return values[&node] = load->second;
+        }
+        if (program.inputs.size() == MAX_INPUTS) {
+          throw std::runtime_error("expression reads more than " + std::to_string(MAX_INPUTS) + " buffers");
+        }
+        instruction.slot = (uint32_t) program.inputs.size();
+        program.inputs.push_back(node.buffer);
+      } else if (node.op == Op::CONSTANT) {
+        if (program.constants.size() == MAX_CONSTANTS) {
+          throw std::runtime_error("expression has more than " + std::to_string(MAX_CONSTANTS) + " constants");
+        }
+        instruction.slot = (uint32_t) program.constants.size();
+        program.constants.push_back(node.value);
+      }
+      for (size_t i = 0; i < node.operands.size(); i++) {
+        instruction.operands[i] = self(self, *node.operands[i]);
+      }
+
+      const auto index = (uint32_t) program.instructions.size();
+      program.instructions.push_back(instruction);
+      if (node.op == Op::INPUT) {
+        loads[node.buffer.buffer] = index;
+      }
+      return values[&node] = index;
+    };
+    visit(visit, expression.node());
+
+    // the buffers & constant values are left out, they don't change the shader
+    hash::Hasher hasher{};
+    hasher.add(program.indirect).add(program.instructions.size());
+    for (const auto &instruction: program.instructions) {
+      hasher.add(instruction.op).add(instruction.operands[0]).add(instruction.operands[1]).add(instruction.slot);
+    }
+    program.hash = hasher.value;
+    return program;
+  }
+
+
+  std::string Evaluator::generateGlsl(const Program &program) {
+    std::ostringstream glsl{};
+    glsl << "#version 450\n\n"
+         << "// generated by walrus::expression::Evaluator\n\n"
+         << "layout(local_size_x_id = " << WORKGROUP_SIZE << ") in;\n\n";
+    for (size_t i = 0; i < program.inputs.size(); i++) {
+      glsl << "layout(set = 0, binding = " << i << ") readonly buffer Input" << i << " { float values[]; } input" << i
+           << ";\n";
+    }
+    glsl << "layout(set = 0, binding = " << program.inputs.size() << ") writeonly buffer Result { float values[]; } result;\n";
+    if (program.indirect) {
+      glsl << "layout(set = 0, binding = " << program.inputs.size() + 1 << ") readonly buffer Args { uint values[]; } args;\n";
+    }
+    glsl << "\n"
+         << "layout(push_constant) uniform PushConstants {\n"
+         << "  uint count;\n"
+         << "  float constants[" << MAX_CONSTANTS << "];\n"
+         << "} pushConstants;\n\n"
+         << "void main() {\n"
+         << (program.indirect ? "  const uint count = args.values[pushConstants.count];\n" : "  const uint count = pushConstants.count;\n")
+         << "  const uint stride = gl_NumWorkGroups.x * gl_WorkGroupSize.x;\n"
+         << "  for (uint i = gl_GlobalInvocationID.x; i < count; i += stride) {\n";
+
+    for (size_t i = 0; i < program.instructions.size(); i++) {
+      const Instruction &instruction = program.instructions[i];
+      glsl << "    float v" << i << " = ";
+      if (instruction.op == Op::INPUT) {
+        glsl << "input" << instruction.slot << ".values[i]";
+      } else if (instruction.op == Op::CONSTANT) {
+        glsl << "pushConstants.constants[" << instruction.slot << "]";
+      } else {
+        glsl << valueOf(
+          instruction.op,
+          "v" + std::to_string(instruction.operands[0]),
+          "v" + std::to_string(instruction.operands[1])
+        );
+      }
+      glsl << ";\n";
+    }
+
+    glsl << "    result.values[i] = v" << program.instructions.size() - 1 << ";\n"
+         << "  }\n"
+         << "}\n";
+    return glsl.str();
+  }
+
+
+  std::vector<uint32_t> Evaluator::compile(const Program &program) const {
+    const std::string glsl = generateGlsl(program);
+    // keyed by the whole source, so a different shader never shares the files
+    const std::string name = "expression_" + hexString(hash::fnv1a(glsl.data(), glsl.size()));
+    if (!_context->getKernelCacheDirectory().empty()) {
+      return compileCached(_context->getKernelCacheDirectory(), name, glsl);
+    }
+
+    /// NO CACHE
+    // a directory of its own, removed once compiled
+    std::error_code error{};
+    std::filesystem::path directory{};
+    do {
+      directory = ShaderCompiler::temporaryPath((std::filesystem::temp_directory_path(error) / "walrus_expressions").string());
+    } while (!std::filesystem::create_directory(directory, error) && !error);
+    if (error) {
+      throw std::runtime_error("failed to create a directory for expression shaders: " + error.message());
+    }
+    std::vector<uint32_t> spirv{};
+    try {
+      spirv = compileCached(directory, name, glsl);
+    } catch (...) {
+      std::filesystem::remove_all(directory, error);
+      throw;
+    }
+    std::filesystem::remove_all(directory, error);
+    return spirv;
+  }
+
+
+  std::vector<uint32_t> Evaluator::compileCached(
+    const std::filesystem::path &directory,
+    const std::string &name,
+    const std::string &glsl
+  ) {
+    const std::filesystem::path glslPath = directory / (name + ".comp");
+    const std::filesystem::path spirvPath = directory / (name + ".comp.spv");
+    const std::filesystem::path checksumPath = directory / (name + ".comp.spv.fnv1a");
+
+    /// CACHED
+    // the source is compared too, in case of a hash collision. a stale or truncated spir-v fails the checksum
+    if (readText(glslPath) == glsl) {
+      std::vector<uint32_t> spirv = readSpirv(spirvPath);
+      if (!spirv.empty() && readText(checksumPath) == checksum(spirv)) {
+        return spirv;
+      }
+    }
+
+    /// COMPILE
+    // every file is replaced atomically: engines compiling the same shader at once write identical files
+    std::error_code error{};
+    std::filesystem::create_directories(directory, error);
+    writeText(glslPath, glsl);
+    if (!ShaderCompiler::compile(glslPath.string(), spirvPath.string())) {
+      throw std::runtime_error("failed to compile expression shader: " + glslPath.string());
+    }
+    std::vector<uint32_t> spirv = readSpirv(spirvPath);
+    if (spirv.empty()) {
+      throw std::runtime_error("failed to read expression shader: " + spirvPath.string());
+    }
+    writeText(checksumPath, checksum(spirv));
+    return spirv;
+  }
+
+
+  const Kernel &Evaluator::getKernel(const Program &program) {
+    const auto [first, last] = _kernels.equal_range(program.hash);
+    for (auto it = first; it != last; it++) {
+      if (it->second.indirect == program.indirect && it->second.instructions == program.instructions) {
+        return it->second.kernel;
+      }
+    }
+
+    KernelInfo info{};
+    info.fileName = "expression_" + hexString(program.hash) + ".comp.spv";
+    info.bindingCount = (uint32_t) program.inputs.size() + (program.indirect ? 2 : 1);
+    info.pushConstantSize = sizeof(PushConstants);
+    info.specConstants = {
+      {WORKGROUP_SIZE, "WORKGROUP_SIZE", GROUP_SIZE, {}},
+    };
+    info.workgroupSize = {"WORKGROUP_SIZE", nullptr, nullptr};
+
+    CompiledKernel compiled{program.instructions, program.indirect, {}};
+    compiled.kernel = _context->getKernel(info, info.defaultVariant(), compile(program));
+    return _kernels.emplace(program.hash, std::move(compiled))->second.kernel;
+  }
+
+} // walrus::expression
@@ -0,0 +1,121 @@
+#ifndef WALRUS_COMPUTE_ENGINE_EVALUATOR_HPP
+#define WALRUS_COMPUTE_ENGINE_EVALUATOR_HPP
+
+#include "engine/compute/context/compute_context.hpp"
+#include "engine/compute/expression/expression.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace walrus::expression {
+
+  /**
+   * @brief evaluates expressions with one fused kernel: every node becomes a line of a generated compute shader,
+   * so each element is read from the inputs once, computed in registers, and written once.
+   * the glsl is compiled at runtime with the glslangValidator of the build (see ShaderCompiler).
+   * kernels are cached by the structure of the expression -- constants are push constants and inputs are bindings,
+   * so `x * 2.f` and `y * 3.f` share a kernel. the spir-v is also kept in the context's kernel cache directory,
+   * keyed by the glsl and checked against a checksum, so later runs skip the compiler.
+   * @note the output may be one of the inputs: element i is only written after every input has been read at i
+   */
+  class Evaluator {
+  public:
+    /// distinct input buffers of an expression. the output (and indirect dispatch args) are bound after them
+    static constexpr uint32_t MAX_INPUTS = 7;
+    /// constants of an expression, passed as push constants
+    static constexpr uint32_t MAX_CONSTANTS = 24;
+    /// invocations per workgroup. the kernels grid-stride, so indirect dispatches can be sized for any multiple of it
+    static constexpr uint32_t GROUP_SIZE = 256;
+
+    void init(ComputeContext &context);
+
+    /**
+     * @brief records the fused dispatch between ComputeContext::begin() and submit(). compiles it on first use.
+     * @param output at least `count` floats
+     */
+    void record(const Expression &expression, const AllocatedBuffer &output, uint32_t count);
+
+    /**
+     * @brief like record, for a count only known on the device (i.e. the values selected by a compaction):
+     * dispatched with the ComputeContext::DispatchArgs at `argsOffset` of `args`, see ComputeContext::recordDispatchArgs.
+     * the kernel reads the count from the args, so the host never waits for it
+     * @note the buffers are bound whole, and must hold the count the args end up with
+     */
+    void recordIndirect(
+      const Expression &expression,
+      const AllocatedBuffer &output,
+      const AllocatedBuffer &args,
+      VkDeviceSize argsOffset = 0
+    );
+
+    /// @brief evaluate into `output` and wait for it. returns the time spent on the device in ms
+    double evaluate(const Expression &expression, const AllocatedBuffer &output, uint32_t count);
+
+    /// @brief the compute shader `expression` is evaluated with
+    static std::string generateGlsl(const Expression &expression);
+
+    /// @brief distinct expression structures compiled so far
+    [[nodiscard]] size_t kernelCount() const { return _kernels.size(); }
+
+  private:
+    /// @brief one SSA value of the generated shader
+    struct Instruction {
+      Op op = Op::CONSTANT;
+      /// previous instructions, by index
+      std::array<uint32_t, 2> operands{};
+      /// INPUT: binding, CONSTANT: push constant slot
+      uint32_t slot = 0;
+
+      bool operator==(const Instruction &other) const {
+        return op == other.op && operands == other.operands && slot == other.slot;
+      }
+    };
+
+    /// @brief an expression flattened in dependency order, shared nodes once
+    struct Program {
+      std::vector<Instruction> instructions{};
+      std::vector<AllocatedBuffer> inputs{};
+      std::vector<float> constants{};
+      /// the count is read from indirect dispatch args, bound after the output
+      bool indirect = false;
+      /// of the instructions only: same structure = same kernel
+      uint64_t hash = 0;
+    };
+
+    /// @brief a kernel & the structure it was generated from, compared on hash hits
+    struct CompiledKernel {
+      std::vector<Instruction> instructions{};
+      bool indirect = false;
+      Kernel kernel{};
+    };
+
+    static Program lower(const Expression &expression, bool indirect = false);
+
+    void record(const Program &program, const AllocatedBuffer &output, uint32_t count);
+
+    static std::string generateGlsl(const Program &program);
+
+    /// @brief compiles the program, or reuses the spir-v of a previous run
+    std::vector<uint32_t> compile(const Program &program) const;
+
+    /// @brief compiles `glsl` in `directory` as `name`, reusing the spir-v if its source & checksum match
+    static std::vector<uint32_t> compileCached(
+      const std::filesystem::path &directory,
+      const std::string &name,
+      const std::string &glsl
+    );
+
+    const Kernel &getKernel(const Program &program);
+
+    ComputeContext *_context = nullptr;
+    /// by Program::hash. nodes keep the kernels in place
+    std::unordered_multimap<uint64_t, CompiledKernel> _kernels{};
+  };
+
+} // walrus::expression
+
+#endif //WALRUS_COMPUTE_ENGINE_EVALUATOR_HPP
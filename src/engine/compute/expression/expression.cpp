@@ -0,0 +1,217 @@
+#include "expression.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace walrus::expression {
+
+  const char *toString(Op op) {
+    switch (op) {
+      case Op::INPUT:
+        return "input";
+      case Op::CONSTANT:
+        return "constant";
+      case Op::NEGATE:
+        return "-";
+      case Op::ABS:
+        return "abs";
+      case Op::SQRT:
+        return "sqrt";
+      case Op::EXP:
+        return "exp";
+      case Op::LOG:
+        return "log";
+      case Op::TANH:
+        return "tanh";
+      case Op::SIGMOID:
+        return "sigmoid";
+      case Op::RELU:
+        return "relu";
+      case Op::ADD:
+        return "+";
+      case Op::SUBTRACT:
+        return "-";
+      case Op::MULTIPLY:
+        return "*";
+      case Op::DIVIDE:
+        return "/";
+      case Op::MIN:
+        return "min";
+      case Op::MAX:
+        return "max";
+      case Op::POW:
+        return "pow";
+    }
+    return "unknown";
+  }
+
+
+  uint32_t operandCount(Op op) {
+    if (op == Op::INPUT || op == Op::CONSTANT) {
+      return 0;
+    }
+    return op >= Op::ADD ? 2 : 1;
+  }
+
+
+  Expression::Expression(float value) {
+    auto node = std::make_shared<Node>();
+    node->op = Op::CONSTANT;
+    node->value = value;
+    _node = std::move(node);
+  }
+
+
+  Expression::Expression(std::shared_ptr<const Node> node) : _node(std::move(node)) {}
+
+
+  Expression Expression::input(const AllocatedBuffer &buffer) {
+    if (buffer.buffer == VK_NULL_HANDLE) {
+      throw std::runtime_error("expression input buffer is null");
+    }
+    auto node = std::make_shared<Node>();
+    node->op = Op::INPUT;
+    node->buffer = buffer;
+    return Expression(std::move(node));
+  }
+
+
+  Expression Expression::apply(Op op, const Expression &operand) {
+    if (operandCount(op) != 1) {
+      throw std::runtime_error(std::string("not a unary expression op: ") + expression::toString(op));
+    }
+    auto node = std::make_shared<Node>();
+    node->op = op;
+    node->operands = {operand._node};
+    return Expression(std::move(node));
+  }
+
+
+  Expression Expression::apply(Op op, const Expression &left, const Expression &right) {
+    if (operandCount(op) != 2) {
+      throw std::runtime_error(std::string("not a binary expression op: ") + expression::toString(op));
+    }
+    auto node = std::make_shared<Node>();
+    node->op = op;
+    node->operands = {left._node, right._node};
+    return Expression(std::move(node));
+  }
+
+
+  std::string Expression::toString() const {
+    // inputs are numbered by first use, like the bindings of the evaluated kernel
+    std::unordered_map<VkBuffer, size_t> inputs{};
+    const auto print = [&](const auto &self, const Node &node) -> std::string {
+      std::ostringstream out{};
+      switch (operandCount(node.op)) {
+        case 0:
+          if (node.op == Op::CONSTANT) {
+            out << node.value;
+          } else {
+            out << "input" << inputs.try_emplace(node.buffer.buffer, inputs.size()).first->second;
+          }
+          break;
+        case 1:
+          out << expression::toString(node.op) << "(" << self(self, *node.operands[0]) << ")";
+          break;
+        default:
+          if (node.op >= Op::MIN) {
+            out << expression::toString(node.op) << "(" << self(self, *node.operands[0]) << ", "
+                << self(self, *node.operands[1]) << ")";
+          } else {
+            out << "(" << self(self, *node.operands[0]) << " " << expression::toString(node.op) << " "
+                << self(self, *node.operands[1]) << ")";
+          }
+          break;
+      }
+      return out.str();
+    };
+    return print(print, *_node);
+  }
+
+
+  /// OPERATORS
+
+  Expression operator-(const Expression &operand) {
+    return Expression::apply(Op::NEGATE, operand);
+  }
+
+
+  Expression operator+(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::ADD, left, right);
+  }
+
+
+  Expression operator-(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::SUBTRACT, left, right);
+  }
+
+
+  Expression operator*(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::MULTIPLY, left, right);
+  }
+
+
+  Expression operator/(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::DIVIDE, left, right);
+  }
+
+
+  /// FUNCTIONS
+
+  Expression abs(const Expression &operand) {
+    return Expression::apply(Op::ABS, operand);
+  }
+
+
+  Expression sqrt(const Expression &operand) {
+    return Expression::apply(Op::SQRT, operand);
+  }
+
+
+  Expression exp(const Expression &operand) {
+    return Expression::apply(Op::EXP, operand);
+  }
+
+
+  Expression log(const Expression &operand) {
+    return Expression::apply(Op::LOG, operand);
+  }
+
+
+  Expression tanh(const Expression &operand) {
+    return Expression::apply(Op::TANH, operand);
+  }
+
+
+  Expression sigmoid(const Expression &operand) {
+    return Expression::apply(Op::SIGMOID, operand);
+  }
+
+
+  Expression relu(const Expression &operand) {
+    return Expression::apply(Op::RELU, operand);
+  }
+
+
+  Expression min(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::MIN, left, right);
+  }
+
+
+  Expression max(const Expression &left, const Expression &right) {
+    return Expression::apply(Op::MAX, left, right);
+  }
+
+
+  Expression pow(const Expression &base, const Expression &exponent) {
+    return Expression::apply(Op::POW, base, exponent);
+  }
+
+
+  Expression clamp(const Expression &operand, const Expression &low, const Expression &high) {
+    return min(max(operand, low), high);
+  }
+
+} // walrus::expression
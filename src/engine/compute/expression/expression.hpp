@@ -0,0 +1,116 @@
+#ifndef WALRUS_COMPUTE_ENGINE_EXPRESSION_HPP
+#define WALRUS_COMPUTE_ENGINE_EXPRESSION_HPP
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace walrus::expression {
+
+  enum class Op : uint32_t {
+    /// leaves
+    INPUT,
+    CONSTANT,
+    /// unary
+    NEGATE,
+    ABS,
+    SQRT,
+    EXP,
+    LOG,
+    TANH,
+    SIGMOID,
+    RELU,
+    /// binary
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MIN,
+    MAX,
+    POW,
+  };
+
+  const char *toString(Op op);
+
+  /// @brief operands of the op: 0 for leaves, 1 for unary & 2 for binary ops
+  uint32_t operandCount(Op op);
+
+  struct Node {
+    Op op = Op::CONSTANT;
+    std::vector<std::shared_ptr<const Node>> operands{};
+    /// INPUT: a device buffer of 32 bit floats
+    AllocatedBuffer buffer{};
+    /// CONSTANT
+    float value = 0.f;
+  };
+
+  /**
+   * @brief a lazy elementwise expression over device buffers of floats: building `a * x + b` records a graph of nodes
+   * instead of dispatching anything. expressions are evaluated into a buffer by an Evaluator, in a single kernel.
+   * nodes are immutable and shared, so subexpressions can be reused (`auto t = x + 1.f; t * t`) and are computed once.
+   */
+  class Expression {
+  public:
+    /// @brief a constant. implicit, so floats mix with expressions: `x * 2.f`
+    Expression(float value); // NOLINT(google-explicit-constructor)
+
+    /// @brief element i of `buffer`, which holds at least as many floats as the evaluated count
+    static Expression input(const AllocatedBuffer &buffer);
+
+    static Expression apply(Op op, const Expression &operand);
+
+    static Expression apply(Op op, const Expression &left, const Expression &right);
+
+    [[nodiscard]] const Node &node() const { return *_node; }
+
+    [[nodiscard]] const std::shared_ptr<const Node> &shared() const { return _node; }
+
+    /// @brief i.e. "max((input0 * 2), 0)", for debugging
+    [[nodiscard]] std::string toString() const;
+
+  private:
+    explicit Expression(std::shared_ptr<const Node> node);
+
+    std::shared_ptr<const Node> _node{};
+  };
+
+  /// OPERATORS
+  Expression operator-(const Expression &operand);
+
+  Expression operator+(const Expression &left, const Expression &right);
+
+  Expression operator-(const Expression &left, const Expression &right);
+
+  Expression operator*(const Expression &left, const Expression &right);
+
+  Expression operator/(const Expression &left, const Expression &right);
+
+  /// FUNCTIONS
+  Expression abs(const Expression &operand);
+
+  Expression sqrt(const Expression &operand);
+
+  Expression exp(const Expression &operand);
+
+  Expression log(const Expression &operand);
+
+  Expression tanh(const Expression &operand);
+
+  Expression sigmoid(const Expression &operand);
+
+  Expression relu(const Expression &operand);
+
+  Expression min(const Expression &left, const Expression &right);
+
+  Expression max(const Expression &left, const Expression &right);
+
+  Expression pow(const Expression &base, const Expression &exponent);
+
+  Expression clamp(const Expression &operand, const Expression &low, const Expression &high);
+
+} // walrus::expression
+
+#endif //WALRUS_COMPUTE_ENGINE_EXPRESSION_HPP
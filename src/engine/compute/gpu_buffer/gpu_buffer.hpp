@@ -0,0 +1,217 @@
+#ifndef WALRUS_COMPUTE_ENGINE_GPU_BUFFER_HPP
+#define WALRUS_COMPUTE_ENGINE_GPU_BUFFER_HPP
+
+#include <vk_types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace walrus {
+
+  /// @brief a range of mapped elements. std::span without c++20
+  template<class T>
+  struct MappedSpan {
+    T *ptr = nullptr;
+    size_t count = 0;
+
+    [[nodiscard]] T *data() const { return ptr; }
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    T *begin() const { return ptr; }
+
+    T *end() const { return ptr + count; }
+
+    T &operator[](size_t i) const { return ptr[i]; }
+  };
+
+
+
+
+  /**
+   * @brief a buffer of `count` elements of T that owns its allocation. move-only, destroyed with the object.
+   * host visible buffers (every memory usage but GPU_ONLY) stay mapped for their whole life: write() / read() / span()
+   * go straight to the memory. device local buffers are filled through ComputeContext::upload.
+   * allocated() is the AllocatedBuffer view the kernels & recording functions take.
+   * @note the allocator must outlive the buffer. reset() it before the allocator is destroyed
+   */
+  template<class T>
+  class GpuBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "gpu buffers hold trivially copyable elements");
+
+  public:
+    GpuBuffer() = default;
+
+    /**
+     * @param queueFamilies families sharing the buffer without ownership transfers. exclusive if fewer than 2
+     * @param pool sub-allocate from this pool (see MemoryPools), or from the default pools if it fails
+     * @param flags extra allocation flags, i.e. VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
+     * @throws std::runtime_error if the allocation fails
+     */
+    GpuBuffer(
+      VmaAllocator allocator,
+      size_t count,
+      VkBufferUsageFlags usage,
+      VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+      const std::vector<uint32_t> &queueFamilies = {},
+      VmaPool pool = nullptr,
+      VmaAllocationCreateFlags flags = 0
+    ) : _allocator(allocator), _count(count), _usage(usage), _memoryUsage(memoryUsage) {
+      VkBufferCreateInfo bufferInfo{};
+      bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      bufferInfo.size = sizeBytes();
+      bufferInfo.usage = usage;
+      if (queueFamilies.size() > 1) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = (uint32_t) queueFamilies.size();
+        bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+      }
+
+      VmaAllocationCreateInfo allocInfo{};
+      allocInfo.usage = memoryUsage;
+      allocInfo.flags = flags;
+      if (memoryUsage != VMA_MEMORY_USAGE_GPU_ONLY) {
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+      }
+      allocInfo.pool = pool;
+      VmaAllocationInfo info{};
+      VkResult result = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &_buffer.buffer, &_buffer.allocation, &info);
+      if (result != VK_SUCCESS && pool != nullptr) {
+        allocInfo.pool = nullptr;
+        result = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &_buffer.buffer, &_buffer.allocation, &info);
+      }
+      if (result != VK_SUCCESS) {
+        _allocator = nullptr;
+        throw std::runtime_error("gpu buffer: failed to create a buffer of " + std::to_string(sizeBytes()) + " bytes");
+      }
+      _buffer.size = sizeBytes();
+      _mapped = static_cast<T *>(info.pMappedData);
+    }
+
+    ~GpuBuffer() { reset(); }
+
+    GpuBuffer(const GpuBuffer &) = delete;
+    GpuBuffer &operator=(const GpuBuffer &) = delete;
+
+    GpuBuffer(GpuBuffer &&other) noexcept { *this = std::move(other); }
+
+    GpuBuffer &operator=(GpuBuffer &&other) noexcept {
+      if (this != &other) {
+        reset();
+        _allocator = other._allocator;
+        _buffer = other._buffer;
+        _mapped = other._mapped;
+        _count = other._count;
+        _usage = other._usage;
+        _memoryUsage = other._memoryUsage;
+        other._allocator = nullptr;
+        other._buffer = AllocatedBuffer{};
+        other._mapped = nullptr;
+        other._count = 0;
+      }
+      return *this;
+    }
+
+    /// @brief destroys the buffer now. the device must be done with it, see release()
+    void reset() {
+      if (_buffer.buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(_allocator, _buffer.buffer, _buffer.allocation);
+      }
+      _buffer = AllocatedBuffer{};
+      _mapped = nullptr;
+      _count = 0;
+    }
+
+    /// @brief gives up ownership, i.e. to a DeletionQueue while the device may still use the buffer
+    [[nodiscard]] AllocatedBuffer release() {
+      AllocatedBuffer buffer = _buffer;
+      _buffer = AllocatedBuffer{};
+      _mapped = nullptr;
+      _count = 0;
+      return buffer;
+    }
+
+
+
+
+  /// --------------------------------------------------
+  /// HOST ACCESS
+  /// --------------------------------------------------
+  public:
+    [[nodiscard]] bool isMapped() const { return _mapped != nullptr; }
+
+    /// @brief the mapped elements. empty for device local buffers
+    [[nodiscard]] MappedSpan<T> span() const { return MappedSpan<T>{_mapped, _mapped != nullptr ? _count : 0}; }
+
+    /// @brief copy `count` elements into the mapped memory at `first`, and flush them for the device
+    void write(const T *values, size_t count, size_t first = 0) {
+      checkRange("write", count, first);
+      memcpy(_mapped + first, values, count * sizeof(T));
+      vmaFlushAllocation(_allocator, _buffer.allocation, first * sizeof(T), count * sizeof(T));
+    }
+
+    void write(const std::vector<T> &values, size_t first = 0) { write(values.data(), values.size(), first); }
+
+    /// @brief copy `count` elements at `first` out of the mapped memory, after the device's writes are made visible
+    void read(T *values, size_t count, size_t first = 0) const {
+      checkRange("read", count, first);
+      vmaInvalidateAllocation(_allocator, _buffer.allocation, first * sizeof(T), count * sizeof(T));
+      memcpy(values, _mapped + first, count * sizeof(T));
+    }
+
+    [[nodiscard]] std::vector<T> read() const {
+      std::vector<T> values(_count);
+      read(values.data(), values.size());
+      return values;
+    }
+
+
+
+
+  /// --------------------------------------------------
+  /// ACCESSORS
+  /// --------------------------------------------------
+  public:
+    [[nodiscard]] const AllocatedBuffer &allocated() const { return _buffer; }
+
+    [[nodiscard]] VkBuffer buffer() const { return _buffer.buffer; }
+
+    [[nodiscard]] size_t count() const { return _count; }
+
+    [[nodiscard]] VkDeviceSize sizeBytes() const { return (VkDeviceSize) _count * sizeof(T); }
+
+    [[nodiscard]] VkBufferUsageFlags usage() const { return _usage; }
+
+    [[nodiscard]] VmaMemoryUsage memoryUsage() const { return _memoryUsage; }
+
+    [[nodiscard]] bool isValid() const { return _buffer.buffer != VK_NULL_HANDLE; }
+
+  private:
+    void checkRange(const char *what, size_t count, size_t first) const {
+      if (_mapped == nullptr) {
+        throw std::runtime_error(std::string("gpu buffer: can't ") + what + " a buffer that isn't host visible");
+      }
+      if (first + count > _count) {
+        throw std::runtime_error(std::string("gpu buffer: ") + what + " out of bounds");
+      }
+    }
+
+    VmaAllocator _allocator = nullptr;
+    AllocatedBuffer _buffer{};
+    T *_mapped = nullptr;
+    size_t _count = 0;
+    VkBufferUsageFlags _usage = 0;
+    VmaMemoryUsage _memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_GPU_BUFFER_HPP
@@ -0,0 +1,92 @@
+#include "kernel.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace walrus {
+
+  KernelVariant KernelInfo::defaultVariant() const {
+    KernelVariant variant{};
+    variant.reserve(specConstants.size());
+    for (auto &constant: specConstants) {
+      variant.push_back(constant.defaultValue);
+    }
+    return variant;
+  }
+
+
+  bool KernelInfo::fits(const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) const {
+    if (variant.size() != specConstants.size()) {
+      return false;
+    }
+    const auto size = localSize(variant);
+    uint64_t invocations = 1;
+    for (uint32_t i = 0; i < 3; i++) {
+      if (size[i] == 0 || size[i] > limits.maxComputeWorkGroupSize[i]) {
+        return false;
+      }
+      invocations *= size[i];
+    }
+    if (invocations > limits.maxComputeWorkGroupInvocations) {
+      return false;
+    }
+    return !isSupported || isSupported(variant, limits);
+  }
+
+
+  std::vector<KernelVariant> KernelInfo::candidateVariants(const VkPhysicalDeviceLimits &limits) const {
+    // cartesian product of the candidates. constants without candidates keep their default
+    std::vector<KernelVariant> variants{{}};
+    for (auto &constant: specConstants) {
+      std::vector<KernelVariant> next{};
+      for (auto &variant: variants) {
+        if (constant.candidates.empty()) {
+          next.push_back(variant);
+          next.back().push_back(constant.defaultValue);
+          continue;
+        }
+        for (uint32_t candidate: constant.candidates) {
+          next.push_back(variant);
+          next.back().push_back(candidate);
+        }
+      }
+      variants = std::move(next);
+    }
+
+    std::vector<KernelVariant> supported{};
+    for (auto &variant: variants) {
+      if (fits(variant, limits)) {
+        supported.push_back(std::move(variant));
+      }
+    }
+    return supported;
+  }
+
+
+  uint32_t KernelInfo::value(const KernelVariant &variant, const char *name) const {
+    for (size_t i = 0; i < specConstants.size() && i < variant.size(); i++) {
+      if (strcmp(specConstants[i].name, name) == 0) {
+        return variant[i];
+      }
+    }
+    throw std::runtime_error(fileName + " has no specialization constant " + name);
+  }
+
+
+  std::array<uint32_t, 3> KernelInfo::localSize(const KernelVariant &variant) const {
+    std::array<uint32_t, 3> size{1, 1, 1};
+    for (uint32_t i = 0; i < 3; i++) {
+      if (workgroupSize[i] != nullptr) {
+        size[i] = value(variant, workgroupSize[i]);
+      }
+    }
+    return size;
+  }
+
+
+  uint32_t Kernel::groupCount(uint64_t count, uint32_t itemsPerInvocation) const {
+    const uint64_t perGroup = (uint64_t) localSize[0] * itemsPerInvocation;
+    return (uint32_t) ((count + perGroup - 1) / perGroup);
+  }
+
+} // walrus
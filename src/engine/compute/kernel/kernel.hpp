@@ -0,0 +1,79 @@
+#ifndef WALRUS_COMPUTE_ENGINE_KERNEL_HPP
+#define WALRUS_COMPUTE_ENGINE_KERNEL_HPP
+
+#include <vk_types.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace walrus {
+
+  /// @brief one value per specialization constant of a kernel, in `KernelInfo::specConstants` order
+  using KernelVariant = std::vector<uint32_t>;
+
+  /// @brief a 32 bit specialization constant, and the values the autotuner may pick from
+  struct SpecConstant {
+    /// `constant_id` (or `local_size_x_id`...) in the shader
+    uint32_t id = 0;
+    const char *name = "";
+    uint32_t defaultValue = 0;
+    /// values benchmarked by the autotuner. empty = always `defaultValue`
+    std::vector<uint32_t> candidates{};
+  };
+
+  /**
+   * @brief describes a compute shader and its interface.
+   * @note bindings are `bindingCount` storage buffers in set 0, bound in order.
+   * @note workgroup & tile sizes should be specialization constants, i.e. `layout(local_size_x_id = 0) in;`,
+   *       so that they can be tuned per device instead of hard coded.
+   */
+  struct KernelInfo {
+    /// spir-v file name inside the shader directory, i.e. "reduce.comp.spv"
+    std::string fileName{};
+    const char *entryPoint = "main";
+    uint32_t bindingCount = 0;
+    uint32_t pushConstantSize = 0;
+    std::vector<SpecConstant> specConstants{};
+    /// names of the constants used as local_size_x/y/z. nullptr = 1
+    std::array<const char *, 3> workgroupSize{nullptr, nullptr, nullptr};
+    /// @brief optional extra limit check, i.e. shared memory that grows with a tile size
+    std::function<bool(const KernelVariant &, const VkPhysicalDeviceLimits &)> isSupported{};
+
+    [[nodiscard]] KernelVariant defaultVariant() const;
+
+    /// @brief true if the variant has a value per constant and fits the device limits
+    [[nodiscard]] bool fits(const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) const;
+
+    /// @brief every combination of candidate values that fits the device limits
+    [[nodiscard]] std::vector<KernelVariant> candidateVariants(const VkPhysicalDeviceLimits &limits) const;
+
+    /// @brief the value of a named constant in `variant`. throws if the kernel has no such constant
+    [[nodiscard]] uint32_t value(const KernelVariant &variant, const char *name) const;
+
+    [[nodiscard]] std::array<uint32_t, 3> localSize(const KernelVariant &variant) const;
+  };
+
+  /**
+   * @brief a compiled variant of a kernel, ready to dispatch.
+   * @note the pipeline & layouts are owned by the caches they came from, don't destroy them.
+   */
+  struct Kernel {
+    KernelInfo info{};
+    KernelVariant variant{};
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    std::array<uint32_t, 3> localSize{1, 1, 1};
+
+    [[nodiscard]] uint32_t value(const char *name) const { return info.value(variant, name); }
+
+    /// @brief workgroups in x needed for `count` items, when each invocation handles `itemsPerInvocation`
+    [[nodiscard]] uint32_t groupCount(uint64_t count, uint32_t itemsPerInvocation = 1) const;
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_KERNEL_HPP
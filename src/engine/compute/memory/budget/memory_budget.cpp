@@ -0,0 +1,173 @@
+#include "memory_budget.hpp"
+#include "pretty_io.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <tuple>
+
+namespace walrus {
+
+  void MemoryBudget::init(VmaAllocator allocator, const DeviceInfo &deviceInfo, uint32_t framesInFlight) {
+    _allocator = allocator;
+    _framesInFlight = std::max(framesInFlight, 1u);
+    _frame = 0;
+    _reported = deviceInfo.capabilities.memoryBudget;
+    vmaGetMemoryProperties(allocator, &_memoryProperties);
+    _heaps.assign(_memoryProperties->memoryHeapCount, HeapBudget{});
+    for (uint32_t i = 0; i < _memoryProperties->memoryHeapCount; i++) {
+      _heaps[i].size = _memoryProperties->memoryHeaps[i].size;
+      _heaps[i].deviceLocal = (_memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+    _assets.clear();
+    _stats = Stats{};
+    refresh();
+  }
+
+
+  void MemoryBudget::destroy() {
+    _assets.clear();
+    for (HeapBudget &heap: _heaps) {
+      heap.streamedBytes = 0;
+    }
+  }
+
+
+  void MemoryBudget::update(uint64_t frameNumber) {
+    _frame = frameNumber;
+    // VMA fetches the driver's budget here, not on every vmaGetBudget
+    vmaSetCurrentFrameIndex(_allocator, (uint32_t) frameNumber);
+    refresh();
+    for (uint32_t i = 0; i < _heaps.size(); i++) {
+      const HeapBudget &heap = _heaps[i];
+      if ((double) heap.usage > (double) heap.budget * EVICT_ABOVE) {
+        evict(i, (VkDeviceSize) ((double) heap.budget * EVICT_TO));
+      }
+    }
+  }
+
+
+  StreamedAssetHandle MemoryBudget::track(VmaAllocation allocation, EvictCallback evict, uint32_t priority) {
+    VmaAllocationInfo info{};
+    vmaGetAllocationInfo(_allocator, allocation, &info);
+    Asset asset{};
+    asset.size = info.size;
+    asset.heapIndex = _memoryProperties->memoryTypes[info.memoryType].heapIndex;
+    asset.priority = priority;
+    asset.lastUsed = _frame;
+    asset.evict = std::move(evict);
+    _heaps[asset.heapIndex].streamedBytes += asset.size;
+    return _assets.insert(asset);
+  }
+
+
+  void MemoryBudget::touch(StreamedAssetHandle handle) {
+    Asset *asset = _assets.get(handle);
+    if (asset != nullptr) {
+      asset->lastUsed = _frame;
+    }
+  }
+
+
+  void MemoryBudget::untrack(StreamedAssetHandle handle) {
+    Asset asset{};
+    if (_assets.remove(handle, &asset)) {
+      _heaps[asset.heapIndex].streamedBytes -= asset.size;
+    }
+  }
+
+
+  bool MemoryBudget::makeRoom(VmaMemoryUsage memoryUsage, VkDeviceSize bytes) {
+    const uint32_t heapIndex = heapIndexOf(memoryUsage);
+    refresh();
+    const HeapBudget &heap = _heaps[heapIndex];
+    const auto limit = (VkDeviceSize) ((double) heap.budget * EVICT_ABOVE);
+    if (heap.usage + bytes > limit) {
+      evict(heapIndex, limit > bytes ? limit - bytes : 0);
+    }
+    if (heap.usage + bytes > heap.budget) {
+      _stats.deniedRooms++;
+      return false;
+    }
+    return true;
+  }
+
+
+  uint32_t MemoryBudget::heapIndexOf(VmaMemoryUsage memoryUsage) const {
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = memoryUsage;
+    uint32_t memoryTypeIndex = 0;
+    if (vmaFindMemoryTypeIndex(_allocator, UINT32_MAX, &allocInfo, &memoryTypeIndex) != VK_SUCCESS) {
+      return 0;
+    }
+    return _memoryProperties->memoryTypes[memoryTypeIndex].heapIndex;
+  }
+
+
+  void MemoryBudget::refresh() {
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS]{};
+    vmaGetBudget(_allocator, budgets);
+    for (uint32_t i = 0; i < _heaps.size(); i++) {
+      _heaps[i].budget = budgets[i].budget;
+      _heaps[i].usage = budgets[i].usage;
+      _heaps[i].blockBytes = budgets[i].blockBytes;
+      _heaps[i].allocationBytes = budgets[i].allocationBytes;
+    }
+  }
+
+
+  void MemoryBudget::evict(uint32_t heapIndex, VkDeviceSize target) {
+    HeapBudget &heap = _heaps[heapIndex];
+
+    /// CANDIDATES
+    // idle assets of the heap, the first to go first
+    std::vector<StreamedAssetHandle> candidates{};
+    const auto &assets = _assets.values();
+    for (size_t i = 0; i < assets.size(); i++) {
+      if (assets[i].heapIndex == heapIndex && assets[i].lastUsed + _framesInFlight <= _frame) {
+        candidates.push_back(_assets.handleAt(i));
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](StreamedAssetHandle a, StreamedAssetHandle b) {
+      const Asset &assetA = *_assets.get(a);
+      const Asset &assetB = *_assets.get(b);
+      return std::tie(assetA.priority, assetA.lastUsed) < std::tie(assetB.priority, assetB.lastUsed);
+    });
+
+    /// EVICT
+    for (StreamedAssetHandle handle: candidates) {
+      if (heap.usage <= target) {
+        break;
+      }
+      Asset asset{};
+      if (!_assets.remove(handle, &asset)) {
+        continue; // untracked by an earlier callback
+      }
+      heap.streamedBytes -= asset.size;
+      // exact for dedicated memory (see track). a sub-allocation is only returned with the whole block
+      heap.usage -= std::min(heap.usage, asset.size);
+      _stats.evictions++;
+      _stats.evictedBytes += asset.size;
+      if (asset.evict) {
+        asset.evict();
+      }
+    }
+  }
+
+
+  void MemoryBudget::print() {
+    refresh();
+    std::cout << io::to_color_string(io::LIGHT_GRAY, "memory budget")
+              << (_reported ? " (VK_EXT_memory_budget)" : " (estimated)") << ": " << _stats.evictions
+              << " evictions, " << _stats.evictedBytes / (1024 * 1024) << " MiB evicted" << std::endl;
+    for (uint32_t i = 0; i < _heaps.size(); i++) {
+      const HeapBudget &heap = _heaps[i];
+      std::cout << io::to_color_string(io::LIGHT_GRAY, "heap " + std::to_string(i))
+                << (heap.deviceLocal ? " (device local): " : " (host):         ")
+                << heap.usage / (1024 * 1024) << " / " << heap.budget / (1024 * 1024) << " MiB ("
+                << heap.pressure() * 100.0 << "%), streamed " << heap.streamedBytes / (1024 * 1024) << " MiB"
+                << std::endl;
+    }
+  }
+
+} // walrus
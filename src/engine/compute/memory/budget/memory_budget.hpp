@@ -0,0 +1,131 @@
+#ifndef WALRUS_COMPUTE_ENGINE_MEMORY_BUDGET_HPP
+#define WALRUS_COMPUTE_ENGINE_MEMORY_BUDGET_HPP
+
+#include "engine/compute/device/device.hpp"
+#include "engine/utils/handle_registry/handle_registry.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace walrus {
+
+  struct StreamedAssetTag;
+  using StreamedAssetHandle = Handle<StreamedAssetTag>;
+
+  /**
+   * @brief per heap usage against the budget the driver grants this process, and eviction of streamed assets
+   * before a heap runs out. budgets come from VK_EXT_memory_budget when DeviceInfo reports it, VMA estimates them
+   * from the heap sizes otherwise.
+   * streamed assets -- textures, cached meshes, anything that can be loaded again -- are tracked with a callback
+   * that frees them. update() evicts from heaps above EVICT_ABOVE of their budget down to EVICT_TO,
+   * lowest priority then least recently used first. makeRoom() does the same ahead of a streamed allocation,
+   * so it fits in the budget instead of failing with VK_ERROR_OUT_OF_DEVICE_MEMORY.
+   * assets touched in the last `framesInFlight` frames are never evicted.
+   * @note not thread safe
+   */
+  class MemoryBudget {
+  public:
+    static constexpr double EVICT_ABOVE = 0.90;
+    static constexpr double EVICT_TO = 0.80;
+
+    struct HeapBudget {
+      bool deviceLocal = false;
+      VkDeviceSize size = 0;
+      /// what this process can use, i.e. less than `size` when other processes hold memory of the heap
+      VkDeviceSize budget = 0;
+      /// what this process uses: VMA's blocks, the swapchain & other implicit objects
+      VkDeviceSize usage = 0;
+      /// VkDeviceMemory allocated by VMA, and the part of it holding allocations
+      VkDeviceSize blockBytes = 0;
+      VkDeviceSize allocationBytes = 0;
+      /// held by tracked assets
+      VkDeviceSize streamedBytes = 0;
+
+      /// @brief usage / budget. above 1 the driver may page the heap out, or fail allocations
+      [[nodiscard]] double pressure() const { return budget > 0 ? (double) usage / (double) budget : 0.0; }
+    };
+
+    struct Stats {
+      uint64_t evictions = 0;
+      VkDeviceSize evictedBytes = 0;
+      /// makeRoom() calls that found no room, even after evicting
+      uint64_t deniedRooms = 0;
+    };
+
+    /// @brief frees the asset's memory, i.e. retires its buffer to a DeletionQueue. the asset is untracked already
+    using EvictCallback = std::function<void()>;
+
+    void init(VmaAllocator allocator, const DeviceInfo &deviceInfo, uint32_t framesInFlight);
+
+    /// @brief forgets every asset, without evicting them. their owners free them
+    void destroy();
+
+    /// @brief once per frame: refreshes the budgets and evicts from the heaps above EVICT_ABOVE
+    void update(uint64_t frameNumber);
+
+    /**
+     * @param allocation the asset's memory. its heap & size are taken from it. give assets dedicated memory
+     *        (VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT): a sub-allocation is only returned with its whole block or pool
+     * @param priority lower is evicted first
+     */
+    StreamedAssetHandle track(VmaAllocation allocation, EvictCallback evict, uint32_t priority = 0);
+
+    /// @brief the asset is used in the current frame. stale handles are ignored
+    void touch(StreamedAssetHandle handle);
+
+    /// @brief stops tracking an asset its owner freed. stale handles are ignored
+    void untrack(StreamedAssetHandle handle);
+
+    /// @brief false once the asset was evicted (or untracked)
+    [[nodiscard]] bool isResident(StreamedAssetHandle handle) const { return _assets.contains(handle); }
+
+    /**
+     * @brief evicts until `bytes` more fit below EVICT_ABOVE of the budget of the heap `memoryUsage` allocates from
+     * @return false if they don't fit in the budget, even after evicting every idle asset
+     */
+    bool makeRoom(VmaMemoryUsage memoryUsage, VkDeviceSize bytes);
+
+    /// @brief the heap allocations of `memoryUsage` come from
+    [[nodiscard]] uint32_t heapIndexOf(VmaMemoryUsage memoryUsage) const;
+
+    /// @brief as of the last update() or makeRoom()
+    [[nodiscard]] const std::vector<HeapBudget> &heaps() const { return _heaps; }
+
+    /// @brief true if the budgets come from the driver, false if they are estimates
+    [[nodiscard]] bool isReported() const { return _reported; }
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+    void print();
+
+  private:
+    struct Asset {
+      VkDeviceSize size = 0;
+      uint32_t heapIndex = 0;
+      uint32_t priority = 0;
+      uint64_t lastUsed = 0;
+      EvictCallback evict{};
+    };
+
+    /// @brief reads the budgets of every heap from VMA
+    void refresh();
+
+    /// @brief evicts idle assets of a heap until its usage is at most `target`
+    void evict(uint32_t heapIndex, VkDeviceSize target);
+
+    VmaAllocator _allocator = nullptr;
+    const VkPhysicalDeviceMemoryProperties *_memoryProperties = nullptr;
+    uint32_t _framesInFlight = 1;
+    uint64_t _frame = 0;
+    bool _reported = false;
+    std::vector<HeapBudget> _heaps{};
+    HandleRegistry<Asset, StreamedAssetTag> _assets{};
+    Stats _stats{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_MEMORY_BUDGET_HPP
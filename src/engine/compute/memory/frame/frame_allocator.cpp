@@ -0,0 +1,131 @@
+#include "frame_allocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace walrus {
+
+  namespace {
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+  }
+
+
+
+
+  void FrameAllocator::init(
+    VmaAllocator allocator,
+    const DeviceInfo &deviceInfo,
+    uint32_t frames,
+    VkDeviceSize frameSize,
+    VkBufferUsageFlags usage
+  ) {
+    if (frames == 0 || frameSize == 0) {
+      throw std::runtime_error("frame allocator: needs at least one frame of memory");
+    }
+    _allocator = allocator;
+    const VkPhysicalDeviceLimits &limits = deviceInfo.properties.limits;
+    _minAlignment = std::max<VkDeviceSize>({
+      1,
+      limits.minUniformBufferOffsetAlignment,
+      limits.minStorageBufferOffsetAlignment,
+      limits.minTexelBufferOffsetAlignment
+    });
+    // whole alignment units, so every frame's buffer starts aligned
+    _frameSize = alignUp(frameSize, std::max<VkDeviceSize>(_minAlignment, limits.nonCoherentAtomSize));
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = _frameSize;
+    bufferInfo.usage = usage;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    /// LINEAR POOL
+    // one block holding every frame, allocated once. the linear algorithm packs the buffers back to back
+    VmaPoolCreateInfo poolInfo{};
+    if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferInfo, &allocInfo, &poolInfo.memoryTypeIndex) != VK_SUCCESS) {
+      throw std::runtime_error("frame allocator: no host visible memory type");
+    }
+    poolInfo.flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+    // slack for the buffers' own alignment requirements
+    poolInfo.blockSize = (_frameSize + std::max<VkDeviceSize>(_minAlignment, 256)) * frames;
+    poolInfo.minBlockCount = 1;
+    poolInfo.maxBlockCount = 1;
+    if (vmaCreatePool(allocator, &poolInfo, &_pool) != VK_SUCCESS) {
+      throw std::runtime_error("frame allocator: failed to create a pool of " + std::to_string(poolInfo.blockSize) + " bytes");
+    }
+
+    /// FRAMES
+    allocInfo.pool = _pool;
+    _frames.resize(frames);
+    for (Frame &frame: _frames) {
+      VmaAllocationInfo info{};
+      if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &frame.buffer.buffer, &frame.buffer.allocation, &info) != VK_SUCCESS) {
+        destroy();
+        throw std::runtime_error("frame allocator: failed to create a frame buffer");
+      }
+      frame.buffer.size = _frameSize;
+      frame.mapped = static_cast<uint8_t *>(info.pMappedData);
+    }
+    _current = 0;
+    _offset = 0;
+    _flushed = 0;
+    _stats = Stats{};
+  }
+
+
+  void FrameAllocator::destroy() {
+    for (Frame &frame: _frames) {
+      if (frame.buffer.buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(_allocator, frame.buffer.buffer, frame.buffer.allocation);
+      }
+    }
+    _frames.clear();
+    if (_pool != nullptr) {
+      vmaDestroyPool(_allocator, _pool);
+      _pool = nullptr;
+    }
+    _offset = 0;
+    _flushed = 0;
+  }
+
+
+  void FrameAllocator::beginFrame(uint64_t frameNumber) {
+    _current = (uint32_t) (frameNumber % _frames.size());
+    _offset = 0;
+    _flushed = 0;
+    _stats.frames++;
+  }
+
+
+  FrameAllocator::Allocation FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    const VkDeviceSize offset = alignUp(_offset, std::max(_minAlignment, alignment));
+    if (offset + size > _frameSize) {
+      throw std::runtime_error(
+        "frame allocator: frame full, " + std::to_string(size) + " bytes requested, "
+        + std::to_string(_frameSize - std::min(offset, _frameSize)) + " left"
+      );
+    }
+    _offset = offset + size;
+    _stats.allocations++;
+    _stats.peakFrameBytes = std::max(_stats.peakFrameBytes, _offset);
+
+    const Frame &frame = _frames[_current];
+    return Allocation{frame.buffer.buffer, offset, size, frame.mapped + offset};
+  }
+
+
+  void FrameAllocator::flush() {
+    if (_offset > _flushed) {
+      // a no-op for coherent memory
+      vmaFlushAllocation(_allocator, _frames[_current].buffer.allocation, _flushed, _offset - _flushed);
+      _flushed = _offset;
+    }
+  }
+
+} // walrus
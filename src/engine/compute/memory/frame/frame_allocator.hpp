@@ -0,0 +1,119 @@
+#ifndef WALRUS_COMPUTE_ENGINE_FRAME_ALLOCATOR_HPP
+#define WALRUS_COMPUTE_ENGINE_FRAME_ALLOCATOR_HPP
+
+#include "engine/compute/device/device.hpp"
+
+#include <vk_types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief per frame memory for data that lives one frame: uniforms, instance data, scratch.
+   * a ring of host visible, persistently mapped buffers, one per frame in flight, carved out of a single block of a
+   * linear VMA pool at init. allocate() bumps an offset in the current frame's buffer, beginFrame() resets the
+   * buffer of the frame it reuses wholesale -- a frame never allocates device memory, nor frees it piece by piece.
+   * usage: beginFrame(frameNumber) once the frame `frames` ago completed, push() / allocate(), flush() before submitting.
+   * @note not thread safe
+   */
+  class FrameAllocator {
+  public:
+    static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4ull << 20;
+    static constexpr VkBufferUsageFlags DEFAULT_USAGE = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                                                        | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                                                        | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                                                        | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+                                                        | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    /// @brief a range of the frame's buffer. valid until the frame's buffer is reused
+    struct Allocation {
+      VkBuffer buffer = VK_NULL_HANDLE;
+      VkDeviceSize offset = 0;
+      VkDeviceSize size = 0;
+      void *mapped = nullptr;
+
+      [[nodiscard]] VkDescriptorBufferInfo descriptor() const { return VkDescriptorBufferInfo{buffer, offset, size}; }
+    };
+
+    struct Stats {
+      uint64_t frames = 0;
+      uint64_t allocations = 0;
+      /// the most bytes a frame used, alignment included
+      VkDeviceSize peakFrameBytes = 0;
+    };
+
+    /**
+     * @param frames frames in flight, i.e. buffers in the ring
+     * @param frameSize bytes per frame. allocate() throws past it
+     * @throws std::runtime_error if the pool or its buffers can't be created
+     */
+    void init(
+      VmaAllocator allocator,
+      const DeviceInfo &deviceInfo,
+      uint32_t frames,
+      VkDeviceSize frameSize = DEFAULT_FRAME_SIZE,
+      VkBufferUsageFlags usage = DEFAULT_USAGE
+    );
+
+    /// @brief the device must be done with every frame
+    void destroy();
+
+    /// @brief makes frame `frameNumber` current, and resets its buffer. the device must be done with the frame it reused
+    void beginFrame(uint64_t frameNumber);
+
+    /**
+     * @brief `size` bytes in the current frame, aligned for uniform, storage & texel buffer offsets at least
+     * @throws std::runtime_error if the frame is full
+     */
+    [[nodiscard]] Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+    /// @brief allocates & copies `count` values
+    template<class T>
+    Allocation push(const T *values, size_t count) {
+      Allocation allocation = allocate((VkDeviceSize) (count * sizeof(T)), (VkDeviceSize) alignof(T));
+      memcpy(allocation.mapped, values, count * sizeof(T));
+      return allocation;
+    }
+
+    template<class T>
+    Allocation push(const T &value) { return push(&value, 1); }
+
+    template<class T>
+    Allocation push(const std::vector<T> &values) { return push(values.data(), values.size()); }
+
+    /// @brief makes the current frame's writes visible to the device. call before submitting the frame
+    void flush();
+
+    /// @brief bytes used in the current frame
+    [[nodiscard]] VkDeviceSize used() const { return _offset; }
+
+    [[nodiscard]] VkDeviceSize frameSize() const { return _frameSize; }
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+  private:
+    struct Frame {
+      AllocatedBuffer buffer{};
+      uint8_t *mapped = nullptr;
+    };
+
+    VmaAllocator _allocator = nullptr;
+    VmaPool _pool = nullptr;
+    std::vector<Frame> _frames{};
+    uint32_t _current = 0;
+    VkDeviceSize _frameSize = 0;
+    /// bumped by allocate(), reset by beginFrame()
+    VkDeviceSize _offset = 0;
+    /// up to where the current frame is flushed
+    VkDeviceSize _flushed = 0;
+    VkDeviceSize _minAlignment = 1;
+    Stats _stats{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_FRAME_ALLOCATOR_HPP
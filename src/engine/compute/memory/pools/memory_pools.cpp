@@ -0,0 +1,154 @@
+#include "memory_pools.hpp"
+#include "pretty_io.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace walrus {
+
+  namespace {
+    const char *className(MemoryPools::MemoryClass memoryClass) {
+      switch (memoryClass) {
+        case MemoryPools::MemoryClass::DEVICE_LOCAL: return "device local";
+        case MemoryPools::MemoryClass::UPLOAD: return "upload";
+        case MemoryPools::MemoryClass::STAGING: return "staging";
+        case MemoryPools::MemoryClass::READBACK: return "readback";
+      }
+      return "?";
+    }
+
+    /// @brief the usages buffers of a class are created with. the memory type is picked for a buffer like these
+    VkBufferUsageFlags classBufferUsage(MemoryPools::MemoryClass memoryClass, const DeviceInfo &deviceInfo) {
+      switch (memoryClass) {
+        case MemoryPools::MemoryClass::DEVICE_LOCAL: {
+          VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                                     | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+                                     | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+          if (deviceInfo.capabilities.bufferDeviceAddress) {
+            usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+          }
+          return usage;
+        }
+        case MemoryPools::MemoryClass::UPLOAD:
+          return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                 | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+                 | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        case MemoryPools::MemoryClass::STAGING:
+          return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        case MemoryPools::MemoryClass::READBACK:
+          return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      }
+      return 0;
+    }
+  }
+
+
+
+
+  void MemoryPools::configureAllocator(const DeviceInfo &deviceInfo, VmaAllocatorCreateInfo &info) {
+    // VMA supports up to 1.1: dedicated allocations & bind memory 2 are core there, no flags needed
+    info.vulkanApiVersion = deviceInfo.properties.apiVersion >= VK_API_VERSION_1_1
+                            ? VK_API_VERSION_1_1
+                            : VK_API_VERSION_1_0;
+    if (deviceInfo.capabilities.bufferDeviceAddress) {
+      info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    }
+    // vmaGetBudget asks the driver, instead of estimating from the heap sizes
+    if (deviceInfo.capabilities.memoryBudget) {
+      info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+  }
+
+
+  MemoryPools::MemoryClass MemoryPools::classOf(VmaMemoryUsage memoryUsage) {
+    switch (memoryUsage) {
+      case VMA_MEMORY_USAGE_CPU_TO_GPU: return MemoryClass::UPLOAD;
+      case VMA_MEMORY_USAGE_CPU_ONLY: return MemoryClass::STAGING;
+      case VMA_MEMORY_USAGE_GPU_TO_CPU: return MemoryClass::READBACK;
+      default: return MemoryClass::DEVICE_LOCAL;
+    }
+  }
+
+
+  VmaMemoryUsage MemoryPools::memoryUsageOf(MemoryClass memoryClass) {
+    switch (memoryClass) {
+      case MemoryClass::DEVICE_LOCAL: return VMA_MEMORY_USAGE_GPU_ONLY;
+      case MemoryClass::UPLOAD: return VMA_MEMORY_USAGE_CPU_TO_GPU;
+      case MemoryClass::STAGING: return VMA_MEMORY_USAGE_CPU_ONLY;
+      case MemoryClass::READBACK: return VMA_MEMORY_USAGE_GPU_TO_CPU;
+    }
+    return VMA_MEMORY_USAGE_GPU_ONLY;
+  }
+
+
+  void MemoryPools::init(VmaAllocator allocator, const DeviceInfo &deviceInfo) {
+    _allocator = allocator;
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+      const auto memoryClass = (MemoryClass) i;
+      Pool &pool = _pools[i];
+      pool = Pool{};
+
+      VkBufferCreateInfo bufferInfo{};
+      bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      bufferInfo.size = 1024; // only the memory type is wanted
+      bufferInfo.usage = classBufferUsage(memoryClass, deviceInfo);
+      VmaAllocationCreateInfo allocInfo{};
+      allocInfo.usage = memoryUsageOf(memoryClass);
+      if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferInfo, &allocInfo, &pool.memoryTypeIndex) != VK_SUCCESS) {
+        pool.memoryTypeIndex = UINT32_MAX;
+        continue;
+      }
+
+      VmaPoolCreateInfo poolInfo{};
+      poolInfo.memoryTypeIndex = pool.memoryTypeIndex;
+      poolInfo.blockSize = memoryClass == MemoryClass::DEVICE_LOCAL ? DEVICE_LOCAL_BLOCK_SIZE : HOST_BLOCK_SIZE;
+      if (vmaCreatePool(allocator, &poolInfo, &pool.pool) != VK_SUCCESS) {
+        pool = Pool{};
+        continue;
+      }
+      pool.blockSize = poolInfo.blockSize;
+    }
+  }
+
+
+  void MemoryPools::destroy() {
+    for (Pool &pool: _pools) {
+      if (pool.pool != nullptr) {
+        vmaDestroyPool(_allocator, pool.pool);
+      }
+      pool = Pool{};
+    }
+  }
+
+
+  VmaPool MemoryPools::poolFor(VmaMemoryUsage memoryUsage, VkDeviceSize size) const {
+    const MemoryClass memoryClass = classOf(memoryUsage);
+    if (memoryUsageOf(memoryClass) != memoryUsage) {
+      return nullptr; // UNKNOWN, GPU_LAZILY_ALLOCATED... have no class
+    }
+    const Pool &pool = _pools[(size_t) memoryClass];
+    if (pool.pool == nullptr || size > pool.blockSize / 2) {
+      return nullptr;
+    }
+    return pool.pool;
+  }
+
+
+  void MemoryPools::print() const {
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+      const Pool &pool = _pools[i];
+      const std::string name = className((MemoryClass) i);
+      if (pool.pool == nullptr) {
+        std::cout << io::to_color_string(io::LIGHT_GRAY, name + " pool") << ": none, default pools" << std::endl;
+        continue;
+      }
+      VmaPoolStats stats{};
+      vmaGetPoolStats(_allocator, pool.pool, &stats);
+      std::cout << io::to_color_string(io::LIGHT_GRAY, name + " pool")
+                << " (memory type " << pool.memoryTypeIndex << "): " << stats.allocationCount << " allocations in "
+                << stats.blockCount << " blocks, " << (stats.size - stats.unusedSize) / 1024 << " / "
+                << stats.size / 1024 << " KiB used" << std::endl;
+    }
+  }
+
+} // walrus
@@ -0,0 +1,69 @@
+#ifndef WALRUS_COMPUTE_ENGINE_MEMORY_POOLS_HPP
+#define WALRUS_COMPUTE_ENGINE_MEMORY_POOLS_HPP
+
+#include "engine/compute/device/device.hpp"
+
+#include <vk_types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace walrus {
+
+  /**
+   * @brief one VMA pool per usage class, so long lived buffers are sub-allocated from a few large blocks
+   * instead of each going through the default pools' heuristics. every class matches a VmaMemoryUsage.
+   * allocations bigger than half a block bypass the pools, VMA gives them dedicated memory.
+   * usage: allocInfo.pool = poolFor(memoryUsage, size), falling back to the default pools (null pool) on failure.
+   * @note the pools must be empty when destroyed
+   */
+  class MemoryPools {
+  public:
+    enum class MemoryClass {
+      DEVICE_LOCAL, // GPU_ONLY: kernel inputs & outputs, scratch
+      UPLOAD,       // CPU_TO_GPU: written by the host every so often, read by the device. vertices, uniforms
+      STAGING,      // CPU_ONLY: transfer sources
+      READBACK,     // GPU_TO_CPU: results read by the host
+    };
+    static constexpr size_t CLASS_COUNT = 4;
+
+    static constexpr VkDeviceSize DEVICE_LOCAL_BLOCK_SIZE = 64ull << 20;
+    static constexpr VkDeviceSize HOST_BLOCK_SIZE = 16ull << 20;
+
+    /**
+     * @brief the vulkan version & flags of the allocator, for what DeviceInfo reports & createLogicalDevice enabled:
+     * 1.1 for dedicated allocations & bind memory 2, buffer device addresses & memory budgets when supported
+     */
+    static void configureAllocator(const DeviceInfo &deviceInfo, VmaAllocatorCreateInfo &info);
+
+    static MemoryClass classOf(VmaMemoryUsage memoryUsage);
+
+    static VmaMemoryUsage memoryUsageOf(MemoryClass memoryClass);
+
+    /// @brief creates a pool per class. a class without a suitable memory type is left to the default pools
+    void init(VmaAllocator allocator, const DeviceInfo &deviceInfo);
+
+    void destroy();
+
+    /// @brief the pool of a class. null if it has none
+    [[nodiscard]] VmaPool pool(MemoryClass memoryClass) const { return _pools[(size_t) memoryClass].pool; }
+
+    /// @brief the pool an allocation of `size` bytes should come from. null for the default pools
+    [[nodiscard]] VmaPool poolFor(VmaMemoryUsage memoryUsage, VkDeviceSize size) const;
+
+    void print() const;
+
+  private:
+    struct Pool {
+      VmaPool pool = nullptr;
+      uint32_t memoryTypeIndex = UINT32_MAX;
+      VkDeviceSize blockSize = 0;
+    };
+
+    VmaAllocator _allocator = nullptr;
+    Pool _pools[CLASS_COUNT]{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_MEMORY_POOLS_HPP
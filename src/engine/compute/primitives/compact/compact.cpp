@@ -0,0 +1,125 @@
+#include "compact.hpp"
+
+#include <algorithm>
+
+namespace walrus::primitives {
+
+  namespace {
+    struct PushConstants {
+      uint32_t count;
+      uint32_t predicate;
+      uint32_t operand;
+      uint32_t partition;
+    };
+  }
+
+
+  void Compact::init(ComputeContext &context) {
+    _context = &context;
+    const auto &deviceInfo = context.getDeviceInfo();
+    const KernelInfo info = kernelInfo(deviceInfo, "compact", 4, sizeof(PushConstants), true);
+
+    // tuned on a partition of uniform values around the median, so every write path is exercised
+    AllocatedBuffer input = createTuningInput(context);
+    AllocatedBuffer output = context.createBuffer(input.size);
+    AllocatedBuffer selected = context.createBuffer(sizeof(uint32_t));
+    AllocatedBuffer state{};
+    const Kernel tuned = context.getTunedKernel(info, tuningKey(deviceInfo, "compact"), [&](const Kernel &kernel) {
+      _kernels[(uint32_t) ValueType::FLOAT32] = kernel;
+      // the state size depends on the tile size of the variant
+      if (state.size < stateSize(TUNING_COUNT)) {
+        context.destroyBuffer(state);
+        state = context.createBuffer(stateSize(TUNING_COUNT));
+      }
+      record(
+        input,
+        output,
+        selected,
+        TUNING_COUNT,
+        ValueType::FLOAT32,
+        Predicate::LESS,
+        toBits(0.5f),
+        PARTITION,
+        state
+      );
+    });
+    context.destroyBuffer(state);
+    context.destroyBuffer(selected);
+    context.destroyBuffer(output);
+    context.destroyBuffer(input);
+    _kernels = typedKernels(context, tuned);
+  }
+
+
+  VkDeviceSize Compact::stateSize(uint32_t count) const {
+    const uint32_t tile = tileSize(_kernels[(uint32_t) ValueType::FLOAT32]);
+    const uint32_t tiles = (count + tile - 1) / tile;
+    // tile counter, then a flag, aggregate & inclusive prefix per tile
+    return (1 + (VkDeviceSize) tiles * 3) * sizeof(uint32_t);
+  }
+
+
+  void Compact::record(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    const AllocatedBuffer &selected,
+    uint32_t count,
+    ValueType type,
+    Predicate predicate,
+    uint32_t operandBits,
+    Mode mode,
+    const AllocatedBuffer &state
+  ) {
+    if (count == 0) {
+      _context->fill(selected, 0, 0, sizeof(uint32_t));
+      _context->barrier();
+      return;
+    }
+    const Kernel &kernel = getKernel(type);
+    const VkDeviceSize size = stateSize(count);
+    _context->fill(state, 0, 0, size);
+    _context->barrier();
+
+    const PushConstants constants{count, (uint32_t) predicate, operandBits, (uint32_t) mode};
+    _context->dispatch(
+      kernel,
+      {
+        ComputeContext::bind(input),
+        ComputeContext::bind(output),
+        ComputeContext::bind(state, 0, size),
+        ComputeContext::bind(selected, 0, sizeof(uint32_t))
+      },
+      &constants,
+      // capped at the device limit, the groups acquire tiles until there are none left
+      std::min(
+        kernel.groupCount(count, kernel.variant[ITEMS_PER_THREAD]),
+        _context->getLimits().maxComputeWorkGroupCount[0]
+      )
+    );
+    _context->barrier();
+  }
+
+
+  uint32_t Compact::runBits(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    uint32_t count,
+    ValueType type,
+    Predicate predicate,
+    uint32_t operandBits,
+    Mode mode
+  ) {
+    AllocatedBuffer state = _context->createBuffer(stateSize(count));
+    AllocatedBuffer selected = _context->createBuffer(sizeof(uint32_t));
+    _context->begin();
+    record(input, output, selected, count, type, predicate, operandBits, mode, state);
+    _context->submit();
+
+    uint32_t selectedCount = 0;
+    _context->download(selected, &selectedCount, sizeof(selectedCount));
+    _context->destroyBuffer(selected);
+    _context->destroyBuffer(state);
+    return selectedCount;
+  }
+
+} // walrus::primitives
@@ -0,0 +1,78 @@
+#ifndef WALRUS_COMPUTE_ENGINE_COMPACT_HPP
+#define WALRUS_COMPUTE_ENGINE_COMPACT_HPP
+
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <cstdint>
+
+namespace walrus::primitives {
+
+  /**
+   * @brief single pass stream compaction & partitioning of 32 bit values, using decoupled look-back.
+   * values matching `predicate(value, operand)` are written to the front of the output in their original order.
+   * when partitioning, the other values fill the back of the output in reverse order.
+   */
+  class Compact {
+  public:
+    /// @brief what to do with the values that don't match the predicate
+    enum Mode : uint32_t {
+      DISCARD = 0,   /// compaction
+      PARTITION = 1, /// rejected values are written after the selected ones, in reverse order
+    };
+
+    /// @brief builds (and on the first run per device, tunes) the kernels
+    void init(ComputeContext &context);
+
+    /// @brief bytes of look-back state `record` needs for `count` values
+    [[nodiscard]] VkDeviceSize stateSize(uint32_t count) const;
+
+    /**
+     * @brief records the compaction between ComputeContext::begin() and submit(). `state` is cleared by the recording.
+     * @param selected receives the number of selected values, as a uint32
+     * @param operandBits see toBits()
+     */
+    void record(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      const AllocatedBuffer &selected,
+      uint32_t count,
+      ValueType type,
+      Predicate predicate,
+      uint32_t operandBits,
+      Mode mode,
+      const AllocatedBuffer &state
+    );
+
+    /// @brief compact / partition `count` values of `input` into `output`. blocks, returns the selected count
+    template<class T>
+    uint32_t run(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      uint32_t count,
+      Predicate predicate,
+      T operand,
+      Mode mode = DISCARD
+    ) {
+      return runBits(input, output, count, valueTypeOf<T>(), predicate, toBits(operand), mode);
+    }
+
+    uint32_t runBits(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      uint32_t count,
+      ValueType type,
+      Predicate predicate,
+      uint32_t operandBits,
+      Mode mode
+    );
+
+    [[nodiscard]] const Kernel &getKernel(ValueType type) const { return _kernels[(uint32_t) type]; }
+
+  private:
+    ComputeContext *_context = nullptr;
+    std::array<Kernel, VALUE_TYPE_COUNT> _kernels{};
+  };
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_COMPACT_HPP
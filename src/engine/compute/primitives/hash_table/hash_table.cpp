@@ -0,0 +1,317 @@
+#include "hash_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace walrus::primitives {
+
+  namespace {
+    struct PushConstants {
+      uint32_t count;
+      uint32_t capacity;
+    };
+
+    /// matches hash_table.glsl. WORKGROUP_SIZE & VALUE_TYPE are shared with the other primitives
+    enum HashSpecConstantId : uint32_t {
+      OPERATION = 1,
+      AGGREGATE = 2,
+      MAX_PROBES = 4,
+    };
+
+    enum Operation : uint32_t {
+      BUILD = 0,
+      PROBE = 1,
+      AGGREGATE_VALUES = 2,
+    };
+
+    /// random accesses are latency bound, so the workgroup size matters little
+    constexpr uint32_t HASH_WORKGROUP_SIZE = 256;
+    /// slots a key tries before overflowing. at the default load factor, probes are rarely longer than a few slots
+    constexpr uint32_t HASH_MAX_PROBES = 128;
+    constexpr uint32_t STATE_WORDS = 2;
+    constexpr uint32_t ALL_ONES = 0xFFFFFFFF;
+
+    KernelInfo kernelInfo(KeyWidth width) {
+      KernelInfo info{};
+      info.fileName = width == KeyWidth::BITS_64 ? "hash_table_64.comp.spv" : "hash_table.comp.spv";
+      info.bindingCount = 5;
+      info.pushConstantSize = sizeof(PushConstants);
+      info.specConstants = {
+        {WORKGROUP_SIZE, "WORKGROUP_SIZE", HASH_WORKGROUP_SIZE, {}},
+        {OPERATION, "OPERATION", BUILD, {}},
+        {AGGREGATE, "AGGREGATE", (uint32_t) Aggregate::SUM, {}},
+        {VALUE_TYPE, "VALUE_TYPE", (uint32_t) ValueType::UINT32, {}},
+        {MAX_PROBES, "MAX_PROBES", HASH_MAX_PROBES, {}},
+      };
+      info.workgroupSize = {"WORKGROUP_SIZE", nullptr, nullptr};
+      return info;
+    }
+
+    /// @brief the value every slot starts from, so that the first value aggregated into it is kept as is
+    uint32_t identity(Aggregate aggregate, ValueType type) {
+      if (aggregate == Aggregate::MIN) {
+        switch (type) {
+          case ValueType::UINT32:
+            return ALL_ONES;
+          case ValueType::INT32:
+            return 0x7FFFFFFF;
+          case ValueType::FLOAT32:
+            return toBits(INFINITY);
+        }
+      }
+      if (aggregate == Aggregate::MAX) {
+        switch (type) {
+          case ValueType::UINT32:
+            return 0;
+          case ValueType::INT32:
+            return 0x80000000;
+          case ValueType::FLOAT32:
+            return toBits(-INFINITY);
+        }
+      }
+      return 0;
+    }
+
+    uint32_t nextPowerOf2(uint64_t value) {
+      uint64_t power = 1;
+      while (power < value) {
+        power *= 2;
+      }
+      return (uint32_t) power;
+    }
+  }
+
+
+  const char *toString(Aggregate aggregate) {
+    switch (aggregate) {
+      case Aggregate::SUM:
+        return "sum";
+      case Aggregate::MIN:
+        return "min";
+      case Aggregate::MAX:
+        return "max";
+      case Aggregate::COUNT:
+        return "count";
+    }
+    return "unknown";
+  }
+
+
+  void HashTable::init(ComputeContext &context) {
+    _context = &context;
+    _info32 = kernelInfo(KeyWidth::BITS_32);
+    _info64 = kernelInfo(KeyWidth::BITS_64);
+  }
+
+
+  bool HashTable::supports(KeyWidth width) const {
+    if (width == KeyWidth::BITS_64) {
+      return _context->getDeviceInfo().capabilities.shaderBufferInt64Atomics;
+    }
+    return true;
+  }
+
+
+  HashTable::Table HashTable::createTable(uint32_t expectedKeys, KeyWidth width, double loadFactor) {
+    if (!(loadFactor > 0.0 && loadFactor <= 1.0)) {
+      throw std::runtime_error("hash table load factor must be in (0, 1]: " + std::to_string(loadFactor));
+    }
+    const auto slots = (uint64_t) std::ceil(std::max<uint32_t>(expectedKeys, 1) / loadFactor);
+    if (slots > MAX_CAPACITY) {
+      throw std::runtime_error("hash table too large: " + std::to_string(slots) + " slots");
+    }
+    return createTableWithCapacity(nextPowerOf2(slots), width);
+  }
+
+
+  void HashTable::destroyTable(Table &table) {
+    _context->destroyBuffer(table.state);
+    _context->destroyBuffer(table.values);
+    _context->destroyBuffer(table.keys);
+    table = Table{};
+  }
+
+
+  void HashTable::recordClear(const Table &table, Aggregate aggregate, ValueType type) {
+    // all ones is the empty key of either width
+    _context->fill(table.keys, ALL_ONES);
+    _context->fill(table.values, identity(aggregate, type));
+    _context->fill(table.state, 0);
+    _context->barrier();
+  }
+
+
+  void HashTable::recordBuild(
+    const Table &table,
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer &values,
+    uint32_t count
+  ) {
+    dispatch(getKernel(table.width, BUILD, Aggregate::SUM, ValueType::UINT32), table, keys, values, count);
+  }
+
+
+  void HashTable::recordProbe(
+    const Table &table,
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer &results,
+    uint32_t count
+  ) {
+    dispatch(getKernel(table.width, PROBE, Aggregate::SUM, ValueType::UINT32), table, keys, results, count);
+  }
+
+
+  void HashTable::recordAggregate(
+    const Table &table,
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer *values,
+    uint32_t count,
+    Aggregate aggregate,
+    ValueType type
+  ) {
+    if (values == nullptr && aggregate != Aggregate::COUNT) {
+      throw std::runtime_error(std::string("hash table aggregate needs values: ") + toString(aggregate));
+    }
+    // COUNT never reads the values, but the binding still needs a buffer
+    const AllocatedBuffer &bound = values != nullptr ? *values : keys;
+    dispatch(getKernel(table.width, AGGREGATE_VALUES, aggregate, type), table, keys, bound, count);
+  }
+
+
+  uint32_t HashTable::overflowCount(const Table &table) {
+    uint32_t overflow = 0;
+    _context->download(table.state, &overflow, sizeof(overflow));
+    return overflow;
+  }
+
+
+  double HashTable::build(Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &values, uint32_t count) {
+    return recordGrowing(table, [&]() {
+      recordClear(table);
+      recordBuild(table, keys, values, count);
+    });
+  }
+
+
+  double HashTable::probe(const Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &results, uint32_t count) {
+    _context->begin();
+    recordProbe(table, keys, results, count);
+    return _context->submit();
+  }
+
+
+  double HashTable::aggregate(
+    Table &table,
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer *values,
+    uint32_t count,
+    Aggregate aggregate,
+    ValueType type
+  ) {
+    return recordGrowing(table, [&]() {
+      recordClear(table, aggregate, type);
+      recordAggregate(table, keys, values, count, aggregate, type);
+    });
+  }
+
+
+  std::vector<HashTable::Entry> HashTable::entries(const Table &table) {
+    const uint32_t words = (uint32_t) table.width;
+    std::vector<uint32_t> keys(((size_t) table.capacity + 1) * words);
+    std::vector<uint32_t> values(table.capacity + 1);
+    uint32_t state[STATE_WORDS] = {};
+    _context->download(table.keys, keys.data(), keys.size() * sizeof(uint32_t));
+    _context->download(table.values, values.data(), values.size() * sizeof(uint32_t));
+    _context->download(table.state, state, sizeof(state));
+
+    std::vector<Entry> result{};
+    for (uint32_t slot = 0; slot <= table.capacity; slot++) {
+      // words are little endian, low word first
+      uint64_t key = keys[(size_t) slot * words];
+      if (table.width == KeyWidth::BITS_64) {
+        key |= (uint64_t) keys[(size_t) slot * words + 1] << 32;
+      }
+      const uint64_t empty = table.width == KeyWidth::BITS_64 ? ~0ull : ALL_ONES;
+      const bool used = slot == table.capacity ? state[1] != 0 : key != empty;
+      if (used) {
+        result.push_back({key, values[slot]});
+      }
+    }
+    return result;
+  }
+
+
+  HashTable::Table HashTable::createTableWithCapacity(uint32_t capacity, KeyWidth width) {
+    if (!supports(width)) {
+      throw std::runtime_error("64 bit hash table keys need 64 bit atomics (shaderBufferInt64Atomics)");
+    }
+    Table table{};
+    table.capacity = capacity;
+    table.width = width;
+    table.keys = _context->createBuffer(((VkDeviceSize) capacity + 1) * (uint32_t) width * sizeof(uint32_t));
+    table.values = _context->createBuffer(((VkDeviceSize) capacity + 1) * sizeof(uint32_t));
+    table.state = _context->createBuffer(STATE_WORDS * sizeof(uint32_t));
+    return table;
+  }
+
+
+  double HashTable::recordGrowing(Table &table, const std::function<void()> &record) {
+    double ms = 0.0;
+    while (true) {
+      _context->begin();
+      record();
+      ms += _context->submit();
+      if (overflowCount(table) == 0) {
+        return ms;
+      }
+      if (table.capacity >= MAX_CAPACITY) {
+        throw std::runtime_error("hash table overflowed at its maximum capacity");
+      }
+      const uint32_t capacity = table.capacity * 2;
+      const KeyWidth width = table.width;
+      destroyTable(table);
+      table = createTableWithCapacity(capacity, width);
+    }
+  }
+
+
+  Kernel HashTable::getKernel(KeyWidth width, uint32_t operation, Aggregate aggregate, ValueType type) {
+    const KernelInfo &info = width == KeyWidth::BITS_64 ? _info64 : _info32;
+    KernelVariant variant = info.defaultVariant();
+    variant[OPERATION] = operation;
+    variant[AGGREGATE] = (uint32_t) aggregate;
+    variant[VALUE_TYPE] = (uint32_t) type;
+    return _context->getKernel(info, variant);
+  }
+
+
+  void HashTable::dispatch(
+    const Kernel &kernel,
+    const Table &table,
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer &values,
+    uint32_t count
+  ) {
+    if (count == 0) {
+      return;
+    }
+    const PushConstants constants{count, table.capacity};
+    const uint32_t groups = std::min(kernel.groupCount(count), _context->getLimits().maxComputeWorkGroupCount[0]);
+    _context->dispatch(
+      kernel,
+      {
+        ComputeContext::bind(table.keys),
+        ComputeContext::bind(table.values),
+        ComputeContext::bind(table.state),
+        ComputeContext::bind(keys),
+        ComputeContext::bind(values),
+      },
+      &constants,
+      groups
+    );
+    _context->barrier();
+  }
+
+} // walrus::primitives
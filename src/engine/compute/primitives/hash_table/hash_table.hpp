@@ -0,0 +1,137 @@
+#ifndef WALRUS_COMPUTE_ENGINE_HASH_TABLE_HPP
+#define WALRUS_COMPUTE_ENGINE_HASH_TABLE_HPP
+
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace walrus::primitives {
+
+  /// @brief how HashTable::aggregate combines the values of a key. matches hash_table.glsl
+  enum class Aggregate : uint32_t {
+    SUM = 0,
+    MIN = 1,
+    MAX = 2,
+    /// occurrences of the key. ignores the values
+    COUNT = 3,
+  };
+
+  const char *toString(Aggregate aggregate);
+
+  /**
+   * @brief lock-free open addressing hash table in device memory, mapping 32 or 64 bit keys to 32 bit values
+   * (see shaders/compute/primitives/hash_table.glsl). three kernels use it:
+   * - build: inserts (key, value) pairs, i.e. the build side of a hash join. duplicate keys keep any one of their values
+   * - probe: looks keys up, i.e. the probe side of a join, giving NOT_FOUND for missing keys
+   * - aggregate: group-by, combining the values of each key with an Aggregate (sum, min, max, count)
+   * tables stay in device memory between kernels, so they can feed the next stage of a pipeline directly.
+   * the capacity follows from the expected key count and a load factor. keys that find no slot overflow:
+   * the blocking build() & aggregate() then rebuild into a table of twice the capacity,
+   * and the record* functions leave the count in the table, see overflowCount().
+   * @note 64 bit keys need 64 bit atomics, see supports()
+   */
+  class HashTable {
+  public:
+    struct Table {
+      /// `capacity` + 1 keys: the last slot holds the all ones key, which marks empty slots in the others
+      AllocatedBuffer keys{};
+      AllocatedBuffer values{};
+      /// the overflow count, and whether the all ones key is in the table
+      AllocatedBuffer state{};
+      uint32_t capacity = 0;
+      KeyWidth width = KeyWidth::BITS_32;
+    };
+
+    struct Entry {
+      uint64_t key = 0;
+      uint32_t value = 0;
+    };
+
+    /// probe result of missing keys
+    static constexpr uint32_t NOT_FOUND = 0xFFFFFFFF;
+    static constexpr double DEFAULT_LOAD_FACTOR = 0.5;
+    static constexpr uint32_t MAX_CAPACITY = 1u << 30;
+
+    void init(ComputeContext &context);
+
+    /// @brief true if the device can run the key width
+    [[nodiscard]] bool supports(KeyWidth width) const;
+
+    /**
+     * @brief an empty table with room for `expectedKeys` at `loadFactor`, rounded up to a power of 2 slots.
+     * lower load factors mean shorter probe sequences, at the cost of memory
+     */
+    Table createTable(uint32_t expectedKeys, KeyWidth width, double loadFactor = DEFAULT_LOAD_FACTOR);
+
+    void destroyTable(Table &table);
+
+    /// @brief records emptying the table, and setting every value to the identity of `aggregate` for `type`
+    void recordClear(const Table &table, Aggregate aggregate = Aggregate::SUM, ValueType type = ValueType::UINT32);
+
+    /// @brief records inserting `count` keys and their values, between ComputeContext::begin() and submit()
+    void recordBuild(const Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &values, uint32_t count);
+
+    /// @brief records looking up `count` keys, writing their values (or NOT_FOUND) to `results`
+    void recordProbe(const Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &results, uint32_t count);
+
+    /**
+     * @brief records combining the `type` values of `count` keys into the table, which must be cleared for `aggregate`
+     * @param values nullptr for COUNT
+     */
+    void recordAggregate(
+      const Table &table,
+      const AllocatedBuffer &keys,
+      const AllocatedBuffer *values,
+      uint32_t count,
+      Aggregate aggregate,
+      ValueType type
+    );
+
+    /// @brief keys that found no slot since the table was cleared. blocks, can't be called while recording
+    uint32_t overflowCount(const Table &table);
+
+    /// @brief replaces the contents of the table with `count` pairs, growing it until they fit. returns the time in ms
+    double build(Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &values, uint32_t count);
+
+    /// @brief looks up `count` keys. blocks until complete, returns the time in ms
+    double probe(const Table &table, const AllocatedBuffer &keys, const AllocatedBuffer &results, uint32_t count);
+
+    /// @brief replaces the contents of the table with the aggregate of every key, growing it until they fit
+    double aggregate(
+      Table &table,
+      const AllocatedBuffer &keys,
+      const AllocatedBuffer *values,
+      uint32_t count,
+      Aggregate aggregate,
+      ValueType type
+    );
+
+    /// @brief every key in the table and its value, in slot order. blocks, can't be called while recording
+    std::vector<Entry> entries(const Table &table);
+
+  private:
+    Table createTableWithCapacity(uint32_t capacity, KeyWidth width);
+
+    /// @brief submits `record` until the table doesn't overflow, doubling its capacity each time
+    double recordGrowing(Table &table, const std::function<void()> &record);
+
+    [[nodiscard]] Kernel getKernel(KeyWidth width, uint32_t operation, Aggregate aggregate, ValueType type);
+
+    void dispatch(
+      const Kernel &kernel,
+      const Table &table,
+      const AllocatedBuffer &keys,
+      const AllocatedBuffer &values,
+      uint32_t count
+    );
+
+    ComputeContext *_context = nullptr;
+    KernelInfo _info32{};
+    KernelInfo _info64{};
+  };
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_HASH_TABLE_HPP
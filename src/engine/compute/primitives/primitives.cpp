@@ -0,0 +1,97 @@
+#include "primitives.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace walrus::primitives {
+
+  const char *toString(ValueType type) {
+    switch (type) {
+      case ValueType::UINT32:
+        return "u32";
+      case ValueType::INT32:
+        return "i32";
+      case ValueType::FLOAT32:
+        return "f32";
+    }
+    return "unknown";
+  }
+
+
+  bool useSubgroups(const DeviceInfo &deviceInfo) {
+    return deviceInfo.supportsSubgroupOperations(VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT);
+  }
+
+
+  KernelInfo kernelInfo(
+    const DeviceInfo &deviceInfo,
+    const std::string &name,
+    uint32_t bindingCount,
+    uint32_t pushConstantSize,
+    bool tiled
+  ) {
+    const bool subgroups = useSubgroups(deviceInfo);
+    const uint32_t minSubgroupSize = std::max<uint32_t>(deviceInfo.subgroups.minSize, 1);
+
+    KernelInfo info{};
+    info.fileName = name + (subgroups ? "_subgroup" : "") + ".comp.spv";
+    info.bindingCount = bindingCount;
+    info.pushConstantSize = pushConstantSize;
+    info.specConstants = {
+      {WORKGROUP_SIZE, "WORKGROUP_SIZE", 256, {64, 128, 256, 512, 1024}},
+      {ITEMS_PER_THREAD, "ITEMS_PER_THREAD", 4, {1, 2, 4, 8, 16}},
+      {MIN_SUBGROUP_SIZE, "MIN_SUBGROUP_SIZE", minSubgroupSize, {}},
+      {VALUE_TYPE, "VALUE_TYPE", (uint32_t) ValueType::FLOAT32, {}},
+    };
+    info.workgroupSize = {"WORKGROUP_SIZE", nullptr, nullptr};
+    info.isSupported = [subgroups, tiled](const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) {
+      const uint32_t workgroupSize = variant[WORKGROUP_SIZE];
+      // one word per invocation, or per subgroup
+      uint64_t words = subgroups
+                       ? (workgroupSize + variant[MIN_SUBGROUP_SIZE] - 1) / variant[MIN_SUBGROUP_SIZE]
+                       : workgroupSize;
+      if (tiled) {
+        words += (uint64_t) workgroupSize * variant[ITEMS_PER_THREAD];
+      }
+      return words * sizeof(uint32_t) <= limits.maxComputeSharedMemorySize;
+    };
+    return info;
+  }
+
+
+  std::string tuningKey(const DeviceInfo &deviceInfo, const std::string &name) {
+    return name + (useSubgroups(deviceInfo) ? "_subgroup" : "");
+  }
+
+
+  std::array<Kernel, VALUE_TYPE_COUNT> typedKernels(ComputeContext &context, const Kernel &tuned) {
+    // every type shares the tuned sizes
+    std::array<Kernel, VALUE_TYPE_COUNT> kernels{};
+    for (uint32_t type = 0; type < VALUE_TYPE_COUNT; type++) {
+      KernelVariant variant = tuned.variant;
+      variant[VALUE_TYPE] = type;
+      kernels[type] = context.getKernel(tuned.info, variant);
+    }
+    return kernels;
+  }
+
+
+  uint32_t tileSize(const Kernel &kernel) {
+    return kernel.variant[WORKGROUP_SIZE] * kernel.variant[ITEMS_PER_THREAD];
+  }
+
+
+  AllocatedBuffer createTuningInput(ComputeContext &context, uint32_t count) {
+    std::vector<float> values(count);
+    std::mt19937 generator(count); // deterministic, so every tuning run sees the same data
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+    for (auto &value: values) {
+      value = distribution(generator);
+    }
+    AllocatedBuffer buffer = context.createBuffer(count * sizeof(float));
+    context.upload(buffer, values.data(), buffer.size);
+    return buffer;
+  }
+
+} // walrus::primitives
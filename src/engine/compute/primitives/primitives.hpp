@@ -0,0 +1,116 @@
+#ifndef WALRUS_COMPUTE_ENGINE_PRIMITIVES_HPP
+#define WALRUS_COMPUTE_ENGINE_PRIMITIVES_HPP
+
+#include "engine/compute/context/compute_context.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace walrus::primitives {
+
+  /**
+   * @brief element types of the primitives. kernels read every type as 32 bit words,
+   * and specialize how they are added & compared on a `VALUE_TYPE` constant (see shaders/compute/primitives/values.glsl)
+   */
+  enum class ValueType : uint32_t {
+    UINT32 = 0,
+    INT32 = 1,
+    FLOAT32 = 2,
+  };
+  constexpr uint32_t VALUE_TYPE_COUNT = 3;
+
+  const char *toString(ValueType type);
+
+  template<class T>
+  constexpr ValueType valueTypeOf() {
+    static_assert(
+      std::is_same_v<T, uint32_t> || std::is_same_v<T, int32_t> || std::is_same_v<T, float>,
+      "primitives support 32 bit uints, ints & floats"
+    );
+    if constexpr (std::is_same_v<T, float>) {
+      return ValueType::FLOAT32;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+      return ValueType::INT32;
+    } else {
+      return ValueType::UINT32;
+    }
+  }
+
+  /// @brief the bits of a value, as passed to kernels
+  template<class T>
+  uint32_t toBits(T value) {
+    static_assert(sizeof(T) == sizeof(uint32_t), "primitives support 32 bit values");
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  template<class T>
+  T fromBits(uint32_t bits) {
+    static_assert(sizeof(T) == sizeof(uint32_t), "primitives support 32 bit values");
+    T value{};
+    memcpy(&value, &bits, sizeof(bits));
+    return value;
+  }
+
+  /// @brief width of radix sort & hash table keys, in 32 bit words
+  enum class KeyWidth : uint32_t {
+    BITS_32 = 1,
+    BITS_64 = 2,
+  };
+
+  /// @brief selects values for compaction & partitioning, by comparing them to an operand. matches compact.glsl
+  enum class Predicate : uint32_t {
+    EQUAL = 0,
+    NOT_EQUAL = 1,
+    LESS = 2,
+    LESS_EQUAL = 3,
+    GREATER = 4,
+    GREATER_EQUAL = 5,
+  };
+
+  /// @brief specialization constants shared by every primitive kernel
+  enum SpecConstantId : uint32_t {
+    WORKGROUP_SIZE = 0,
+    ITEMS_PER_THREAD = 1,
+    MIN_SUBGROUP_SIZE = 2, // only read by the subgroup variants
+    VALUE_TYPE = 3,
+  };
+
+  /// @brief true if the device can run the subgroup variants of the primitives
+  bool useSubgroups(const DeviceInfo &deviceInfo);
+
+  /**
+   * @brief kernel info shared by the primitives: tunable workgroup size & items per invocation,
+   * and the subgroup variant (`<name>_subgroup.comp.spv`) when the device supports it
+   * @param tiled true if the kernel keeps a whole tile (workgroup size * items per invocation) in shared memory
+   */
+  KernelInfo kernelInfo(
+    const DeviceInfo &deviceInfo,
+    const std::string &name,
+    uint32_t bindingCount,
+    uint32_t pushConstantSize,
+    bool tiled
+  );
+
+  /// @brief the name a primitive is tuned under, i.e. "scan_subgroup"
+  std::string tuningKey(const DeviceInfo &deviceInfo, const std::string &name);
+
+  /// @brief the tuned kernel specialized for each value type, indexed by ValueType
+  std::array<Kernel, VALUE_TYPE_COUNT> typedKernels(ComputeContext &context, const Kernel &tuned);
+
+  /// @brief values processed by one workgroup of a tiled kernel
+  uint32_t tileSize(const Kernel &kernel);
+
+  /// @brief values in the workload the primitives are tuned on.
+  /// large enough to be bandwidth bound on discrete gpus, small enough to tune quickly on cpu implementations
+  constexpr uint32_t TUNING_COUNT = 1u << 22;
+
+  /// @brief a device buffer of `count` pseudo random floats in [0, 1), used as the tuning workload
+  AllocatedBuffer createTuningInput(ComputeContext &context, uint32_t count = TUNING_COUNT);
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_PRIMITIVES_HPP
@@ -0,0 +1,269 @@
+#include "radix_sort.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace walrus::primitives {
+
+  namespace {
+    struct HistogramConstants {
+      uint32_t count;
+    };
+
+    struct OnesweepConstants {
+      uint32_t count;
+      uint32_t pass;
+    };
+
+    /// specialization constants after the ones shared by every primitive
+    enum RadixSpecConstantId : uint32_t {
+      KEY_WORDS = 4,
+      HAS_PAYLOAD = 5,
+    };
+
+    /// matches radix.glsl
+    constexpr uint32_t RADIX_BITS = 8;
+    constexpr uint32_t RADIX = 1u << RADIX_BITS;
+
+    uint32_t passCount(KeyWidth width) {
+      return (uint32_t) width * 32 / RADIX_BITS;
+    }
+
+    /// one workgroup per tile, in both the histogram & the onesweep
+    uint32_t tileCount(uint32_t count, const KernelVariant &variant) {
+      const uint32_t tile = variant[WORKGROUP_SIZE] * variant[ITEMS_PER_THREAD];
+      return (count + tile - 1) / tile;
+    }
+  }
+
+
+  void RadixSort::init(ComputeContext &context) {
+    _context = &context;
+    const auto &deviceInfo = context.getDeviceInfo();
+    const bool subgroups = useSubgroups(deviceInfo);
+
+    /// KERNELS
+    _onesweepInfo = kernelInfo(deviceInfo, "radix_onesweep", 6, sizeof(OnesweepConstants), true);
+    _onesweepInfo.specConstants[WORKGROUP_SIZE].candidates = {64, 128, 256, 512};
+    _onesweepInfo.specConstants[ITEMS_PER_THREAD].candidates = {2, 4, 8, 16};
+    _onesweepInfo.specConstants.push_back({KEY_WORDS, "KEY_WORDS", 1, {}});
+    _onesweepInfo.specConstants.push_back({HAS_PAYLOAD, "HAS_PAYLOAD", 1, {}});
+    _onesweepInfo.isSupported = [subgroups](const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) {
+      const uint64_t workgroupSize = variant[WORKGROUP_SIZE];
+      const uint64_t tile = workgroupSize * variant[ITEMS_PER_THREAD];
+      // the tile's keys & payloads, the digit counts, starts & offsets, and the scan partials
+      uint64_t words = tile * (variant[KEY_WORDS] + 1) + 3 * RADIX + 3;
+      words += subgroups
+               ? (workgroupSize + variant[MIN_SUBGROUP_SIZE] - 1) / variant[MIN_SUBGROUP_SIZE]
+               : workgroupSize;
+      return words * sizeof(uint32_t) <= limits.maxComputeSharedMemorySize;
+    };
+
+    // the histogram shares the onesweep variant, so its tiles line up
+    _histogramInfo = _onesweepInfo;
+    _histogramInfo.fileName = "radix_histogram.comp.spv";
+    _histogramInfo.bindingCount = 2;
+    _histogramInfo.pushConstantSize = sizeof(HistogramConstants);
+    _histogramInfo.isSupported = {};
+
+    KernelInfo scanInfo{};
+    scanInfo.fileName = "radix_scan.comp.spv";
+    scanInfo.bindingCount = 1;
+    _scan = context.getKernel(scanInfo);
+
+    /// TUNING
+    // tuned on float keys with payloads. every run sorts a fresh copy of the input
+    AllocatedBuffer input = createTuningInput(context);
+    AllocatedBuffer keys = context.createBuffer(input.size);
+    AllocatedBuffer payloads = createTuningInput(context);
+    Scratch scratch{};
+    // the sort runs the variant adjusted to its keys, so candidates the adjustment changes would be timed as
+    // another variant. they are skipped
+    KernelInfo tuningInfo = _onesweepInfo;
+    tuningInfo.isSupported = [this](const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) {
+      if (!_onesweepInfo.fits(variant, limits)) {
+        return false;
+      }
+      try {
+        return adjust(variant, ValueType::FLOAT32, KeyWidth::BITS_32, true, TUNING_COUNT) == variant;
+      } catch (const std::runtime_error &) {
+        return false; // no tile large enough
+      }
+    };
+    const Kernel tuned = context.getTunedKernel(tuningInfo, tuningKey(deviceInfo, "radix_sort"), [&](const Kernel &kernel) {
+      _tuned = kernel.variant;
+      // the state size depends on the tile size of the variant
+      if (scratch.state.size < stateSize(tileCount(TUNING_COUNT, _tuned))) {
+        destroyScratch(scratch);
+        scratch = createScratch(TUNING_COUNT, KeyWidth::BITS_32, true);
+      }
+      context.copy(input, keys, input.size);
+      context.barrier();
+      record(keys, &payloads, TUNING_COUNT, ValueType::FLOAT32, KeyWidth::BITS_32, scratch);
+    });
+    _tuned = tuned.variant;
+    destroyScratch(scratch);
+    context.destroyBuffer(payloads);
+    context.destroyBuffer(keys);
+    context.destroyBuffer(input);
+  }
+
+
+  RadixSort::Scratch RadixSort::createScratch(uint32_t capacity, KeyWidth width, bool payloads) {
+    const VkDeviceSize count = std::max<uint32_t>(capacity, 1);
+    Scratch scratch{};
+    scratch.capacity = capacity;
+    scratch.keys = _context->createBuffer(count * (uint32_t) width * sizeof(uint32_t));
+    if (payloads) {
+      scratch.payloads = _context->createBuffer(count * sizeof(uint32_t));
+    }
+    scratch.offsets = _context->createBuffer(passCount(width) * RADIX * sizeof(uint32_t));
+    // smaller sorts never use smaller tiles than the smallest sort, nor more tiles than the group count limit
+    const uint32_t tiles = std::min(
+      tileCount((uint32_t) count, variantFor(ValueType::UINT32, width, payloads, 1)),
+      _context->getLimits().maxComputeWorkGroupCount[0]
+    );
+    scratch.state = _context->createBuffer(stateSize(tiles));
+    return scratch;
+  }
+
+
+  void RadixSort::destroyScratch(Scratch &scratch) {
+    _context->destroyBuffer(scratch.state);
+    _context->destroyBuffer(scratch.offsets);
+    _context->destroyBuffer(scratch.payloads);
+    _context->destroyBuffer(scratch.keys);
+    scratch = Scratch{};
+  }
+
+
+  void RadixSort::record(
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer *payloads,
+    uint32_t count,
+    ValueType type,
+    KeyWidth width,
+    const Scratch &scratch
+  ) {
+    if (count <= 1) {
+      return;
+    }
+    if (count > MAX_COUNT) {
+      throw std::runtime_error("radix sort supports up to 2^30 - 1 keys");
+    }
+    const bool hasPayloads = payloads != nullptr;
+    const KernelVariant variant = variantFor(type, width, hasPayloads, count);
+    const uint32_t tiles = tileCount(count, variant);
+    const VkDeviceSize stateBytes = stateSize(tiles);
+    const VkDeviceSize offsetsSize = (VkDeviceSize) passCount(width) * RADIX * sizeof(uint32_t);
+    if (scratch.capacity < count
+        || scratch.keys.size < (VkDeviceSize) count * (uint32_t) width * sizeof(uint32_t)
+        || (hasPayloads && scratch.payloads.size < (VkDeviceSize) count * sizeof(uint32_t))
+        || scratch.offsets.size < offsetsSize
+        || scratch.state.size < stateBytes) {
+      throw std::runtime_error("radix sort scratch is too small for the sort");
+    }
+    const Kernel histogram = _context->getKernel(_histogramInfo, variant);
+    const Kernel onesweep = _context->getKernel(_onesweepInfo, variant);
+    const VkDescriptorBufferInfo offsets = ComputeContext::bind(scratch.offsets, 0, offsetsSize);
+
+    /// DIGIT OFFSETS
+    _context->fill(scratch.offsets, 0, 0, offsetsSize);
+    _context->barrier();
+    const HistogramConstants histogramConstants{count};
+    _context->dispatch(histogram, {ComputeContext::bind(keys), offsets}, &histogramConstants, tiles);
+    _context->barrier();
+    _context->dispatch(_scan, {offsets}, nullptr, passCount(width));
+    _context->barrier();
+
+    /// PASSES
+    // without payloads, the payload bindings alias the keys and are never accessed
+    const AllocatedBuffer *keyBuffers[2] = {&keys, &scratch.keys};
+    const AllocatedBuffer *payloadBuffers[2] = {
+      hasPayloads ? payloads : &keys,
+      hasPayloads ? &scratch.payloads : &scratch.keys
+    };
+    for (uint32_t pass = 0; pass < passCount(width); pass++) {
+      const uint32_t src = pass % 2;
+      const uint32_t dst = 1 - src;
+      _context->fill(scratch.state, 0, 0, stateBytes);
+      _context->barrier();
+      const OnesweepConstants constants{count, pass};
+      _context->dispatch(
+        onesweep,
+        {
+          ComputeContext::bind(*keyBuffers[src]),
+          ComputeContext::bind(*keyBuffers[dst]),
+          ComputeContext::bind(*payloadBuffers[src]),
+          ComputeContext::bind(*payloadBuffers[dst]),
+          offsets,
+          ComputeContext::bind(scratch.state, 0, stateBytes)
+        },
+        &constants,
+        tiles
+      );
+      _context->barrier();
+    }
+  }
+
+
+  double RadixSort::sortBits(
+    const AllocatedBuffer &keys,
+    const AllocatedBuffer *payloads,
+    uint32_t count,
+    ValueType type,
+    KeyWidth width
+  ) {
+    Scratch scratch = createScratch(count, width, payloads != nullptr);
+    _context->begin();
+    record(keys, payloads, count, type, width, scratch);
+    const double ms = _context->submit();
+    destroyScratch(scratch);
+    return ms;
+  }
+
+
+  KernelVariant RadixSort::variantFor(ValueType type, KeyWidth width, bool payloads, uint32_t count) const {
+    return adjust(_tuned, type, width, payloads, count);
+  }
+
+
+  KernelVariant RadixSort::adjust(
+    KernelVariant variant,
+    ValueType type,
+    KeyWidth width,
+    bool payloads,
+    uint32_t count
+  ) const {
+    const VkPhysicalDeviceLimits &limits = _context->getLimits();
+    variant[VALUE_TYPE] = (uint32_t) type;
+    variant[KEY_WORDS] = (uint32_t) width;
+    variant[HAS_PAYLOAD] = payloads ? 1 : 0;
+    while (!_onesweepInfo.fits(variant, limits) && variant[ITEMS_PER_THREAD] > 1) {
+      variant[ITEMS_PER_THREAD] /= 2;
+    }
+
+    // the tiles aren't grid-strided: grow them until there are no more than maxComputeWorkGroupCount[0]
+    for (const uint32_t constant: {ITEMS_PER_THREAD, WORKGROUP_SIZE}) {
+      while (tileCount(count, variant) > limits.maxComputeWorkGroupCount[0]) {
+        KernelVariant larger = variant;
+        larger[constant] *= 2;
+        if (!_onesweepInfo.fits(larger, limits)) {
+          break;
+        }
+        variant = larger;
+      }
+    }
+    if (tileCount(count, variant) > limits.maxComputeWorkGroupCount[0]) {
+      throw std::runtime_error("radix sort: too many keys for maxComputeWorkGroupCount[0], even with the largest tile");
+    }
+    return variant;
+  }
+
+
+  VkDeviceSize RadixSort::stateSize(uint32_t tiles) const {
+    // tile counter, then a flag & count per digit per tile
+    return (1 + (VkDeviceSize) tiles * RADIX) * sizeof(uint32_t);
+  }
+
+} // walrus::primitives
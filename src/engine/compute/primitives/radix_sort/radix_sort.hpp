@@ -0,0 +1,126 @@
+#ifndef WALRUS_COMPUTE_ENGINE_RADIX_SORT_HPP
+#define WALRUS_COMPUTE_ENGINE_RADIX_SORT_HPP
+
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace walrus::primitives {
+
+  /// @brief how the radix sort compares keys of type K. 64 bit keys use the 32 bit type of the same kind
+  template<class K>
+  constexpr ValueType radixKeyType() {
+    static_assert(
+      std::is_same_v<K, uint32_t> || std::is_same_v<K, int32_t> || std::is_same_v<K, float>
+      || std::is_same_v<K, uint64_t> || std::is_same_v<K, int64_t> || std::is_same_v<K, double>,
+      "radix sort supports 32 & 64 bit uints, ints & floats"
+    );
+    if constexpr (std::is_floating_point_v<K>) {
+      return ValueType::FLOAT32;
+    } else if constexpr (std::is_signed_v<K>) {
+      return ValueType::INT32;
+    } else {
+      return ValueType::UINT32;
+    }
+  }
+
+  template<class K>
+  constexpr KeyWidth radixKeyWidth() {
+    return sizeof(K) == sizeof(uint64_t) ? KeyWidth::BITS_64 : KeyWidth::BITS_32;
+  }
+
+  /**
+   * @brief onesweep LSD radix sort of 32 or 64 bit keys, with optional 32 bit payloads, 8 bits per pass.
+   * one histogram kernel counts the digits of every pass up front, then each pass ranks & scatters the keys
+   * in a single dispatch using a per digit decoupled look-back (see shaders/compute/primitives/radix_onesweep.glsl).
+   * passes ping-pong between the caller's buffers and the scratch buffers. the pass count is even,
+   * so the sorted keys end up back in the caller's buffers. the sort is stable.
+   * @note ints & floats are sorted by value: negative numbers first, -0.0 before 0.0, nans by their bits
+   */
+  class RadixSort {
+  public:
+    /// @brief device buffers for sorts of up to `capacity` keys
+    struct Scratch {
+      AllocatedBuffer keys{};
+      AllocatedBuffer payloads{};
+      /// digit offsets of every pass
+      AllocatedBuffer offsets{};
+      /// look-back state of one pass
+      AllocatedBuffer state{};
+      uint32_t capacity = 0;
+    };
+
+    /// the look-back packs counts in 30 bits
+    static constexpr uint32_t MAX_COUNT = (1u << 30) - 1;
+
+    /// @brief builds (and on the first run per device, tunes) the kernels
+    void init(ComputeContext &context);
+
+    Scratch createScratch(uint32_t capacity, KeyWidth width, bool payloads);
+
+    void destroyScratch(Scratch &scratch);
+
+    /**
+     * @brief records the sort between ComputeContext::begin() and submit()
+     * @param payloads nullptr to sort keys only
+     */
+    void record(
+      const AllocatedBuffer &keys,
+      const AllocatedBuffer *payloads,
+      uint32_t count,
+      ValueType type,
+      KeyWidth width,
+      const Scratch &scratch
+    );
+
+    /// @brief sort `count` keys of type K in place. blocks until complete, returns the time in ms
+    template<class K>
+    double sort(const AllocatedBuffer &keys, uint32_t count) {
+      return sortBits(keys, nullptr, count, radixKeyType<K>(), radixKeyWidth<K>());
+    }
+
+    /// @brief sort `count` keys of type K in place, and their 32 bit payloads along with them
+    template<class K>
+    double sort(const AllocatedBuffer &keys, const AllocatedBuffer &payloads, uint32_t count) {
+      return sortBits(keys, &payloads, count, radixKeyType<K>(), radixKeyWidth<K>());
+    }
+
+    double sortBits(
+      const AllocatedBuffer &keys,
+      const AllocatedBuffer *payloads,
+      uint32_t count,
+      ValueType type,
+      KeyWidth width
+    );
+
+  private:
+    /**
+     * @brief the tuned variant, adjusted to the keys. larger keys may need smaller tiles to fit in shared memory,
+     * and more than maxComputeWorkGroupCount[0] tiles of `count` keys need larger ones.
+     * @throws std::runtime_error if no tile that fits in shared memory is large enough
+     */
+    [[nodiscard]] KernelVariant variantFor(ValueType type, KeyWidth width, bool payloads, uint32_t count) const;
+
+    /// @brief `variant` adjusted to the keys, as variantFor() adjusts the tuned variant
+    [[nodiscard]] KernelVariant adjust(
+      KernelVariant variant,
+      ValueType type,
+      KeyWidth width,
+      bool payloads,
+      uint32_t count
+    ) const;
+
+    /// @brief bytes of look-back state of one pass over `tiles` tiles
+    [[nodiscard]] VkDeviceSize stateSize(uint32_t tiles) const;
+
+    ComputeContext *_context = nullptr;
+    KernelInfo _histogramInfo{};
+    KernelInfo _onesweepInfo{};
+    KernelVariant _tuned{};
+    Kernel _scan{};
+  };
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_RADIX_SORT_HPP
@@ -0,0 +1,109 @@
+#include "reduce.hpp"
+
+#include <algorithm>
+
+namespace walrus::primitives {
+
+  namespace {
+    struct PushConstants {
+      uint32_t count;
+    };
+  }
+
+
+  void Reduce::init(ComputeContext &context) {
+    _context = &context;
+    const auto &deviceInfo = context.getDeviceInfo();
+    const KernelInfo info = kernelInfo(deviceInfo, "reduce", 2, sizeof(PushConstants), false);
+
+    AllocatedBuffer input = createTuningInput(context);
+    // the scratch size depends on the variant, so size it for the smallest candidate
+    AllocatedBuffer scratch = context.createBuffer(2 * (TUNING_COUNT / 64 + 1024) * sizeof(float));
+    const Kernel tuned = context.getTunedKernel(info, tuningKey(deviceInfo, "reduce"), [&](const Kernel &kernel) {
+      _kernels[(uint32_t) ValueType::FLOAT32] = kernel;
+      record(input, TUNING_COUNT, ValueType::FLOAT32, scratch);
+    });
+    context.destroyBuffer(input);
+    context.destroyBuffer(scratch);
+    _kernels = typedKernels(context, tuned);
+  }
+
+
+  VkDeviceSize Reduce::scratchCount(uint32_t count) const {
+    VkDeviceSize total = 0;
+    while (count > 1) {
+      count = groupCount(count);
+      total += alignCount(count);
+    }
+    return std::max<VkDeviceSize>(total, 1);
+  }
+
+
+  uint32_t Reduce::record(const AllocatedBuffer &input, uint32_t count, ValueType type, const AllocatedBuffer &scratch) {
+    const Kernel &kernel = getKernel(type);
+    if (count <= 1) {
+      // nothing to reduce, but the result is still expected in scratch
+      if (count == 1) {
+        _context->copy(input, scratch, sizeof(uint32_t));
+      } else {
+        _context->fill(scratch, 0, 0, sizeof(uint32_t));
+      }
+      _context->barrier();
+      return 0;
+    }
+
+    // each pass reads the previous pass's partial sums, and writes its own after them in `scratch`
+    VkDescriptorBufferInfo src = ComputeContext::bind(input);
+    uint32_t srcOffset = 0;
+    uint32_t dstOffset = 0;
+    while (count > 1) {
+      const uint32_t groups = groupCount(count);
+      const VkDescriptorBufferInfo dst = ComputeContext::bind(
+        scratch,
+        (VkDeviceSize) dstOffset * sizeof(uint32_t),
+        (VkDeviceSize) groups * sizeof(uint32_t)
+      );
+      const PushConstants constants{count};
+      _context->dispatch(kernel, {src, dst}, &constants, groups);
+      _context->barrier();
+
+      src = dst;
+      srcOffset = dstOffset;
+      dstOffset += alignCount(groups);
+      count = groups;
+    }
+    return srcOffset;
+  }
+
+
+  uint32_t Reduce::sumBits(const AllocatedBuffer &input, uint32_t count, ValueType type) {
+    AllocatedBuffer scratch = _context->createBuffer(scratchCount(count) * sizeof(uint32_t));
+    _context->begin();
+    const uint32_t index = record(input, count, type, scratch);
+    _context->submit();
+
+    uint32_t result = 0;
+    _context->download(scratch, &result, sizeof(result), (VkDeviceSize) index * sizeof(uint32_t));
+    _context->destroyBuffer(scratch);
+    return result;
+  }
+
+
+  uint32_t Reduce::groupCount(uint32_t count) const {
+    // every type shares the tuned sizes
+    const Kernel &kernel = _kernels[(uint32_t) ValueType::FLOAT32];
+    // capped at the device limit, the shader grid-strides over the remaining tiles
+    return std::min(
+      kernel.groupCount(count, kernel.variant[ITEMS_PER_THREAD]),
+      _context->getLimits().maxComputeWorkGroupCount[0]
+    );
+  }
+
+
+  uint32_t Reduce::alignCount(uint32_t count) const {
+    const auto alignment = (uint32_t) (_context->getLimits().minStorageBufferOffsetAlignment / sizeof(uint32_t));
+    const uint32_t elements = std::max<uint32_t>(alignment, 1);
+    return (count + elements - 1) / elements * elements;
+  }
+
+} // walrus::primitives
@@ -0,0 +1,54 @@
+#ifndef WALRUS_COMPUTE_ENGINE_REDUCE_HPP
+#define WALRUS_COMPUTE_ENGINE_REDUCE_HPP
+
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <cstdint>
+
+namespace walrus::primitives {
+
+  /**
+   * @brief multi-level reduction: sums a device buffer of 32 bit values.
+   * each pass reduces a workgroup's worth of values to one partial sum, until a single value is left.
+   * the workgroup size & items per invocation are tuned per device on first use.
+   * @note devices with subgroup arithmetic use a subgroup variant, with one barrier per pass instead of one per tree level
+   */
+  class Reduce {
+  public:
+    /// @brief builds (and on the first run per device, tunes) the kernels
+    void init(ComputeContext &context);
+
+    /// @brief number of values `record` needs in its scratch buffer
+    [[nodiscard]] VkDeviceSize scratchCount(uint32_t count) const;
+
+    /**
+     * @brief records every pass between ComputeContext::begin() and submit()
+     * @param scratch at least `scratchCount(count)` values
+     * @return the index of the sum in `scratch`
+     */
+    uint32_t record(const AllocatedBuffer &input, uint32_t count, ValueType type, const AllocatedBuffer &scratch);
+
+    /// @brief sum `count` values of `input`. blocks until the result is downloaded
+    template<class T>
+    T sum(const AllocatedBuffer &input, uint32_t count) {
+      return fromBits<T>(sumBits(input, count, valueTypeOf<T>()));
+    }
+
+    uint32_t sumBits(const AllocatedBuffer &input, uint32_t count, ValueType type);
+
+    [[nodiscard]] const Kernel &getKernel(ValueType type) const { return _kernels[(uint32_t) type]; }
+
+  private:
+    /// @brief partial sums written by one pass over `count` values, i.e. the groups it dispatches
+    [[nodiscard]] uint32_t groupCount(uint32_t count) const;
+
+    /// @brief scratch offsets are rounded up to the storage buffer offset alignment
+    [[nodiscard]] uint32_t alignCount(uint32_t count) const;
+
+    ComputeContext *_context = nullptr;
+    std::array<Kernel, VALUE_TYPE_COUNT> _kernels{};
+  };
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_REDUCE_HPP
@@ -0,0 +1,163 @@
+#ifndef WALRUS_COMPUTE_ENGINE_PRIMITIVES_REFERENCE_HPP
+#define WALRUS_COMPUTE_ENGINE_PRIMITIVES_REFERENCE_HPP
+
+#include "engine/compute/primitives/hash_table/hash_table.hpp"
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * CPU reference implementations of the primitives, used to check the kernels.
+ * ints wrap like the kernels do (two's complement), floats accumulate in double,
+ * so float results are the exact sum rounded once -- compare kernels against them with a tolerance.
+ */
+namespace walrus::primitives::reference {
+
+  namespace detail {
+    /// @brief floats are summed in double, ints in uint32 so overflow wraps instead of being undefined
+    template<class T>
+    using Accumulator = std::conditional_t<std::is_same_v<T, float>, double, uint32_t>;
+  }
+
+  template<class T>
+  T reduce(const std::vector<T> &values) {
+    detail::Accumulator<T> sum{};
+    for (const T &value: values) {
+      sum += (detail::Accumulator<T>) value;
+    }
+    return (T) sum;
+  }
+
+  template<class T>
+  std::vector<T> scan(const std::vector<T> &values, bool inclusive) {
+    std::vector<T> result(values.size());
+    detail::Accumulator<T> sum{};
+    for (size_t i = 0; i < values.size(); i++) {
+      if (!inclusive) {
+        result[i] = (T) sum;
+      }
+      sum += (detail::Accumulator<T>) values[i];
+      if (inclusive) {
+        result[i] = (T) sum;
+      }
+    }
+    return result;
+  }
+
+  template<class T>
+  bool isSelected(T value, Predicate predicate, T operand) {
+    switch (predicate) {
+      case Predicate::EQUAL:
+        return value == operand;
+      case Predicate::NOT_EQUAL:
+        return value != operand;
+      case Predicate::LESS:
+        return value < operand;
+      case Predicate::LESS_EQUAL:
+        return value <= operand;
+      case Predicate::GREATER:
+        return value > operand;
+      case Predicate::GREATER_EQUAL:
+        return value >= operand;
+    }
+    return false;
+  }
+
+  /// @brief selected values in order. when partitioning, followed by the rejected values in reverse order
+  template<class T>
+  std::vector<T> compact(const std::vector<T> &values, Predicate predicate, T operand, bool partition) {
+    std::vector<T> selected{};
+    std::vector<T> rejected{};
+    for (const T &value: values) {
+      if (isSelected(value, predicate, operand)) {
+        selected.push_back(value);
+      } else if (partition) {
+        rejected.push_back(value);
+      }
+    }
+    selected.insert(selected.end(), rejected.rbegin(), rejected.rend());
+    return selected;
+  }
+
+
+  /// @brief bits whose unsigned order is the order the radix sort gives `key`. see radix.glsl
+  template<class K>
+  auto orderedBits(K key) {
+    using Bits = std::conditional_t<sizeof(K) == sizeof(uint64_t), uint64_t, uint32_t>;
+    constexpr Bits SIGN_BIT = Bits(1) << (sizeof(Bits) * 8 - 1);
+    Bits bits = 0;
+    memcpy(&bits, &key, sizeof(bits));
+    if constexpr (std::is_floating_point_v<K>) {
+      return (bits & SIGN_BIT) != 0 ? (Bits) ~bits : (Bits) (bits ^ SIGN_BIT);
+    } else if constexpr (std::is_signed_v<K>) {
+      return (Bits) (bits ^ SIGN_BIT);
+    } else {
+      return bits;
+    }
+  }
+
+  /// @brief stable sort of `keys` by their ordered bits. `payloads` (if not null) are moved along with their keys
+  template<class K>
+  void sort(std::vector<K> &keys, std::vector<uint32_t> *payloads) {
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return orderedBits(keys[a]) < orderedBits(keys[b]);
+    });
+    std::vector<K> sortedKeys(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      sortedKeys[i] = keys[order[i]];
+    }
+    keys = std::move(sortedKeys);
+    if (payloads != nullptr) {
+      std::vector<uint32_t> sortedPayloads(payloads->size());
+      for (size_t i = 0; i < order.size(); i++) {
+        sortedPayloads[i] = (*payloads)[order[i]];
+      }
+      *payloads = std::move(sortedPayloads);
+    }
+  }
+
+  /**
+   * @brief the aggregate of the values of each key, as HashTable::aggregate leaves them in its table
+   * @param values ignored by COUNT
+   */
+  template<class K, class T>
+  std::unordered_map<K, detail::Accumulator<T>> groupBy(
+    const std::vector<K> &keys,
+    const std::vector<T> &values,
+    Aggregate aggregate
+  ) {
+    std::unordered_map<K, detail::Accumulator<T>> groups{};
+    for (size_t i = 0; i < keys.size(); i++) {
+      const T value = aggregate == Aggregate::COUNT ? T(1) : values[i];
+      const auto [group, inserted] = groups.try_emplace(keys[i], (detail::Accumulator<T>) value);
+      if (inserted) {
+        continue;
+      }
+      const T current = (T) group->second;
+      switch (aggregate) {
+        case Aggregate::SUM:
+        case Aggregate::COUNT:
+          group->second += (detail::Accumulator<T>) value;
+          break;
+        case Aggregate::MIN:
+          group->second = (detail::Accumulator<T>) std::min(current, value);
+          break;
+        case Aggregate::MAX:
+          group->second = (detail::Accumulator<T>) std::max(current, value);
+          break;
+      }
+    }
+    return groups;
+  }
+
+} // walrus::primitives::reference
+
+#endif //WALRUS_COMPUTE_ENGINE_PRIMITIVES_REFERENCE_HPP
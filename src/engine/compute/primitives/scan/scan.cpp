@@ -0,0 +1,93 @@
+#include "scan.hpp"
+
+#include <algorithm>
+
+namespace walrus::primitives {
+
+  namespace {
+    struct PushConstants {
+      uint32_t count;
+      uint32_t inclusive;
+    };
+  }
+
+
+  void Scan::init(ComputeContext &context) {
+    _context = &context;
+    const auto &deviceInfo = context.getDeviceInfo();
+    const KernelInfo info = kernelInfo(deviceInfo, "scan", 3, sizeof(PushConstants), true);
+
+    AllocatedBuffer input = createTuningInput(context);
+    AllocatedBuffer output = context.createBuffer(input.size);
+    AllocatedBuffer state{};
+    const Kernel tuned = context.getTunedKernel(info, tuningKey(deviceInfo, "scan"), [&](const Kernel &kernel) {
+      _kernels[(uint32_t) ValueType::FLOAT32] = kernel;
+      // the state size depends on the tile size of the variant
+      if (state.size < stateSize(TUNING_COUNT)) {
+        context.destroyBuffer(state);
+        state = context.createBuffer(stateSize(TUNING_COUNT));
+      }
+      record(input, output, TUNING_COUNT, ValueType::FLOAT32, true, state);
+    });
+    context.destroyBuffer(state);
+    context.destroyBuffer(output);
+    context.destroyBuffer(input);
+    _kernels = typedKernels(context, tuned);
+  }
+
+
+  VkDeviceSize Scan::stateSize(uint32_t count) const {
+    const uint32_t tile = tileSize(_kernels[(uint32_t) ValueType::FLOAT32]);
+    const uint32_t tiles = (count + tile - 1) / tile;
+    // tile counter, then a flag, aggregate & inclusive prefix per tile
+    return (1 + (VkDeviceSize) tiles * 3) * sizeof(uint32_t);
+  }
+
+
+  void Scan::record(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    uint32_t count,
+    ValueType type,
+    bool inclusive,
+    const AllocatedBuffer &state
+  ) {
+    if (count == 0) {
+      return;
+    }
+    const Kernel &kernel = getKernel(type);
+    const VkDeviceSize size = stateSize(count);
+    _context->fill(state, 0, 0, size);
+    _context->barrier();
+
+    const PushConstants constants{count, inclusive ? 1u : 0u};
+    _context->dispatch(
+      kernel,
+      {ComputeContext::bind(input), ComputeContext::bind(output), ComputeContext::bind(state, 0, size)},
+      &constants,
+      // capped at the device limit, the groups acquire tiles until there are none left
+      std::min(
+        kernel.groupCount(count, kernel.variant[ITEMS_PER_THREAD]),
+        _context->getLimits().maxComputeWorkGroupCount[0]
+      )
+    );
+    _context->barrier();
+  }
+
+
+  double Scan::run(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    uint32_t count,
+    ValueType type,
+    bool inclusive
+  ) {
+    AllocatedBuffer state = _context->createBuffer(stateSize(count));
+    _context->begin();
+    record(input, output, count, type, inclusive, state);
+    const double ms = _context->submit();
+    _context->destroyBuffer(state);
+    return ms;
+  }
+
+} // walrus::primitives
@@ -0,0 +1,55 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SCAN_HPP
+#define WALRUS_COMPUTE_ENGINE_SCAN_HPP
+
+#include "engine/compute/primitives/primitives.hpp"
+
+#include <cstdint>
+
+namespace walrus::primitives {
+
+  /**
+   * @brief single pass inclusive / exclusive prefix sum of 32 bit values, using decoupled look-back.
+   * each workgroup scans a tile, publishes its aggregate, and looks back over the previous tiles for its prefix,
+   * so the input is read once and the output written once in a single dispatch.
+   * the groups are capped at maxComputeWorkGroupCount[0], each scans tiles until none are left.
+   */
+  class Scan {
+  public:
+    /// @brief builds (and on the first run per device, tunes) the kernels
+    void init(ComputeContext &context);
+
+    /// @brief bytes of look-back state `record` needs for `count` values
+    [[nodiscard]] VkDeviceSize stateSize(uint32_t count) const;
+
+    /**
+     * @brief records the scan between ComputeContext::begin() and submit(). `state` is cleared by the recording.
+     * @note `input` and `output` may not alias
+     */
+    void record(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      uint32_t count,
+      ValueType type,
+      bool inclusive,
+      const AllocatedBuffer &state
+    );
+
+    /// @brief scan `count` values of `input` into `output`. blocks until complete, returns the time in ms
+    double run(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      uint32_t count,
+      ValueType type,
+      bool inclusive
+    );
+
+    [[nodiscard]] const Kernel &getKernel(ValueType type) const { return _kernels[(uint32_t) type]; }
+
+  private:
+    ComputeContext *_context = nullptr;
+    std::array<Kernel, VALUE_TYPE_COUNT> _kernels{};
+  };
+
+} // walrus::primitives
+
+#endif //WALRUS_COMPUTE_ENGINE_SCAN_HPP
@@ -0,0 +1,139 @@
+#include "resource_registry.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace walrus {
+
+  namespace {
+    template<class T, class Tag>
+    const T &lookup(const HandleRegistry<T, Tag> &registry, Handle<Tag> handle, const char *what) {
+      const T *value = registry.get(handle);
+      if (value == nullptr) {
+        throw std::runtime_error(std::string("resource registry: stale or null ") + what + " handle");
+      }
+      return *value;
+    }
+  }
+
+
+
+
+  void ResourceRegistry::init(VkDevice device, VmaAllocator allocator) {
+    _device = device;
+    _allocator = allocator;
+  }
+
+
+  void ResourceRegistry::destroy() {
+    for (const auto &pipeline: _pipelines.values()) {
+      vkDestroyPipeline(_device, pipeline, nullptr);
+    }
+    for (const auto &image: _images.values()) {
+      vmaDestroyImage(_allocator, image.image, image.allocation);
+    }
+    for (const auto &buffer: _buffers.values()) {
+      vmaDestroyBuffer(_allocator, buffer.buffer, buffer.allocation);
+    }
+    for (const auto &semaphore: _semaphores.values()) {
+      vkDestroySemaphore(_device, semaphore, nullptr);
+    }
+    for (const auto &fence: _fences.values()) {
+      vkDestroyFence(_device, fence, nullptr);
+    }
+    _pipelines.clear();
+    _images.clear();
+    _buffers.clear();
+    _semaphores.clear();
+    _fences.clear();
+  }
+
+
+  FenceHandle ResourceRegistry::createFence(VkFenceCreateFlags flags) {
+    VkFenceCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    info.flags = flags;
+    VkFence fence = VK_NULL_HANDLE;
+    if (vkCreateFence(_device, &info, nullptr, &fence) != VK_SUCCESS) {
+      throw std::runtime_error("resource registry: failed to create fence");
+    }
+    return _fences.insert(fence);
+  }
+
+
+  SemaphoreHandle ResourceRegistry::createSemaphore() {
+    VkSemaphoreCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    if (vkCreateSemaphore(_device, &info, nullptr, &semaphore) != VK_SUCCESS) {
+      throw std::runtime_error("resource registry: failed to create semaphore");
+    }
+    return _semaphores.insert(semaphore);
+  }
+
+
+  const AllocatedBuffer &ResourceRegistry::buffer(BufferHandle handle) const {
+    return lookup(_buffers, handle, "buffer");
+  }
+
+
+  const AllocatedImage &ResourceRegistry::image(ImageHandle handle) const {
+    return lookup(_images, handle, "image");
+  }
+
+
+  VkPipeline ResourceRegistry::pipeline(PipelineHandle handle) const {
+    return lookup(_pipelines, handle, "pipeline");
+  }
+
+
+  VkFence ResourceRegistry::fence(FenceHandle handle) const {
+    return lookup(_fences, handle, "fence");
+  }
+
+
+  VkSemaphore ResourceRegistry::semaphore(SemaphoreHandle handle) const {
+    return lookup(_semaphores, handle, "semaphore");
+  }
+
+
+  void ResourceRegistry::release(BufferHandle handle, DeletionQueue &deletionQueue, uint64_t value) {
+    AllocatedBuffer buffer{};
+    if (_buffers.remove(handle, &buffer)) {
+      deletionQueue.retireBuffer(buffer, value);
+    }
+  }
+
+
+  void ResourceRegistry::release(ImageHandle handle, DeletionQueue &deletionQueue, uint64_t value) {
+    AllocatedImage image{};
+    if (_images.remove(handle, &image)) {
+      deletionQueue.retireImage(image.image, image.allocation, value);
+    }
+  }
+
+
+  void ResourceRegistry::release(PipelineHandle handle, DeletionQueue &deletionQueue, uint64_t value) {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (_pipelines.remove(handle, &pipeline)) {
+      deletionQueue.retirePipeline(pipeline, value);
+    }
+  }
+
+
+  void ResourceRegistry::release(FenceHandle handle, DeletionQueue &deletionQueue, uint64_t value) {
+    VkFence fence = VK_NULL_HANDLE;
+    if (_fences.remove(handle, &fence)) {
+      deletionQueue.retireFence(fence, value);
+    }
+  }
+
+
+  void ResourceRegistry::release(SemaphoreHandle handle, DeletionQueue &deletionQueue, uint64_t value) {
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    if (_semaphores.remove(handle, &semaphore)) {
+      deletionQueue.retireSemaphore(semaphore, value);
+    }
+  }
+
+} // walrus
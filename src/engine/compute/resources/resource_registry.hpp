@@ -0,0 +1,101 @@
+#ifndef WALRUS_COMPUTE_ENGINE_RESOURCE_REGISTRY_HPP
+#define WALRUS_COMPUTE_ENGINE_RESOURCE_REGISTRY_HPP
+
+#include "engine/compute/synchronize/deletion/deletion_queue.hpp"
+#include "engine/utils/handle_registry/handle_registry.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+
+namespace walrus {
+
+  /// tags of the registry handles. vulkan handles can share a type (32 bit builds), the tags keep them apart
+  struct BufferTag;
+  struct ImageTag;
+  struct PipelineTag;
+  struct FenceTag;
+  struct SemaphoreTag;
+
+  using BufferHandle = Handle<BufferTag>;
+  using ImageHandle = Handle<ImageTag>;
+  using PipelineHandle = Handle<PipelineTag>;
+  using FenceHandle = Handle<FenceTag>;
+  using SemaphoreHandle = Handle<SemaphoreTag>;
+
+  /**
+   * @brief owns the engine's buffers, images, pipelines, fences & semaphores behind generational handles.
+   * handles stay valid as the registry grows, unlike pointers into a vector, and lookups of released objects fail
+   * instead of returning a destroyed (or reused) vulkan handle.
+   * release() hands an object to a DeletionQueue, so it can be dropped while the device may still use it.
+   * @note not thread safe
+   */
+  class ResourceRegistry {
+  public:
+    void init(VkDevice device, VmaAllocator allocator);
+
+    /// @brief destroys everything still registered. the device must be idle
+    void destroy();
+
+    /// CREATE & ADOPT
+    FenceHandle createFence(VkFenceCreateFlags flags = 0);
+
+    SemaphoreHandle createSemaphore();
+
+    /// @brief takes ownership of a buffer created elsewhere, i.e. by ComputeContext::createBuffer
+    BufferHandle addBuffer(const AllocatedBuffer &buffer) { return _buffers.insert(buffer); }
+
+    ImageHandle addImage(const AllocatedImage &image) { return _images.insert(image); }
+
+    PipelineHandle addPipeline(VkPipeline pipeline) { return _pipelines.insert(pipeline); }
+
+    /// LOOKUP
+    // throw on stale handles. get() of each registry returns null instead
+    [[nodiscard]] const AllocatedBuffer &buffer(BufferHandle handle) const;
+
+    [[nodiscard]] const AllocatedImage &image(ImageHandle handle) const;
+
+    [[nodiscard]] VkPipeline pipeline(PipelineHandle handle) const;
+
+    [[nodiscard]] VkFence fence(FenceHandle handle) const;
+
+    [[nodiscard]] VkSemaphore semaphore(SemaphoreHandle handle) const;
+
+    /// RELEASE
+    // unregister now, destroy once the deletion queue reaches `value`. stale handles are ignored
+    void release(BufferHandle handle, DeletionQueue &deletionQueue, uint64_t value);
+
+    void release(ImageHandle handle, DeletionQueue &deletionQueue, uint64_t value);
+
+    void release(PipelineHandle handle, DeletionQueue &deletionQueue, uint64_t value);
+
+    void release(FenceHandle handle, DeletionQueue &deletionQueue, uint64_t value);
+
+    void release(SemaphoreHandle handle, DeletionQueue &deletionQueue, uint64_t value);
+
+    /// ITERATION
+    [[nodiscard]] const HandleRegistry<AllocatedBuffer, BufferTag> &buffers() const { return _buffers; }
+
+    [[nodiscard]] const HandleRegistry<AllocatedImage, ImageTag> &images() const { return _images; }
+
+    [[nodiscard]] const HandleRegistry<VkPipeline, PipelineTag> &pipelines() const { return _pipelines; }
+
+    /// @brief contiguous, so every fence can be waited on with one vkWaitForFences
+    [[nodiscard]] const HandleRegistry<VkFence, FenceTag> &fences() const { return _fences; }
+
+    [[nodiscard]] const HandleRegistry<VkSemaphore, SemaphoreTag> &semaphores() const { return _semaphores; }
+
+  private:
+    VkDevice _device = VK_NULL_HANDLE;
+    VmaAllocator _allocator = nullptr;
+
+    HandleRegistry<AllocatedBuffer, BufferTag> _buffers{};
+    HandleRegistry<AllocatedImage, ImageTag> _images{};
+    HandleRegistry<VkPipeline, PipelineTag> _pipelines{};
+    HandleRegistry<VkFence, FenceTag> _fences{};
+    HandleRegistry<VkSemaphore, SemaphoreTag> _semaphores{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_RESOURCE_REGISTRY_HPP
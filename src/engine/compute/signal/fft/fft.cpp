@@ -0,0 +1,310 @@
+#include "fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace walrus::signal {
+
+  namespace {
+    /// matches `Layout` in fft.glsl
+    struct Layout {
+      uint32_t elementStride;
+      uint32_t signalStride;
+      uint32_t blockSignals;
+      uint32_t blockStride;
+    };
+
+    struct SharedConstants {
+      Layout layout;
+      uint32_t batch;
+      float direction;
+      float scale;
+    };
+
+    struct GlobalConstants {
+      Layout layout;
+      uint32_t batch;
+      float direction;
+      float scale;
+      uint32_t size;
+      uint32_t stride;
+    };
+
+    struct RealConstants {
+      uint32_t halfSize;
+      uint32_t batch;
+    };
+
+    /// matches fft_shared.comp
+    enum SpecConstantId : uint32_t {
+      WORKGROUP_SIZE = 0,
+      SIZE = 1,
+      SIGNALS = 2,
+    };
+
+    constexpr uint32_t GLOBAL_WORKGROUP_SIZE = 256;
+    /// small signals are packed into workgroups of at least this many invocations
+    constexpr uint32_t MIN_SHARED_WORKGROUP_SIZE = 64;
+    /// values held by each invocation of the shared memory kernel
+    constexpr uint32_t VALUES_PER_INVOCATION = 8;
+    /// largest transform tried in shared memory. 64 KiB of shared memory
+    constexpr uint32_t MAX_SHARED_SIZE = 1u << 13;
+
+    constexpr bool isPowerOf2(uint32_t value) {
+      return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    uint32_t log2(uint32_t value) {
+      uint32_t bits = 0;
+      while (value > 1) {
+        value >>= 1;
+        bits++;
+      }
+      return bits;
+    }
+
+    /// @brief the radix of each pass, as in fft.glsl: the remainder first, then radix 8
+    std::vector<uint32_t> radices(uint32_t size) {
+      const uint32_t bits = log2(size);
+      std::vector<uint32_t> passes{};
+      if (bits % 3 != 0) {
+        passes.push_back(1u << (bits % 3));
+      }
+      passes.insert(passes.end(), bits / 3, 8);
+      return passes;
+    }
+
+    uint32_t radixIndex(uint32_t radix) {
+      return log2(radix) - 1;
+    }
+
+    KernelInfo kernelInfo(const char *fileName, uint32_t pushConstantSize) {
+      KernelInfo info{};
+      info.fileName = fileName;
+      info.bindingCount = 2;
+      info.pushConstantSize = pushConstantSize;
+      info.specConstants = {{WORKGROUP_SIZE, "WORKGROUP_SIZE", GLOBAL_WORKGROUP_SIZE, {}}};
+      info.workgroupSize = {"WORKGROUP_SIZE", nullptr, nullptr};
+      return info;
+    }
+  }
+
+
+  VkDeviceSize FftPlan::inputSize() const {
+    return points() * (real ? sizeof(float) : 2 * sizeof(float));
+  }
+
+
+  VkDeviceSize FftPlan::outputSize() const {
+    const uint64_t values = real ? (uint64_t) (width / 2 + 1) * batch : points();
+    return values * 2 * sizeof(float);
+  }
+
+
+  void Fft::init(ComputeContext &context) {
+    _context = &context;
+
+    _sharedInfo = kernelInfo("fft_shared.comp.spv", sizeof(SharedConstants));
+    _sharedInfo.specConstants = {
+      {WORKGROUP_SIZE, "WORKGROUP_SIZE", MIN_SHARED_WORKGROUP_SIZE, {}},
+      {SIZE, "SIZE", 256, {}},
+      {SIGNALS, "SIGNALS", 1, {}},
+    };
+    _sharedInfo.isSupported = [](const KernelVariant &variant, const VkPhysicalDeviceLimits &limits) {
+      const uint64_t values = (uint64_t) variant[SIZE] * variant[SIGNALS];
+      return values * 2 * sizeof(float) <= limits.maxComputeSharedMemorySize;
+    };
+    _maxSharedSize = 0;
+    for (uint32_t size = 2; size <= MAX_SHARED_SIZE && _sharedInfo.fits(sharedVariant(size), context.getLimits()); size *= 2) {
+      _maxSharedSize = size;
+    }
+
+    KernelInfo globalInfo = kernelInfo("fft_global.comp.spv", sizeof(GlobalConstants));
+    globalInfo.specConstants.push_back({1, "RADIX", 8, {}});
+    for (uint32_t radix: {2u, 4u, 8u}) {
+      KernelVariant variant = globalInfo.defaultVariant();
+      variant[1] = radix;
+      _global[radixIndex(radix)] = context.getKernel(globalInfo, variant);
+    }
+    _real = context.getKernel(kernelInfo("fft_real.comp.spv", sizeof(RealConstants)));
+  }
+
+
+  void Fft::validate(const FftPlan &plan, Direction direction) {
+    if (!isPowerOf2(plan.width) || plan.width < 2 || !isPowerOf2(plan.height)) {
+      throw std::runtime_error(
+        "fft sizes must be powers of 2: " + std::to_string(plan.width) + " x " + std::to_string(plan.height)
+      );
+    }
+    if (plan.real && (plan.height != 1 || direction != Direction::FORWARD)) {
+      throw std::runtime_error("real fft plans are 1D forward transforms");
+    }
+    if (plan.real && plan.width < 4) {
+      throw std::runtime_error("real ffts need at least 4 points");
+    }
+    // offsets are 32 bit in the kernels
+    if (plan.outputSize() / (2 * sizeof(float)) > UINT32_MAX) {
+      throw std::runtime_error("fft plan too large: " + std::to_string(plan.points()) + " points");
+    }
+  }
+
+
+  Fft::Scratch Fft::createScratch(const FftPlan &plan) {
+    // complex values of the transform, before any unpacking
+    const VkDeviceSize size = plan.real ? plan.inputSize() : plan.outputSize();
+    Scratch scratch{};
+    if (plan.real || plan.height > 1 || plan.width > _maxSharedSize) {
+      scratch.first = _context->createBuffer(size);
+    }
+    if (plan.height > _maxSharedSize) {
+      scratch.second = _context->createBuffer(size);
+    }
+    return scratch;
+  }
+
+
+  void Fft::destroyScratch(Scratch &scratch) {
+    _context->destroyBuffer(scratch.second);
+    _context->destroyBuffer(scratch.first);
+    scratch = Scratch{};
+  }
+
+
+  void Fft::record(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    const FftPlan &plan,
+    Direction direction,
+    const Scratch &scratch
+  ) {
+    validate(plan, direction);
+    if (plan.batch == 0) {
+      return;
+    }
+
+    if (plan.real) {
+      // the packed transform is half the size, and contiguous. the output isn't written yet, so it can be the temp
+      const uint32_t halfSize = plan.width / 2;
+      recordAxis(input, scratch.first, output, {1, halfSize, plan.batch, 0, halfSize, plan.batch}, direction);
+      const RealConstants constants{halfSize, plan.batch};
+      const uint64_t bins = (uint64_t) (halfSize + 1) * plan.batch;
+      _context->dispatch(
+        _real,
+        {ComputeContext::bind(scratch.first), ComputeContext::bind(output)},
+        &constants,
+        groupCount(_real, bins)
+      );
+      _context->barrier();
+      return;
+    }
+
+    const uint32_t rows = plan.height * plan.batch;
+    if (plan.height == 1) {
+      recordAxis(input, output, scratch.first, {1, plan.width, rows, 0, plan.width, rows}, direction);
+      return;
+    }
+    // rows into the scratch, then columns into the output: column c of image i starts at i * width * height + c
+    const uint32_t imageSize = plan.width * plan.height;
+    recordAxis(input, scratch.first, output, {1, plan.width, rows, 0, plan.width, rows}, direction);
+    recordAxis(
+      scratch.first,
+      output,
+      scratch.second,
+      {plan.width, 1, plan.width, imageSize, plan.height, plan.width * plan.batch},
+      direction
+    );
+  }
+
+
+  double Fft::transform(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    const FftPlan &plan,
+    Direction direction
+  ) {
+    validate(plan, direction);
+    Scratch scratch = createScratch(plan);
+    _context->begin();
+    record(input, output, plan, direction, scratch);
+    const double ms = _context->submit();
+    destroyScratch(scratch);
+    return ms;
+  }
+
+
+  double Fft::flops(const FftPlan &plan) {
+    const double points = (double) plan.points();
+    const double complexFlops = 5.0 * points * std::log2((double) plan.width * plan.height);
+    return plan.real ? complexFlops / 2.0 : complexFlops;
+  }
+
+
+  void Fft::recordAxis(
+    const AllocatedBuffer &input,
+    const AllocatedBuffer &output,
+    const AllocatedBuffer &temp,
+    const Axis &axis,
+    Direction direction
+  ) {
+    const Layout layout{axis.elementStride, axis.signalStride, axis.blockSignals, axis.blockStride};
+    const auto sign = (float) direction;
+    const float scale = direction == Direction::INVERSE ? 1.f / (float) axis.size : 1.f;
+
+    if (axis.size <= _maxSharedSize) {
+      const Kernel kernel = _context->getKernel(_sharedInfo, sharedVariant(axis.size));
+      const uint32_t signals = kernel.variant[SIGNALS];
+      const SharedConstants constants{layout, axis.count, sign, scale};
+      const uint64_t groups = (axis.count + signals - 1) / signals;
+      _context->dispatch(
+        kernel,
+        {ComputeContext::bind(input), ComputeContext::bind(output)},
+        &constants,
+        groupCount(kernel, groups * kernel.localSize[0])
+      );
+      _context->barrier();
+      return;
+    }
+
+    // the passes alternate between the output & temp, ending in the output
+    const std::vector<uint32_t> passes = radices(axis.size);
+    const AllocatedBuffer *source = &input;
+    uint32_t stride = 1;
+    for (size_t pass = 0; pass < passes.size(); pass++) {
+      const uint32_t radix = passes[pass];
+      const bool last = pass + 1 == passes.size();
+      const AllocatedBuffer *destination = (passes.size() - 1 - pass) % 2 == 0 ? &output : &temp;
+      const Kernel &kernel = _global[radixIndex(radix)];
+      const GlobalConstants constants{layout, axis.count, sign, last ? scale : 1.f, axis.size, stride};
+      _context->dispatch(
+        kernel,
+        {ComputeContext::bind(*source), ComputeContext::bind(*destination)},
+        &constants,
+        groupCount(kernel, (uint64_t) axis.size / radix * axis.count)
+      );
+      _context->barrier();
+      source = destination;
+      stride *= radix;
+    }
+  }
+
+
+  KernelVariant Fft::sharedVariant(uint32_t size) {
+    const uint32_t invocations = std::max<uint32_t>(size / VALUES_PER_INVOCATION, 1);
+    const uint32_t signals = std::max<uint32_t>(MIN_SHARED_WORKGROUP_SIZE / invocations, 1);
+    KernelVariant variant(3);
+    variant[WORKGROUP_SIZE] = invocations * signals;
+    variant[SIZE] = size;
+    variant[SIGNALS] = signals;
+    return variant;
+  }
+
+
+  uint32_t Fft::groupCount(const Kernel &kernel, uint64_t invocations) const {
+    const uint32_t groups = kernel.groupCount(std::max<uint64_t>(invocations, 1));
+    return std::min(groups, _context->getLimits().maxComputeWorkGroupCount[0]);
+  }
+
+} // walrus::signal
@@ -0,0 +1,128 @@
+#ifndef WALRUS_COMPUTE_ENGINE_FFT_HPP
+#define WALRUS_COMPUTE_ENGINE_FFT_HPP
+
+#include "engine/compute/context/compute_context.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace walrus::signal {
+
+  /// @brief sign of the exponent. inverse transforms are scaled by 1 / points, so they undo forward ones
+  enum class Direction : int32_t {
+    FORWARD = -1,
+    INVERSE = 1,
+  };
+
+  /**
+   * @brief a batch of transforms. complex values are interleaved 32 bit floats (real, imaginary),
+   * 2D signals are row major, and the signals of a batch are contiguous
+   */
+  struct FftPlan {
+    /// points per row. a power of 2, at least 2
+    uint32_t width = 0;
+    /// rows. 1 = 1D transforms, otherwise a power of 2
+    uint32_t height = 1;
+    uint32_t batch = 1;
+    /// real-to-complex: real input, and width / 2 + 1 complex bins per signal. 1D forward transforms only
+    bool real = false;
+
+    [[nodiscard]] uint64_t points() const { return (uint64_t) width * height * batch; }
+
+    [[nodiscard]] VkDeviceSize inputSize() const;
+
+    [[nodiscard]] VkDeviceSize outputSize() const;
+  };
+
+  /**
+   * @brief batched 1D & 2D Stockham FFTs with radix 2, 4 & 8 passes (see shaders/compute/signal/fft.glsl).
+   * transforms that fit in shared memory run every pass in one dispatch, a workgroup per signal (or several small
+   * signals per workgroup). larger ones run a dispatch per pass through global memory, ping-ponging with scratch.
+   * either way, a whole batch is transformed by each dispatch. 2D transforms run the rows, then the columns.
+   * real-to-complex transforms pack the signal in a complex one of half the size, and unpack the bins after it.
+   * @note transforms are out of place: the input is never written, and must not alias the output
+   * @note the kernel sizes follow from the transform size, they aren't tuned
+   */
+  class Fft {
+  public:
+    /// @brief device buffers for the intermediate results of a plan
+    struct Scratch {
+      /// global passes ping-pong with it, and 2D & real transforms keep their first stage in it
+      AllocatedBuffer first{};
+      /// the global passes of 2D columns ping-pong with it
+      AllocatedBuffer second{};
+    };
+
+    void init(ComputeContext &context);
+
+    /// @brief the largest transform run in shared memory. larger ones take a dispatch per pass
+    [[nodiscard]] uint32_t getMaxSharedSize() const { return _maxSharedSize; }
+
+    /// @brief throws if the plan isn't supported
+    static void validate(const FftPlan &plan, Direction direction);
+
+    Scratch createScratch(const FftPlan &plan);
+
+    void destroyScratch(Scratch &scratch);
+
+    /**
+     * @brief records the transforms between ComputeContext::begin() and submit()
+     * @param input `plan.inputSize()` bytes
+     * @param output `plan.outputSize()` bytes
+     */
+    void record(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      const FftPlan &plan,
+      Direction direction,
+      const Scratch &scratch
+    );
+
+    /// @brief transforms `input` into `output`. blocks until complete, returns the time in ms
+    double transform(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      const FftPlan &plan,
+      Direction direction = Direction::FORWARD
+    );
+
+    /// @brief the conventional 5 N log2(N) floating point operations of a complex transform, half for real ones
+    static double flops(const FftPlan &plan);
+
+  private:
+    /// @brief where the signals of one axis are, in complex values. see `Layout` in fft.glsl
+    struct Axis {
+      uint32_t elementStride;
+      uint32_t signalStride;
+      uint32_t blockSignals;
+      uint32_t blockStride;
+      uint32_t size;
+      uint32_t count;
+    };
+
+    /// @brief transforms every signal of one axis from `input` to `output`. `temp` holds the odd global passes
+    void recordAxis(
+      const AllocatedBuffer &input,
+      const AllocatedBuffer &output,
+      const AllocatedBuffer &temp,
+      const Axis &axis,
+      Direction direction
+    );
+
+    /// @brief the shared memory kernel variant of a size: its workgroup size, size & signals per workgroup
+    [[nodiscard]] static KernelVariant sharedVariant(uint32_t size);
+
+    /// @brief workgroups for `invocations`, capped at the dispatch limit. the kernels stride over the rest
+    [[nodiscard]] uint32_t groupCount(const Kernel &kernel, uint64_t invocations) const;
+
+    ComputeContext *_context = nullptr;
+    KernelInfo _sharedInfo{};
+    uint32_t _maxSharedSize = 0;
+    /// one per radix: 2, 4 & 8
+    std::array<Kernel, 3> _global{};
+    Kernel _real{};
+  };
+
+} // walrus::signal
+
+#endif //WALRUS_COMPUTE_ENGINE_FFT_HPP
@@ -0,0 +1,69 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SIGNAL_REFERENCE_HPP
+#define WALRUS_COMPUTE_ENGINE_SIGNAL_REFERENCE_HPP
+
+#include "engine/compute/signal/fft/fft.hpp"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+/**
+ * CPU reference implementations of the signal kernels, used to check them.
+ * direct DFTs in double, one bin at a time: O(N) per bin, so check a few bins of large transforms.
+ * complex values are interleaved floats (real, imaginary), as on the device.
+ */
+namespace walrus::signal::reference {
+
+  constexpr double PI = 3.14159265358979323846;
+
+  /// @brief exp(direction * 2 pi i * numerator / denominator)
+  inline std::complex<double> twiddle(uint64_t numerator, uint64_t denominator, Direction direction) {
+    const double angle = (double) direction * 2.0 * PI * (double) (numerator % denominator) / (double) denominator;
+    return std::polar(1.0, angle);
+  }
+
+  /// @brief one bin of the DFT of `size` complex values, `stride` complex values apart. inverse DFTs are scaled by 1 / size
+  inline std::complex<double> dftBin(
+    const float *values,
+    uint32_t size,
+    uint32_t bin,
+    Direction direction,
+    uint32_t stride = 1
+  ) {
+    std::complex<double> sum{};
+    for (uint32_t n = 0; n < size; n++) {
+      const float *value = values + 2 * (size_t) n * stride;
+      sum += std::complex<double>(value[0], value[1]) * twiddle((uint64_t) bin * n, size, direction);
+    }
+    return direction == Direction::INVERSE ? sum / (double) size : sum;
+  }
+
+  /// @brief one bin of the 2D DFT of a row major `width` x `height` signal
+  inline std::complex<double> dft2DBin(
+    const float *values,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row,
+    uint32_t col,
+    Direction direction
+  ) {
+    std::complex<double> sum{};
+    for (uint32_t y = 0; y < height; y++) {
+      const std::complex<double> rowBin = dftBin(values + 2 * (size_t) y * width, width, col, direction);
+      sum += rowBin * twiddle((uint64_t) row * y, height, direction);
+    }
+    return direction == Direction::INVERSE ? sum / (double) height : sum;
+  }
+
+  /// @brief one bin of the forward DFT of `size` real values
+  inline std::complex<double> realDftBin(const float *values, uint32_t size, uint32_t bin) {
+    std::complex<double> sum{};
+    for (uint32_t n = 0; n < size; n++) {
+      sum += (double) values[n] * twiddle((uint64_t) bin * n, size, Direction::FORWARD);
+    }
+    return sum;
+  }
+
+} // walrus::signal::reference
+
+#endif //WALRUS_COMPUTE_ENGINE_SIGNAL_REFERENCE_HPP
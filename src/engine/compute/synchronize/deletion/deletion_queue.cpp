@@ -0,0 +1,154 @@
+#include "deletion_queue.hpp"
+
+namespace walrus {
+
+  namespace {
+    /// @brief destroys the entries the device is done with, and compacts the others in place (keeping the capacity)
+    template<class Entry, class Destroy>
+    uint32_t collectEntries(std::vector<Entry> &entries, uint64_t completed, Destroy destroy) {
+      size_t kept = 0;
+      for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].value <= completed) {
+          destroy(entries[i].handle);
+        } else {
+          entries[kept++] = entries[i];
+        }
+      }
+      const auto destroyed = (uint32_t) (entries.size() - kept);
+      entries.resize(kept);
+      return destroyed;
+    }
+  }
+
+
+
+
+  void DeletionQueue::init(VkDevice device, VmaAllocator allocator) {
+    _device = device;
+    _allocator = allocator;
+    _stats = Stats{};
+  }
+
+
+  void DeletionQueue::retirePipeline(VkPipeline pipeline, uint64_t value) {
+    if (pipeline == VK_NULL_HANDLE) {
+      return;
+    }
+    _pipelines.push_back({pipeline, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireBuffer(VkBuffer buffer, VmaAllocation allocation, uint64_t value) {
+    if (buffer == VK_NULL_HANDLE) {
+      return;
+    }
+    _buffers.push_back({{buffer, allocation}, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireImage(VkImage image, VmaAllocation allocation, uint64_t value) {
+    if (image == VK_NULL_HANDLE) {
+      return;
+    }
+    _images.push_back({{image, allocation}, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireImageView(VkImageView imageView, uint64_t value) {
+    if (imageView == VK_NULL_HANDLE) {
+      return;
+    }
+    _imageViews.push_back({imageView, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireFramebuffer(VkFramebuffer framebuffer, uint64_t value) {
+    if (framebuffer == VK_NULL_HANDLE) {
+      return;
+    }
+    _framebuffers.push_back({framebuffer, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireSemaphore(VkSemaphore semaphore, uint64_t value) {
+    if (semaphore == VK_NULL_HANDLE) {
+      return;
+    }
+    _semaphores.push_back({semaphore, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireFence(VkFence fence, uint64_t value) {
+    if (fence == VK_NULL_HANDLE) {
+      return;
+    }
+    _fences.push_back({fence, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireDescriptorPool(VkDescriptorPool descriptorPool, uint64_t value) {
+    if (descriptorPool == VK_NULL_HANDLE) {
+      return;
+    }
+    _descriptorPools.push_back({descriptorPool, value});
+    _stats.retired++;
+  }
+
+
+  void DeletionQueue::retireCommandPool(VkCommandPool commandPool, uint64_t value) {
+    if (commandPool == VK_NULL_HANDLE) {
+      return;
+    }
+    _commandPools.push_back({commandPool, value});
+    _stats.retired++;
+  }
+
+
+  uint32_t DeletionQueue::collect(uint64_t completed) {
+    uint32_t destroyed = 0;
+    // users before the objects they use: framebuffers before their views, views before their images
+    destroyed += collectEntries(_pipelines, completed, [&](VkPipeline pipeline) {
+      vkDestroyPipeline(_device, pipeline, nullptr);
+    });
+    destroyed += collectEntries(_framebuffers, completed, [&](VkFramebuffer framebuffer) {
+      vkDestroyFramebuffer(_device, framebuffer, nullptr);
+    });
+    destroyed += collectEntries(_imageViews, completed, [&](VkImageView imageView) {
+      vkDestroyImageView(_device, imageView, nullptr);
+    });
+    destroyed += collectEntries(_images, completed, [&](const ImageAllocation &image) {
+      vmaDestroyImage(_allocator, image.image, image.allocation);
+    });
+    destroyed += collectEntries(_buffers, completed, [&](const BufferAllocation &buffer) {
+      vmaDestroyBuffer(_allocator, buffer.buffer, buffer.allocation);
+    });
+    destroyed += collectEntries(_descriptorPools, completed, [&](VkDescriptorPool descriptorPool) {
+      vkDestroyDescriptorPool(_device, descriptorPool, nullptr);
+    });
+    destroyed += collectEntries(_commandPools, completed, [&](VkCommandPool commandPool) {
+      vkDestroyCommandPool(_device, commandPool, nullptr);
+    });
+    destroyed += collectEntries(_semaphores, completed, [&](VkSemaphore semaphore) {
+      vkDestroySemaphore(_device, semaphore, nullptr);
+    });
+    destroyed += collectEntries(_fences, completed, [&](VkFence fence) {
+      vkDestroyFence(_device, fence, nullptr);
+    });
+    _stats.destroyed += destroyed;
+    return destroyed;
+  }
+
+
+  size_t DeletionQueue::size() const {
+    return _pipelines.size() + _buffers.size() + _images.size() + _imageViews.size() + _framebuffers.size()
+           + _semaphores.size() + _fences.size() + _descriptorPools.size() + _commandPools.size();
+  }
+
+} // walrus
@@ -0,0 +1,97 @@
+#ifndef WALRUS_COMPUTE_ENGINE_DELETION_QUEUE_HPP
+#define WALRUS_COMPUTE_ENGINE_DELETION_QUEUE_HPP
+
+#include <vk_types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief vulkan objects released mid-run, destroyed once the device has passed every submission that may use them.
+   * each object is retired with a value -- the frame number or timeline value of the last submission that may use it --
+   * and destroyed by the first collect() whose completed value reaches it.
+   * objects are kept as typed handles in one flat array per type, so steady state frames don't allocate.
+   * @note not thread safe. values only need to be comparable within one queue, use one DeletionQueue per timeline
+   */
+  class DeletionQueue {
+  public:
+    /// @brief totals since init()
+    struct Stats {
+      uint64_t retired = 0;
+      uint64_t destroyed = 0;
+    };
+
+    void init(VkDevice device, VmaAllocator allocator);
+
+    void retirePipeline(VkPipeline pipeline, uint64_t value);
+
+    void retireBuffer(VkBuffer buffer, VmaAllocation allocation, uint64_t value);
+
+    void retireBuffer(const AllocatedBuffer &buffer, uint64_t value) { retireBuffer(buffer.buffer, buffer.allocation, value); }
+
+    void retireImage(VkImage image, VmaAllocation allocation, uint64_t value);
+
+    void retireImageView(VkImageView imageView, uint64_t value);
+
+    void retireFramebuffer(VkFramebuffer framebuffer, uint64_t value);
+
+    void retireSemaphore(VkSemaphore semaphore, uint64_t value);
+
+    void retireFence(VkFence fence, uint64_t value);
+
+    void retireDescriptorPool(VkDescriptorPool descriptorPool, uint64_t value);
+
+    void retireCommandPool(VkCommandPool commandPool, uint64_t value);
+
+    /**
+     * @brief destroys every object retired with a value <= `completed`
+     * @return the number of objects destroyed
+     */
+    uint32_t collect(uint64_t completed);
+
+    /// @brief destroys everything, i.e. at teardown once the device is idle
+    uint32_t flush() { return collect(UINT64_MAX); }
+
+    /// @brief objects waiting for the device
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+  private:
+    template<class T>
+    struct Retired {
+      T handle;
+      uint64_t value;
+    };
+
+    struct BufferAllocation {
+      VkBuffer buffer;
+      VmaAllocation allocation;
+    };
+
+    struct ImageAllocation {
+      VkImage image;
+      VmaAllocation allocation;
+    };
+
+    VkDevice _device = VK_NULL_HANDLE;
+    VmaAllocator _allocator = nullptr;
+
+    std::vector<Retired<VkPipeline>> _pipelines{};
+    std::vector<Retired<BufferAllocation>> _buffers{};
+    std::vector<Retired<ImageAllocation>> _images{};
+    std::vector<Retired<VkImageView>> _imageViews{};
+    std::vector<Retired<VkFramebuffer>> _framebuffers{};
+    std::vector<Retired<VkSemaphore>> _semaphores{};
+    std::vector<Retired<VkFence>> _fences{};
+    std::vector<Retired<VkDescriptorPool>> _descriptorPools{};
+    std::vector<Retired<VkCommandPool>> _commandPools{};
+    Stats _stats{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_DELETION_QUEUE_HPP
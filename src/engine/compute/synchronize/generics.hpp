@@ -3,10 +3,11 @@
 
 namespace walrus::sync::generics {
 
+  /// @brief the objects guarding a frame: `present` is signaled by acquire, `render` once the frame is drawn
   template<class T>
   struct RenderSync {
-    T* pPresent = nullptr;
-    T* pRender = nullptr;
+    T present{};
+    T render{};
   };
 
 
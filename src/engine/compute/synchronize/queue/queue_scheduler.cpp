@@ -0,0 +1,144 @@
+#include "queue_scheduler.hpp"
+#include "pretty_io.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace walrus {
+
+  void QueueScheduler::init(VkDevice device, const DeviceInfo &deviceInfo, const std::vector<VkQueue> &queues) {
+    if (queues.empty()) {
+      throw std::runtime_error("queue scheduler: no queues");
+    }
+    _device = device;
+    _getCounterValue = nullptr;
+    _queues.clear();
+    _next[0] = 0;
+    _next[1] = 0;
+    if (deviceInfo.capabilities.timelineSemaphore) {
+      _getCounterValue = (PFN_vkGetSemaphoreCounterValue) vkGetDeviceProcAddr(
+        device,
+        deviceInfo.properties.apiVersion >= VK_API_VERSION_1_2
+        ? "vkGetSemaphoreCounterValue"
+        : "vkGetSemaphoreCounterValueKHR"
+      );
+    }
+
+    for (uint32_t i = 0; i < queues.size(); i++) {
+      Queue queue{};
+      queue.queue = queues[i];
+      queue.stats.priority = DeviceInfo::queuePriority(i) >= DeviceInfo::HIGH_QUEUE_PRIORITY
+                             ? Priority::HIGH
+                             : Priority::LOW;
+      if (_getCounterValue != nullptr) {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        info.pNext = &typeInfo;
+        if (vkCreateSemaphore(_device, &info, nullptr, &queue.timeline) != VK_SUCCESS) {
+          throw std::runtime_error("queue scheduler: failed to create timeline semaphore");
+        }
+      }
+      _queues.push_back(queue);
+    }
+  }
+
+
+  void QueueScheduler::destroy() {
+    for (auto &queue: _queues) {
+      if (queue.timeline != VK_NULL_HANDLE) {
+        vkDestroySemaphore(_device, queue.timeline, nullptr);
+      }
+    }
+    _queues.clear();
+    _getCounterValue = nullptr;
+    _device = VK_NULL_HANDLE;
+  }
+
+
+  uint32_t QueueScheduler::select(Priority priority) {
+    bool hasClass = false;
+    for (auto &queue: _queues) {
+      hasClass = hasClass || queue.stats.priority == priority;
+    }
+
+    // starts at the cursor, so the first of equally busy queues is the next in round-robin order
+    const auto count = (uint32_t) _queues.size();
+    uint32_t &next = _next[(uint32_t) priority];
+    int best = -1;
+    for (uint32_t k = 0; k < count; k++) {
+      const uint32_t i = (next + k) % count;
+      Queue &queue = _queues[i];
+      if (hasClass && queue.stats.priority != priority) {
+        continue;
+      }
+      poll(queue);
+      if (best < 0 || queue.stats.inFlight < _queues[best].stats.inFlight) {
+        best = (int) i;
+      }
+    }
+    next = ((uint32_t) best + 1) % count;
+    return (uint32_t) best;
+  }
+
+
+  VkResult QueueScheduler::submit(uint32_t index, SubmitBatcher &batcher, VkFence fence, uint64_t *value) {
+    Queue &queue = _queues.at(index);
+    if (queue.timeline != VK_NULL_HANDLE) {
+      batcher.signal(queue.timeline, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, queue.submitted + 1);
+    }
+    const VkResult result = batcher.flush(queue.queue, fence);
+    if (result != VK_SUCCESS) {
+      return result;
+    }
+    queue.submitted++;
+    queue.stats.submissions++;
+    if (queue.timeline != VK_NULL_HANDLE) {
+      queue.stats.inFlight = (uint32_t) (queue.submitted - queue.completed);
+      queue.stats.peakInFlight = std::max(queue.stats.peakInFlight, queue.stats.inFlight);
+    }
+    if (value != nullptr) {
+      *value = queue.submitted;
+    }
+    return VK_SUCCESS;
+  }
+
+
+  void QueueScheduler::update() {
+    for (auto &queue: _queues) {
+      poll(queue);
+    }
+  }
+
+
+  void QueueScheduler::poll(Queue &queue) {
+    if (queue.timeline != VK_NULL_HANDLE && queue.completed < queue.submitted) {
+      uint64_t value = 0;
+      if (_getCounterValue(_device, queue.timeline, &value) == VK_SUCCESS) {
+        queue.completed = value;
+      }
+    }
+    queue.stats.inFlight = queue.timeline != VK_NULL_HANDLE ? (uint32_t) (queue.submitted - queue.completed) : 0;
+    queue.stats.samples++;
+    if (queue.stats.inFlight > 0) {
+      queue.stats.busySamples++;
+    }
+  }
+
+
+  void QueueScheduler::print() const {
+    for (uint32_t i = 0; i < _queues.size(); i++) {
+      const QueueStats &stats = _queues[i].stats;
+      std::cout << io::to_color_string(io::LIGHT_GRAY, "queue " + std::to_string(i))
+                << (stats.priority == Priority::HIGH ? " (high): " : " (low):  ")
+                << stats.submissions << " submissions, peak in flight " << stats.peakInFlight
+                << ", occupancy " << stats.occupancy() * 100.0 << "%" << std::endl;
+    }
+  }
+
+} // walrus
@@ -0,0 +1,96 @@
+#ifndef WALRUS_COMPUTE_ENGINE_QUEUE_SCHEDULER_HPP
+#define WALRUS_COMPUTE_ENGINE_QUEUE_SCHEDULER_HPP
+
+#include "engine/compute/device/device.hpp"
+#include "engine/compute/synchronize/submit/submit_batcher.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief spreads independent submissions over every queue of a family.
+   * queues are classed by the priority they were created with (see DeviceInfo::queuePriority):
+   * select() picks the least busy queue of a class, round-robin between equally busy ones,
+   * and falls back to the other class when a class has no queue.
+   * each queue signals its own timeline semaphore, so the work in flight is known without blocking.
+   * usage: index = select(priority), then submit(index, batcher). update() once per frame samples the occupancy.
+   * @note not thread safe, like the queues it submits to
+   * @note without timeline semaphores the completions are unknown: select() is plain round-robin and nothing is in flight
+   */
+  class QueueScheduler {
+  public:
+    enum class Priority {
+      HIGH, // latency sensitive, i.e. rendering
+      LOW,  // batch work
+    };
+
+    /// @brief per queue totals since init()
+    struct QueueStats {
+      Priority priority = Priority::LOW;
+      uint64_t submissions = 0;
+      /// submitted, not complete at the last poll
+      uint32_t inFlight = 0;
+      uint32_t peakInFlight = 0;
+      /// polls, and the ones that found work in flight
+      uint64_t samples = 0;
+      uint64_t busySamples = 0;
+
+      /// @brief share of the samples the queue had work in flight, 0..1
+      [[nodiscard]] double occupancy() const { return samples > 0 ? (double) busySamples / (double) samples : 0.0; }
+    };
+
+    /// @param queues every queue of the family, in queue index order
+    void init(VkDevice device, const DeviceInfo &deviceInfo, const std::vector<VkQueue> &queues);
+
+    /// @brief the queues must be idle
+    void destroy();
+
+    /// @brief the index of the queue the next submission of `priority` should go to
+    uint32_t select(Priority priority);
+
+    /**
+     * @brief submits everything queued in `batcher` on queue `index`, and signals the queue's timeline after it
+     * @param value if not null, the timeline value the submission signals
+     */
+    [[nodiscard]] VkResult submit(uint32_t index, SubmitBatcher &batcher, VkFence fence = VK_NULL_HANDLE, uint64_t *value = nullptr);
+
+    /// @brief polls the completions of every queue and samples their occupancy
+    void update();
+
+    void print() const;
+
+    [[nodiscard]] VkQueue getQueue(uint32_t index) const { return _queues[index].queue; }
+
+    /// @brief signaled by queue `index` with the value of each of its submissions. null without timeline semaphores
+    [[nodiscard]] VkSemaphore getTimeline(uint32_t index) const { return _queues[index].timeline; }
+
+    [[nodiscard]] uint32_t size() const { return (uint32_t) _queues.size(); }
+
+    [[nodiscard]] const QueueStats &stats(uint32_t index) const { return _queues[index].stats; }
+
+  private:
+    struct Queue {
+      VkQueue queue = VK_NULL_HANDLE;
+      VkSemaphore timeline = VK_NULL_HANDLE;
+      uint64_t submitted = 0;
+      uint64_t completed = 0;
+      QueueStats stats{};
+    };
+
+    /// @brief refreshes `completed` & `inFlight` of a queue
+    void poll(Queue &queue);
+
+    VkDevice _device = VK_NULL_HANDLE;
+    PFN_vkGetSemaphoreCounterValue _getCounterValue = nullptr;
+    std::vector<Queue> _queues{};
+    /// round-robin cursor per priority
+    uint32_t _next[2]{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_QUEUE_SCHEDULER_HPP
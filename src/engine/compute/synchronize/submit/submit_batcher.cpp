@@ -0,0 +1,89 @@
+#include "submit_batcher.hpp"
+
+namespace walrus {
+
+  void SubmitBatcher::init(VkDevice device, const DeviceInfo &deviceInfo) {
+    _sync2.init(device, deviceInfo);
+    _stats = Stats{};
+  }
+
+
+  SubmitBatcher::Batch &SubmitBatcher::currentBatch(bool newBatch) {
+    if (_batches.empty() || newBatch) {
+      Batch batch{};
+      batch.firstWait = (uint32_t) _waits.size();
+      batch.firstCommandBuffer = (uint32_t) _commandBuffers.size();
+      batch.firstSignal = (uint32_t) _signals.size();
+      _batches.push_back(batch);
+    }
+    return _batches.back();
+  }
+
+
+  void SubmitBatcher::wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, uint64_t value) {
+    const bool started = !_batches.empty()
+                         && (_batches.back().commandBufferCount > 0 || _batches.back().signalCount > 0);
+    Batch &batch = currentBatch(started);
+    VkSemaphoreSubmitInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    info.semaphore = semaphore;
+    info.value = value;
+    info.stageMask = stages;
+    _waits.push_back(info);
+    batch.waitCount++;
+  }
+
+
+  void SubmitBatcher::add(VkCommandBuffer commandBuffer) {
+    const bool signaled = !_batches.empty() && _batches.back().signalCount > 0;
+    Batch &batch = currentBatch(signaled);
+    VkCommandBufferSubmitInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    info.commandBuffer = commandBuffer;
+    _commandBuffers.push_back(info);
+    batch.commandBufferCount++;
+  }
+
+
+  void SubmitBatcher::signal(VkSemaphore semaphore, VkPipelineStageFlags2 stages, uint64_t value) {
+    Batch &batch = currentBatch(false);
+    VkSemaphoreSubmitInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    info.semaphore = semaphore;
+    info.value = value;
+    info.stageMask = stages;
+    _signals.push_back(info);
+    batch.signalCount++;
+  }
+
+
+  VkResult SubmitBatcher::flush(VkQueue queue, VkFence fence) {
+    if (_batches.empty() && fence == VK_NULL_HANDLE) {
+      return VK_SUCCESS;
+    }
+    _submits.clear();
+    for (const auto &batch: _batches) {
+      VkSubmitInfo2 info{};
+      info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+      info.waitSemaphoreInfoCount = batch.waitCount;
+      info.pWaitSemaphoreInfos = batch.waitCount > 0 ? &_waits[batch.firstWait] : nullptr;
+      info.commandBufferInfoCount = batch.commandBufferCount;
+      info.pCommandBufferInfos = batch.commandBufferCount > 0 ? &_commandBuffers[batch.firstCommandBuffer] : nullptr;
+      info.signalSemaphoreInfoCount = batch.signalCount;
+      info.pSignalSemaphoreInfos = batch.signalCount > 0 ? &_signals[batch.firstSignal] : nullptr;
+      _submits.push_back(info);
+    }
+    // an empty submission still signals the fence, once the previous work on the queue is done
+    const VkResult result = _sync2.submit(queue, (uint32_t) _submits.size(), _submits.data(), fence);
+
+    _stats.flushes++;
+    _stats.submits += (uint32_t) _submits.size();
+    _stats.commandBuffers += (uint32_t) _commandBuffers.size();
+    _waits.clear();
+    _commandBuffers.clear();
+    _signals.clear();
+    _batches.clear();
+    return result;
+  }
+
+} // walrus
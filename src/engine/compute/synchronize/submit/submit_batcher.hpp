@@ -0,0 +1,84 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SUBMIT_BATCHER_HPP
+#define WALRUS_COMPUTE_ENGINE_SUBMIT_BATCHER_HPP
+
+#include "engine/compute/device/device.hpp"
+#include "engine/compute/synchronize/synchronization2/synchronization2.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief collects the command buffers, semaphore waits & signals queued for one queue during a frame,
+   * from any subsystem, and submits them with a single vkQueueSubmit2 call.
+   * consecutive command buffers share one VkSubmitInfo2. a new one only starts where the order requires it:
+   * a wait queued after command buffers (the earlier ones don't wait), or command buffers queued after a signal
+   * (the signal doesn't wait for them).
+   * usage: wait() / add() / signal() in submission order, then flush().
+   * @note the storage is kept between flushes, so steady state frames don't allocate
+   */
+  class SubmitBatcher {
+  public:
+    /// @brief totals since init(), i.e. to compare the submissions with the command buffers they carried
+    struct Stats {
+      uint32_t flushes = 0;
+      uint32_t submits = 0;
+      uint32_t commandBuffers = 0;
+    };
+
+    void init(VkDevice device, const DeviceInfo &deviceInfo);
+
+    /**
+     * @brief the command buffers added next wait for the semaphore, at `stages`
+     * @param value of a timeline semaphore, 0 for a binary one
+     */
+    void wait(VkSemaphore semaphore, VkPipelineStageFlags2 stages, uint64_t value = 0);
+
+    void add(VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief signals the semaphore once the command buffers added so far are done with `stages`
+     * @param value of a timeline semaphore, 0 for a binary one
+     */
+    void signal(VkSemaphore semaphore, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, uint64_t value = 0);
+
+    /// @brief submits everything queued since the last flush. the fence is signaled when all of it is done
+    [[nodiscard]] VkResult flush(VkQueue queue, VkFence fence = VK_NULL_HANDLE);
+
+    [[nodiscard]] bool isEmpty() const { return _batches.empty(); }
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+    [[nodiscard]] const sync::Synchronization2 &getSynchronization2() const { return _sync2; }
+
+  private:
+    /// @brief one VkSubmitInfo2, as ranges of the flattened waits, command buffers & signals
+    struct Batch {
+      uint32_t firstWait = 0;
+      uint32_t waitCount = 0;
+      uint32_t firstCommandBuffer = 0;
+      uint32_t commandBufferCount = 0;
+      uint32_t firstSignal = 0;
+      uint32_t signalCount = 0;
+    };
+
+    /// @brief the batch the next wait / command buffer / signal goes into, after `newBatch` or a new one
+    Batch &currentBatch(bool newBatch);
+
+    sync::Synchronization2 _sync2{};
+
+    std::vector<VkSemaphoreSubmitInfo> _waits{};
+    std::vector<VkCommandBufferSubmitInfo> _commandBuffers{};
+    std::vector<VkSemaphoreSubmitInfo> _signals{};
+    std::vector<Batch> _batches{};
+    /// scratch of flush
+    std::vector<VkSubmitInfo2> _submits{};
+    Stats _stats{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_SUBMIT_BATCHER_HPP
@@ -0,0 +1,185 @@
+#include "synchronization2.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace walrus::sync {
+
+  VkPipelineStageFlags toLegacyStages(VkPipelineStageFlags2 stages) {
+    auto legacy = (VkPipelineStageFlags) (stages & 0xffffffffull);
+    if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT
+                  | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT)) {
+      legacy |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT)) {
+      legacy |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    if (stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT) {
+      legacy |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    }
+    return legacy;
+  }
+
+
+  VkAccessFlags toLegacyAccess(VkAccessFlags2 access) {
+    auto legacy = (VkAccessFlags) (access & 0xffffffffull);
+    if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) {
+      legacy |= VK_ACCESS_SHADER_READ_BIT;
+    }
+    if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) {
+      legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    return legacy;
+  }
+
+
+  void Synchronization2::init(VkDevice device, const DeviceInfo &deviceInfo) {
+    _pipelineBarrier2 = nullptr;
+    _queueSubmit2 = nullptr;
+    if (!deviceInfo.capabilities.synchronization2) {
+      return;
+    }
+    const bool core = deviceInfo.properties.apiVersion >= VK_API_VERSION_1_3;
+    _pipelineBarrier2 = (PFN_vkCmdPipelineBarrier2) vkGetDeviceProcAddr(
+      device,
+      core ? "vkCmdPipelineBarrier2" : "vkCmdPipelineBarrier2KHR"
+    );
+    _queueSubmit2 = (PFN_vkQueueSubmit2) vkGetDeviceProcAddr(
+      device,
+      core ? "vkQueueSubmit2" : "vkQueueSubmit2KHR"
+    );
+  }
+
+
+  void Synchronization2::pipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfo &dependencyInfo) const {
+    if (isNative()) {
+      _pipelineBarrier2(commandBuffer, &dependencyInfo);
+      return;
+    }
+
+    /// LEGACY
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<VkMemoryBarrier> memoryBarriers(dependencyInfo.memoryBarrierCount);
+    for (uint32_t i = 0; i < dependencyInfo.memoryBarrierCount; i++) {
+      const VkMemoryBarrier2 &barrier = dependencyInfo.pMemoryBarriers[i];
+      srcStages |= toLegacyStages(barrier.srcStageMask);
+      dstStages |= toLegacyStages(barrier.dstStageMask);
+      memoryBarriers[i].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      memoryBarriers[i].srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+      memoryBarriers[i].dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+    }
+    std::vector<VkBufferMemoryBarrier> bufferBarriers(dependencyInfo.bufferMemoryBarrierCount);
+    for (uint32_t i = 0; i < dependencyInfo.bufferMemoryBarrierCount; i++) {
+      const VkBufferMemoryBarrier2 &barrier = dependencyInfo.pBufferMemoryBarriers[i];
+      srcStages |= toLegacyStages(barrier.srcStageMask);
+      dstStages |= toLegacyStages(barrier.dstStageMask);
+      VkBufferMemoryBarrier &legacy = bufferBarriers[i];
+      legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+      legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+      legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+      legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+      legacy.buffer = barrier.buffer;
+      legacy.offset = barrier.offset;
+      legacy.size = barrier.size;
+    }
+    std::vector<VkImageMemoryBarrier> imageBarriers(dependencyInfo.imageMemoryBarrierCount);
+    for (uint32_t i = 0; i < dependencyInfo.imageMemoryBarrierCount; i++) {
+      const VkImageMemoryBarrier2 &barrier = dependencyInfo.pImageMemoryBarriers[i];
+      srcStages |= toLegacyStages(barrier.srcStageMask);
+      dstStages |= toLegacyStages(barrier.dstStageMask);
+      VkImageMemoryBarrier &legacy = imageBarriers[i];
+      legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+      legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+      legacy.oldLayout = barrier.oldLayout;
+      legacy.newLayout = barrier.newLayout;
+      legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+      legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+      legacy.image = barrier.image;
+      legacy.subresourceRange = barrier.subresourceRange;
+    }
+    vkCmdPipelineBarrier(
+      commandBuffer,
+      srcStages != 0 ? srcStages : (VkPipelineStageFlags) VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      dstStages != 0 ? dstStages : (VkPipelineStageFlags) VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      dependencyInfo.dependencyFlags,
+      (uint32_t) memoryBarriers.size(),
+      memoryBarriers.data(),
+      (uint32_t) bufferBarriers.size(),
+      bufferBarriers.data(),
+      (uint32_t) imageBarriers.size(),
+      imageBarriers.data()
+    );
+  }
+
+
+  VkResult Synchronization2::submit(
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo2 *submits,
+    VkFence fence
+  ) const {
+    if (isNative()) {
+      return _queueSubmit2(queue, submitCount, submits, fence);
+    }
+
+    /// LEGACY
+    // flattened, then pointed into once every submit was added, so the vectors don't move under the pointers
+    std::vector<VkSemaphore> semaphores{};
+    std::vector<uint64_t> values{};
+    std::vector<VkPipelineStageFlags> waitStages{};
+    std::vector<VkCommandBuffer> commandBuffers{};
+    bool timeline = false;
+    for (uint32_t i = 0; i < submitCount; i++) {
+      const VkSubmitInfo2 &submit = submits[i];
+      for (uint32_t j = 0; j < submit.waitSemaphoreInfoCount; j++) {
+        semaphores.push_back(submit.pWaitSemaphoreInfos[j].semaphore);
+        values.push_back(submit.pWaitSemaphoreInfos[j].value);
+        const VkPipelineStageFlags stages = toLegacyStages(submit.pWaitSemaphoreInfos[j].stageMask);
+        waitStages.push_back(stages != 0 ? stages : (VkPipelineStageFlags) VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        timeline = timeline || submit.pWaitSemaphoreInfos[j].value != 0;
+      }
+      for (uint32_t j = 0; j < submit.signalSemaphoreInfoCount; j++) {
+        semaphores.push_back(submit.pSignalSemaphoreInfos[j].semaphore);
+        values.push_back(submit.pSignalSemaphoreInfos[j].value);
+        timeline = timeline || submit.pSignalSemaphoreInfos[j].value != 0;
+      }
+      for (uint32_t j = 0; j < submit.commandBufferInfoCount; j++) {
+        commandBuffers.push_back(submit.pCommandBufferInfos[j].commandBuffer);
+      }
+    }
+    std::vector<VkSubmitInfo> infos(submitCount);
+    std::vector<VkTimelineSemaphoreSubmitInfo> timelineInfos(timeline ? submitCount : 0);
+    size_t semaphore = 0;
+    size_t waitStage = 0;
+    size_t commandBuffer = 0;
+    for (uint32_t i = 0; i < submitCount; i++) {
+      const VkSubmitInfo2 &submit = submits[i];
+      VkSubmitInfo &info = infos[i];
+      info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      info.waitSemaphoreCount = submit.waitSemaphoreInfoCount;
+      info.pWaitSemaphores = semaphores.data() + semaphore;
+      info.pWaitDstStageMask = waitStages.data() + waitStage;
+      info.signalSemaphoreCount = submit.signalSemaphoreInfoCount;
+      info.pSignalSemaphores = semaphores.data() + semaphore + submit.waitSemaphoreInfoCount;
+      info.commandBufferCount = submit.commandBufferInfoCount;
+      info.pCommandBuffers = commandBuffers.data() + commandBuffer;
+      if (timeline) {
+        VkTimelineSemaphoreSubmitInfo &timelineInfo = timelineInfos[i];
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = submit.waitSemaphoreInfoCount;
+        timelineInfo.pWaitSemaphoreValues = values.data() + semaphore;
+        timelineInfo.signalSemaphoreValueCount = submit.signalSemaphoreInfoCount;
+        timelineInfo.pSignalSemaphoreValues = values.data() + semaphore + submit.waitSemaphoreInfoCount;
+        info.pNext = &timelineInfo;
+      }
+      semaphore += submit.waitSemaphoreInfoCount + submit.signalSemaphoreInfoCount;
+      waitStage += submit.waitSemaphoreInfoCount;
+      commandBuffer += submit.commandBufferInfoCount;
+    }
+    return vkQueueSubmit(queue, submitCount, infos.data(), fence);
+  }
+
+} // walrus::sync
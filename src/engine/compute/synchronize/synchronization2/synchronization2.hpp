@@ -0,0 +1,45 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SYNCHRONIZATION2_HPP
+#define WALRUS_COMPUTE_ENGINE_SYNCHRONIZATION2_HPP
+
+#include "engine/compute/device/device.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+
+namespace walrus::sync {
+
+  /// @brief sync2 stages as legacy ones. the low 32 bits match, the newer split stages map to their legacy parents
+  VkPipelineStageFlags toLegacyStages(VkPipelineStageFlags2 stages);
+
+  /// @brief sync2 accesses as legacy ones, see toLegacyStages
+  VkAccessFlags toLegacyAccess(VkAccessFlags2 access);
+
+  /**
+   * @brief barriers & queue submissions in synchronization2 terms (VkDependencyInfo, VkSubmitInfo2), on every device.
+   * uses vkCmdPipelineBarrier2 & vkQueueSubmit2 (or their KHR aliases) when the device has synchronization2,
+   * and translates to the equivalent legacy calls otherwise.
+   * @note the legacy barriers share one pair of stage masks per call, so they may wait a little more than needed
+   */
+  class Synchronization2 {
+  public:
+    void init(VkDevice device, const DeviceInfo &deviceInfo);
+
+    [[nodiscard]] bool isNative() const { return _pipelineBarrier2 != nullptr && _queueSubmit2 != nullptr; }
+
+    void pipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfo &dependencyInfo) const;
+
+    /**
+     * @brief submits the batches in one call. timeline semaphore values are passed through (vulkan 1.2),
+     * binary semaphores take a value of 0
+     */
+    [[nodiscard]] VkResult submit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2 *submits, VkFence fence) const;
+
+  private:
+    PFN_vkCmdPipelineBarrier2 _pipelineBarrier2 = nullptr;
+    PFN_vkQueueSubmit2 _queueSubmit2 = nullptr;
+  };
+
+} // walrus::sync
+
+#endif //WALRUS_COMPUTE_ENGINE_SYNCHRONIZATION2_HPP
@@ -0,0 +1,585 @@
+#include "frame_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace walrus {
+
+  namespace {
+    bool contains(VkFlags64 flags, VkFlags64 subset) {
+      return (flags & subset) == subset;
+    }
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// PASS BUILDER
+  /// --------------------------------------------------
+
+  FrameGraph::PassBuilder &FrameGraph::PassBuilder::read(
+    ResourceId resource,
+    VkPipelineStageFlags2 stages,
+    VkAccessFlags2 access,
+    VkImageLayout layout
+  ) {
+    _graph->addAccess(_pass, resource, stages, access, layout, false);
+    return *this;
+  }
+
+
+  FrameGraph::PassBuilder &FrameGraph::PassBuilder::write(
+    ResourceId resource,
+    VkPipelineStageFlags2 stages,
+    VkAccessFlags2 access,
+    VkImageLayout layout
+  ) {
+    _graph->addAccess(_pass, resource, stages, access, layout, true);
+    return *this;
+  }
+
+
+  FrameGraph::PassBuilder &FrameGraph::PassBuilder::sideEffects() {
+    _graph->_passes[_pass].sideEffects = true;
+    return *this;
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// DECLARATION
+  /// --------------------------------------------------
+
+  void FrameGraph::init(VkDevice device, const DeviceInfo &deviceInfo, VmaAllocator allocator) {
+    _transients.init(device, allocator);
+    _sync2.init(device, deviceInfo);
+  }
+
+
+  void FrameGraph::destroy() {
+    _transients.destroy();
+    reset();
+  }
+
+
+  void FrameGraph::reset() {
+    _resources.clear();
+    _passes.clear();
+    _accesses.clear();
+    _edges.clear();
+    _states.clear();
+    _readers.clear();
+    _order.clear();
+    _batches.clear();
+    _bufferBarriers.clear();
+    _imageBarriers.clear();
+    _transientResources.clear();
+    _transients.reset();
+    _stats = Stats{};
+    _compiled = false;
+  }
+
+
+  FrameGraph::ResourceId FrameGraph::importBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size) {
+    Resource resource{};
+    resource.type = ResourceType::BUFFER;
+    resource.buffer = buffer;
+    resource.offset = offset;
+    resource.size = size;
+    _resources.push_back(resource);
+    _compiled = false;
+    return (ResourceId) _resources.size() - 1;
+  }
+
+
+  FrameGraph::ResourceId FrameGraph::importImage(
+    VkImage image,
+    const VkImageSubresourceRange &range,
+    VkImageLayout currentLayout,
+    VkPipelineStageFlags2 waitStages
+  ) {
+    Resource resource{};
+    resource.type = ResourceType::IMAGE;
+    resource.image = image;
+    resource.range = range;
+    resource.initialLayout = currentLayout;
+    resource.initialStages = waitStages;
+    _resources.push_back(resource);
+    _compiled = false;
+    return (ResourceId) _resources.size() - 1;
+  }
+
+
+  FrameGraph::ResourceId FrameGraph::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage) {
+    Resource resource{};
+    resource.type = ResourceType::BUFFER;
+    resource.size = size;
+    resource.transient = true;
+    resource.bufferUsage = usage;
+    _resources.push_back(resource);
+    _compiled = false;
+    return (ResourceId) _resources.size() - 1;
+  }
+
+
+  FrameGraph::ResourceId FrameGraph::createImage(const VkImageCreateInfo &info, VkImageAspectFlags aspectMask) {
+    Resource resource{};
+    resource.type = ResourceType::IMAGE;
+    resource.range.aspectMask = aspectMask;
+    resource.range.levelCount = info.mipLevels;
+    resource.range.layerCount = info.arrayLayers;
+    resource.transient = true;
+    resource.imageInfo = info;
+    _resources.push_back(resource);
+    _compiled = false;
+    return (ResourceId) _resources.size() - 1;
+  }
+
+
+  VkBuffer FrameGraph::getBuffer(ResourceId resource) const {
+    return _resources.at(resource).buffer;
+  }
+
+
+  VkImage FrameGraph::getImage(ResourceId resource) const {
+    return _resources.at(resource).image;
+  }
+
+
+  void FrameGraph::markOutput(
+    ResourceId resource,
+    VkImageLayout finalLayout,
+    VkPipelineStageFlags2 stages,
+    VkAccessFlags2 access
+  ) {
+    Resource &output = _resources.at(resource);
+    if (output.transient) {
+      throw std::runtime_error("frame graph: transient resources don't outlive the frame");
+    }
+    if (output.type == ResourceType::BUFFER && finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+      throw std::runtime_error("frame graph: buffers have no layout");
+    }
+    output.output = true;
+    output.finalLayout = finalLayout;
+    output.finalStages = stages;
+    output.finalAccess = access;
+    _compiled = false;
+  }
+
+
+  FrameGraph::PassBuilder FrameGraph::addPass(const char *name, Record record) {
+    Pass pass{};
+    pass.name = name;
+    pass.record = std::move(record);
+    pass.firstAccess = (uint32_t) _accesses.size();
+    _passes.push_back(std::move(pass));
+    _compiled = false;
+    return {*this, (PassId) _passes.size() - 1};
+  }
+
+
+  void FrameGraph::addAccess(
+    PassId pass,
+    ResourceId resource,
+    VkPipelineStageFlags2 stages,
+    VkAccessFlags2 access,
+    VkImageLayout layout,
+    bool write
+  ) {
+    if (pass + 1 != _passes.size()) {
+      throw std::runtime_error("frame graph: declare accesses before adding the next pass");
+    }
+    const bool image = _resources.at(resource).type == ResourceType::IMAGE;
+    if (image && layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+      throw std::runtime_error(std::string("frame graph: image access without a layout in pass ") + _passes[pass].name);
+    }
+    if (!image) {
+      layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    // a pass touching a resource several times (i.e. read & write) is one access, synchronized once
+    Pass &owner = _passes[pass];
+    for (uint32_t i = owner.firstAccess; i < owner.firstAccess + owner.accessCount; i++) {
+      Access &previous = _accesses[i];
+      if (previous.resource != resource) {
+        continue;
+      }
+      if (previous.layout != layout) {
+        throw std::runtime_error(std::string("frame graph: one image in two layouts in pass ") + owner.name);
+      }
+      previous.stages |= stages;
+      previous.access |= access;
+      previous.write = previous.write || write;
+      previous.read = previous.read || !write;
+      _compiled = false;
+      return;
+    }
+    _accesses.push_back({pass, resource, stages, access, layout, write, !write});
+    owner.accessCount++;
+    _compiled = false;
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// COMPILATION
+  /// --------------------------------------------------
+
+  void FrameGraph::compile() {
+    for (auto &pass: _passes) {
+      pass.live = false;
+      pass.level = 0;
+    }
+    _order.clear();
+    _batches.clear();
+    _bufferBarriers.clear();
+    _imageBarriers.clear();
+
+    buildEdges(false);
+    cull();
+    // culled passes may have been the ones changing a layout, so the remaining passes are linked again
+    buildEdges(true);
+    computeLevels();
+    allocateTransients();
+    computeBarriers();
+
+    _stats.passes = (uint32_t) _passes.size();
+    _stats.culled = (uint32_t) (_passes.size() - _order.size());
+    _stats.levels = _order.empty() ? 0 : _passes[_order.back()].level + 1;
+    _stats.barrierBatches = (uint32_t) _batches.size();
+    _stats.bufferBarriers = (uint32_t) _bufferBarriers.size();
+    _stats.imageBarriers = (uint32_t) _imageBarriers.size();
+    _stats.transientRequestedBytes = _transients.stats().requestedBytes;
+    _stats.transientPlacedBytes = _transients.stats().placedBytes;
+    _compiled = true;
+  }
+
+
+  void FrameGraph::buildEdges(bool liveOnly) {
+    _edges.clear();
+    _readers.clear();
+    _states.assign(_resources.size(), State{});
+    for (size_t i = 0; i < _resources.size(); i++) {
+      _states[i].layout = _resources[i].initialLayout;
+    }
+
+    // walks the passes in declaration order, so edges are sorted by their `to` pass
+    for (PassId pass = 0; pass < _passes.size(); pass++) {
+      const Pass &current = _passes[pass];
+      if (liveOnly && !current.live) {
+        continue;
+      }
+      for (uint32_t i = current.firstAccess; i < current.firstAccess + current.accessCount; i++) {
+        const Access &access = _accesses[i];
+        State &state = _states[access.resource];
+        const bool transition = access.layout != VK_IMAGE_LAYOUT_UNDEFINED && access.layout != state.layout;
+        // read after write keeps the writer alive. write after write only orders the two writers:
+        // the later one overwrites the contents, so the earlier one is culled unless something reads it
+        if (state.lastWriter != NONE && state.lastWriter != pass) {
+          _edges.push_back({state.lastWriter, pass, access.read});
+        }
+        if (!access.write && !transition) {
+          _readers.push_back({pass, state.readers});
+          state.readers = (uint32_t) _readers.size() - 1;
+          continue;
+        }
+        // write after read: the readers only need to run first
+        for (uint32_t reader = state.readers; reader != NONE; reader = _readers[reader].next) {
+          if (_readers[reader].pass != pass) {
+            _edges.push_back({_readers[reader].pass, pass, false});
+          }
+        }
+        state.lastWriter = pass;
+        state.readers = NONE;
+        if (transition) {
+          state.layout = access.layout;
+        }
+      }
+    }
+  }
+
+
+  void FrameGraph::cull() {
+    for (auto &pass: _passes) {
+      pass.live = pass.sideEffects;
+    }
+    for (const auto &access: _accesses) {
+      if (access.write && _resources[access.resource].output) {
+        _passes[access.pass].live = true;
+      }
+    }
+    // edges go from earlier to later passes, so a pass is final once the edges into later passes are visited
+    for (auto edge = _edges.rbegin(); edge != _edges.rend(); edge++) {
+      if (edge->data && _passes[edge->to].live) {
+        _passes[edge->from].live = true;
+      }
+    }
+  }
+
+
+  void FrameGraph::computeLevels() {
+    for (const auto &edge: _edges) {
+      _passes[edge.to].level = std::max(_passes[edge.to].level, _passes[edge.from].level + 1);
+    }
+    for (PassId pass = 0; pass < _passes.size(); pass++) {
+      if (_passes[pass].live) {
+        _order.push_back(pass);
+      }
+    }
+    // passes of a level don't depend on each other. within a level, the declaration order is kept
+    std::stable_sort(_order.begin(), _order.end(), [&](PassId a, PassId b) {
+      return _passes[a].level < _passes[b].level;
+    });
+  }
+
+
+  void FrameGraph::allocateTransients() {
+    /// LIFETIMES
+    // in levels: passes of one level may overlap on the device, so their resources can't share memory
+    constexpr uint32_t UNUSED = NONE;
+    std::vector<std::pair<uint32_t, uint32_t>> lifetimes(_resources.size(), {UNUSED, 0});
+    for (const PassId pass: _order) {
+      const Pass &current = _passes[pass];
+      for (uint32_t i = current.firstAccess; i < current.firstAccess + current.accessCount; i++) {
+        auto &[first, last] = lifetimes[_accesses[i].resource];
+        first = std::min(first, current.level);
+        last = std::max(last, current.level);
+      }
+    }
+
+    /// PLACEMENT
+    _transients.reset();
+    _transientResources.clear();
+    for (ResourceId id = 0; id < _resources.size(); id++) {
+      Resource &resource = _resources[id];
+      if (!resource.transient) {
+        continue;
+      }
+      resource.buffer = VK_NULL_HANDLE;
+      resource.image = VK_NULL_HANDLE;
+      resource.transientIndex = NONE;
+      const auto [first, last] = lifetimes[id];
+      if (first == UNUSED) {
+        continue;
+      }
+      resource.transientIndex = resource.type == ResourceType::IMAGE
+                                ? _transients.addImage(resource.imageInfo, first, last)
+                                : _transients.addBuffer(resource.size, resource.bufferUsage, first, last);
+      _transientResources.push_back(id);
+    }
+    _transients.allocate();
+    for (const ResourceId id: _transientResources) {
+      Resource &resource = _resources[id];
+      if (resource.type == ResourceType::IMAGE) {
+        resource.image = _transients.getImage(resource.transientIndex);
+      } else {
+        resource.buffer = _transients.getBuffer(resource.transientIndex);
+      }
+    }
+  }
+
+
+  void FrameGraph::computeBarriers() {
+    _states.assign(_resources.size(), State{});
+    for (size_t i = 0; i < _resources.size(); i++) {
+      _states[i].layout = _resources[i].initialLayout;
+      _states[i].writeStages = _resources[i].initialStages;
+      _states[i].aliased = _resources[i].transientIndex != NONE;
+    }
+
+    // one batch before each level, for every pass of the level
+    for (uint32_t index = 0; index < _order.size();) {
+      const uint32_t level = _passes[_order[index]].level;
+      Batch batch{index, (uint32_t) _bufferBarriers.size(), 0, (uint32_t) _imageBarriers.size(), 0};
+      for (; index < _order.size() && _passes[_order[index]].level == level; index++) {
+        const Pass &pass = _passes[_order[index]];
+        for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; i++) {
+          barrierFor(_accesses[i], _states[_accesses[i].resource], batch);
+        }
+      }
+      if (batch.bufferCount + batch.imageCount > 0) {
+        _batches.push_back(batch);
+      }
+    }
+
+    /// OUTPUTS
+    Batch batch{(uint32_t) _order.size(), (uint32_t) _bufferBarriers.size(), 0, (uint32_t) _imageBarriers.size(), 0};
+    for (ResourceId resource = 0; resource < _resources.size(); resource++) {
+      const Resource &output = _resources[resource];
+      if (!output.output) {
+        continue;
+      }
+      const State &state = _states[resource];
+      const bool transition = output.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED && output.finalLayout != state.layout;
+      const bool used = output.finalStages != VK_PIPELINE_STAGE_2_NONE
+                        && (state.writeStages | state.readStages) != VK_PIPELINE_STAGE_2_NONE;
+      if (!transition && !used) {
+        continue;
+      }
+      Access access{};
+      access.resource = resource;
+      access.stages = output.finalStages;
+      access.access = output.finalAccess;
+      access.layout = transition ? output.finalLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+      access.write = true; // waits for every previous access
+      barrierFor(access, _states[resource], batch);
+    }
+    if (batch.bufferCount + batch.imageCount > 0) {
+      _batches.push_back(batch);
+    }
+  }
+
+
+  void FrameGraph::barrierFor(const Access &access, State &state, Batch &batch) {
+    const Resource &resource = _resources[access.resource];
+    if (state.aliased) {
+      // the memory may have been used by resources of earlier levels, the first access waits for them
+      state.aliased = false;
+      _transients.previousOccupants(resource.transientIndex, _occupants);
+      for (const TransientAllocator::Index occupant: _occupants) {
+        const State &previous = _states[_transientResources[occupant]];
+        state.writeStages |= previous.writeStages | previous.readStages;
+        state.writeAccess |= previous.writeAccess;
+      }
+    }
+    const bool image = resource.type == ResourceType::IMAGE;
+    const VkImageLayout oldLayout = state.layout;
+    const VkImageLayout newLayout = access.layout != VK_IMAGE_LAYOUT_UNDEFINED ? access.layout : oldLayout;
+    const bool transition = image && newLayout != oldLayout;
+
+    VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+    bool needed = false;
+    if (access.write || transition) {
+      // waits for the last write & every read since. reads need no memory dependency
+      srcStages = state.writeStages | state.readStages;
+      srcAccess = state.writeAccess;
+      needed = transition || srcStages != VK_PIPELINE_STAGE_2_NONE;
+      state.layout = newLayout;
+      // a layout transition is a write of its own, the readers after it depend on it
+      state.writeStages = access.stages;
+      state.writeAccess = access.write ? access.access : VK_ACCESS_2_NONE;
+      state.visibleStages = access.write ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+      state.visibleAccess = access.write ? VK_ACCESS_2_NONE : access.access;
+      state.readStages = access.write ? VK_PIPELINE_STAGE_2_NONE : access.stages;
+    } else {
+      // a read only needs the last write, unless a previous barrier already made it visible to these stages
+      const bool visible = contains(state.visibleStages, access.stages) && contains(state.visibleAccess, access.access);
+      srcStages = state.writeStages;
+      srcAccess = state.writeAccess;
+      needed = srcStages != VK_PIPELINE_STAGE_2_NONE && !visible;
+      state.visibleStages |= access.stages;
+      state.visibleAccess |= access.access;
+      state.readStages |= access.stages;
+    }
+    if (!needed) {
+      return;
+    }
+
+    /// MERGE
+    // readers of a resource in the same level wait for the same write, so they share its barrier
+    if (image) {
+      for (uint32_t i = batch.firstImage; i < batch.firstImage + batch.imageCount; i++) {
+        VkImageMemoryBarrier2 &barrier = _imageBarriers[i];
+        if (barrier.image == resource.image && barrier.newLayout == newLayout && barrier.oldLayout == oldLayout) {
+          barrier.dstStageMask |= access.stages;
+          barrier.dstAccessMask |= access.access;
+          return;
+        }
+      }
+    } else {
+      for (uint32_t i = batch.firstBuffer; i < batch.firstBuffer + batch.bufferCount; i++) {
+        VkBufferMemoryBarrier2 &barrier = _bufferBarriers[i];
+        if (barrier.buffer == resource.buffer && barrier.offset == resource.offset) {
+          barrier.dstStageMask |= access.stages;
+          barrier.dstAccessMask |= access.access;
+          return;
+        }
+      }
+    }
+
+    /// BARRIER
+    if (image) {
+      VkImageMemoryBarrier2 barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+      barrier.srcStageMask = srcStages;
+      barrier.srcAccessMask = srcAccess;
+      barrier.dstStageMask = access.stages;
+      barrier.dstAccessMask = access.access;
+      barrier.oldLayout = oldLayout;
+      barrier.newLayout = newLayout;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = resource.image;
+      barrier.subresourceRange = resource.range;
+      _imageBarriers.push_back(barrier);
+      batch.imageCount++;
+    } else {
+      VkBufferMemoryBarrier2 barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+      barrier.srcStageMask = srcStages;
+      barrier.srcAccessMask = srcAccess;
+      barrier.dstStageMask = access.stages;
+      barrier.dstAccessMask = access.access;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.buffer = resource.buffer;
+      barrier.offset = resource.offset;
+      barrier.size = resource.size;
+      _bufferBarriers.push_back(barrier);
+      batch.bufferCount++;
+    }
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// EXECUTION
+  /// --------------------------------------------------
+
+  void FrameGraph::execute(VkCommandBuffer commandBuffer) const {
+    if (!_compiled) {
+      throw std::runtime_error("frame graph: compile before executing");
+    }
+    auto batch = _batches.begin();
+    for (uint32_t index = 0; index <= _order.size(); index++) {
+      for (; batch != _batches.end() && batch->beforePass == index; batch++) {
+        recordBatch(commandBuffer, *batch);
+      }
+      if (index < _order.size()) {
+        const Pass &pass = _passes[_order[index]];
+        if (pass.record) {
+          pass.record(commandBuffer);
+        }
+      }
+    }
+  }
+
+
+  std::vector<const char *> FrameGraph::executionOrder() const {
+    std::vector<const char *> names{};
+    names.reserve(_order.size());
+    for (const PassId pass: _order) {
+      names.push_back(_passes[pass].name);
+    }
+    return names;
+  }
+
+
+  void FrameGraph::recordBatch(VkCommandBuffer commandBuffer, const Batch &batch) const {
+    VkDependencyInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    info.bufferMemoryBarrierCount = batch.bufferCount;
+    info.pBufferMemoryBarriers = batch.bufferCount > 0 ? &_bufferBarriers[batch.firstBuffer] : nullptr;
+    info.imageMemoryBarrierCount = batch.imageCount;
+    info.pImageMemoryBarriers = batch.imageCount > 0 ? &_imageBarriers[batch.firstImage] : nullptr;
+    _sync2.pipelineBarrier(commandBuffer, info);
+  }
+
+} // walrus
@@ -0,0 +1,301 @@
+#ifndef WALRUS_COMPUTE_ENGINE_FRAME_GRAPH_HPP
+#define WALRUS_COMPUTE_ENGINE_FRAME_GRAPH_HPP
+
+#include "engine/compute/device/device.hpp"
+#include "engine/compute/synchronize/synchronization2/synchronization2.hpp"
+#include "engine/rendering/frame_graph/transient/transient_allocator.hpp"
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief the passes of a frame (graphics or compute), and the buffers & images they read and write.
+   * passes are declared in submission order with the resources they access. `compile` then:
+   *  - culls the passes that nothing kept (a marked output, or a pass with side effects) depends on,
+   *  - orders the rest by dependency level, so independent passes run between the same pair of barriers and can overlap,
+   *  - works out the smallest set of barriers (with image layout transitions) before each level, one batch per level.
+   * `execute` records the barriers & passes. barriers use vkCmdPipelineBarrier2 when the device supports
+   * synchronization2, and the equivalent legacy barriers otherwise.
+   * resources are imported, or created by the graph for the frame: transient resources whose passes don't overlap share memory.
+   * usage, every frame: reset(), import / create resources, add passes, compile(), execute().
+   * @note the storage is kept between frames, so steady state frames don't allocate (besides the pass callbacks,
+   *       and the translated barriers on devices without synchronization2)
+   * @note every resource is owned by one queue family. ownership transfers are left to the caller
+   */
+  class FrameGraph {
+  public:
+    using ResourceId = uint32_t;
+    using PassId = uint32_t;
+    /// @brief records the commands of a pass. barriers are recorded by the graph, around it
+    using Record = std::function<void(VkCommandBuffer)>;
+
+    /// @brief declares what a pass accesses. returned by addPass
+    class PassBuilder {
+    public:
+      PassBuilder(FrameGraph &graph, PassId pass) : _graph(&graph), _pass(pass) {}
+
+      /// @param layout images only: the layout the pass reads the image in
+      PassBuilder &read(
+        ResourceId resource,
+        VkPipelineStageFlags2 stages,
+        VkAccessFlags2 access,
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED
+      );
+
+      /**
+       * @param layout images only: the layout the pass writes the image in
+       * @note a write alone overwrites the previous contents, so it doesn't keep the previous writer alive.
+       *       a pass that keeps part of them (a load op, a partial write, read-modify-write) declares a read too
+       */
+      PassBuilder &write(
+        ResourceId resource,
+        VkPipelineStageFlags2 stages,
+        VkAccessFlags2 access,
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED
+      );
+
+      /// @brief never culled, i.e. a pass that writes to host visible memory or a query pool
+      PassBuilder &sideEffects();
+
+      [[nodiscard]] PassId id() const { return _pass; }
+
+    private:
+      FrameGraph *_graph;
+      PassId _pass;
+    };
+
+    /// @brief what compile() did, for debugging & profiling
+    struct Stats {
+      uint32_t passes = 0;
+      uint32_t culled = 0;
+      /// groups of independent passes, with at most one barrier batch between two of them
+      uint32_t levels = 0;
+      uint32_t barrierBatches = 0;
+      uint32_t bufferBarriers = 0;
+      uint32_t imageBarriers = 0;
+      /// transient memory without & with aliasing
+      VkDeviceSize transientRequestedBytes = 0;
+      VkDeviceSize transientPlacedBytes = 0;
+    };
+
+    /// @param allocator the memory of transient resources is allocated from
+    void init(VkDevice device, const DeviceInfo &deviceInfo, VmaAllocator allocator);
+
+    /// @brief destroys the transient resources & their memory. call once the device is idle
+    void destroy();
+
+    /// @brief forget the passes & resources of the previous frame
+    void reset();
+
+    /// RESOURCES
+
+    ResourceId importBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    /**
+     * @param currentLayout the layout the image is in when the graph runs. UNDEFINED discards the contents
+     * @param waitStages stages already waiting for the image, i.e. the wait stage of the semaphore a swapchain image
+     *        was acquired with. the first barrier on the image starts from them, to chain with that wait
+     */
+    ResourceId importImage(
+      VkImage image,
+      const VkImageSubresourceRange &range,
+      VkImageLayout currentLayout,
+      VkPipelineStageFlags2 waitStages = VK_PIPELINE_STAGE_2_NONE
+    );
+
+    /**
+     * @brief a buffer that only lives during the frame, created by compile(). its memory may be shared with other
+     * transient resources, so its first access has to write it. see getBuffer
+     */
+    ResourceId createBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+
+    /**
+     * @brief an image that only lives during the frame, created by compile(). its first access has to write it
+     * (or transition it from UNDEFINED). see getImage
+     * @param info `initialLayout` is ignored, the image starts UNDEFINED
+     */
+    ResourceId createImage(const VkImageCreateInfo &info, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+    /// @brief the buffer of a resource. transient buffers exist after compile(), i.e. when passes are recorded
+    [[nodiscard]] VkBuffer getBuffer(ResourceId resource) const;
+
+    [[nodiscard]] VkImage getImage(ResourceId resource) const;
+
+    /**
+     * @brief keeps the passes writing the resource, and leaves it ready for use after the graph. imported resources only
+     * @param finalLayout images only: transitioned to at the end, i.e. PRESENT_SRC_KHR. UNDEFINED = as last used
+     * @param stages & access of the first use after the graph. NONE when it is waited on by a semaphore (or present)
+     */
+    void markOutput(
+      ResourceId resource,
+      VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE,
+      VkAccessFlags2 access = VK_ACCESS_2_NONE
+    );
+
+    /// PASSES
+
+    /// @param name for debugging, must outlive the frame
+    PassBuilder addPass(const char *name, Record record);
+
+    /// @brief culls & orders the passes, and works out the barriers. throws on inconsistent accesses
+    void compile();
+
+    /// @brief records every pass that wasn't culled, with its barriers. call after compile()
+    void execute(VkCommandBuffer commandBuffer) const;
+
+    /// @brief the passes that are recorded, in execution order
+    [[nodiscard]] std::vector<const char *> executionOrder() const;
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+  private:
+    static constexpr uint32_t NONE = ~0u;
+
+    enum class ResourceType : uint32_t {
+      BUFFER,
+      IMAGE,
+    };
+
+    struct Resource {
+      ResourceType type = ResourceType::BUFFER;
+      VkBuffer buffer = VK_NULL_HANDLE;
+      VkDeviceSize offset = 0;
+      VkDeviceSize size = VK_WHOLE_SIZE;
+      VkImage image = VK_NULL_HANDLE;
+      VkImageSubresourceRange range{};
+      VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      VkPipelineStageFlags2 initialStages = VK_PIPELINE_STAGE_2_NONE;
+      bool output = false;
+      VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      VkPipelineStageFlags2 finalStages = VK_PIPELINE_STAGE_2_NONE;
+      VkAccessFlags2 finalAccess = VK_ACCESS_2_NONE;
+      /// TRANSIENT
+      bool transient = false;
+      VkBufferUsageFlags bufferUsage = 0;
+      VkImageCreateInfo imageInfo{};
+      /// NONE if no live pass uses the resource
+      TransientAllocator::Index transientIndex = NONE;
+    };
+
+    /// @brief everything one pass does to one resource
+    struct Access {
+      PassId pass = 0;
+      ResourceId resource = 0;
+      VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+      VkAccessFlags2 access = VK_ACCESS_2_NONE;
+      VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      bool write = false;
+      /// declared with read(): the pass depends on the previous contents, even if it writes the resource too
+      bool read = false;
+    };
+
+    struct Pass {
+      const char *name = "";
+      Record record{};
+      bool sideEffects = false;
+      /// accesses are contiguous per pass, in `_accesses`
+      uint32_t firstAccess = 0;
+      uint32_t accessCount = 0;
+      /// COMPILED
+      bool live = false;
+      uint32_t level = 0;
+    };
+
+    /// @brief the synchronization state of a resource, while walking the passes in order
+    struct State {
+      VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      /// stages of the last write (or layout transition), and its memory writes
+      VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+      VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+      /// stages & accesses the last write was made visible to
+      VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE;
+      VkAccessFlags2 visibleAccess = VK_ACCESS_2_NONE;
+      /// stages reading the resource since the last write. the next write waits for them
+      VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+      /// DEPENDENCIES
+      PassId lastWriter = NONE;
+      /// the passes reading the resource since the last write, a list through `_readers`
+      uint32_t readers = NONE;
+      /// transient resources wait for the previous occupants of their memory on first access
+      bool aliased = false;
+    };
+
+    /// @brief a node of a State's reader list
+    struct Reader {
+      PassId pass = 0;
+      uint32_t next = NONE;
+    };
+
+    /// @brief barriers recorded before `beforePass` (an index into `_order`, or the pass count for the end)
+    struct Batch {
+      uint32_t beforePass = 0;
+      uint32_t firstBuffer = 0;
+      uint32_t bufferCount = 0;
+      uint32_t firstImage = 0;
+      uint32_t imageCount = 0;
+    };
+
+    /// @brief an edge of the dependency graph. only data dependencies keep passes alive
+    struct Edge {
+      PassId from = 0;
+      PassId to = 0;
+      bool data = false;
+    };
+
+    void addAccess(
+      PassId pass,
+      ResourceId resource,
+      VkPipelineStageFlags2 stages,
+      VkAccessFlags2 access,
+      VkImageLayout layout,
+      bool write
+    );
+
+    /// @brief the dependencies between the live passes (or every pass, before culling)
+    void buildEdges(bool liveOnly);
+
+    void cull();
+
+    void computeLevels();
+
+    /// @brief places the transient resources used by live passes, by the levels they are used in
+    void allocateTransients();
+
+    void computeBarriers();
+
+    /// @brief the barrier `access` needs against `state`, if any. updates the state
+    void barrierFor(const Access &access, State &state, Batch &batch);
+
+    void recordBatch(VkCommandBuffer commandBuffer, const Batch &batch) const;
+
+    sync::Synchronization2 _sync2{};
+
+    std::vector<Resource> _resources{};
+    std::vector<Pass> _passes{};
+    std::vector<Access> _accesses{};
+    std::vector<Edge> _edges{};
+    std::vector<State> _states{};
+    std::vector<Reader> _readers{};
+    /// COMPILED
+    std::vector<PassId> _order{};
+    std::vector<Batch> _batches{};
+    std::vector<VkBufferMemoryBarrier2> _bufferBarriers{};
+    std::vector<VkImageMemoryBarrier2> _imageBarriers{};
+    Stats _stats{};
+    bool _compiled = false;
+    TransientAllocator _transients{};
+    /// scratch of barrierFor
+    std::vector<TransientAllocator::Index> _occupants{};
+    /// transient index -> resource
+    std::vector<ResourceId> _transientResources{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_FRAME_GRAPH_HPP
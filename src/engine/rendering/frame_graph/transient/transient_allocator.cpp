@@ -0,0 +1,321 @@
+#include "transient_allocator.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace walrus {
+
+  namespace {
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool lifetimesOverlap(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB) {
+      return firstA <= lastB && firstB <= lastA;
+    }
+  }
+
+
+  bool TransientAllocator::Request::operator==(const Request &other) const {
+    if (image != other.image || firstLevel != other.firstLevel || lastLevel != other.lastLevel) {
+      return false;
+    }
+    if (!image) {
+      return size == other.size && bufferUsage == other.bufferUsage;
+    }
+    const VkImageCreateInfo &a = imageInfo;
+    const VkImageCreateInfo &b = other.imageInfo;
+    return a.flags == b.flags
+           && a.imageType == b.imageType
+           && a.format == b.format
+           && a.extent.width == b.extent.width
+           && a.extent.height == b.extent.height
+           && a.extent.depth == b.extent.depth
+           && a.mipLevels == b.mipLevels
+           && a.arrayLayers == b.arrayLayers
+           && a.samples == b.samples
+           && a.tiling == b.tiling
+           && a.usage == b.usage;
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// REQUESTS
+  /// --------------------------------------------------
+
+  void TransientAllocator::init(VkDevice device, VmaAllocator allocator) {
+    _device = device;
+    _allocator = allocator;
+  }
+
+
+  void TransientAllocator::destroy() {
+    destroyResources();
+    for (auto &block: _blocks) {
+      if (block.allocation != nullptr) {
+        vmaFreeMemory(_allocator, block.allocation);
+      }
+    }
+    _blocks.clear();
+    _requests.clear();
+    _allocatedRequests.clear();
+    _stats = Stats{};
+  }
+
+
+  void TransientAllocator::reset() {
+    _requests.clear();
+  }
+
+
+  TransientAllocator::Index TransientAllocator::addBuffer(
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    uint32_t firstLevel,
+    uint32_t lastLevel
+  ) {
+    Request request{};
+    request.size = size;
+    request.bufferUsage = usage;
+    request.firstLevel = firstLevel;
+    request.lastLevel = lastLevel;
+    _requests.push_back(request);
+    return (Index) _requests.size() - 1;
+  }
+
+
+  TransientAllocator::Index TransientAllocator::addImage(
+    const VkImageCreateInfo &info,
+    uint32_t firstLevel,
+    uint32_t lastLevel
+  ) {
+    Request request{};
+    request.image = true;
+    request.imageInfo = info;
+    // nothing chained is kept, the info is compared with the next frame's
+    request.imageInfo.pNext = nullptr;
+    request.imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    request.imageInfo.queueFamilyIndexCount = 0;
+    request.imageInfo.pQueueFamilyIndices = nullptr;
+    request.imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    request.firstLevel = firstLevel;
+    request.lastLevel = lastLevel;
+    _requests.push_back(request);
+    return (Index) _requests.size() - 1;
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// PLACEMENT
+  /// --------------------------------------------------
+
+  void TransientAllocator::allocate() {
+    _stats = Stats{};
+    _stats.resources = (uint32_t) _requests.size();
+    // steady state: the same frame as before, nothing to create or bind
+    if (_requests == _allocatedRequests && _resources.size() == _requests.size()) {
+      for (const auto &resource: _resources) {
+        _stats.requestedBytes += resource.requirements.size;
+      }
+      for (const auto &block: _blocks) {
+        _stats.placedBytes += block.size;
+      }
+      _stats.blocks = (uint32_t) _blocks.size();
+      _stats.reused = true;
+      return;
+    }
+    destroyResources();
+
+    /// CREATE
+    _resources.resize(_requests.size());
+    for (size_t i = 0; i < _requests.size(); i++) {
+      const Request &request = _requests[i];
+      Resource &resource = _resources[i];
+      if (request.image) {
+        if (vkCreateImage(_device, &request.imageInfo, nullptr, &resource.image) != VK_SUCCESS) {
+          throw std::runtime_error("transient allocator: failed to create an image");
+        }
+        vkGetImageMemoryRequirements(_device, resource.image, &resource.requirements);
+      } else {
+        VkBufferCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        info.size = request.size;
+        info.usage = request.bufferUsage;
+        info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(_device, &info, nullptr, &resource.buffer) != VK_SUCCESS) {
+          throw std::runtime_error("transient allocator: failed to create a buffer");
+        }
+        vkGetBufferMemoryRequirements(_device, resource.buffer, &resource.requirements);
+      }
+      _stats.requestedBytes += resource.requirements.size;
+    }
+
+    /// PLACE
+    // largest first: the big resources set the block sizes, the small ones fill the gaps between them
+    std::vector<Index> order(_resources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](Index a, Index b) {
+      return _resources[a].requirements.size > _resources[b].requirements.size;
+    });
+    for (auto &block: _blocks) {
+      block.linear = true;
+      block.memoryTypeBits = ~0u;
+      block.alignment = 1;
+      block.size = 0;
+    }
+    uint32_t blockCount = 0;
+    std::vector<Index> placed{};
+    placed.reserve(order.size());
+    for (const Index index: order) {
+      Resource &resource = _resources[index];
+      const bool linear = _requests[index].isLinear();
+      // the compatible block growing the least
+      uint32_t best = blockCount;
+      VkDeviceSize bestOffset = 0;
+      VkDeviceSize bestGrowth = ~0ull;
+      for (uint32_t block = 0; block < blockCount; block++) {
+        const Block &candidate = _blocks[block];
+        if (candidate.linear != linear || (candidate.memoryTypeBits & resource.requirements.memoryTypeBits) == 0) {
+          continue;
+        }
+        const VkDeviceSize offset = findOffset(block, index, placed);
+        const VkDeviceSize end = offset + resource.requirements.size;
+        const VkDeviceSize growth = end > candidate.size ? end - candidate.size : 0;
+        if (growth < bestGrowth) {
+          best = block;
+          bestOffset = offset;
+          bestGrowth = growth;
+        }
+      }
+      if (best == blockCount) {
+        if (blockCount == _blocks.size()) {
+          _blocks.emplace_back();
+        }
+        blockCount++;
+        _blocks[best].linear = linear;
+        _blocks[best].memoryTypeBits = ~0u;
+        _blocks[best].alignment = 1;
+        _blocks[best].size = 0;
+      }
+      Block &block = _blocks[best];
+      block.memoryTypeBits &= resource.requirements.memoryTypeBits;
+      block.alignment = std::max(block.alignment, resource.requirements.alignment);
+      block.size = std::max(block.size, bestOffset + resource.requirements.size);
+      resource.block = best;
+      resource.offset = bestOffset;
+      placed.push_back(index);
+    }
+
+    /// ALLOCATE
+    for (uint32_t i = blockCount; i < _blocks.size(); i++) {
+      if (_blocks[i].allocation != nullptr) {
+        vmaFreeMemory(_allocator, _blocks[i].allocation);
+      }
+    }
+    _blocks.resize(blockCount);
+    for (auto &block: _blocks) {
+      const bool fits = block.allocation != nullptr
+                        && block.capacity >= block.size
+                        && block.capacityAlignment >= block.alignment // alignments are powers of two
+                        && (block.memoryTypeBits & (1u << block.memoryType)) != 0;
+      if (fits) {
+        continue;
+      }
+      if (block.allocation != nullptr) {
+        vmaFreeMemory(_allocator, block.allocation);
+        block.allocation = nullptr;
+      }
+      VkMemoryRequirements requirements{};
+      requirements.size = block.size;
+      requirements.alignment = block.alignment;
+      requirements.memoryTypeBits = block.memoryTypeBits;
+      VmaAllocationCreateInfo createInfo{};
+      createInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+      VmaAllocationInfo allocationInfo{};
+      if (vmaAllocateMemory(_allocator, &requirements, &createInfo, &block.allocation, &allocationInfo) != VK_SUCCESS) {
+        block.allocation = nullptr;
+        throw std::runtime_error("transient allocator: out of device memory");
+      }
+      block.capacity = block.size;
+      block.capacityAlignment = block.alignment;
+      block.memoryType = allocationInfo.memoryType;
+    }
+
+    /// BIND
+    for (const auto &resource: _resources) {
+      const Block &block = _blocks[resource.block];
+      const VkResult result = resource.image != VK_NULL_HANDLE
+                              ? vmaBindImageMemory2(_allocator, block.allocation, resource.offset, resource.image, nullptr)
+                              : vmaBindBufferMemory2(_allocator, block.allocation, resource.offset, resource.buffer, nullptr);
+      if (result != VK_SUCCESS) {
+        throw std::runtime_error("transient allocator: failed to bind memory");
+      }
+    }
+    for (const auto &block: _blocks) {
+      _stats.placedBytes += block.size;
+    }
+    _stats.blocks = (uint32_t) _blocks.size();
+    _allocatedRequests = _requests;
+  }
+
+
+  VkDeviceSize TransientAllocator::findOffset(uint32_t block, Index index, const std::vector<Index> &placed) const {
+    const Request &request = _requests[index];
+    const VkMemoryRequirements &requirements = _resources[index].requirements;
+    // the ranges taken while the resource is alive, by offset
+    std::vector<std::pair<VkDeviceSize, VkDeviceSize>> taken{};
+    for (const Index other: placed) {
+      const Request &otherRequest = _requests[other];
+      if (_resources[other].block == block
+          && lifetimesOverlap(request.firstLevel, request.lastLevel, otherRequest.firstLevel, otherRequest.lastLevel)) {
+        taken.emplace_back(_resources[other].offset, _resources[other].offset + _resources[other].requirements.size);
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    VkDeviceSize offset = 0;
+    for (const auto &[begin, end]: taken) {
+      if (alignUp(offset, requirements.alignment) + requirements.size <= begin) {
+        break;
+      }
+      offset = std::max(offset, end);
+    }
+    return alignUp(offset, requirements.alignment);
+  }
+
+
+  void TransientAllocator::previousOccupants(Index index, std::vector<Index> &outOccupants) const {
+    outOccupants.clear();
+    const Resource &resource = _resources.at(index);
+    const VkDeviceSize end = resource.offset + resource.requirements.size;
+    for (Index other = 0; other < _resources.size(); other++) {
+      const Resource &occupant = _resources[other];
+      const bool sharesMemory = occupant.block == resource.block
+                                && occupant.offset < end
+                                && resource.offset < occupant.offset + occupant.requirements.size;
+      if (other != index && sharesMemory && _requests[other].lastLevel < _requests[index].firstLevel) {
+        outOccupants.push_back(other);
+      }
+    }
+  }
+
+
+  void TransientAllocator::destroyResources() {
+    for (auto &resource: _resources) {
+      if (resource.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(_device, resource.buffer, nullptr);
+      }
+      if (resource.image != VK_NULL_HANDLE) {
+        vkDestroyImage(_device, resource.image, nullptr);
+      }
+    }
+    _resources.clear();
+    _allocatedRequests.clear();
+  }
+
+} // walrus
@@ -0,0 +1,129 @@
+#ifndef WALRUS_COMPUTE_ENGINE_TRANSIENT_ALLOCATOR_HPP
+#define WALRUS_COMPUTE_ENGINE_TRANSIENT_ALLOCATOR_HPP
+
+#include <vk_types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief device memory for the buffers & images that only live during part of a frame (intermediate targets,
+   * compute scratch). resources whose lifetimes don't overlap are placed in the same memory, at overlapping offsets.
+   * usage, every frame: reset(), addBuffer() / addImage() with the levels they are used in, allocate().
+   * when the requests match the previous frame, its resources & placement are kept as they are.
+   * @note resources sharing memory don't share contents. the first access of a resource has to write it
+   *       (images start in VK_IMAGE_LAYOUT_UNDEFINED), after a barrier on the previous occupants, see `previousOccupants`
+   * @note allocate() destroys the previous frame's resources when the requests changed, call it once they are unused
+   */
+  class TransientAllocator {
+  public:
+    using Index = uint32_t;
+
+    /// @brief what allocate() did, i.e. to compare peak memory with & without aliasing
+    struct Stats {
+      uint32_t resources = 0;
+      uint32_t blocks = 0;
+      /// the memory the resources would take without aliasing
+      VkDeviceSize requestedBytes = 0;
+      /// the memory they take, summed over the blocks
+      VkDeviceSize placedBytes = 0;
+      /// true if the previous frame's resources were kept
+      bool reused = false;
+    };
+
+    TransientAllocator() = default;
+
+    ~TransientAllocator() = default;
+
+    TransientAllocator(const TransientAllocator &) = delete;
+    TransientAllocator &operator=(const TransientAllocator &) = delete;
+
+    void init(VkDevice device, VmaAllocator allocator);
+
+    /// @brief destroys the resources & frees the memory. call once the device is idle
+    void destroy();
+
+    /// @brief forget the requests of the previous frame. its resources & memory are kept for allocate() to reuse
+    void reset();
+
+    /// REQUESTS
+
+    /// @param firstLevel & lastLevel the first & last frame graph level using the resource, inclusive
+    Index addBuffer(VkDeviceSize size, VkBufferUsageFlags usage, uint32_t firstLevel, uint32_t lastLevel);
+
+    /// @param info an image with `initialLayout` UNDEFINED, created with exclusive sharing
+    Index addImage(const VkImageCreateInfo &info, uint32_t firstLevel, uint32_t lastLevel);
+
+    /// @brief creates the resources and binds them to (shared) memory. throws if memory runs out
+    void allocate();
+
+    /// RESULTS
+
+    [[nodiscard]] VkBuffer getBuffer(Index index) const { return _resources.at(index).buffer; }
+
+    [[nodiscard]] VkImage getImage(Index index) const { return _resources.at(index).image; }
+
+    /// @brief the resources placed in memory `index` used before it, in no particular order
+    void previousOccupants(Index index, std::vector<Index> &outOccupants) const;
+
+    [[nodiscard]] const Stats &stats() const { return _stats; }
+
+  private:
+    /// @brief a request, compared with the previous frame's to reuse its resources
+    struct Request {
+      bool image = false;
+      VkDeviceSize size = 0;
+      VkBufferUsageFlags bufferUsage = 0;
+      VkImageCreateInfo imageInfo{};
+      uint32_t firstLevel = 0;
+      uint32_t lastLevel = 0;
+
+      [[nodiscard]] bool operator==(const Request &other) const;
+
+      /// @brief buffers & linear tiling images. bufferImageGranularity only separates linear from non-linear resources
+      [[nodiscard]] bool isLinear() const { return !image || imageInfo.tiling == VK_IMAGE_TILING_LINEAR; }
+    };
+
+    struct Resource {
+      VkBuffer buffer = VK_NULL_HANDLE;
+      VkImage image = VK_NULL_HANDLE;
+      VkMemoryRequirements requirements{};
+      uint32_t block = 0;
+      VkDeviceSize offset = 0;
+    };
+
+    /// @brief one allocation, shared by resources with compatible memory types
+    struct Block {
+      /// linear & non-linear resources get their own blocks, so they never share a bufferImageGranularity page
+      bool linear = true;
+      uint32_t memoryTypeBits = ~0u;
+      VkDeviceSize alignment = 1;
+      VkDeviceSize size = 0;
+      /// kept between frames, reallocated when too small, misaligned or of an incompatible type
+      VmaAllocation allocation = nullptr;
+      VkDeviceSize capacity = 0;
+      VkDeviceSize capacityAlignment = 1;
+      uint32_t memoryType = 0;
+    };
+
+    /// @brief the lowest offset in `block` where `index` fits, next to the resources already placed that it overlaps in time
+    VkDeviceSize findOffset(uint32_t block, Index index, const std::vector<Index> &placed) const;
+
+    void destroyResources();
+
+    VkDevice _device = VK_NULL_HANDLE;
+    VmaAllocator _allocator = nullptr;
+
+    std::vector<Request> _requests{};
+    /// the requests `_resources` were created for
+    std::vector<Request> _allocatedRequests{};
+    std::vector<Resource> _resources{};
+    std::vector<Block> _blocks{};
+    Stats _stats{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_TRANSIENT_ALLOCATOR_HPP
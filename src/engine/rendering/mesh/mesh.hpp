@@ -1,6 +1,9 @@
 #ifndef WALRUS_COMPUTE_ENGINE_MESH_HPP
 #define WALRUS_COMPUTE_ENGINE_MESH_HPP
 
+#include "engine/compute/gpu_buffer/gpu_buffer.hpp"
+#include "engine/compute/memory/budget/memory_budget.hpp"
+
 #include <vk_types.h>
 #include <vector>
 #include <glm/vec3.hpp>
@@ -23,7 +26,9 @@ namespace walrus {
 
   struct Mesh {
     std::vector<Vertex> vertices;
-    AllocatedBuffer vertexBuffer;
+    GpuBuffer<Vertex> vertexBuffer;
+    /// the vertex buffer is a streamed asset: evicted under memory pressure, uploaded again when needed
+    StreamedAssetHandle residency{};
   };
 
 } // walrus
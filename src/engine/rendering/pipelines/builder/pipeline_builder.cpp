@@ -1,10 +1,53 @@
 #include "pipeline_builder.hpp"
 
 #include "pretty_io.hpp"
+#include "engine/utils/hash/hash.hpp"
+
 #include <iostream>
+#include <array>
+#include <stdexcept>
 
 namespace walrus {
 
+  namespace {
+    /// mixed into the key of fast-linked pipelines, so they don't collide with optimized / monolithic ones
+    constexpr uint64_t FAST_LINK_TAG = 0x9e3779b97f4a7c15ull;
+
+    void addShaderStage(hash::Hasher &hasher, const VkPipelineShaderStageCreateInfo &stage, uint64_t codeHash) {
+      hasher.add(stage.stage);
+      hasher.add(stage.flags);
+      hasher.addString(stage.pName);
+      if (codeHash != 0) {
+        hasher.add(codeHash);
+      } else {
+        hasher.add(stage.module);
+      }
+      hasher.add(stage.pSpecializationInfo != nullptr);
+      if (stage.pSpecializationInfo != nullptr) {
+        const VkSpecializationInfo &spec = *stage.pSpecializationInfo;
+        hasher.add(spec.mapEntryCount);
+        for (uint32_t i = 0; i < spec.mapEntryCount; i++) {
+          hasher.add(spec.pMapEntries[i].constantID);
+          hasher.add(spec.pMapEntries[i].offset);
+          hasher.add(spec.pMapEntries[i].size);
+        }
+        hasher.addBytes(spec.pData, spec.dataSize);
+      }
+    }
+
+    void addMultisampleState(hash::Hasher &hasher, const VkPipelineMultisampleStateCreateInfo &state) {
+      hasher.add(state.rasterizationSamples);
+      hasher.add(state.sampleShadingEnable);
+      hasher.add(state.minSampleShading);
+      hasher.add(state.alphaToCoverageEnable);
+      hasher.add(state.alphaToOneEnable);
+      if (state.pSampleMask != nullptr) {
+        const uint32_t words = (state.rasterizationSamples + 31) / 32;
+        hasher.addBytes(state.pSampleMask, words * sizeof(VkSampleMask));
+      }
+    }
+  }
+
   PipelineBuilder::PipelineBuilder() {
     init();
   }
@@ -22,26 +65,143 @@ namespace walrus {
     this->viewport.y = 0.f;
   }
 
-  void PipelineBuilder::build(VkDevice vkDevice, VkRenderPass vkRenderPass, VkPipeline *outPipeline) {
-    /// VIEWPORT
+  void PipelineBuilder::addShaderStage(VkShaderStageFlagBits stage, VkShaderModule vkShaderModule, uint64_t codeHash) {
+    // keep hashes aligned with stages, even if stages were pushed directly
+    shaderHashes.resize(shaderStages.size(), 0);
+    shaderStages.push_back(defaults::pipeline::shaderStageCreateInfo(stage, vkShaderModule));
+    shaderHashes.push_back(codeHash);
+  }
+
+  hash::Key PipelineBuilder::key(const RenderPassInfo &renderPass) const {
+    // the full state is exactly the union of the library parts
+    hash::Hasher hasher = hash::Hasher::recorder();
+    for (uint32_t part = 0; part < LIBRARY_PART_COUNT; part++) {
+      addLibraryPart(hasher, static_cast<LibraryPart>(part), renderPass);
+    }
+    return hasher.key();
+  }
+
+  hash::Key PipelineBuilder::libraryPartKey(LibraryPart part, const RenderPassInfo &renderPass) const {
+    hash::Hasher hasher = hash::Hasher::recorder();
+    addLibraryPart(hasher, part, renderPass);
+    return hasher.key();
+  }
+
+  void PipelineBuilder::addLibraryPart(hash::Hasher &hasher, LibraryPart part, const RenderPassInfo &renderPass) const {
+    hasher.add(part);
+    switch (part) {
+      case VERTEX_INPUT: {
+        /// VERTEX INPUT
+        hasher.add(vertexInputState.flags);
+        hasher.add(vertexInputState.vertexBindingDescriptionCount);
+        for (uint32_t i = 0; i < vertexInputState.vertexBindingDescriptionCount; i++) {
+          const auto &binding = vertexInputState.pVertexBindingDescriptions[i];
+          hasher.add(binding.binding).add(binding.stride).add(binding.inputRate);
+        }
+        hasher.add(vertexInputState.vertexAttributeDescriptionCount);
+        for (uint32_t i = 0; i < vertexInputState.vertexAttributeDescriptionCount; i++) {
+          const auto &attribute = vertexInputState.pVertexAttributeDescriptions[i];
+          hasher.add(attribute.location).add(attribute.binding).add(attribute.format).add(attribute.offset);
+        }
+        /// INPUT ASSEMBLY
+        hasher.add(inputAssemblyState.topology);
+        hasher.add(inputAssemblyState.primitiveRestartEnable);
+        return;
+      }
+      case PRE_RASTERIZATION: {
+        /// SHADER STAGES (everything but fragment)
+        for (size_t i = 0; i < shaderStages.size(); i++) {
+          if (shaderStages[i].stage != VK_SHADER_STAGE_FRAGMENT_BIT) {
+            addShaderStage(hasher, shaderStages[i], i < shaderHashes.size() ? shaderHashes[i] : 0);
+          }
+        }
+        /// VIEWPORT
+        hasher.add(viewport.x).add(viewport.y).add(viewport.width).add(viewport.height);
+        hasher.add(viewport.minDepth).add(viewport.maxDepth);
+        hasher.add(scissor.offset.x).add(scissor.offset.y);
+        hasher.add(scissor.extent.width).add(scissor.extent.height);
+        /// RASTERIZER
+        hasher.add(rasterizerState.depthClampEnable);
+        hasher.add(rasterizerState.rasterizerDiscardEnable);
+        hasher.add(rasterizerState.polygonMode);
+        hasher.add(rasterizerState.cullMode);
+        hasher.add(rasterizerState.frontFace);
+        hasher.add(rasterizerState.depthBiasEnable);
+        hasher.add(rasterizerState.depthBiasConstantFactor);
+        hasher.add(rasterizerState.depthBiasClamp);
+        hasher.add(rasterizerState.depthBiasSlopeFactor);
+        hasher.add(rasterizerState.lineWidth);
+        break;
+      }
+      case FRAGMENT_SHADER: {
+        /// SHADER STAGES (fragment only)
+        for (size_t i = 0; i < shaderStages.size(); i++) {
+          if (shaderStages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+            addShaderStage(hasher, shaderStages[i], i < shaderHashes.size() ? shaderHashes[i] : 0);
+          }
+        }
+        addMultisampleState(hasher, multisampleState);
+        break;
+      }
+      case FRAGMENT_OUTPUT: {
+        /// COLOR BLEND
+        hasher.add(colorBlendAttachmentState.blendEnable);
+        hasher.add(colorBlendAttachmentState.srcColorBlendFactor);
+        hasher.add(colorBlendAttachmentState.dstColorBlendFactor);
+        hasher.add(colorBlendAttachmentState.colorBlendOp);
+        hasher.add(colorBlendAttachmentState.srcAlphaBlendFactor);
+        hasher.add(colorBlendAttachmentState.dstAlphaBlendFactor);
+        hasher.add(colorBlendAttachmentState.alphaBlendOp);
+        hasher.add(colorBlendAttachmentState.colorWriteMask);
+        addMultisampleState(hasher, multisampleState);
+        hasher.addKey(renderPass.key);
+        return;
+      }
+      default:
+        throw std::runtime_error("unknown pipeline library part");
+    }
+    /// RENDER PASS & LAYOUT
+    // render pass handles may be reused once destroyed, so the render pass is hashed by value (see RenderPassInfo).
+    // layouts are deduplicated by the PipelineCache and live as long as it does, so their handles identify their state.
+    hasher.addKey(renderPass.key);
+    hasher.add(pipelineLayout);
+  }
+
+  VkPipelineViewportStateCreateInfo PipelineBuilder::viewportStateCreateInfo() const {
     // TODO: enable multiple viewports
-    VkPipelineViewportStateCreateInfo viewportCreate = {};
-    viewportCreate.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportCreate.pNext = nullptr;
-    viewportCreate.viewportCount = 1;
-    viewportCreate.pViewports = &this->viewport;
-    viewportCreate.scissorCount = 1;
-    viewportCreate.pScissors = &this->scissor;
+    VkPipelineViewportStateCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    info.pNext = nullptr;
+    info.viewportCount = 1;
+    info.pViewports = &this->viewport;
+    info.scissorCount = 1;
+    info.pScissors = &this->scissor;
+    return info;
+  }
 
-    /// COLOR BLEND
+  VkPipelineColorBlendStateCreateInfo PipelineBuilder::colorBlendStateCreateInfo() const {
     // TODO: enable true color blending logic
-    VkPipelineColorBlendStateCreateInfo colorBlendCreate{}; /// NOTE: this has to match fragment shader outputs
-    colorBlendCreate.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlendCreate.pNext = nullptr;
-    colorBlendCreate.logicOpEnable = VK_FALSE;
-    colorBlendCreate.logicOp = VK_LOGIC_OP_COPY;
-    colorBlendCreate.attachmentCount = 1;
-    colorBlendCreate.pAttachments = &this->colorBlendAttachmentState;
+    VkPipelineColorBlendStateCreateInfo info{}; /// NOTE: this has to match fragment shader outputs
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    info.pNext = nullptr;
+    info.logicOpEnable = VK_FALSE;
+    info.logicOp = VK_LOGIC_OP_COPY;
+    info.attachmentCount = 1;
+    info.pAttachments = &this->colorBlendAttachmentState;
+    return info;
+  }
+
+  void PipelineBuilder::build(
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    VkPipeline *outPipeline,
+    VkPipelineCache vkPipelineCache
+  ) {
+    /// VIEWPORT
+    VkPipelineViewportStateCreateInfo viewportCreate = viewportStateCreateInfo();
+
+    /// COLOR BLEND
+    VkPipelineColorBlendStateCreateInfo colorBlendCreate = colorBlendStateCreateInfo();
 
     /// PIPELINE
     VkGraphicsPipelineCreateInfo info{};
@@ -55,14 +215,14 @@ namespace walrus {
     info.pMultisampleState = &this->multisampleState;
     info.pViewportState = &viewportCreate;
     info.pColorBlendState = &colorBlendCreate;
-    info.renderPass = vkRenderPass;
+    info.renderPass = renderPass.renderPass;
     info.layout = this->pipelineLayout;
-    info.subpass = 0;
+    info.subpass = renderPass.subpass;
     info.basePipelineHandle = VK_NULL_HANDLE;
 
     if (vkCreateGraphicsPipelines(
       vkDevice,
-      VK_NULL_HANDLE,
+      vkPipelineCache,
       1,
       &info,
       nullptr,
@@ -70,8 +230,181 @@ namespace walrus {
     ) != VK_SUCCESS) {
       vkDestroyPipeline(vkDevice, *outPipeline, nullptr);
       std::cout << io::to_color_string(io::RED, "failed to create pipeline");
-      outPipeline = VK_NULL_HANDLE;
+      *outPipeline = VK_NULL_HANDLE;
+    }
+  }
+
+  void PipelineBuilder::build(
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    PipelineCache &cache,
+    VkPipeline *outPipeline,
+    VkPipelineCache vkPipelineCache
+  ) {
+    hash::Key pipelineKey = key(renderPass);
+    if (cache.findPipeline(pipelineKey, outPipeline)) {
+      return;
+    }
+    build(vkDevice, renderPass, outPipeline, vkPipelineCache);
+    if (*outPipeline != VK_NULL_HANDLE) {
+      *outPipeline = cache.insertPipeline(vkDevice, std::move(pipelineKey), *outPipeline);
+    }
+  }
+
+
+
+
+  /// --------------------------------------------------
+  /// GRAPHICS PIPELINE LIBRARY
+  /// --------------------------------------------------
+
+  VkPipeline PipelineBuilder::buildLibraryPart(
+    LibraryPart part,
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    PipelineCache &cache,
+    VkPipelineCache vkPipelineCache
+  ) {
+    hash::Key partKey = libraryPartKey(part, renderPass);
+    VkPipeline library = VK_NULL_HANDLE;
+    if (cache.findPipeline(partKey, &library)) {
+      return library;
     }
+
+    VkPipelineViewportStateCreateInfo viewportCreate = viewportStateCreateInfo();
+    VkPipelineColorBlendStateCreateInfo colorBlendCreate = colorBlendStateCreateInfo();
+    std::vector<VkPipelineShaderStageCreateInfo> stages{};
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryInfo.pNext = nullptr;
+
+    VkGraphicsPipelineCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    info.pNext = &libraryInfo;
+    // retaining link time optimization info lets the same parts be fast-linked now & optimized later
+    info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR
+                 | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    info.subpass = renderPass.subpass;
+    info.basePipelineHandle = VK_NULL_HANDLE;
+    info.basePipelineIndex = -1;
+
+    switch (part) {
+      case VERTEX_INPUT:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+        info.pVertexInputState = &this->vertexInputState;
+        info.pInputAssemblyState = &this->inputAssemblyState;
+        break;
+      case PRE_RASTERIZATION:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+        for (auto &stage: shaderStages) {
+          if (stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT) { stages.push_back(stage); }
+        }
+        info.pViewportState = &viewportCreate;
+        info.pRasterizationState = &this->rasterizerState;
+        info.layout = this->pipelineLayout;
+        info.renderPass = renderPass.renderPass;
+        break;
+      case FRAGMENT_SHADER:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+        for (auto &stage: shaderStages) {
+          if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT) { stages.push_back(stage); }
+        }
+        // TODO : pass depth stencil state once the render pass has a depth attachment
+        info.pMultisampleState = &this->multisampleState;
+        info.layout = this->pipelineLayout;
+        info.renderPass = renderPass.renderPass;
+        break;
+      case FRAGMENT_OUTPUT:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+        info.pColorBlendState = &colorBlendCreate;
+        info.pMultisampleState = &this->multisampleState;
+        info.renderPass = renderPass.renderPass;
+        break;
+      default:
+        throw std::runtime_error("unknown pipeline library part");
+    }
+    info.stageCount = static_cast<uint32_t>(stages.size());
+    info.pStages = stages.empty() ? nullptr : stages.data();
+
+    if (vkCreateGraphicsPipelines(vkDevice, vkPipelineCache, 1, &info, nullptr, &library) != VK_SUCCESS) {
+      std::cout << io::to_color_string(io::RED, "failed to create pipeline library part") << std::endl;
+      return VK_NULL_HANDLE;
+    }
+    return cache.insertPipeline(vkDevice, std::move(partKey), library);
+  }
+
+  VkPipeline PipelineBuilder::link(
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    PipelineCache &cache,
+    VkPipelineCache vkPipelineCache,
+    bool optimize
+  ) {
+    // an optimized link is equivalent to a monolithic pipeline, so it shares the monolithic key
+    hash::Key pipelineKey = key(renderPass);
+    if (!optimize) {
+      pipelineKey = hash::Hasher::recorder().addKey(pipelineKey).add(FAST_LINK_TAG).key();
+    }
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (cache.findPipeline(pipelineKey, &pipeline)) {
+      return pipeline;
+    }
+
+    /// LIBRARY PARTS
+    // parts are cached independently, so permutations only compile the parts that changed
+    std::array<VkPipeline, LIBRARY_PART_COUNT> libraries{};
+    for (uint32_t part = 0; part < LIBRARY_PART_COUNT; part++) {
+      libraries[part] = buildLibraryPart(
+        static_cast<LibraryPart>(part),
+        vkDevice,
+        renderPass,
+        cache,
+        vkPipelineCache
+      );
+      if (libraries[part] == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+      }
+    }
+
+    /// LINK
+    VkPipelineLibraryCreateInfoKHR linkInfo{};
+    linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    linkInfo.pNext = nullptr;
+    linkInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    linkInfo.pLibraries = libraries.data();
+
+    VkGraphicsPipelineCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    info.pNext = &linkInfo;
+    info.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    info.layout = this->pipelineLayout;
+    info.basePipelineHandle = VK_NULL_HANDLE;
+    info.basePipelineIndex = -1;
+
+    if (vkCreateGraphicsPipelines(vkDevice, vkPipelineCache, 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
+      std::cout << io::to_color_string(io::RED, "failed to link pipeline libraries") << std::endl;
+      return VK_NULL_HANDLE;
+    }
+    return cache.insertPipeline(vkDevice, std::move(pipelineKey), pipeline);
+  }
+
+  VkPipeline PipelineBuilder::buildLinked(
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    PipelineCache &cache,
+    VkPipelineCache vkPipelineCache
+  ) {
+    return link(vkDevice, renderPass, cache, vkPipelineCache, false);
+  }
+
+  VkPipeline PipelineBuilder::buildOptimized(
+    VkDevice vkDevice,
+    const RenderPassInfo &renderPass,
+    PipelineCache &cache,
+    VkPipelineCache vkPipelineCache
+  ) {
+    return link(vkDevice, renderPass, cache, vkPipelineCache, true);
   }
 
-} // walrus
\ No newline at end of file
+} // walrus
@@ -2,9 +2,12 @@
 #define WALRUS_COMPUTE_ENGINE_PIPELINE_BUILDER_HPP
 
 #include "../defaults/pipeline_defaults.hpp"
+#include "../cache/pipeline_cache.hpp"
+#include "../../renderpasses/render_pass.hpp"
 
 #include <vk_types.h>
 #include <vector>
+#include <cstdint>
 
 namespace walrus {
 
@@ -17,9 +20,86 @@ namespace walrus {
 
     ~PipelineBuilder() = default;
 
-    void build(VkDevice vkDevice, VkRenderPass vkRenderPass, VkPipeline *outPipeline);
+    /**
+     * @brief appends a shader stage and remembers its code hash for `key()`
+     * @param codeHash a hash of the spir-v the module was created from.
+     *        if 0, the module handle is hashed instead (only dedups the exact same module)
+     */
+    void addShaderStage(VkShaderStageFlagBits stage, VkShaderModule vkShaderModule, uint64_t codeHash = 0);
+
+    /// @brief the independently compiled parts of a pipeline (VK_EXT_graphics_pipeline_library)
+    enum LibraryPart : uint32_t {
+      VERTEX_INPUT = 0,
+      PRE_RASTERIZATION,
+      FRAGMENT_SHADER,
+      FRAGMENT_OUTPUT,
+      LIBRARY_PART_COUNT
+    };
+
+    /// @brief a stable key over all state that is passed to vkCreateGraphicsPipelines
+    [[nodiscard]] hash::Key key(const RenderPassInfo &renderPass) const;
+
+    /// @brief a stable key over only the state that the library part consumes
+    [[nodiscard]] hash::Key libraryPartKey(LibraryPart part, const RenderPassInfo &renderPass) const;
+
+    /**
+     * @param vkPipelineCache (optional) driver cache used for compilation.
+     *        externally synchronized -- when building from multiple threads, give each thread its own.
+     */
+    void build(
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      VkPipeline *outPipeline,
+      VkPipelineCache vkPipelineCache = VK_NULL_HANDLE
+    );
+
+    /// @brief returns the cached pipeline if identical state was built before, otherwise builds & caches it
+    void build(
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      PipelineCache &cache,
+      VkPipeline *outPipeline,
+      VkPipelineCache vkPipelineCache = VK_NULL_HANDLE
+    );
+
+    /**
+     * @brief compile (or reuse) a single library part. owned by `cache`.
+     * @note requires DeviceInfo::Capabilities::graphicsPipelineLibrary
+     */
+    VkPipeline buildLibraryPart(
+      LibraryPart part,
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      PipelineCache &cache,
+      VkPipelineCache vkPipelineCache = VK_NULL_HANDLE
+    );
+
+    /**
+     * @brief compiles any missing library parts, then links them without link time optimization.
+     * fast enough to run at draw time when `graphicsPipelineLibraryFastLinking` is reported.
+     * @return the linked pipeline (owned by `cache`), or VK_NULL_HANDLE on failure
+     */
+    VkPipeline buildLinked(
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      PipelineCache &cache,
+      VkPipelineCache vkPipelineCache = VK_NULL_HANDLE
+    );
+
+    /**
+     * @brief links the library parts with link time optimization. slow -- meant for a worker thread.
+     * the result is cached under the same key as a monolithic `build`.
+     */
+    VkPipeline buildOptimized(
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      PipelineCache &cache,
+      VkPipelineCache vkPipelineCache = VK_NULL_HANDLE
+    );
 
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages{};
+    /// @brief parallel to shaderStages. filled by addShaderStage()
+    std::vector<uint64_t> shaderHashes{};
     VkPipelineVertexInputStateCreateInfo vertexInputState = defaults::pipeline::vertexInputStateCreateInfo();
     VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = defaults::pipeline::inputAssemblyStateCreateInfo();
     VkPipelineRasterizationStateCreateInfo rasterizerState = defaults::pipeline::rasterizationStateCreateInfo();
@@ -28,6 +108,21 @@ namespace walrus {
     VkRect2D scissor{};
     VkViewport viewport{};
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+  private:
+    /// @note returned structs point into this builder
+    [[nodiscard]] VkPipelineViewportStateCreateInfo viewportStateCreateInfo() const;
+    [[nodiscard]] VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo() const;
+
+    void addLibraryPart(hash::Hasher &hasher, LibraryPart part, const RenderPassInfo &renderPass) const;
+
+    VkPipeline link(
+      VkDevice vkDevice,
+      const RenderPassInfo &renderPass,
+      PipelineCache &cache,
+      VkPipelineCache vkPipelineCache,
+      bool optimize
+    );
   };
 
 } // walrus
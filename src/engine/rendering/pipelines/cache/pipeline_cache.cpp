@@ -0,0 +1,277 @@
+#include "pipeline_cache.hpp"
+
+#include "engine/shaders/compiler/shader_compiler.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace walrus {
+
+  namespace {
+    /// @brief true if `data` was saved by the same driver & device, so the driver can use it
+    bool isCompatible(const std::vector<char> &data, const VkPhysicalDeviceProperties &properties) {
+      VkPipelineCacheHeaderVersionOne header{};
+      if (data.size() < sizeof(header)) {
+        return false;
+      }
+      // the header is tightly packed & may be unaligned in the file
+      memcpy(&header, data.data(), sizeof(header));
+      return header.headerSize >= sizeof(header)
+             && header.headerSize <= data.size()
+             && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+             && header.vendorID == properties.vendorID
+             && header.deviceID == properties.deviceID
+             && memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+  }
+
+  hash::Key PipelineCache::layoutKey(const VkPipelineLayoutCreateInfo &info) {
+    hash::Hasher hasher = hash::Hasher::recorder();
+    hasher.add(info.flags);
+    hasher.add(info.setLayoutCount);
+    for (uint32_t i = 0; i < info.setLayoutCount; i++) {
+      hasher.add(info.pSetLayouts[i]);
+    }
+    hasher.add(info.pushConstantRangeCount);
+    for (uint32_t i = 0; i < info.pushConstantRangeCount; i++) {
+      hasher.add(info.pPushConstantRanges[i].stageFlags);
+      hasher.add(info.pPushConstantRanges[i].offset);
+      hasher.add(info.pPushConstantRanges[i].size);
+    }
+    return hasher.key();
+  }
+
+
+  VkPipelineLayout PipelineCache::getLayout(VkDevice vkDevice, const VkPipelineLayoutCreateInfo &info) {
+    hash::Key key = layoutKey(info);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _layouts.find(key);
+    if (it != _layouts.end()) {
+      _stats.layoutHits++;
+      return it->second;
+    }
+    _stats.layoutMisses++;
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    if (vkCreatePipelineLayout(vkDevice, &info, nullptr, &layout) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create pipeline layout");
+    }
+    _layouts.emplace(std::move(key), layout);
+    return layout;
+  }
+
+
+  bool PipelineCache::findPipeline(const hash::Key &key, VkPipeline *outPipeline) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pipelines.find(key);
+    if (it == _pipelines.end()) {
+      _stats.pipelineMisses++;
+      return false;
+    }
+    _stats.pipelineHits++;
+    _references[it->second]++;
+    *outPipeline = it->second;
+    return true;
+  }
+
+
+  VkPipeline PipelineCache::insertPipeline(VkDevice vkDevice, hash::Key key, VkPipeline vkPipeline) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto [it, inserted] = _pipelines.emplace(std::move(key), vkPipeline);
+    if (!inserted && it->second != vkPipeline) {
+      // two threads compiled the same state. keep the first one.
+      vkDestroyPipeline(vkDevice, vkPipeline, nullptr);
+    }
+    _references[it->second]++;
+    return it->second;
+  }
+
+
+  void PipelineCache::retainPipeline(VkPipeline vkPipeline) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _references.find(vkPipeline);
+    if (it != _references.end()) {
+      it->second++;
+    }
+  }
+
+
+  bool PipelineCache::releasePipeline(VkPipeline vkPipeline) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto references = _references.find(vkPipeline);
+    if (references == _references.end() || --references->second > 0) {
+      return false;
+    }
+    // the last reference: no thread can get the pipeline from a lookup anymore once its entry is gone
+    _references.erase(references);
+    for (auto it = _pipelines.begin(); it != _pipelines.end(); it++) {
+      if (it->second == vkPipeline) {
+        _pipelines.erase(it);
+        break;
+      }
+    }
+    return true;
+  }
+
+
+  void PipelineCache::setCacheFile(const std::string &filePath, const VkPhysicalDeviceProperties &properties) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cacheFile = filePath;
+    _deviceProperties = properties;
+  }
+
+
+  VkPipelineCache PipelineCache::createDriverCache(VkDevice vkDevice) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    createDriverCacheLocked(vkDevice);
+    return _driverCache;
+  }
+
+
+  void PipelineCache::createDriverCacheLocked(VkDevice vkDevice) {
+    if (_driverCache != VK_NULL_HANDLE) {
+      return;
+    }
+    /// SAVED DATA
+    std::vector<char> data{};
+    if (!_cacheFile.empty()) {
+      std::ifstream file(_cacheFile, std::ios::binary);
+      data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+      if (!isCompatible(data, _deviceProperties)) {
+        data.clear(); // missing, or saved by another driver / device: start cold
+      }
+    }
+
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.pNext = nullptr;
+    info.flags = 0;
+    info.initialDataSize = data.size();
+    info.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(vkDevice, &info, nullptr, &_driverCache) != VK_SUCCESS) {
+      _driverCache = VK_NULL_HANDLE;
+      throw std::runtime_error("failed to create pipeline cache");
+    }
+  }
+
+
+  bool PipelineCache::saveDriverCache(VkDevice vkDevice) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return saveDriverCacheLocked(vkDevice);
+  }
+
+
+  bool PipelineCache::saveDriverCacheLocked(VkDevice vkDevice) {
+    if (_driverCache == VK_NULL_HANDLE || _cacheFile.empty()) {
+      return false;
+    }
+    size_t size = 0;
+    if (vkGetPipelineCacheData(vkDevice, _driverCache, &size, nullptr) != VK_SUCCESS) {
+      return false;
+    }
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(vkDevice, _driverCache, &size, data.data()) != VK_SUCCESS) {
+      return false;
+    }
+    data.resize(size);
+
+    // write a temporary file and rename it, so a crash or another instance can't leave a truncated cache behind
+    const std::string temporary = ShaderCompiler::temporaryPath(_cacheFile);
+    {
+      std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+      file.write(data.data(), static_cast<std::streamsize>(data.size()));
+      if (!file.good()) {
+        return false;
+      }
+    }
+    std::error_code error{};
+    std::filesystem::rename(temporary, _cacheFile, error);
+    if (error) {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+
+
+  std::vector<VkPipelineCache> PipelineCache::createWorkerCaches(VkDevice vkDevice, uint32_t count) {
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.pNext = nullptr;
+    info.flags = 0;
+    info.initialDataSize = 0;
+    info.pInitialData = nullptr;
+
+    std::vector<VkPipelineCache> caches(count, VK_NULL_HANDLE);
+    for (auto &cache: caches) {
+      if (vkCreatePipelineCache(vkDevice, &info, nullptr, &cache) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache");
+      }
+    }
+    return caches;
+  }
+
+
+  void PipelineCache::mergeWorkerCaches(VkDevice vkDevice, std::vector<VkPipelineCache> &workerCaches) {
+    if (workerCaches.empty()) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    // jobs started before the driver cache was created still keep what the workers compiled
+    createDriverCacheLocked(vkDevice);
+    vkMergePipelineCaches(
+      vkDevice,
+      _driverCache,
+      static_cast<uint32_t>(workerCaches.size()),
+      workerCaches.data()
+    );
+    for (auto &cache: workerCaches) {
+      vkDestroyPipelineCache(vkDevice, cache, nullptr);
+    }
+    workerCaches.clear();
+  }
+
+
+  size_t PipelineCache::pipelineCount() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pipelines.size();
+  }
+
+
+  size_t PipelineCache::layoutCount() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _layouts.size();
+  }
+
+
+  PipelineCache::Stats PipelineCache::getStats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+
+  void PipelineCache::destroy(VkDevice vkDevice) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // must destroy pipelines before pipeline layouts
+    for (auto &[key, pipeline]: _pipelines) {
+      vkDestroyPipeline(vkDevice, pipeline, nullptr);
+    }
+    _pipelines.clear();
+    _references.clear();
+    // pipeline layouts are now safe to destroy
+    for (auto &[key, layout]: _layouts) {
+      vkDestroyPipelineLayout(vkDevice, layout, nullptr);
+    }
+    _layouts.clear();
+    if (_driverCache != VK_NULL_HANDLE) {
+      // a cache that can't be saved only means a cold start next run
+      saveDriverCacheLocked(vkDevice);
+      vkDestroyPipelineCache(vkDevice, _driverCache, nullptr);
+      _driverCache = VK_NULL_HANDLE;
+    }
+  }
+
+} // walrus
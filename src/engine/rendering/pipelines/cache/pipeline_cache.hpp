@@ -0,0 +1,113 @@
+#ifndef WALRUS_COMPUTE_ENGINE_PIPELINE_CACHE_HPP
+#define WALRUS_COMPUTE_ENGINE_PIPELINE_CACHE_HPP
+
+#include <vk_types.h>
+
+#include "engine/utils/hash/hash.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+namespace walrus {
+
+  /**
+   * @brief in-memory cache of pipelines & pipeline layouts, keyed by their create state.
+   * keys keep the bytes they were hashed from, so a hash collision is a miss rather than a wrong pipeline.
+   * also holds the shared driver side VkPipelineCache that per-thread caches are merged into.
+   * @note the cache owns every handle it returns. call destroy() once the device is idle.
+   *       pipelines are reference counted: every pipeline returned by findPipeline() / insertPipeline()
+   *       holds a reference, which is dropped with releasePipeline().
+   * @note lookups and inserts are thread safe. the driver cache is externally synchronized,
+   *       so worker threads should compile into their own VkPipelineCache and merge afterwards.
+   */
+  class PipelineCache {
+  public:
+    PipelineCache() = default;
+
+    ~PipelineCache() = default;
+
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    /// @brief key of everything that affects a pipeline layout
+    static hash::Key layoutKey(const VkPipelineLayoutCreateInfo &info);
+
+    /// @brief returns a cached layout for `info`, creating it on first use
+    VkPipelineLayout getLayout(VkDevice vkDevice, const VkPipelineLayoutCreateInfo &info);
+
+    /// @brief returns true and sets `outPipeline` (with a reference taken) if a pipeline with the key was already built
+    bool findPipeline(const hash::Key &key, VkPipeline *outPipeline);
+
+    /**
+     * @brief hand ownership of a pipeline to the cache
+     * @return the cached pipeline for `key`, with a reference taken. if another thread inserted the same key first,
+     *         `vkPipeline` is destroyed and the existing pipeline is returned instead.
+     */
+    VkPipeline insertPipeline(VkDevice vkDevice, hash::Key key, VkPipeline vkPipeline);
+
+    /// @brief take another reference to a cached pipeline, i.e. when the same handle is used in a second place
+    void retainPipeline(VkPipeline vkPipeline);
+
+    /**
+     * @brief drop a reference. once the last one is dropped, ownership goes back to the caller without destroying
+     * the pipeline -- a replaced pipeline must outlive the frames that still use it.
+     * @return true if the caller now owns the pipeline. false if it is still referenced, or not owned by the cache
+     */
+    bool releasePipeline(VkPipeline vkPipeline);
+
+    /**
+     * @brief seed the driver cache from `filePath`, and save it there on destroy(). call before createDriverCache().
+     * data saved by another driver or device (see the VkPipelineCacheHeaderVersionOne header) is ignored.
+     */
+    void setCacheFile(const std::string &filePath, const VkPhysicalDeviceProperties &properties);
+
+    /// @brief create the shared driver cache. returns the existing one if already created
+    VkPipelineCache createDriverCache(VkDevice vkDevice);
+
+    /// @brief write the driver cache to the cache file. false if there is nothing to save or it couldn't be written
+    bool saveDriverCache(VkDevice vkDevice);
+
+    /// @brief the shared driver cache -- only use it from one thread at a time
+    VkPipelineCache getDriverCache() const { return _driverCache; }
+
+    /// @brief create one empty VkPipelineCache per worker thread
+    static std::vector<VkPipelineCache> createWorkerCaches(VkDevice vkDevice, uint32_t count);
+
+    /// @brief merge worker caches into the shared driver cache (created if needed), then destroy them
+    void mergeWorkerCaches(VkDevice vkDevice, std::vector<VkPipelineCache> &workerCaches);
+
+    /// @brief save the driver cache, then destroy all pipelines before all layouts
+    void destroy(VkDevice vkDevice);
+
+    [[nodiscard]] size_t pipelineCount();
+    [[nodiscard]] size_t layoutCount();
+
+    struct Stats {
+      uint32_t pipelineHits = 0;
+      uint32_t pipelineMisses = 0;
+      uint32_t layoutHits = 0;
+      uint32_t layoutMisses = 0;
+    };
+    [[nodiscard]] Stats getStats();
+
+  private:
+    /// @note requires the lock
+    void createDriverCacheLocked(VkDevice vkDevice);
+    bool saveDriverCacheLocked(VkDevice vkDevice);
+
+    std::unordered_map<hash::Key, VkPipeline, hash::KeyHash> _pipelines{};
+    std::unordered_map<VkPipeline, uint32_t> _references{};
+    std::unordered_map<hash::Key, VkPipelineLayout, hash::KeyHash> _layouts{};
+    VkPipelineCache _driverCache = VK_NULL_HANDLE;
+    std::string _cacheFile{};
+    VkPhysicalDeviceProperties _deviceProperties{};
+    Stats _stats{};
+    std::mutex _mutex{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_PIPELINE_CACHE_HPP
@@ -7,6 +7,16 @@
 
 namespace walrus {
 
+  namespace {
+    void addAttachmentReferences(hash::Hasher &hasher, const VkAttachmentReference *references, uint32_t count) {
+      hasher.add(count);
+      hasher.add(references != nullptr);
+      for (uint32_t i = 0; references != nullptr && i < count; i++) {
+        hasher.add(references[i].attachment).add(references[i].layout);
+      }
+    }
+  }
+
   bool RenderPass::CreateInfo::isEmpty() const {
     return attachmentDescriptions.empty() && attachmentReferences.empty() && subPasses.empty();
   }
@@ -39,10 +49,10 @@ namespace walrus {
     // don't care about stencil
     colorAttachment->stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment->stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    // don't know or care about starting layout
-    colorAttachment->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    // after the renderpass ends, the image hs to be on a layout ready for display
-    colorAttachment->finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // the frame graph transitions the image into the attachment layout before the renderpass,
+    // and to a layout ready for display after it
+    colorAttachment->initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment->finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     attachmentRef->attachment = index_desc; // indexes into _renderpass.pAttachments
     attachmentRef->layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -57,5 +67,46 @@ namespace walrus {
     createInfo.updateCreateInfo();
   }
 
+  RenderPassInfo RenderPass::Describe(
+    VkRenderPass vkRenderPass,
+    const VkRenderPassCreateInfo &createInfo,
+    uint32_t subpass
+  ) {
+    if (subpass >= createInfo.subpassCount) {
+      throw std::runtime_error("render pass: subpass index out of range");
+    }
+    // everything that makes two render passes compatible: the attachments, and every subpass
+    hash::Hasher hasher = hash::Hasher::recorder();
+    hasher.add(subpass);
+    /// ATTACHMENTS
+    hasher.add(createInfo.attachmentCount);
+    for (uint32_t i = 0; i < createInfo.attachmentCount; i++) {
+      const auto &attachment = createInfo.pAttachments[i];
+      hasher.add(attachment.flags);
+      hasher.add(attachment.format);
+      hasher.add(attachment.samples);
+      hasher.add(attachment.loadOp).add(attachment.storeOp);
+      hasher.add(attachment.stencilLoadOp).add(attachment.stencilStoreOp);
+      hasher.add(attachment.initialLayout).add(attachment.finalLayout);
+    }
+    /// SUBPASSES
+    hasher.add(createInfo.subpassCount);
+    for (uint32_t i = 0; i < createInfo.subpassCount; i++) {
+      const auto &description = createInfo.pSubpasses[i];
+      hasher.add(description.flags);
+      hasher.add(description.pipelineBindPoint);
+      addAttachmentReferences(hasher, description.pInputAttachments, description.inputAttachmentCount);
+      addAttachmentReferences(hasher, description.pColorAttachments, description.colorAttachmentCount);
+      // resolve attachments are either absent or one per color attachment
+      addAttachmentReferences(hasher, description.pResolveAttachments, description.colorAttachmentCount);
+      addAttachmentReferences(hasher, description.pDepthStencilAttachment, 1);
+      hasher.add(description.preserveAttachmentCount);
+      for (uint32_t j = 0; j < description.preserveAttachmentCount; j++) {
+        hasher.add(description.pPreserveAttachments[j]);
+      }
+    }
+    return RenderPassInfo{vkRenderPass, subpass, hasher.key()};
+  }
+
 
 } // walrus
\ No newline at end of file
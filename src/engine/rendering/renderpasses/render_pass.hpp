@@ -3,10 +3,23 @@
 
 #include <vk_types.h>
 
+#include "engine/utils/hash/hash.hpp"
+
 #include <vector>
 
 namespace walrus {
 
+  /**
+   * @brief a render pass handle & the subpass that pipelines are built for.
+   * pipelines are keyed by `key`, which holds the attachments & subpasses by value --
+   * render pass handles may be reused once destroyed, so the handle itself is never part of a key.
+   */
+  struct RenderPassInfo {
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    hash::Key key{};
+  };
+
   class RenderPass {
   public:
 
@@ -26,6 +39,13 @@ namespace walrus {
       VkFormat &vkSwapchainFormat
     );
 
+    /// @brief describe `subpass` of a render pass created from `createInfo`, for building pipelines against it
+    static RenderPassInfo Describe(
+      VkRenderPass vkRenderPass,
+      const VkRenderPassCreateInfo &createInfo,
+      uint32_t subpass = 0
+    );
+
     RenderPass() = delete;
 
   private:
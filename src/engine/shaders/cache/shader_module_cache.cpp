@@ -0,0 +1,105 @@
+#include "shader_module_cache.hpp"
+
+#include "engine/utils/hash/hash.hpp"
+#include "engine/utils/mapped_file/mapped_file.hpp"
+#include "engine/shaders/embedded/embedded_spirv.hpp"
+
+#include <filesystem>
+
+namespace walrus {
+
+  namespace {
+    /// seeds the second hash that hits are compared with, so it is independent of the key
+    constexpr uint64_t CHECKSUM_SEED = 0x9ae16a3b2f90404full;
+  }
+
+  bool ShaderModuleCache::load(VkDevice vkDevice, const std::string &filePath, Module *outModule, bool allowEmbedded) {
+#ifdef WALRUS_EMBED_SPIRV
+    if (allowEmbedded) {
+      const auto blob = embedded::findSpirv(std::filesystem::path(filePath).filename().string());
+      if (blob != nullptr) {
+        return get(vkDevice, blob->code, blob->codeSize, outModule);
+      }
+    }
+#else
+    (void) allowEmbedded;
+#endif
+    MappedFile file{filePath};
+    if (!file.isOpen() || file.size() % sizeof(uint32_t) != 0) {
+      return false;
+    }
+    return get(vkDevice, static_cast<const uint32_t *>(file.data()), file.size(), outModule);
+  }
+
+
+  bool ShaderModuleCache::get(VkDevice vkDevice, const uint32_t *code, size_t codeSize, Module *outModule) {
+    uint64_t codeHash = hash::fnv1a(code, codeSize);
+    const uint64_t checksum = hash::fnv1a(code, codeSize, CHECKSUM_SEED);
+    std::lock_guard<std::mutex> lock(_mutex);
+    // a collision moves on to the hash of the code seeded with the previous key, until the code or a free key is found.
+    // pipelines are keyed by the code hash too, so different code never shares a key
+    auto it = _modules.find(codeHash);
+    for (; it != _modules.end(); it = _modules.find(codeHash)) {
+      if (it->second.codeSize == codeSize && it->second.checksum == checksum) {
+        break;
+      }
+      codeHash = hash::fnv1a(code, codeSize, codeHash);
+    }
+    if (it != _modules.end() && it->second.module != VK_NULL_HANDLE) {
+      it->second.references++;
+      *outModule = {it->second.module, codeHash};
+      return true;
+    }
+
+    VkShaderModuleCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    info.pNext = nullptr;
+    info.codeSize = codeSize;
+    info.pCode = code;
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(vkDevice, &info, nullptr, &shaderModule) != VK_SUCCESS) {
+      return false;
+    }
+    // released code is recreated under its old key
+    _modules[codeHash] = {shaderModule, codeSize, checksum, 1};
+    *outModule = {shaderModule, codeHash};
+    return true;
+  }
+
+
+  void ShaderModuleCache::release(VkDevice vkDevice, uint64_t codeHash) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _modules.find(codeHash);
+    if (it == _modules.end() || it->second.references == 0) {
+      return;
+    }
+    if (--it->second.references == 0) {
+      // pipelines don't need their modules once created. the entry stays, so the key isn't given to other code
+      vkDestroyShaderModule(vkDevice, it->second.module, nullptr);
+      it->second.module = VK_NULL_HANDLE;
+    }
+  }
+
+
+  void ShaderModuleCache::destroy(VkDevice vkDevice) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &[codeHash, entry]: _modules) {
+      if (entry.module != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(vkDevice, entry.module, nullptr);
+      }
+    }
+    _modules.clear();
+  }
+
+
+  size_t ShaderModuleCache::size() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t live = 0;
+    for (auto &[codeHash, entry]: _modules) {
+      live += entry.module != VK_NULL_HANDLE ? 1 : 0;
+    }
+    return live;
+  }
+
+} // walrus
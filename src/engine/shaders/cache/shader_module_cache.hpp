@@ -0,0 +1,69 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SHADER_MODULE_CACHE_HPP
+#define WALRUS_COMPUTE_ENGINE_SHADER_MODULE_CACHE_HPP
+
+#include <vk_types.h>
+
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <mutex>
+
+namespace walrus {
+
+  /**
+   * @brief shader modules keyed by a hash of their spir-v, so identical code is only created once.
+   * hash hits are compared by size & a second, differently seeded hash -- no copy of the code is kept --
+   * and different code with the same hash gets a key of its own.
+   * @note modules are reference counted: every load() / get() must be paired with a release() once the
+   *       pipelines using the module are built. released code keeps its key, so a code hash is never reused.
+   * @note thread safe
+   */
+  class ShaderModuleCache {
+  public:
+    struct Module {
+      VkShaderModule module = VK_NULL_HANDLE;
+      /// unique per spir-v in this cache
+      uint64_t codeHash = 0;
+    };
+
+    ShaderModuleCache() = default;
+
+    ~ShaderModuleCache() = default;
+
+    ShaderModuleCache(const ShaderModuleCache &) = delete;
+    ShaderModuleCache &operator=(const ShaderModuleCache &) = delete;
+
+    /**
+     * @brief load spir-v from embedded data (if built with WALRUS_EMBED_SPIRV), otherwise memory maps the file.
+     * the spir-v is passed to vulkan straight from the mapping, without intermediate copies.
+     * @param allowEmbedded false forces a read from disk (i.e. after recompiling a shader)
+     */
+    bool load(VkDevice vkDevice, const std::string &filePath, Module *outModule, bool allowEmbedded = true);
+
+    /// @brief returns the module for `code`, creating it if no module with the same spir-v exists
+    bool get(VkDevice vkDevice, const uint32_t *code, size_t codeSize, Module *outModule);
+
+    /// @brief drop a reference taken by load() / get(). the last one destroys the module
+    void release(VkDevice vkDevice, uint64_t codeHash);
+
+    void destroy(VkDevice vkDevice);
+
+    /// @brief number of live modules
+    [[nodiscard]] size_t size();
+
+  private:
+    struct Entry {
+      /// VK_NULL_HANDLE once every reference is released
+      VkShaderModule module = VK_NULL_HANDLE;
+      size_t codeSize = 0;
+      uint64_t checksum = 0;
+      uint32_t references = 0;
+    };
+
+    std::unordered_map<uint64_t, Entry> _modules{};
+    std::mutex _mutex{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_SHADER_MODULE_CACHE_HPP
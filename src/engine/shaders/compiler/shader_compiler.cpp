@@ -0,0 +1,136 @@
+#include "shader_compiler.hpp"
+
+#include "pretty_io.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char **environ;
+#endif
+
+namespace walrus {
+
+  namespace {
+    /// @brief runs `arguments[0]` (searched on the PATH) with `arguments`, without a shell. true if it exits with 0
+    bool run(const std::vector<std::string> &arguments) {
+      std::vector<char *> argv{};
+      for (auto &argument: arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+      }
+      argv.push_back(nullptr);
+#if defined(_WIN32)
+      return _spawnvp(_P_WAIT, argv[0], argv.data()) == 0;
+#else
+      pid_t pid = 0;
+      if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+        return false;
+      }
+      int status = 0;
+      while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+          return false;
+        }
+      }
+      return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+    }
+  }
+
+
+
+
+  std::string ShaderCompiler::validatorPath() {
+#ifdef WALRUS_GLSL_VALIDATOR
+    std::string path = WALRUS_GLSL_VALIDATOR;
+    if (!path.empty()) {
+      return path;
+    }
+#endif
+    return "glslangValidator";
+  }
+
+  std::string ShaderCompiler::sourceDirectory() {
+#ifdef WALRUS_SHADER_SOURCE_DIR
+    return WALRUS_SHADER_SOURCE_DIR;
+#else
+    return "../../shaders";
+#endif
+  }
+
+  std::string ShaderCompiler::targetEnvironment() {
+#ifdef WALRUS_SHADER_TARGET_ENV
+    return WALRUS_SHADER_TARGET_ENV;
+#else
+    return "vulkan1.1";
+#endif
+  }
+
+  std::string ShaderCompiler::temporaryPath(const std::string &path) {
+    static std::atomic<uint64_t> paths{0};
+#if defined(_WIN32)
+    const int process = _getpid();
+#else
+    const pid_t process = getpid();
+#endif
+    return path + "." + std::to_string(process) + "." + std::to_string(paths++) + ".tmp";
+  }
+
+  bool ShaderCompiler::isShaderSource(const std::string &path) {
+    const std::string extension = std::filesystem::path(path).extension().string();
+    return extension == ".vert" || extension == ".frag" || extension == ".comp";
+  }
+
+  bool ShaderCompiler::isShaderInclude(const std::string &path) {
+    return std::filesystem::path(path).extension() == ".glsl";
+  }
+
+  std::vector<std::string> ShaderCompiler::includes(const std::string &glslPath) {
+    std::vector<std::string> paths{};
+    std::ifstream file(glslPath);
+    const std::filesystem::path directory = std::filesystem::path(glslPath).parent_path();
+    for (std::string line; std::getline(file, line);) {
+      // #include "name.glsl" -- glslang resolves quoted includes relative to the including file
+      const size_t directive = line.find_first_not_of(" \t");
+      if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0) {
+        continue;
+      }
+      const size_t open = line.find('"', directive);
+      const size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+      if (close != std::string::npos) {
+        paths.push_back((directory / line.substr(open + 1, close - open - 1)).string());
+      }
+    }
+    return paths;
+  }
+
+  bool ShaderCompiler::compile(const std::string &glslPath, const std::string &spirvPath) {
+    // several shaders (or the same one, from two engines) may compile at once
+    const std::string temporary = temporaryPath(spirvPath);
+    const bool compiled = run({validatorPath(), "-V", "--target-env", targetEnvironment(), glslPath, "-o", temporary});
+    std::error_code error{};
+    if (!compiled) {
+      std::filesystem::remove(temporary, error);
+      std::cerr << io::to_color_string(io::RED, "failed to compile shader: " + glslPath) << std::endl;
+      return false;
+    }
+    // atomic: a reader still mapping the previous spir-v keeps it until it unmaps
+    std::filesystem::rename(temporary, spirvPath, error);
+    if (error) {
+      std::filesystem::remove(temporary, error);
+      std::cerr << io::to_color_string(io::RED, "failed to replace shader: " + spirvPath) << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+} // walrus
@@ -0,0 +1,46 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SHADER_COMPILER_HPP
+#define WALRUS_COMPUTE_ENGINE_SHADER_COMPILER_HPP
+
+#include <string>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief compiles glsl into spir-v at runtime, using the glslangValidator found by cmake.
+   * @note the validator path is baked in through the `WALRUS_GLSL_VALIDATOR` definition,
+   *       otherwise `glslangValidator` is expected to be on the PATH.
+   */
+  struct ShaderCompiler {
+    /// @brief path to the glslangValidator executable
+    static std::string validatorPath();
+
+    /// @brief the root of the glsl sources (`shaders/` in the repository)
+    static std::string sourceDirectory();
+
+    /// @brief the vulkan version the spir-v targets, same as the build (`SHADER_TARGET_ENV`)
+    static std::string targetEnvironment();
+
+    /**
+     * @brief compile a glsl file into a spir-v file. the stage is picked from the file extension.
+     * the spir-v is written to a temporary file and renamed over `spirvPath`, so readers never see a partial file.
+     * @return true if the validator exited successfully
+     */
+    static bool compile(const std::string &glslPath, const std::string &spirvPath);
+
+    /// @brief a path next to `path` that no other thread or process writes to, to write & rename over `path`
+    static std::string temporaryPath(const std::string &path);
+
+    /// @brief true for the glsl extensions the build compiles (.vert, .frag, .comp)
+    static bool isShaderSource(const std::string &path);
+
+    /// @brief true for glsl code #included by shader sources (.glsl)
+    static bool isShaderInclude(const std::string &path);
+
+    /// @brief the files `glslPath` #includes directly, relative to its directory
+    static std::vector<std::string> includes(const std::string &glslPath);
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_SHADER_COMPILER_HPP
@@ -0,0 +1,27 @@
+#ifndef WALRUS_COMPUTE_ENGINE_EMBEDDED_SPIRV_HPP
+#define WALRUS_COMPUTE_ENGINE_EMBEDDED_SPIRV_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace walrus::embedded {
+
+  /// @brief spir-v compiled into the executable at build time
+  struct SpirvBlob {
+    const char *fileName = nullptr; // i.e. "triangle_red.frag.spv"
+    const uint32_t *code = nullptr;
+    size_t codeSize = 0;            // in bytes
+  };
+
+  /**
+   * @brief look up embedded spir-v by file name (directories are ignored).
+   * @return nullptr if not embedded
+   * @note only defined when built with `-DWALRUS_EMBED_SPIRV=ON`. the definition is generated by
+   *       cmake/embed_spirv.cmake
+   */
+  const SpirvBlob *findSpirv(const std::string &fileName);
+
+} // walrus::embedded
+
+#endif //WALRUS_COMPUTE_ENGINE_EMBEDDED_SPIRV_HPP
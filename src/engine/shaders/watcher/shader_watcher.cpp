@@ -0,0 +1,174 @@
+#include "shader_watcher.hpp"
+
+#include "engine/shaders/compiler/shader_compiler.hpp"
+#include "pretty_io.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace walrus {
+
+  namespace {
+    bool isWatched(const std::string &path) {
+      return ShaderCompiler::isShaderSource(path) || ShaderCompiler::isShaderInclude(path);
+    }
+
+    /// @brief true if `glslPath` includes `include`, directly or through other includes
+    bool includes(
+      const std::filesystem::path &glslPath,
+      const std::filesystem::path &include,
+      std::vector<std::filesystem::path> &visited
+    ) {
+      for (auto &included: ShaderCompiler::includes(glslPath.string())) {
+        std::error_code error{};
+        const std::filesystem::path path = std::filesystem::weakly_canonical(included, error);
+        if (path == include) {
+          return true;
+        }
+        if (std::find(visited.begin(), visited.end(), path) != visited.end()) {
+          continue; // include guards -- or a cycle
+        }
+        visited.push_back(path);
+        if (includes(path, include, visited)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+
+
+
+
+  ShaderWatcher::ShaderWatcher(const std::string &directory) : _directory{directory} {
+    std::error_code error{};
+    if (!std::filesystem::is_directory(_directory, error)) {
+      std::cerr << io::to_color_string(io::RED, "shader watcher: not a directory: " + _directory) << std::endl;
+      return;
+    }
+#if defined(__linux__)
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify < 0) {
+      std::cerr << io::to_color_string(io::RED, "shader watcher: inotify_init1 failed") << std::endl;
+      return;
+    }
+#endif
+    /// inotify watches are not recursive, so every sub directory gets its own watch
+    watchDirectory(_directory);
+    for (auto &entry: std::filesystem::recursive_directory_iterator(_directory, error)) {
+      if (entry.is_directory()) {
+        watchDirectory(entry.path());
+      }
+    }
+    _isWatching = true;
+  }
+
+  ShaderWatcher::~ShaderWatcher() {
+#if defined(__linux__)
+    if (_inotify >= 0) {
+      close(_inotify); // also removes every watch
+    }
+#endif
+  }
+
+  void ShaderWatcher::watchDirectory(const std::filesystem::path &directory) {
+#if defined(__linux__)
+    // IN_CLOSE_WRITE : editors that write in place. IN_MOVED_TO : editors that write a temp file & rename
+    const int watch = inotify_add_watch(
+      _inotify,
+      directory.c_str(),
+      IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE
+    );
+    if (watch >= 0) {
+      _watches[watch] = directory;
+    }
+#else
+    std::error_code error{};
+    for (auto &entry: std::filesystem::directory_iterator(directory, error)) {
+      if (entry.is_regular_file() && isWatched(entry.path().string())) {
+        _timestamps[entry.path().string()] = entry.last_write_time();
+      }
+    }
+#endif
+  }
+
+  void ShaderWatcher::addIncluding(const std::filesystem::path &include, std::vector<std::string> &sources) const {
+    std::error_code error{};
+    const std::filesystem::path target = std::filesystem::weakly_canonical(include, error);
+    for (auto &entry: std::filesystem::recursive_directory_iterator(_directory, error)) {
+      std::vector<std::filesystem::path> visited{};
+      if (entry.is_regular_file() && ShaderCompiler::isShaderSource(entry.path().string())
+          && includes(entry.path(), target, visited)) {
+        sources.push_back(entry.path().string());
+      }
+    }
+  }
+
+  std::vector<std::string> ShaderWatcher::poll() {
+    std::vector<std::string> changed{};
+    if (!_isWatching) {
+      return changed;
+    }
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+      const ssize_t length = read(_inotify, buffer, sizeof(buffer));
+      if (length <= 0) {
+        break; // EAGAIN -- nothing left to read
+      }
+      for (ssize_t offset = 0; offset < length;) {
+        auto event = reinterpret_cast<const inotify_event *>(buffer + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        auto directory = _watches.find(event->wd);
+        if (event->len == 0 || directory == _watches.end()) {
+          continue;
+        }
+        const std::filesystem::path path = directory->second / event->name;
+        if (event->mask & IN_ISDIR) {
+          if (event->mask & IN_CREATE) {
+            watchDirectory(path);
+          }
+          continue;
+        }
+        if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && isWatched(path.string())) {
+          changed.push_back(path.string());
+        }
+      }
+    }
+#else
+    std::error_code error{};
+    for (auto &entry: std::filesystem::recursive_directory_iterator(_directory, error)) {
+      if (!entry.is_regular_file() || !isWatched(entry.path().string())) {
+        continue;
+      }
+      const auto time = entry.last_write_time();
+      auto it = _timestamps.find(entry.path().string());
+      if (it == _timestamps.end() || it->second != time) {
+        _timestamps[entry.path().string()] = time;
+        changed.push_back(entry.path().string());
+      }
+    }
+#endif
+    /// INCLUDES
+    // replaced by the sources that include them
+    std::vector<std::string> sources{};
+    for (auto &path: changed) {
+      if (ShaderCompiler::isShaderInclude(path)) {
+        addIncluding(path, sources);
+      } else {
+        sources.push_back(path);
+      }
+    }
+    changed = std::move(sources);
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+  }
+
+} // walrus
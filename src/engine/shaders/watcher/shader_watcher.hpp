@@ -0,0 +1,50 @@
+#ifndef WALRUS_COMPUTE_ENGINE_SHADER_WATCHER_HPP
+#define WALRUS_COMPUTE_ENGINE_SHADER_WATCHER_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+
+namespace walrus {
+
+  /**
+   * @brief watches a shader directory (recursively) for modified glsl sources.
+   * a modified include (.glsl) reports every source of the directory that includes it, directly or not.
+   * @note uses inotify on linux. other platforms fall back to comparing modification times on poll.
+   */
+  class ShaderWatcher {
+  public:
+    explicit ShaderWatcher(const std::string &directory);
+
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher &) = delete;
+    ShaderWatcher &operator=(const ShaderWatcher &) = delete;
+
+    /// @brief non-blocking. returns the glsl sources that were written since the last poll (no duplicates)
+    std::vector<std::string> poll();
+
+    [[nodiscard]] bool isWatching() const { return _isWatching; }
+
+  private:
+    void watchDirectory(const std::filesystem::path &directory);
+
+    /// @brief appends the shader sources under the watched directory that include `include`
+    void addIncluding(const std::filesystem::path &include, std::vector<std::string> &sources) const;
+
+    std::string _directory{};
+    bool _isWatching = false;
+
+#if defined(__linux__)
+    int _inotify = -1;
+    /// inotify watch descriptor -> watched directory
+    std::unordered_map<int, std::filesystem::path> _watches{};
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> _timestamps{};
+#endif
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_SHADER_WATCHER_HPP
@@ -0,0 +1,86 @@
+#include "half.hpp"
+
+#include <cstring>
+
+namespace walrus::half {
+
+  uint16_t fromFloat(float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    const auto sign = (uint16_t) ((bits >> 16) & 0x8000u);
+    const uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    /// INF & NAN
+    if (exponent == 0xFF) {
+      return (uint16_t) (sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0));
+    }
+
+    const int32_t halfExponent = (int32_t) exponent - 127 + 15;
+    /// OVERFLOW
+    if (halfExponent >= 0x1F) {
+      return (uint16_t) (sign | 0x7C00u);
+    }
+
+    /// SUBNORMALS & UNDERFLOW
+    if (halfExponent <= 0) {
+      if (halfExponent < -10) {
+        return sign;
+      }
+      mantissa |= 0x800000u; // the implicit leading 1
+      const auto shift = (uint32_t) (14 - halfExponent);
+      uint32_t halfMantissa = mantissa >> shift;
+      const uint32_t remainder = mantissa & ((1u << shift) - 1);
+      const uint32_t halfway = 1u << (shift - 1);
+      if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) {
+        halfMantissa++;
+      }
+      return (uint16_t) (sign | halfMantissa);
+    }
+
+    /// NORMALS
+    uint32_t half = ((uint32_t) halfExponent << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1))) {
+      half++; // may carry into the exponent, up to infinity, which is the correct rounding
+    }
+    return (uint16_t) (sign | half);
+  }
+
+
+  float toFloat(uint16_t bits) {
+    const uint32_t sign = (uint32_t) (bits & 0x8000u) << 16;
+    const uint32_t exponent = (bits >> 10) & 0x1Fu;
+    uint32_t mantissa = bits & 0x3FFu;
+
+    uint32_t result;
+    if (exponent == 0x1F) {
+      result = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+      result = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+      result = sign;
+    } else {
+      // subnormal: normalize the mantissa
+      int32_t shift = 0;
+      while ((mantissa & 0x400u) == 0) {
+        mantissa <<= 1;
+        shift++;
+      }
+      result = sign | ((uint32_t) (127 - 15 + 1 - shift) << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    float value = 0.f;
+    memcpy(&value, &result, sizeof(value));
+    return value;
+  }
+
+
+  std::vector<uint16_t> fromFloats(const std::vector<float> &values) {
+    std::vector<uint16_t> result(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      result[i] = fromFloat(values[i]);
+    }
+    return result;
+  }
+
+} // walrus::half
@@ -0,0 +1,18 @@
+#ifndef WALRUS_COMPUTE_ENGINE_HALF_HPP
+#define WALRUS_COMPUTE_ENGINE_HALF_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace walrus::half {
+
+  /// @brief IEEE 754 binary16 bits of `value`, rounded to nearest even. overflows to infinity, keeps nans
+  uint16_t fromFloat(float value);
+
+  float toFloat(uint16_t bits);
+
+  std::vector<uint16_t> fromFloats(const std::vector<float> &values);
+
+} // walrus::half
+
+#endif //WALRUS_COMPUTE_ENGINE_HALF_HPP
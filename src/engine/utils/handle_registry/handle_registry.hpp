@@ -0,0 +1,128 @@
+#ifndef WALRUS_COMPUTE_ENGINE_HANDLE_REGISTRY_HPP
+#define WALRUS_COMPUTE_ENGINE_HANDLE_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace walrus {
+
+  /**
+   * @brief a generational index into a HandleRegistry<T>. stays valid when the registry grows,
+   * and is detected as stale once its value was removed, even if the slot was reused.
+   * `Tag` keeps handles of different registries apart, i.e. a fence handle can't look up a semaphore.
+   */
+  template<class Tag>
+  struct Handle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    [[nodiscard]] bool isNull() const { return index == INVALID_INDEX; }
+
+    bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+
+    bool operator!=(const Handle &other) const { return !(*this == other); }
+  };
+
+
+
+
+  /**
+   * @brief values addressed by generational handles, stored contiguously for iteration.
+   * slots map handles to the dense array in O(1), removal swaps the last value into the hole.
+   * usage: handle = insert(value), get(handle) -- null once removed --, remove(handle).
+   * @note pointers from get() & values() are invalidated by insert & remove, keep the handles instead
+   */
+  template<class T, class Tag = T>
+  class HandleRegistry {
+  public:
+    using HandleType = Handle<Tag>;
+
+    HandleType insert(const T &value) {
+      uint32_t slot;
+      if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+      } else {
+        slot = (uint32_t) _slots.size();
+        _slots.push_back(Slot{});
+      }
+      _slots[slot].dense = (uint32_t) _values.size();
+      _values.push_back(value);
+      _denseToSlot.push_back(slot);
+      return HandleType{slot, _slots[slot].generation};
+    }
+
+    /// @return false if the handle is stale. the removed value is moved to `out` if not null
+    bool remove(HandleType handle, T *out = nullptr) {
+      if (!contains(handle)) {
+        return false;
+      }
+      Slot &slot = _slots[handle.index];
+      const uint32_t dense = slot.dense;
+      const auto last = (uint32_t) (_values.size() - 1);
+      if (out != nullptr) {
+        *out = _values[dense];
+      }
+      if (dense != last) {
+        _values[dense] = _values[last];
+        _denseToSlot[dense] = _denseToSlot[last];
+        _slots[_denseToSlot[dense]].dense = dense;
+      }
+      _values.pop_back();
+      _denseToSlot.pop_back();
+      slot.generation++;
+      _freeSlots.push_back(handle.index);
+      return true;
+    }
+
+    /// @brief removal bumps the slot's generation, so handles to removed values never match
+    [[nodiscard]] bool contains(HandleType handle) const {
+      return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+    }
+
+    /// @return null if the handle is stale
+    T *get(HandleType handle) { return contains(handle) ? &_values[_slots[handle.index].dense] : nullptr; }
+
+    const T *get(HandleType handle) const { return contains(handle) ? &_values[_slots[handle.index].dense] : nullptr; }
+
+    /// @brief every value, in no particular order
+    [[nodiscard]] const std::vector<T> &values() const { return _values; }
+
+    /// @brief the handle of values()[denseIndex]
+    [[nodiscard]] HandleType handleAt(size_t denseIndex) const {
+      const uint32_t slot = _denseToSlot[denseIndex];
+      return HandleType{slot, _slots[slot].generation};
+    }
+
+    [[nodiscard]] size_t size() const { return _values.size(); }
+
+    [[nodiscard]] bool empty() const { return _values.empty(); }
+
+    /// @brief removes every value. outstanding handles become stale
+    void clear() {
+      for (uint32_t slot: _denseToSlot) {
+        _slots[slot].generation++;
+        _freeSlots.push_back(slot);
+      }
+      _values.clear();
+      _denseToSlot.clear();
+    }
+
+  private:
+    struct Slot {
+      uint32_t dense = 0;
+      uint32_t generation = 0;
+    };
+
+    std::vector<T> _values{};
+    std::vector<uint32_t> _denseToSlot{};
+    std::vector<Slot> _slots{};
+    std::vector<uint32_t> _freeSlots{};
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_HANDLE_REGISTRY_HPP
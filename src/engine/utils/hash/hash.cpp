@@ -0,0 +1,57 @@
+#include "hash.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace walrus::hash {
+
+  uint64_t fnv1a(const void *data, size_t size, uint64_t seed) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    uint64_t value = seed;
+    for (size_t i = 0; i < size; i++) {
+      value ^= bytes[i];
+      value *= FNV_PRIME;
+    }
+    return value;
+  }
+
+  Hasher Hasher::recorder() {
+    Hasher hasher{};
+    hasher.recording = true;
+    return hasher;
+  }
+
+  Hasher &Hasher::addRaw(const void *data, size_t size) {
+    value = fnv1a(data, size, value);
+    if (recording && size > 0) {
+      auto first = static_cast<const uint8_t *>(data);
+      bytes.insert(bytes.end(), first, first + size);
+    }
+    return *this;
+  }
+
+  Hasher &Hasher::addBytes(const void *data, size_t size) {
+    // include the size, so that adjacent ranges can't collide by shifting bytes between them
+    add(size);
+    return addRaw(data, size);
+  }
+
+  Hasher &Hasher::addString(const char *str) {
+    if (str == nullptr) {
+      return addBytes("", 0);
+    }
+    return addBytes(str, strlen(str));
+  }
+
+  Hasher &Hasher::addKey(const Key &key) {
+    return addBytes(key.bytes.data(), key.bytes.size());
+  }
+
+  Key Hasher::key() const {
+    if (!recording) {
+      throw std::runtime_error("hash: key() requires a recording hasher");
+    }
+    return Key{value, bytes};
+  }
+
+} // walrus::hash
@@ -0,0 +1,75 @@
+#ifndef WALRUS_COMPUTE_ENGINE_HASH_HPP
+#define WALRUS_COMPUTE_ENGINE_HASH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace walrus::hash {
+
+  /// FNV-1a 64 bit constants
+  constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+  constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+  /// @brief FNV-1a over a raw byte range. pass a previous result as `seed` to chain ranges together.
+  uint64_t fnv1a(const void *data, size_t size, uint64_t seed = FNV_OFFSET);
+
+  /**
+   * @brief a hash together with the bytes it was computed from.
+   * keys compare by their bytes, so two states that happen to share a hash never share a cache entry.
+   */
+  struct Key {
+    uint64_t value = FNV_OFFSET;
+    std::vector<uint8_t> bytes{};
+
+    bool operator==(const Key &other) const { return value == other.value && bytes == other.bytes; }
+    bool operator!=(const Key &other) const { return !(*this == other); }
+  };
+
+  /// @brief hash functor for unordered containers keyed by Key
+  struct KeyHash {
+    size_t operator()(const Key &key) const { return static_cast<size_t>(key.value); }
+  };
+
+  /**
+   * @brief accumulates a stable hash field by field.
+   * @note only scalar fields are accepted on purpose -- hashing whole vulkan structs would pull in
+   *       padding bytes and pNext pointers, which are not stable between otherwise identical structs.
+   */
+  struct Hasher {
+    uint64_t value = FNV_OFFSET;
+    /// @brief if true, every hashed byte is kept as well -- see key()
+    bool recording = false;
+    std::vector<uint8_t> bytes{};
+
+    /// @brief a hasher that records its input, for cache keys that must be compared on a hit
+    static Hasher recorder();
+
+    template<class T>
+    Hasher &add(const T &field) {
+      static_assert(
+        std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>,
+        "hash vulkan structs field by field"
+      );
+      return addRaw(&field, sizeof(T));
+    }
+
+    Hasher &addBytes(const void *data, size_t size);
+
+    /// @brief hashes a null terminated string. nullptr hashes the same as an empty string
+    Hasher &addString(const char *str);
+
+    /// @brief hashes the bytes of another key, so that they are compared as part of this one
+    Hasher &addKey(const Key &key);
+
+    /// @brief the hash & the recorded bytes. requires a recorder()
+    [[nodiscard]] Key key() const;
+
+  private:
+    Hasher &addRaw(const void *data, size_t size);
+  };
+
+} // walrus::hash
+
+#endif //WALRUS_COMPUTE_ENGINE_HASH_HPP
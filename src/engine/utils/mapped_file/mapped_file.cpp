@@ -0,0 +1,58 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#error "This code has only been built for macOS or Linux systems."
+#endif
+
+namespace walrus {
+
+  MappedFile::MappedFile(const std::string &filePath) {
+    const int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      void *mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        _data = mapping;
+        _size = static_cast<size_t>(info.st_size);
+      }
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+  }
+
+  MappedFile::~MappedFile() {
+    close();
+  }
+
+  MappedFile::MappedFile(MappedFile &&other) noexcept
+    : _data{std::exchange(other._data, nullptr)},
+      _size{std::exchange(other._size, 0)} {}
+
+  MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      close();
+      _data = std::exchange(other._data, nullptr);
+      _size = std::exchange(other._size, 0);
+    }
+    return *this;
+  }
+
+  void MappedFile::close() {
+    if (_data != nullptr) {
+      munmap(_data, _size);
+      _data = nullptr;
+      _size = 0;
+    }
+  }
+
+} // walrus
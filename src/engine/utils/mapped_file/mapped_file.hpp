@@ -0,0 +1,40 @@
+#ifndef WALRUS_COMPUTE_ENGINE_MAPPED_FILE_HPP
+#define WALRUS_COMPUTE_ENGINE_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace walrus {
+
+  /**
+   * @brief a read-only memory mapping of a whole file (RAII, move-only).
+   * the mapping is page aligned, so it can be read as 32 bit words (i.e. spir-v) without copying.
+   */
+  class MappedFile {
+  public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &filePath);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    [[nodiscard]] bool isOpen() const { return _data != nullptr; }
+    [[nodiscard]] const void *data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+
+    void close();
+
+  private:
+    void *_data = nullptr;
+    size_t _size = 0;
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_MAPPED_FILE_HPP
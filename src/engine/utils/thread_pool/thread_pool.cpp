@@ -0,0 +1,76 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace walrus {
+
+  namespace {
+    thread_local int workerIndex = -1;
+  }
+
+  ThreadPool::ThreadPool(uint32_t threadCount) {
+    if (threadCount == 0) {
+      threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+      _workers.emplace_back(&ThreadPool::workerLoop, this, static_cast<int>(i));
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    _jobAvailable.notify_all();
+    // remaining jobs are drained before the workers exit
+    for (auto &worker: _workers) {
+      worker.join();
+    }
+  }
+
+  int ThreadPool::currentWorkerIndex() {
+    return workerIndex;
+  }
+
+  void ThreadPool::enqueue(std::function<void()> &&job) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _jobs.push_back(std::move(job));
+    }
+    _jobAvailable.notify_one();
+  }
+
+  void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _jobs.empty() && _runningJobs == 0; });
+  }
+
+  void ThreadPool::workerLoop(int index) {
+    workerIndex = index;
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobAvailable.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+        if (_jobs.empty()) {
+          return; // stopping & drained
+        }
+        job = std::move(_jobs.front());
+        _jobs.pop_front();
+        _runningJobs++;
+      }
+      // exceptions are captured by the packaged_task and rethrown from the future
+      job();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _runningJobs--;
+        if (_jobs.empty() && _runningJobs == 0) {
+          _idle.notify_all();
+        }
+      }
+    }
+  }
+
+} // walrus
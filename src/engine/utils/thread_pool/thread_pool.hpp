@@ -0,0 +1,66 @@
+#ifndef WALRUS_COMPUTE_ENGINE_THREAD_POOL_HPP
+#define WALRUS_COMPUTE_ENGINE_THREAD_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+
+namespace walrus {
+
+  /**
+   * @brief a fixed size pool of worker threads pulling jobs from a shared fifo queue.
+   * @note jobs that touch externally synchronized vulkan objects (i.e. VkPipelineCache, VkCommandPool)
+   *       can use `currentWorkerIndex()` to pick a per-worker object instead of locking.
+   */
+  class ThreadPool {
+  public:
+    /// @param threadCount number of workers. 0 uses the hardware concurrency (minimum 1)
+    explicit ThreadPool(uint32_t threadCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// @brief queue a job. the returned future receives its result (or exception)
+    template<class F>
+    auto submit(F &&job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+      using Result = std::invoke_result_t<std::decay_t<F>>;
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+      std::future<Result> future = task->get_future();
+      enqueue([task]() { (*task)(); });
+      return future;
+    }
+
+    /// @brief blocks until the queue is empty and no job is running
+    void waitIdle();
+
+    [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(_workers.size()); }
+
+    /// @brief index of the calling worker in [0, size()), or -1 if not called from a worker of any pool
+    static int currentWorkerIndex();
+
+  private:
+    void enqueue(std::function<void()> &&job);
+
+    void workerLoop(int index);
+
+    std::vector<std::thread> _workers{};
+    std::deque<std::function<void()>> _jobs{};
+    std::mutex _mutex{};
+    std::condition_variable _jobAvailable{};
+    std::condition_variable _idle{};
+    uint32_t _runningJobs = 0;
+    bool _stopping = false;
+  };
+
+} // walrus
+
+#endif //WALRUS_COMPUTE_ENGINE_THREAD_POOL_HPP
@@ -4,12 +4,15 @@
 #include "vk_initializers.h"
 
 #include "engine/compute/commands/command.hpp"
+#include "engine/compute/primitives/reduce/reduce.hpp"
 
 #include "engine/rendering/renderpasses/render_pass.hpp"
+#include "engine/rendering/frame_graph/frame_graph.hpp"
 #include "engine/rendering/pipelines/builder/pipeline_builder.hpp"
 #include "engine/rendering/pipelines/defaults/pipeline_defaults.hpp"
 #include "engine/rendering/window/events/window_events.hpp"
 #include "engine/rendering/window/events/keys/keys.hpp"
+#include "engine/shaders/compiler/shader_compiler.hpp"
 
 #define GLFW_INCLUDE_VULKAN
 
@@ -19,11 +22,13 @@
 
 #include "vk_mem_alloc.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <stdexcept>
 #include <cassert>
-#include <fstream>
+#include <chrono>
+#include <filesystem>
 
 #define VK_CHECK(x) assert(x == VK_SUCCESS)
 
@@ -43,6 +48,9 @@ namespace walrus {
       init_vulkan();           /// vulkan instance, surface(opt), debug(opt), messenger, device, memory allocator
       init_commands();         /// command pool, command buffers, destructor queue
       init_sync_structures();  /// fences, semaphores, destructor queue
+      if (_task & DeviceTask::COMPUTE) {
+        init_compute();        /// compute kernels: descriptors, timestamps, autotune results, destructor queue
+      }
 
       /// engine_initialization graphics structures
       if (_task & DeviceTask::GRAPHICS) {
@@ -50,6 +58,7 @@ namespace walrus {
         init_renderpass();    /// render pass, destructor queue
         init_framebuffers();  /// framebuffers, destructor queue
         init_pipelines();     /// load shaders, pipeline-layout, pipelines, destroy shaders, destructor queue
+        init_shader_watcher(); /// watch glsl sources, rebuild pipelines when they change
         /// FIXME : mesh loading doesn't work yet. the triangle is hard coded into the shader...
 //        load_meshes();        /// test triangle
       }
@@ -210,10 +219,12 @@ namespace walrus {
         _deviceInfo,
         _physicalDevice,
         &_device,
-        _queues
+        _queues,
+        &_computeQueues
       );
 
       std::cout << "queue size: " << _queues.size() << std::endl;
+      std::cout << "async compute queue size: " << _computeQueues.size() << std::endl;
       std::cout << "queue data size: " << _deviceInfo.queueData.size() << std::endl;
 
       // TODO: QUEUE REFACTOR -- update commands and queue logic to work with not-complete-support queue families.
@@ -242,8 +253,31 @@ namespace walrus {
       info.physicalDevice = _physicalDevice;
       info.device = _device;
       info.instance = _instance;
+      MemoryPools::configureAllocator(_deviceInfo, info);
       vmaCreateAllocator(&info, &_allocator);
     }
+    _memoryPools.init(_allocator, _deviceInfo);
+    _memoryBudget.init(_allocator, _deviceInfo, FRAME_ALLOCATOR_FRAMES);
+    if (_task & GRAPHICS) {
+      _frameMemory.init(_allocator, _deviceInfo, FRAME_ALLOCATOR_FRAMES);
+    }
+    _deletionQueue.init(_device, _allocator);
+    _resources.init(_device, _allocator);
+    // before any pipeline is built: the driver cache is seeded from the previous run when it is created
+    _pipelineCache.setCacheFile(_pipelineCacheFile, _deviceInfo.properties);
+
+    /// DESTROY
+    // registered first, so the caches outlive everything built from them.
+    // compute only tasks never call init_pipelines, so the pipeline cache is destroyed here too
+    _mainDestructionQueue.addDestructor([=]() {
+      _deletionQueue.flush();
+      _pipelineCache.destroy(_device);
+      _shaderModules.destroy(_device);
+      // last, every buffer sub-allocated from them is gone
+      _frameMemory.destroy();
+      _memoryPools.destroy();
+      _memoryBudget.destroy();
+    });
   }
 
 
@@ -298,6 +332,40 @@ namespace walrus {
 
 
 
+  void VulkanEngine::init_compute() {
+    ComputeContext::CreateInfo info{};
+    info.physicalDevice = _physicalDevice;
+    info.device = _device;
+    info.queue = _queues.front();
+    info.queueFamilyIndex = _deviceInfo.getBestQueueIndex();
+    // rendering & compute tasks overlap: compute gets a queue of its own, from the dedicated compute family if there is one.
+    // otherwise its submissions go to the low priority queues of the best family
+    if (_task == DeviceTask::ALL && !_computeQueues.empty()) {
+      info.queue = _computeQueues.front();
+      info.queueFamilyIndex = _deviceInfo.getAsyncComputeQueueIndex();
+      info.concurrentQueueFamilies = {(uint32_t) _deviceInfo.getBestQueueIndex()};
+    } else {
+      info.scheduler = &_queueScheduler;
+    }
+    info.allocator = _allocator;
+    info.pools = &_memoryPools;
+    info.deviceInfo = &_deviceInfo;
+    info.pipelineCache = &_pipelineCache;
+    info.shaderModules = &_shaderModules;
+    info.shaderDirectory = _computePaths.shaderDirectory;
+    info.autotuneFilePath = _computePaths.autotuneFile;
+    info.kernelCacheDirectory = _computePaths.kernelCacheDirectory;
+    _compute.init(info);
+
+    /// DESTROY
+    _mainDestructionQueue.addDestructor([=]() {
+      _compute.destroy();
+    });
+  }
+
+
+
+
   void VulkanEngine::init_swapchain() {
     assert((_task & DeviceTask::GRAPHICS) && "cannot initialize swapchain for non-graphics task");
     /// TODO : add swapchain reset / recreation logic
@@ -452,6 +520,8 @@ namespace walrus {
     auto renderPassCreateInfo = RenderPass::CreateInfo{};
     RenderPass::GetDefaultRenderPassCreateInfo(renderPassCreateInfo, _swapchainImageFormat);
     VK_CHECK(vkCreateRenderPass(_device, &renderPassCreateInfo.createInfo, nullptr, &_renderPass));
+    // pipelines are cached by the attachments & subpass they render to, not by the render pass handle
+    _renderPassInfo = RenderPass::Describe(_renderPass, renderPassCreateInfo.createInfo, 0);
 
     /// DESTROY
     _mainDestructionQueue.addDestructor([=]() {
@@ -514,104 +584,83 @@ namespace walrus {
 
   void VulkanEngine::init_sync_structures() {
     /// FENCES
-    {
-      VkFenceCreateInfo info{};
-      info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-      info.pNext = nullptr;
-      info.flags = VK_FENCE_CREATE_SIGNALED_BIT; // signal == mutex lock
-
-      _fencePool.push_back(VK_NULL_HANDLE);
-      VK_CHECK(vkCreateFence(_device, &info, nullptr, &_fencePool.back()));
-      _fences.pRender = &_fencePool.back();
-    }
+    _fences.render = _resources.createFence(VK_FENCE_CREATE_SIGNALED_BIT); // signal == mutex lock
 
     /// SEMAPHORES
-    {
-      VkSemaphoreCreateInfo info{};
-      info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-      info.pNext = nullptr;
-      info.flags = 0;
+    _semaphores.present = _resources.createSemaphore();
+    _semaphores.render = _resources.createSemaphore();
 
-      size_t index = _semaphorePool.size();
-      _semaphorePool.push_back(VK_NULL_HANDLE);
-      _semaphorePool.push_back(VK_NULL_HANDLE);
-      VK_CHECK(vkCreateSemaphore(_device, &info, nullptr, &_semaphorePool.at(index)));
-      VK_CHECK(vkCreateSemaphore(_device, &info, nullptr, &_semaphorePool.at(index + 1)));
-      _semaphores.pPresent = &_semaphorePool.at(index);
-      _semaphores.pRender = &_semaphorePool.at(index + 1);
-    }
+    /// BARRIERS, SUBMISSIONS & TRANSIENT MEMORY
+    _frameGraph.init(_device, _deviceInfo, _allocator);
+    _submitBatcher.init(_device, _deviceInfo);
+
+    /// QUEUES
+    // frames go to the high priority queue, independent compute work is spread over the others
+    _queueScheduler.init(_device, _deviceInfo, _queues);
+    _renderQueue = _queueScheduler.select(QueueScheduler::Priority::HIGH);
 
     /// DESTROY
     _mainDestructionQueue.addDestructor([=]() {
-      vkWaitForFences(
-        _device,
-        _fencePool.size(),
-        _fencePool.data(),
-        true,
-        1'000'000'000
-      );
-      for (auto &fence: _fencePool) {
-        vkDestroyFence(
+      const auto &fences = _resources.fences().values();
+      if (!fences.empty()) {
+        vkWaitForFences(
           _device,
-          fence,
-          nullptr
+          (uint32_t) fences.size(),
+          fences.data(),
+          true,
+          1'000'000'000
         );
       }
+      _frameGraph.destroy();
+      _queueScheduler.destroy();
       // TODO: are we not supposed to wait for semaphores the same as for fences?
-      for (auto &semaphore: _semaphorePool) {
-        vkDestroySemaphore(
-          _device,
-          semaphore,
-          nullptr
-        );
-      }
+      _resources.destroy();
     });
   }
 
 
 
 
-  /// @brief reads a shader file into a buffer and creates a shader module from it.
-  bool VulkanEngine::load_shader_module(const char *filePath, VkShaderModule *outShaderModule) {
-    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
+  /// @brief memory maps a spir-v file (or finds it embedded in the executable) and gets its shader module from the cache.
+  /// @param outCodeHash (optional) receives a hash of the spir-v, used to deduplicate pipelines
+  /// @param allowEmbedded false forces a read from disk, i.e. after the shader was recompiled
+  /// @note modules are owned by `_shaderModules`: don't destroy them, release them -- see `release_shader_modules`
+  bool VulkanEngine::load_shader_module(
+    const char *filePath,
+    VkShaderModule *outShaderModule,
+    uint64_t *outCodeHash,
+    bool allowEmbedded
+  ) {
+    ShaderModuleCache::Module shaderModule{};
+    if (!_shaderModules.load(_device, filePath, &shaderModule, allowEmbedded)) {
       return false;
     }
+    *outShaderModule = shaderModule.module;
+    if (outCodeHash != nullptr) {
+      *outCodeHash = shaderModule.codeHash;
+    }
+    return true;
+  }
 
-    // gets file size, because std::ios::ate sets the position to the end of the file
-    size_t fileSize = (size_t) file.tellg();
-    /// TODO : is a vector the optimal container for buffer?
-    std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
-    file.seekg(0);
-    file.read((char *) buffer.data(), (long) fileSize);
-    file.close();
 
-    VkShaderModuleCreateInfo info{};
-    info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    info.pNext = nullptr;
-    info.codeSize = buffer.size() * sizeof(uint32_t);
-    info.pCode = buffer.data();
 
-    VkShaderModule shaderModule;
-    if (
-      vkCreateShaderModule(
-        _device,
-        &info,
-        nullptr,
-        &shaderModule
-      ) != VK_SUCCESS
-    ){
-      return false;
+  /// @brief drop the builder's references to its shader modules, once its pipeline or library parts are created.
+  /// the modules are destroyed when no other build holds them
+  void VulkanEngine::release_shader_modules(const PipelineBuilder &builder) {
+    for (uint64_t codeHash: builder.shaderHashes) {
+      if (codeHash != 0) { // 0: the stage failed to load
+        _shaderModules.release(_device, codeHash);
+      }
     }
-    *outShaderModule = shaderModule;
-    return true;
   }
 
 
 
 
+
   void VulkanEngine::init_pipelines() {
     assert(_swapchain != VK_NULL_HANDLE && "must initialize swapchain before pipelines");
+    assert(!_shaders.filePaths.empty() && "at least one pipeline is needed as the fallback");
 
     /// CONSTANTS
     VkPipelineLayoutCreateInfo info = defaults::pipeline::layoutCreateInfo();
@@ -620,72 +669,275 @@ namespace walrus {
     builder.inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     builder.rasterizerState.polygonMode = VK_POLYGON_MODE_FILL;
 
+    /// LAYOUT
+    // TODO: add descriptor sets and other stuff
+    // every pipeline currently shares the same (empty) layout, so the cache hands back a single handle
+    builder.pipelineLayout = _pipelineCache.getLayout(_device, info);
+    VkPipelineCache driverCache = _pipelineCache.createDriverCache(_device);
+
+    /// LOAD SHADERS
+    // shader modules are cached by content, and released once the pipeline (or its library parts) using them is created
+    std::vector<PipelineBuilder> builders{};
     for (auto &shaderPath: _shaders.filePaths) {
-      /// LOAD SHADERS
-      VkShaderModule fragmentShader; // will be instantiated in `load_shader_module` call
-      VkShaderModule vertexShader;   // will be instantiated in `load_shader_module` call
+      VkShaderModule fragmentShader = VK_NULL_HANDLE; // will be instantiated in `load_shader_module` call
+      VkShaderModule vertexShader = VK_NULL_HANDLE;   // will be instantiated in `load_shader_module` call
+      uint64_t fragmentHash = 0;
+      uint64_t vertexHash = 0;
       {
         std::string fragFilePath = shaderPath + ".frag.spv";
         std::string vertFilePath = shaderPath + ".vert.spv";
         io::printExists(
-          load_shader_module(fragFilePath.data(), &fragmentShader),
+          load_shader_module(fragFilePath.data(), &fragmentShader, &fragmentHash),
           fragFilePath
         );
         io::printExists(
-          load_shader_module(vertFilePath.data(), &vertexShader),
+          load_shader_module(vertFilePath.data(), &vertexShader, &vertexHash),
           vertFilePath
         );
       }
 
-      /// LAYOUT
-      {
-        // TODO: add descriptor sets and other stuff
-        _pipelineLayouts.push_back(VK_NULL_HANDLE);
-        VK_CHECK(vkCreatePipelineLayout(
-                _device,
-                &info,
-                nullptr,
-                &_pipelineLayouts.back()
-        ));
+      /// FIXME : pipeline defaults are in a defaults namespace, but renderpass isn't
+      /// FIXME : some classes have default creator functions and some don't...
+      /// FIXME : standardize how default createInfo structs are created.
+      builder.shaderStages.clear();
+      builder.shaderHashes.clear();
+      builder.addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, fragmentHash);
+      builder.addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertexShader, vertexHash);
+      builders.push_back(builder);
+    }
+    _pipelineBuilders = builders;
+
+    _pipelines.assign(builders.size(), VK_NULL_HANDLE);
+    _pipelineJobs.workerCaches = PipelineCache::createWorkerCaches(_device, _threadPool.size());
+
+    if (_deviceInfo.capabilities.graphicsPipelineLibrary) {
+      /// GRAPHICS PIPELINE LIBRARY
+      // library parts are compiled once and shared between pipelines. fast linking them is cheap,
+      // so every pipeline is usable right away. optimized links are scheduled on the thread pool
+      for (size_t i = 0; i < builders.size(); i++) {
+        _pipelines[i] = builders[i].buildLinked(_device, _renderPassInfo, _pipelineCache, driverCache);
+        if (_pipelines[i] == VK_NULL_HANDLE) {
+          builders[i].build(_device, _renderPassInfo, _pipelineCache, &_pipelines[i], driverCache);
+          release_shader_modules(builders[i]);
+          continue;
+        }
+        // the library parts retain what the optimized link needs, so the modules aren't used past this point
+        release_shader_modules(builders[i]);
+        _pipelineJobs.pending.emplace_back(i, _threadPool.submit([this, pipelineBuilder = builders[i]]() mutable {
+          return pipelineBuilder.buildOptimized(
+                  _device,
+                  _renderPassInfo,
+                  _pipelineCache,
+                  _pipelineJobs.workerCaches[ThreadPool::currentWorkerIndex()]
+          );
+        }));
+      }
+    } else {
+      /// FALLBACK PIPELINE
+      // the first pipeline is built on the main thread, so that rendering can start
+      // while the remaining pipelines are still compiling
+      builders.front().build(
+              _device,
+              _renderPassInfo,
+              _pipelineCache,
+              &_pipelines.front(),
+              driverCache
+      );
+      release_shader_modules(builders.front());
+
+      /// PARALLEL COMPILATION
+      // VkPipelineCache is externally synchronized, so each worker compiles into its own cache.
+      // worker caches are merged into the shared cache once every job has finished -- see `update_pipelines`
+      for (size_t i = 1; i < builders.size(); i++) {
+        _pipelines[i] = _pipelines.front();
+        _pipelineCache.retainPipeline(_pipelines[i]); // every slot holds its own reference
+        _pipelineJobs.pending.emplace_back(i, _threadPool.submit([this, pipelineBuilder = builders[i]]() mutable {
+          VkPipeline pipeline = VK_NULL_HANDLE;
+          /// identical state returns the already built pipeline
+          pipelineBuilder.build(
+                  _device,
+                  _renderPassInfo,
+                  _pipelineCache,
+                  &pipeline,
+                  _pipelineJobs.workerCaches[ThreadPool::currentWorkerIndex()]
+          );
+          release_shader_modules(pipelineBuilder);
+          return pipeline;
+        }));
       }
+    }
+    if (!_shaders.compileAsync) {
+      _threadPool.waitIdle();
+    }
+    update_pipelines();
 
-      /// PIPELINE
-      {
-        /// FIXME : pipeline defaults are in a defaults namespace, but renderpass isn't
-        /// FIXME : some classes have default creator functions and some don't...
-        /// FIXME : standardize how default createInfo structs are created.
+    /// DESTROY
+    _mainDestructionQueue.addDestructor([=]() {
+      // pending jobs still reference the cache & shader modules. queued reloads are dropped, not started
+      _pipelineJobs.queuedReloads.clear();
+      _threadPool.waitIdle();
+      update_pipelines();
+      _deletionQueue.flush();
+      // the cache owns the pipelines and layouts, and destroys pipelines before layouts
+      _pipelineCache.destroy(_device);
+      _pipelines.clear();
+    });
+  }
 
-        builder.shaderStages.clear();
-        builder.shaderStages.push_back(
-          defaults::pipeline::shaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader)
-        );
-        builder.shaderStages.push_back(
-          defaults::pipeline::shaderStageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT, vertexShader)
-        );
-        builder.pipelineLayout = _pipelineLayouts.back();
 
-        _pipelines.push_back(VK_NULL_HANDLE);
-        builder.build(
-                _device,
-                _renderPass,
-                &_pipelines.back()
-        );
+
+
+  /// @brief swap in pipelines that finished compiling on the thread pool. called at frame boundaries.
+  void VulkanEngine::update_pipelines() {
+    auto &pending = _pipelineJobs.pending;
+    std::vector<size_t> completed{};
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        it++;
+        continue;
       }
-      vkDestroyShaderModule(_device, fragmentShader, nullptr);
-      vkDestroyShaderModule(_device, vertexShader, nullptr);
+      VkPipeline pipeline = it->second.get();
+      if (pipeline != VK_NULL_HANDLE && pipeline != _pipelines[it->first]) {
+        VkPipeline previous = _pipelines[it->first];
+        _pipelines[it->first] = pipeline;
+        retire_pipeline(previous);
+      } else if (pipeline != VK_NULL_HANDLE) {
+        retire_pipeline(pipeline); // the job's reference to the pipeline already in use
+      } // else keep rendering with the current pipeline
+      completed.push_back(it->first);
+      it = pending.erase(it);
     }
 
-    /// DESTROY
-    _mainDestructionQueue.addDestructor([=]() {
-      // must destroy pipelines before pipeline layouts
-      for (auto &pipeline: _pipelines) {
-        vkDestroyPipeline(_device, pipeline, nullptr);
+    /// QUEUED RELOADS
+    for (size_t index: completed) {
+      auto queued = _pipelineJobs.queuedReloads.find(index);
+      if (queued != _pipelineJobs.queuedReloads.end()) {
+        std::vector<std::string> glslPaths = std::move(queued->second);
+        _pipelineJobs.queuedReloads.erase(queued);
+        rebuild_pipeline(index, std::move(glslPaths));
       }
-      // pipeline layouts are now safe to destroy
-      for (auto &layout: _pipelineLayouts) {
-        vkDestroyPipelineLayout(_device, layout, nullptr);
+    }
+    if (!pending.empty() || _pipelineJobs.workerCaches.empty()) {
+      return;
+    }
+
+    /// ALL JOBS COMPLETE
+    _pipelineCache.mergeWorkerCaches(_device, _pipelineJobs.workerCaches);
+    std::cout << "pipelines built: " << _pipelineCache.pipelineCount()
+              << " unique / " << _pipelines.size() << " requested" << std::endl;
+  }
+
+
+
+
+  void VulkanEngine::init_shader_watcher() {
+    _shaderWatcher = std::make_unique<ShaderWatcher>(ShaderCompiler::sourceDirectory());
+    io::printExists(_shaderWatcher->isWatching(), "shader hot reload: " + ShaderCompiler::sourceDirectory());
+  }
+
+
+
+
+  /// @brief recompile modified glsl & rebuild the affected pipelines on the thread pool.
+  /// the results are swapped in by `update_pipelines` at the next frame boundary.
+  void VulkanEngine::reload_shaders() {
+    if (!_shaderWatcher) {
+      return;
+    }
+    /// CHANGED STAGES
+    // one rebuild per pipeline, however many of its stages changed
+    std::unordered_map<size_t, std::vector<std::string>> reloads{};
+    for (auto &glslPath: _shaderWatcher->poll()) {
+      // the build compiles `<dir>/name.frag` into `shaders/name.frag.spv`, and shader paths are `shaders/name`
+      const std::string name = std::filesystem::path(glslPath).stem().string();
+      for (size_t i = 0; i < _shaders.filePaths.size(); i++) {
+        if (std::filesystem::path(_shaders.filePaths[i]).filename().string() == name) {
+          std::cout << io::to_color_string(io::CYAN, "reloading shader: ") << glslPath << std::endl;
+          reloads[i].push_back(glslPath);
+        }
       }
-    });
+    }
+
+    for (auto &[index, glslPaths]: reloads) {
+      const bool building = std::any_of(
+        _pipelineJobs.pending.begin(),
+        _pipelineJobs.pending.end(),
+        [index = index](const auto &job) { return job.first == index; }
+      );
+      if (!building) {
+        rebuild_pipeline(index, std::move(glslPaths));
+        continue;
+      }
+      // coalesced into a single rebuild once the current one completes -- see `update_pipelines`
+      auto &queued = _pipelineJobs.queuedReloads[index];
+      for (auto &glslPath: glslPaths) {
+        if (std::find(queued.begin(), queued.end(), glslPath) == queued.end()) {
+          queued.push_back(glslPath);
+        }
+      }
+    }
+  }
+
+
+
+
+  void VulkanEngine::rebuild_pipeline(size_t index, std::vector<std::string> glslPaths) {
+    // worker caches are merged & destroyed whenever no job is pending, so the first rebuild after that recreates them
+    if (_pipelineJobs.workerCaches.empty()) {
+      _pipelineJobs.workerCaches = PipelineCache::createWorkerCaches(_device, _threadPool.size());
+    }
+    _pipelineJobs.pending.emplace_back(index, _threadPool.submit(
+      [this, index, glslPaths = std::move(glslPaths), pipelineBuilder = _pipelineBuilders[index]]() mutable -> VkPipeline {
+        const std::string &shaderPath = _shaders.filePaths[index];
+        for (auto &glslPath: glslPaths) {
+          const std::string extension = std::filesystem::path(glslPath).extension().string();
+          if (!ShaderCompiler::compile(glslPath, shaderPath + extension + ".spv")) {
+            return VK_NULL_HANDLE; // keep the current pipeline
+          }
+        }
+
+        /// LOAD SHADERS
+        VkShaderModule fragmentShader = VK_NULL_HANDLE;
+        VkShaderModule vertexShader = VK_NULL_HANDLE;
+        uint64_t fragmentHash = 0;
+        uint64_t vertexHash = 0;
+        // read from disk -- embedded spir-v would be stale
+        const bool loaded = load_shader_module((shaderPath + ".frag.spv").data(), &fragmentShader, &fragmentHash, false)
+                            && load_shader_module((shaderPath + ".vert.spv").data(), &vertexShader, &vertexHash, false);
+        pipelineBuilder.shaderStages.clear();
+        pipelineBuilder.shaderHashes.clear();
+        pipelineBuilder.addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, fragmentHash);
+        pipelineBuilder.addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertexShader, vertexHash);
+
+        /// PIPELINE
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (loaded) {
+          pipelineBuilder.build(
+                  _device,
+                  _renderPassInfo,
+                  _pipelineCache,
+                  &pipeline,
+                  _pipelineJobs.workerCaches[ThreadPool::currentWorkerIndex()]
+          );
+        }
+        // also releases the fragment stage if only the vertex stage failed to load
+        release_shader_modules(pipelineBuilder);
+        return pipeline;
+      }
+    ));
+  }
+
+
+
+
+  /// @brief drop a reference to a replaced pipeline, and queue it for destruction if it was the last one
+  void VulkanEngine::retire_pipeline(VkPipeline pipeline) {
+    // other shader paths (i.e. the fallback) & jobs that got it from the cache hold references of their own
+    if (!_pipelineCache.releasePipeline(pipeline)) {
+      return; // still referenced, or not owned by the cache
+    }
+    // the frames submitted so far may still use it
+    _deletionQueue.retirePipeline(pipeline, (uint64_t) _frameNumber);
   }
 
 
@@ -708,59 +960,53 @@ namespace walrus {
 
 
   void VulkanEngine::upload_mesh(Mesh &mesh) {
-    /// VMA BUFFER
-    {
-      VkBufferCreateInfo bufferInfo{};
-      bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-      bufferInfo.size = mesh.vertices.size() * sizeof(walrus::Vertex);
-      bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-
-      VmaAllocationCreateInfo vmaAllocInfo{};
-      vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-
-      VK_CHECK(vmaCreateBuffer(
-              _allocator,
-              &bufferInfo,
-              &vmaAllocInfo,
-              &mesh.vertexBuffer.buffer,
-              &mesh.vertexBuffer.allocation,
-              nullptr
-      ));
+    const VkDeviceSize size = mesh.vertices.size() * sizeof(Vertex);
+    // meshes evicted & uploaded again are already registered for destruction
+    const bool firstUpload = mesh.residency.isNull();
+
+    /// BUDGET
+    // evict idle streamed assets first, rather than letting the allocation fail
+    if (!_memoryBudget.makeRoom(VMA_MEMORY_USAGE_CPU_TO_GPU, size)) {
+      std::cout << io::to_color_string(io::ORANGE, "mesh upload: over the memory budget, even after evicting")
+                << std::endl;
     }
 
-    /// DESTROY
-    _mainDestructionQueue.addDestructor([=]() {
-      vmaDestroyBuffer(
-              _allocator,
-              mesh.vertexBuffer.buffer,
-              mesh.vertexBuffer.allocation
-      );
+    /// VMA BUFFER
+    // host visible & persistently mapped: the vertices are written straight into it, without a map / unmap per upload.
+    // dedicated memory, not the fixed pools: evicting the mesh has to give its memory back to the heap
+    mesh.vertexBuffer = GpuBuffer<Vertex>(
+      _allocator,
+      mesh.vertices.size(),
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      VMA_MEMORY_USAGE_CPU_TO_GPU,
+      {},
+      nullptr,
+      VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
+    );
+    mesh.vertexBuffer.write(mesh.vertices);
+    // the vertices stay on the host: once evicted (not resident), use_mesh uploads the mesh again
+    mesh.residency = _memoryBudget.track(mesh.vertexBuffer.allocated().allocation, [this, &mesh]() {
+      _deletionQueue.retireBuffer(mesh.vertexBuffer.release(), (uint64_t) _frameNumber);
     });
 
+    /// DESTROY
+    if (firstUpload) {
+      _mainDestructionQueue.addDestructor([this, &mesh]() {
+        _memoryBudget.untrack(mesh.residency);
+        mesh.vertexBuffer.reset();
+      });
+    }
+  }
+
 
-    /// FIXME : what's the optimal way to do this? Will this be slow?
-    /// TODO : how often might this run? Is this a bottleneck?
-    /**
-     * transfering data from the cpu to the gpu has the following steps:
-     * 1. map the gpu memory to the cpu
-     * 2. copy the data to the mapped memory
-     * 3. unmap the gpu memory
-     */
-    void *data;
-    vmaMapMemory(
-        _allocator,
-        mesh.vertexBuffer.allocation,
-        &data
-    );
-    memcpy(
-        data,
-        mesh.vertices.data(),
-        mesh.vertices.size() * sizeof(walrus::Vertex)
-    );
-    vmaUnmapMemory(
-        _allocator,
-        mesh.vertexBuffer.allocation
-    );
+
+
+  void VulkanEngine::use_mesh(Mesh &mesh) {
+    if (!_memoryBudget.isResident(mesh.residency)) {
+      upload_mesh(mesh);
+    }
+    // the least recently used meshes are evicted first, and meshes of frames in flight never are
+    _memoryBudget.touch(mesh.residency);
   }
 
 
@@ -778,28 +1024,41 @@ namespace walrus {
 
   void VulkanEngine::draw() {
     uint32_t imageIndex;
+    const VkFence renderFence = _resources.fence(_fences.render);
+    const VkSemaphore presentSemaphore = _resources.semaphore(_semaphores.present);
+    const VkSemaphore renderSemaphore = _resources.semaphore(_semaphores.render);
     VK_CHECK(vkWaitForFences(
             _device,
             1,
-            _fences.pRender,
+            &renderFence,
             true,
             1'000'000'000
     ));
     VK_CHECK(vkResetFences(
             _device,
             1,
-            _fences.pRender
+            &renderFence
     ));
+    /// the previous frame has completed -- every frame submitted so far is done with the retired objects
+    _deletionQueue.collect((uint64_t) _frameNumber);
+    /// the frame memory of the frame FRAME_ALLOCATOR_FRAMES ago is free too
+    _frameMemory.beginFrame((uint64_t) _frameNumber);
+    /// evictions retire their buffers, so they are destroyed once this frame completes
+    _memoryBudget.update((uint64_t) _frameNumber);
+    /// meshes drawn this frame: after the evictions, before recording
+    if (!_test.mesh.vertices.empty()) {
+      use_mesh(_test.mesh);
+    }
     VK_CHECK(vkAcquireNextImageKHR(
             _device,
             _swapchain,
             1'000'000'000,
-            *_semaphores.pPresent,
+            presentSemaphore,
             nullptr,
             &imageIndex
     ));
 
-    auto graphicsQueue = _queues.front();
+    auto graphicsQueue = _queueScheduler.getQueue(_renderQueue);
 
     VkClearValue clearValue{};
     float flash = abs(sin((float) _frameNumber / 120.f));
@@ -822,57 +1081,85 @@ namespace walrus {
       VK_CHECK(vkBeginCommandBuffer(_commandBuffer, &info));
     }
 
-    /// RENDER PASS
+    /// FRAME GRAPH
     {
-      VkRenderPassBeginInfo info{};
-      info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-      info.pNext = nullptr;
-      info.renderPass = _renderPass;
-      info.framebuffer = _framebuffers[imageIndex]; // the image we will render into.
-      info.clearValueCount = 1;
-      info.pClearValues = &clearValue;
-      // offset and extent can be set if we want to render a small renderpass into a bigger image
-      info.renderArea.offset.x = 0;
-      info.renderArea.offset.y = 0;
-      info.renderArea.extent = _swapchainExtent;
-
-      vkCmdBeginRenderPass(
-        _commandBuffer,
-        &info,
-        VK_SUBPASS_CONTENTS_INLINE
-      );
-      vkCmdBindPipeline(
-        _commandBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        _pipelines[_shaders.currentIndex]
-      );
-      vkCmdDraw(
-        _commandBuffer,
-        3, /// FIXME : this should be the number of vertices in the mesh
-        1,
-        0,
-        0
+      _frameGraph.reset();
+      VkImageSubresourceRange colorRange{};
+      colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      colorRange.levelCount = 1;
+      colorRange.layerCount = 1;
+      // the acquire semaphore is waited on at COLOR_ATTACHMENT_OUTPUT, the first barrier chains with that wait
+      const auto swapchainImage = _frameGraph.importImage(
+        _swapchainImages[imageIndex],
+        colorRange,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
       );
-      vkCmdEndRenderPass(
-        _commandBuffer
+      // presentation waits on the render semaphore, so only the layout is left to change
+      _frameGraph.markOutput(swapchainImage, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+      _frameGraph.addPass("triangle", [&](VkCommandBuffer commandBuffer) {
+        VkRenderPassBeginInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        info.pNext = nullptr;
+        info.renderPass = _renderPass;
+        info.framebuffer = _framebuffers[imageIndex]; // the image we will render into.
+        info.clearValueCount = 1;
+        info.pClearValues = &clearValue;
+        // offset and extent can be set if we want to render a small renderpass into a bigger image
+        info.renderArea.offset.x = 0;
+        info.renderArea.offset.y = 0;
+        info.renderArea.extent = _swapchainExtent;
+
+        vkCmdBeginRenderPass(
+          commandBuffer,
+          &info,
+          VK_SUBPASS_CONTENTS_INLINE
+        );
+        vkCmdBindPipeline(
+          commandBuffer,
+          VK_PIPELINE_BIND_POINT_GRAPHICS,
+          _pipelines[_shaders.currentIndex]
+        );
+        if (_test.mesh.vertexBuffer.isValid()) {
+          const VkBuffer vertexBuffer = _test.mesh.vertexBuffer.buffer();
+          const VkDeviceSize offset = 0;
+          vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+        }
+        vkCmdDraw(
+          commandBuffer,
+          3, /// FIXME : this should be the number of vertices in the mesh
+          1,
+          0,
+          0
+        );
+        vkCmdEndRenderPass(
+          commandBuffer
+        );
+      }).write(
+        swapchainImage,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
       );
+
+      _frameGraph.compile();
+      _frameGraph.execute(_commandBuffer);
     }
     VK_CHECK(vkEndCommandBuffer(_commandBuffer));
 
     /// SUBMIT TO QUEUE
     {
-      VkSubmitInfo info{};
-      info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-      info.pNext = nullptr;
-      VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-      info.pWaitDstStageMask = &waitStage;
-      info.waitSemaphoreCount = 1;
-      info.pWaitSemaphores = _semaphores.pPresent; // mutex is locked from vkAcquireNextImageKHR above
-      info.signalSemaphoreCount = 1;
-      info.pSignalSemaphores = _semaphores.pRender; // set rendering mutex
-      info.commandBufferCount = 1;
-      info.pCommandBuffers = &_commandBuffer;
-      VK_CHECK(vkQueueSubmit(graphicsQueue, 1, &info, *_fences.pRender));
+      // mutex is locked from vkAcquireNextImageKHR above. only the color output waits for it,
+      // the frame graph's first barrier chains with this wait
+      _submitBatcher.wait(presentSemaphore, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+      // the frame's transient writes, visible before the device reads them
+      _frameMemory.flush();
+      _submitBatcher.add(_commandBuffer);
+      // after every command, the transition to PRESENT_SRC included
+      _submitBatcher.signal(renderSemaphore, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT); // set rendering mutex
+      // everything queued during the frame goes in one submission
+      VK_CHECK(_queueScheduler.submit(_renderQueue, _submitBatcher, renderFence));
     }
 
     /// PRESENT
@@ -883,7 +1170,7 @@ namespace walrus {
       info.swapchainCount = 1;
       info.pSwapchains = &_swapchain;
       info.waitSemaphoreCount = 1;
-      info.pWaitSemaphores = _semaphores.pRender; // mutex is locked from vkQueueSubmit above
+      info.pWaitSemaphores = &renderSemaphore; // mutex is locked from the submission above
       info.pImageIndices = &imageIndex;
       VK_CHECK(vkQueuePresentKHR(graphicsQueue, &info));
     }
@@ -907,19 +1194,121 @@ namespace walrus {
     while (!_window.shouldClose()) {
       glfwPollEvents();
       winEvents.poll();
+      reload_shaders();
+      update_pipelines();
       if (winEvents.keyPress(keys::SPACE)) {
         _shaders.currentIndex = (_shaders.currentIndex + 1) % _shaders.filePaths.size();
       }
       draw();
+      if (_task & DeviceTask::COMPUTE) {
+        update_async_compute();
+      }
+      _queueScheduler.update();
+    }
+    if (_task & DeviceTask::COMPUTE) {
+      finish_async_compute();
     }
+    _queueScheduler.print();
+    _memoryPools.print();
+    _memoryBudget.print();
+  }
+
+
+  void VulkanEngine::update_async_compute() {
+    AsyncCompute &job = _asyncCompute;
+
+    /// SETUP
+    if (!job.input.isValid()) {
+      job.count = 1u << 22;
+      std::vector<float> values(job.count);
+      for (uint32_t i = 0; i < job.count; i++) {
+        values[i] = (float) (i % 17) * 0.25f;
+      }
+      job.reduce.init(_compute);
+      job.input = _compute.createGpuBuffer<float>(job.count);
+      _compute.upload(job.input, values);
+      job.scratch = _compute.createGpuBuffer<float>(job.reduce.scratchCount(job.count));
+      job.readback = _compute.createGpuBuffer<float>(1, VMA_MEMORY_USAGE_GPU_TO_CPU, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    }
+
+    /// COLLECT
+    if (job.submission != 0) {
+      job.frames++;
+      if (!_compute.isComplete(job.submission)) {
+        return;
+      }
+      job.deviceMs += _compute.wait();
+      job.jobs++;
+      job.readback.read(&job.result, 1);
+    }
+
+    /// SUBMIT
+    // the frames never read the sum, so the compute queue runs without waiting for them
+    _compute.begin();
+    const uint32_t index = job.reduce.record(
+      job.input.allocated(),
+      job.count,
+      primitives::ValueType::FLOAT32,
+      job.scratch.allocated()
+    );
+    _compute.barrier();
+    _compute.copy(job.scratch.allocated(), job.readback.allocated(), sizeof(float), (VkDeviceSize) index * sizeof(float));
+    job.submission = _compute.submitAsync();
+  }
+
+
+  void VulkanEngine::finish_async_compute() {
+    AsyncCompute &job = _asyncCompute;
+    if (!job.input.isValid()) {
+      return;
+    }
+    // the last submission is always in flight
+    if (job.submission != 0) {
+      job.deviceMs += _compute.wait();
+      job.jobs++;
+    }
+    std::cout << "async compute: " << job.jobs << " reductions (last sum " << job.result << ") overlapped "
+              << job.frames << " frames, " << (job.jobs > 0 ? job.deviceMs / job.jobs : 0.0) << " ms each" << std::endl;
+    // the buffers are destroyed with the job
+    job = AsyncCompute{};
   }
 
   void VulkanEngine::runCompute() {
     bool done = false;
     while(!done) {
       std::cout << io::to_color_string(io::Color::CYAN, "\nRUN COMPUTE\n\n");
+
+      /// REDUCE
+      {
+        const uint32_t count = 1u << 24;
+        std::vector<float> values(count);
+        double expected = 0.0;
+        for (uint32_t i = 0; i < count; i++) {
+          values[i] = (float) (i % 17) * 0.25f;
+          expected += values[i];
+        }
+
+        primitives::Reduce reduce{};
+        reduce.init(_compute);
+        AllocatedBuffer input = _compute.createBuffer(count * sizeof(float));
+        _compute.upload(input, values.data(), input.size);
+
+        AllocatedBuffer scratch = _compute.createBuffer(reduce.scratchCount(count) * sizeof(float));
+        _compute.begin();
+        reduce.record(input, count, primitives::ValueType::FLOAT32, scratch);
+        const double ms = _compute.submit();
+        const auto result = reduce.sum<float>(input, count);
+
+        std::cout << "reduce: " << result << " (expected " << expected << ") "
+                  << ms << " ms, " << (double) input.size / (ms * 1e6) << " GB/s" << std::endl;
+        _compute.destroyBuffer(scratch);
+        _compute.destroyBuffer(input);
+      }
       done = true;
     }
+    _queueScheduler.print();
+    _memoryPools.print();
+    _memoryBudget.print();
   }
 
 }
\ No newline at end of file
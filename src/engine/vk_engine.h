@@ -6,6 +6,21 @@
 
 #include "engine/compute/device/device.hpp"
 #include "engine/compute/synchronize/generics.hpp"
+#include "engine/compute/synchronize/submit/submit_batcher.hpp"
+#include "engine/compute/synchronize/queue/queue_scheduler.hpp"
+#include "engine/compute/synchronize/deletion/deletion_queue.hpp"
+#include "engine/compute/resources/resource_registry.hpp"
+#include "engine/compute/memory/pools/memory_pools.hpp"
+#include "engine/compute/memory/frame/frame_allocator.hpp"
+#include "engine/compute/memory/budget/memory_budget.hpp"
+#include "engine/compute/context/compute_context.hpp"
+#include "engine/compute/primitives/reduce/reduce.hpp"
+#include "engine/rendering/frame_graph/frame_graph.hpp"
+#include "engine/rendering/pipelines/cache/pipeline_cache.hpp"
+#include "engine/rendering/pipelines/builder/pipeline_builder.hpp"
+#include "engine/shaders/watcher/shader_watcher.hpp"
+#include "engine/shaders/cache/shader_module_cache.hpp"
+#include "engine/utils/thread_pool/thread_pool.hpp"
 
 #include <vk_types.h>
 
@@ -13,6 +28,10 @@
 #include <string>
 #include <functional>
 #include <deque>
+#include <future>
+#include <memory>
+#include <utility>
+#include <unordered_map>
 
 namespace walrus {
 
@@ -48,6 +67,9 @@ namespace walrus {
 
     void destroy();
 
+    /// @brief compute kernels, buffers & dispatch. only initialized for COMPUTE tasks
+    ComputeContext &getCompute() { return _compute; }
+
   private:
 
     void init_vulkan();
@@ -62,25 +84,55 @@ namespace walrus {
 
     void init_sync_structures();
 
-    bool load_shader_module(const char* filePath, VkShaderModule* outShaderModule);
+    void init_compute();
+
+    bool load_shader_module(
+      const char* filePath,
+      VkShaderModule* outShaderModule,
+      uint64_t* outCodeHash = nullptr,
+      bool allowEmbedded = true
+    );
+
+    void release_shader_modules(const PipelineBuilder &builder);
 
     void init_pipelines();
 
+    void update_pipelines();
+
+    void init_shader_watcher();
+
+    void reload_shaders();
+
+    /// @brief recompile `glslPaths` & rebuild pipeline `index` on the thread pool
+    void rebuild_pipeline(size_t index, std::vector<std::string> glslPaths);
+
+    void retire_pipeline(VkPipeline pipeline);
+
     void load_meshes();
 
     void upload_mesh(Mesh& mesh);
 
+    /// @brief called for each mesh drawn this frame: uploads it again if it was evicted, keeps it from being evicted
+    void use_mesh(Mesh& mesh);
+
 
     void draw();
 
     void runRender();
 
+    /// @brief collects the background reduction if it's done & submits the next one. called once per frame
+    void update_async_compute();
+
+    /// @brief waits for the background reduction & prints how many frames it overlapped
+    void finish_async_compute();
+
     void runCompute();
 
 
     /// TASK NEUTRAL
     bool _isInitialized{false};
     DeviceTask _task = ALL;
+    ThreadPool _threadPool{};
 
     /// VALIDATION & DEBUG
 #ifdef NDEBUG
@@ -98,19 +150,64 @@ namespace walrus {
     /// TODO : QUEUE REFACTOR - support multiple devices & support multiple queue families across multiple devices
     DeviceInfo _deviceInfo{};
     std::vector<VkQueue> _queues{};
+    /// a queue of the dedicated compute family, for ALL tasks. empty if the device has none
+    std::vector<VkQueue> _computeQueues{};
     std::vector<VkPhysicalDevice> _physicalDevices{};
 
     VkCommandPool _commandPool{};
     VkCommandBuffer _commandBuffer{};
 
     /// SYNC
-    std::vector<VkSemaphore> _semaphorePool{};
-    std::vector<VkFence> _fencePool;
-    sync::generics::RenderSync<VkSemaphore> _semaphores{};
-    sync::generics::RenderSync<VkFence> _fences{};
+    sync::generics::RenderSync<SemaphoreHandle> _semaphores{};
+    sync::generics::RenderSync<FenceHandle> _fences{};
+    /// the frame's command buffers & semaphores, submitted together
+    SubmitBatcher _submitBatcher{};
+    /// every queue of the best family. frames are submitted to `_renderQueue`
+    QueueScheduler _queueScheduler{};
+    uint32_t _renderQueue = 0;
 
     /// MEMORY
     VmaAllocator _allocator = nullptr;
+    /// a pool per usage class, for the compute context's buffers & meshes
+    MemoryPools _memoryPools{};
+    /// per frame uniforms, instance data & scratch. reset when its frame comes around, see draw()
+    FrameAllocator _frameMemory{};
+    /// the render fence is waited on before each frame, so two buffers never race the device
+    static constexpr uint32_t FRAME_ALLOCATOR_FRAMES = 2;
+    /// heap usage vs budget, and eviction of streamed assets (meshes) before allocations fail
+    MemoryBudget _memoryBudget{};
+    /// objects released mid-run (i.e. replaced pipelines), keyed by `_frameNumber`. collected once the render fence is waited on
+    DeletionQueue _deletionQueue{};
+    /// fences, semaphores & other objects addressed by handles, which stay valid as the registry grows
+    ResourceRegistry _resources{};
+
+    /// SHADERS
+    ShaderModuleCache _shaderModules{};
+
+    /// COMPUTE
+    ComputeContext _compute{};
+    struct ComputePaths {
+      std::string shaderDirectory = "../../shaders/";
+      /// per device autotune results. delete to re-tune
+      std::string autotuneFile = "walrus_autotune.txt";
+      /// spir-v of generated kernels, checked against a checksum before use. delete to recompile
+      std::string kernelCacheDirectory = "walrus_kernels";
+    };
+    ComputePaths _computePaths{};
+    /// a reduction kept in flight on the compute queue while frames render, for ALL tasks
+    struct AsyncCompute {
+      primitives::Reduce reduce{};
+      GpuBuffer<float> input{};
+      GpuBuffer<float> scratch{};
+      GpuBuffer<float> readback{}; // persistently mapped
+      uint32_t count = 0;
+      uint64_t submission = 0; // 0 = nothing submitted yet
+      float result = 0.0f;
+      uint32_t jobs = 0;
+      uint32_t frames = 0; // drawn while a reduction was in flight
+      double deviceMs = 0.0;
+    };
+    AsyncCompute _asyncCompute{};
 
     /// RENDERING
     int _frameNumber{0};
@@ -125,12 +222,21 @@ namespace walrus {
     std::vector<VkImageView> _swapchainImageViews{};
 
     VkRenderPass _renderPass = VK_NULL_HANDLE;
+    /// what pipelines are built & cached against -- see RenderPass::Describe
+    RenderPassInfo _renderPassInfo{};
     std::vector<VkFramebuffer> _framebuffers{};
+    /// the passes of a frame and their barriers, rebuilt every frame
+    FrameGraph _frameGraph{};
 
-    std::vector<VkPipelineLayout> _pipelineLayouts{};
+    /// pipelines & layouts are owned by the cache. `_pipelines` indexes them by shader path.
+    PipelineCache _pipelineCache{};
+    /// driver pipeline cache data saved by the previous run. ignored if saved by another driver or device. delete to start cold
+    std::string _pipelineCacheFile = "walrus_pipeline_cache.bin";
     std::vector<VkPipeline> _pipelines{};
     struct Shaders {
       uint32_t currentIndex = {0};
+      /// if true, rendering starts with the first pipeline while the rest compile in the background
+      bool compileAsync = true;
       std::vector<std::string> filePaths{
         "../../shaders/triangle_red",
         "../../shaders/triangle_RGB"
@@ -138,6 +244,22 @@ namespace walrus {
     };
     Shaders _shaders{};
 
+    /// pipelines compiling on the thread pool. swapped into `_pipelines` by `update_pipelines`
+    struct PipelineJobs {
+      std::vector<std::pair<size_t, std::future<VkPipeline>>> pending{}; // (index into _pipelines, result)
+      std::vector<VkPipelineCache> workerCaches{}; // one per worker, merged once nothing is pending
+      /// sources modified while their pipeline was still building, rebuilt once it completes. at most one build
+      /// per pipeline is pending, so builds can't complete out of order or read spir-v another build is writing
+      std::unordered_map<size_t, std::vector<std::string>> queuedReloads{};
+    };
+    PipelineJobs _pipelineJobs{};
+    /// one builder per shader path, kept for rebuilding pipelines when their shaders change.
+    /// their shader modules are released once built -- rebuilds load the stages again
+    std::vector<PipelineBuilder> _pipelineBuilders{};
+
+    /// HOT RELOAD
+    std::unique_ptr<ShaderWatcher> _shaderWatcher{};
+
     struct Test {
       Mesh mesh{};
       VkPipeline* pipeline = VK_NULL_HANDLE;
@@ -4,6 +4,12 @@
 #include <vk_mem_alloc.h>
 
 struct AllocatedBuffer {
-  VkBuffer buffer;
-  VmaAllocation allocation;
-};
\ No newline at end of file
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VmaAllocation allocation = nullptr;
+  VkDeviceSize size = 0;
+};
+
+struct AllocatedImage {
+  VkImage image = VK_NULL_HANDLE;
+  VmaAllocation allocation = nullptr;
+};